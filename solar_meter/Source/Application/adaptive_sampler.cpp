@@ -0,0 +1,243 @@
+/**
+ *******************************************************************************
+ * @file    adaptive_sampler.cpp
+ * @author  hq
+ * @date    2025-07-23 21:15:37
+ * @brief   Adaptive sampler source file
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * INCLUDES
+ *******************************************************************************/
+#include "adaptive_sampler.hpp"
+
+/*******************************************************************************
+ * EXTERN VARIABLES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * PRIVATE MACROS AND DEFINES
+ *******************************************************************************/
+#define MEAN_FRACTION_BITS          (4u)
+#define MEAN_SCALE                  ((int32_t)(1u << MEAN_FRACTION_BITS))   /* samples are signed, scaled by multiplying */
+#define AVERAGING_SHIFT             (3u)        /* 1/8 weight per new sample   */
+#define US_PER_MS                   (1000u)
+#define PERMILLE                    (1000u)
+#define MILLIHZ_US                  (1000000000ull)
+
+/*******************************************************************************
+ * PRIVATE TYPEDEFS
+ *******************************************************************************/
+
+/*******************************************************************************
+ * STATIC VARIABLES
+ *******************************************************************************/
+
+/* single shot conversion time in us, indexed by ads1115DataRate_t   */
+static const uint32_t conversionTimeUs[ADAPTIVE_SAMPLER_MAX_LEVELS] =
+{
+    125000u, 62500u, 31250u, 15625u, 7813u, 4000u, 2106u, 1163u
+};
+
+/*******************************************************************************
+ * GLOBAL VARIABLES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * STATIC FUNCTION PROTOTYPES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * STATIC FUNCTIONS
+ *******************************************************************************/
+void AdaptiveSampler::setLevel(uint8_t newLevel)
+{
+    level = newLevel;
+    quietCount = 0u;
+    stats.levelChanges++;
+}
+
+/*******************************************************************************
+ * GLOBAL FUNCTIONS
+ *******************************************************************************/
+AdaptiveSampler::AdaptiveSampler() : level(0u),
+                                     levelCount(1u),
+                                     quietCount(0u),
+                                     previousSample(0),
+                                     primed(false),
+                                     meanQ4(0),
+                                     variance(0u),
+                                     conversionUs(0u),
+                                     elapsedUs(0u)
+{
+    memset(&config, 0, sizeof(config));
+    memset(&stats, 0, sizeof(stats));
+}
+
+Status_t AdaptiveSampler::init(const AdaptiveSamplerConfig_t * _config)
+{
+    Status_t status = STATUS_OKAY;
+
+    if (CHECK_POINTER_VALID(_config) == false)
+    {
+        status = STATUS_NULL_POINTER;
+    }
+
+    /*! - bounds must be ordered and the lower thresholds must sit below the
+     *  raise thresholds to give hysteresis */
+    if (    (status == STATUS_OKAY)
+         && (    (_config->maxDataRate < _config->minDataRate)
+              || (_config->maxDataRate > ADS1115_DATA_RATE_860_SPS)
+              || (_config->minSamplePeriodMs == 0u)
+              || (_config->maxSamplePeriodMs < _config->minSamplePeriodMs)
+              || (_config->derivativeLower > _config->derivativeRaise)
+              || (_config->varianceLower > _config->varianceRaise)))
+    {
+        status = STATUS_OUT_OF_BOUNDS;
+    }
+
+    /*! - a conversion has to fit in the sample period at both ends    */
+    if (    (status == STATUS_OKAY)
+         && (    (conversionTimeUs[_config->minDataRate] > ((uint32_t)_config->maxSamplePeriodMs * US_PER_MS))
+              || (conversionTimeUs[_config->maxDataRate] > ((uint32_t)_config->minSamplePeriodMs * US_PER_MS))))
+    {
+        status = STATUS_OUT_OF_BOUNDS;
+    }
+
+    if (status == STATUS_OKAY)
+    {
+        config = *_config;
+        levelCount = (uint8_t)(config.maxDataRate - config.minDataRate + 1);
+        level = 0u;
+        quietCount = 0u;
+        primed = false;
+        variance = 0u;
+        conversionUs = 0u;
+        elapsedUs = 0u;
+        memset(&stats, 0, sizeof(stats));
+    }
+
+    return status;
+}
+
+bool AdaptiveSampler::update(int16_t sample)
+{
+    bool changed = false;
+
+    /*! - account the sample at the rate it was taken with */
+    conversionUs += conversionTimeUs[getDataRate()];
+    elapsedUs += (uint32_t)getSamplePeriodMs() * US_PER_MS;
+    stats.samplesPerLevel[level]++;
+    stats.samples++;
+
+    if (primed == false)
+    {
+        previousSample = sample;
+        meanQ4 = (int32_t)sample * MEAN_SCALE;
+        primed = true;
+    }
+    else
+    {
+        int32_t derivative = (int32_t)sample - (int32_t)previousSample;
+        if (derivative < 0)
+        {
+            derivative = -derivative;
+        }
+        previousSample = sample;
+
+        /*! - exponentially weighted mean and variance  */
+        meanQ4 += (((int32_t)sample * MEAN_SCALE) - meanQ4) >> AVERAGING_SHIFT;
+        int32_t deviation = (int32_t)sample - (meanQ4 >> MEAN_FRACTION_BITS);
+        int64_t square = (int64_t)deviation * deviation;
+        variance = (uint32_t)((int64_t)variance + ((square - (int64_t)variance) >> AVERAGING_SHIFT));
+
+        bool active = ((uint32_t)derivative >= config.derivativeRaise)
+                   || (variance >= config.varianceRaise);
+        bool quiet = ((uint32_t)derivative < config.derivativeLower)
+                  && (variance < config.varianceLower);
+
+        if (active)
+        {
+            /*! - transients are short, go straight to the fastest level */
+            quietCount = 0u;
+            if (level != (levelCount - 1u))
+            {
+                setLevel(levelCount - 1u);
+                changed = true;
+            }
+        }
+        else if (quiet)
+        {
+            /*! - step down one level per quiet hold time */
+            quietCount++;
+            if ((quietCount >= config.quietSamples) && (level > 0u))
+            {
+                setLevel(level - 1u);
+                changed = true;
+            }
+        }
+        else
+        {
+            /*! - inside the hysteresis band, hold the level   */
+            quietCount = 0u;
+        }
+    }
+
+    return changed;
+}
+
+Status_t AdaptiveSampler::applyDataRate(ADS1115 & adc)
+{
+    ads1115ConfigRegister_t configRegister;
+    Status_t status = adc.getConfiguration(&configRegister);
+
+    if (status == STATUS_OKAY)
+    {
+        configRegister.dataRate = (uint8_t)getDataRate();
+        status = adc.setConfiguration(&configRegister);
+    }
+
+    return status;
+}
+
+ads1115DataRate_t AdaptiveSampler::getDataRate(void) const
+{
+    return (ads1115DataRate_t)(config.minDataRate + level);
+}
+
+uint16_t AdaptiveSampler::getSamplePeriodMs(void) const
+{
+    uint16_t period = config.maxSamplePeriodMs;
+
+    if (levelCount > 1u)
+    {
+        uint32_t span = (uint32_t)config.maxSamplePeriodMs - config.minSamplePeriodMs;
+        period = (uint16_t)(config.maxSamplePeriodMs - ((span * level) / (levelCount - 1u)));
+    }
+
+    return period;
+}
+
+Status_t AdaptiveSampler::getStats(AdaptiveSamplerStats_t * _stats)
+{
+    Status_t status = STATUS_OKAY;
+
+    if (CHECK_POINTER_VALID(_stats) == false)
+    {
+        status = STATUS_NULL_POINTER;
+    }
+
+    if (status == STATUS_OKAY)
+    {
+        if (elapsedUs != 0u)
+        {
+            stats.dutyCyclePermille = (uint16_t)((conversionUs * PERMILLE) / elapsedUs);
+            stats.averageRateMilliHz = (uint32_t)(((uint64_t)stats.samples * MILLIHZ_US) / elapsedUs);
+        }
+
+        *_stats = stats;
+    }
+
+    return status;
+}
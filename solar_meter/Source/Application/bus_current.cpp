@@ -0,0 +1,87 @@
+/**
+ *******************************************************************************
+ * @file    bus_current.cpp
+ * @author  hq
+ * @date    2025-08-16 18:42:05
+ * @brief   Bus current source file
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * INCLUDES
+ *******************************************************************************/
+#include "bus_current.hpp"
+
+/*******************************************************************************
+ * EXTERN VARIABLES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * PRIVATE MACROS AND DEFINES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * PRIVATE TYPEDEFS
+ *******************************************************************************/
+
+/*******************************************************************************
+ * STATIC VARIABLES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * GLOBAL VARIABLES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * STATIC FUNCTION PROTOTYPES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * STATIC FUNCTIONS
+ *******************************************************************************/
+
+/*******************************************************************************
+ * GLOBAL FUNCTIONS
+ *******************************************************************************/
+BusCurrent::BusCurrent(float _ampsPerCount) : ampsPerCount(_ampsPerCount),
+                                              sumCounts(0),
+                                              count(0u)
+{
+}
+
+void BusCurrent::init(void)
+{
+    sumCounts = 0;
+    count = 0u;
+}
+
+void BusCurrent::addSample(int16_t counts)
+{
+    /*! - a full sum is kept as is, the mean is still right */
+    if (count < UINT16_MAX)
+    {
+        sumCounts += counts;
+        count++;
+    }
+}
+
+Status_t BusCurrent::getFilteredCurrent(float * value)
+{
+    Status_t status = STATUS_OKAY;
+
+    if (CHECK_POINTER_VALID(value) == false)
+    {
+        status = STATUS_NULL_POINTER;
+    }
+    else if (count == 0u)
+    {
+        status = STATUS_QUEUE_FAIL;
+    }
+    else
+    {
+        *value = ((float)sumCounts / (float)count) * ampsPerCount;
+        init();
+    }
+
+    return status;
+}
@@ -27,7 +27,6 @@
 /************************************
  * PRIVATE MACROS AND DEFINES
  ************************************/
-static const char *TAG = "bus voltage";
 
 /************************************
  * PRIVATE TYPEDEFS
@@ -44,40 +43,60 @@ static const char *TAG = "bus voltage";
 /************************************
  * STATIC FUNCTION PROTOTYPES
  ************************************/
-static void voltage_Task(void *arg);
 
 /************************************
  * STATIC FUNCTIONS
  ************************************/
-static void voltage_Task(void *arg)
+
+/************************************
+ * GLOBAL FUNCTIONS
+ ************************************/
+BusVoltage::BusVoltage(float _voltsPerCount) : voltsPerCount(_voltsPerCount),
+                                               sumCounts(0),
+                                               count(0u)
 {
+}
 
-    /* initialize voltage task */
+void BusVoltage::init(void)
+{
+    sumCounts = 0;
+    count = 0u;
+}
 
-   while (1) 
+void BusVoltage::addSample(int16_t counts)
+{
+    /* a full sum is kept as is, the mean is still right */
+    if (count < UINT16_MAX)
     {
-        /* while i2c data exists send out data  */
-        ESP_LOGI(TAG, "bus voltage task\r\n");
-
-        /* design i2c task, this might have multiple channels*/
-
-
-        vTaskDelay(1000 / portTICK_RATE_MS);
+        sumCounts += counts;
+        count++;
     }
 }
 
-/************************************
- * GLOBAL FUNCTIONS
- ************************************/
-void init_BusVoltage(void)
+Status_t BusVoltage::getFilteredVoltage(float * value)
 {
-    /*  create voltage task */
-    xTaskCreate(voltage_Task, "voltage_task", 1024, NULL, 5, NULL);
+    Status_t status = STATUS_OKAY;
+
+    if (value == NULL)
+    {
+        status = STATUS_NULL_POINTER;
+    }
+    else if (count == 0u)
+    {
+        status = STATUS_QUEUE_FAIL;
+    }
+    else
+    {
+        *value = ((float)sumCounts / (float)count) * voltsPerCount;
+        init();
+    }
+
+    return status;
 }
 
 Status_t get_filtered_voltage(float * value)
 {
-    Status_t retVal = ERR_UNKNOWN;
+    Status_t retVal = STATUS_UNKNOWN;
 
     
 
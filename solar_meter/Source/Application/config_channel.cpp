@@ -0,0 +1,395 @@
+/**
+ *******************************************************************************
+ * @file    config_channel.cpp
+ * @author  hq
+ * @date    2025-08-04 19:12:26
+ * @brief   Config channel source file
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * INCLUDES
+ *******************************************************************************/
+#include "config_channel.hpp"
+#include "crc.h"
+
+extern "C"
+{
+    #include "freertos/task.h"
+    #include "esp_log.h"
+}
+
+/*******************************************************************************
+ * EXTERN VARIABLES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * PRIVATE MACROS AND DEFINES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * PRIVATE TYPEDEFS
+ *******************************************************************************/
+
+/*******************************************************************************
+ * STATIC VARIABLES
+ *******************************************************************************/
+static const char *TAG = "ConfigChannel";
+
+/*******************************************************************************
+ * GLOBAL VARIABLES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * STATIC FUNCTION PROTOTYPES
+ *******************************************************************************/
+static uint16_t getUint16(const uint8_t * src);
+static uint32_t getUint32(const uint8_t * src);
+
+/*******************************************************************************
+ * STATIC FUNCTIONS
+ *******************************************************************************/
+static uint16_t getUint16(const uint8_t * src)
+{
+    return (uint16_t)(src[0] | (src[1] << 8));
+}
+
+static uint32_t getUint32(const uint8_t * src)
+{
+    return (uint32_t)src[0] | ((uint32_t)src[1] << 8) | ((uint32_t)src[2] << 16) | ((uint32_t)src[3] << 24);
+}
+
+Status_t ConfigChannel::validate(const RuntimeConfig_t * config)
+{
+    Status_t status = STATUS_OKAY;
+
+    if (    (config->reportPeriodMs < CONFIG_MIN_REPORT_PERIOD_MS)
+         || (config->reportPeriodMs > CONFIG_MAX_REPORT_PERIOD_MS)
+         || (config->dataRate > ADS1115_DATA_RATE_860_SPS)
+         || (config->pga > CONFIG_MAX_PGA)
+         || (config->filterLength == 0u)
+         || (config->filterLength > CONFIG_MAX_FILTER_LENGTH))
+    {
+        status = STATUS_OUT_OF_BOUNDS;
+    }
+
+    return status;
+}
+
+/*!
+ * \brief applies the key, value pairs of a command on top of config
+ *
+ * \param data - command without header and crc
+ * \param length - bytes of key, value pairs
+ * \param config - starts as the active configuration, left partially
+ * updated on failure
+ * \return Status_t - STATUS_OUT_OF_BOUNDS for an unknown key, a truncated
+ * value or a field out of range
+ */
+Status_t ConfigChannel::decode(const uint8_t * data, uint16_t length, RuntimeConfig_t * config)
+{
+    Status_t status = STATUS_OKAY;
+    uint16_t index = 0u;
+
+    while ((status == STATUS_OKAY) && (index < length))
+    {
+        uint8_t key = data[index++];
+        uint16_t remaining = (uint16_t)(length - index);
+
+        /*! - value size is fixed by the key, an unknown key can not be skipped */
+        if ((key == CONFIG_KEY_REPORT_PERIOD_MS) && (remaining >= sizeof(uint32_t)))
+        {
+            config->reportPeriodMs = getUint32(&data[index]);
+            index += sizeof(uint32_t);
+        }
+        else if ((key == CONFIG_KEY_DATA_RATE) && (remaining >= 1u))
+        {
+            config->dataRate = (ads1115DataRate_t)data[index++];
+        }
+        else if ((key == CONFIG_KEY_PGA) && (remaining >= 1u))
+        {
+            config->pga = data[index++];
+        }
+        else if ((key == CONFIG_KEY_FILTER_LENGTH) && (remaining >= 1u))
+        {
+            config->filterLength = data[index++];
+        }
+        else
+        {
+            status = STATUS_OUT_OF_BOUNDS;
+        }
+    }
+
+    if (status == STATUS_OKAY)
+    {
+        /*! - a command is applied whole or not at all  */
+        status = validate(config);
+    }
+
+    return status;
+}
+
+/*!
+ * \brief queues the ack of a command upstream
+ *
+ * Ack layout, little endian:
+ *  [0..1]  sequence number of the command
+ *  [2]     Status_t result, STATUS_OKAY once the configuration is in effect
+ */
+void ConfigChannel::acknowledge(uint16_t sequence, Status_t result)
+{
+    Status_t status = STATUS_OKAY;
+    NetworkingMessage_t message;
+    MessageBuffer_t * buffer = messagePool.allocate(CONFIG_ACK_SIZE);
+
+    if (CHECK_POINTER_VALID(buffer) == false)
+    {
+        status = STATUS_POOL_EXHAUSTED;
+    }
+
+    if (status == STATUS_OKAY)
+    {
+        buffer->data[0] = (uint8_t)(sequence & 0xFFu);
+        buffer->data[1] = (uint8_t)(sequence >> 8);
+        buffer->data[2] = (uint8_t)result;
+        buffer->length = CONFIG_ACK_SIZE;
+
+        message.id = MESSAGE_ID_CONFIG_ACK;
+        message.timestamp = xTaskGetTickCount();
+        message.buffer = buffer;
+        status = networkingModule.queueNetworkingMessage(&message);
+    }
+
+    if (status != STATUS_OKAY)
+    {
+        taskENTER_CRITICAL();
+        stats.acksDropped++;
+        taskEXIT_CRITICAL();
+
+        ESP_LOGE(TAG, "Error: %i, ack %u dropped", status, sequence);
+    }
+}
+
+/*******************************************************************************
+ * GLOBAL FUNCTIONS
+ *******************************************************************************/
+ConfigChannel::ConfigChannel(NetworkingModule &_networkingModule) :
+                             networkingModule(_networkingModule),
+                             activeSlot(0u),
+                             pending(false),
+                             pendingSequence(0u),
+                             completedValid(false),
+                             completedSequence(0u),
+                             completedResult(STATUS_OKAY)
+{
+    memset(slots, 0, sizeof(slots));
+    memset(&stats, 0, sizeof(stats));
+}
+
+Status_t ConfigChannel::init(const RuntimeConfig_t * config)
+{
+    Status_t status = STATUS_OKAY;
+
+    if (CHECK_POINTER_VALID(config) == false)
+    {
+        status = STATUS_NULL_POINTER;
+    }
+    else
+    {
+        status = validate(config);
+    }
+
+    if (status == STATUS_OKAY)
+    {
+        taskENTER_CRITICAL();
+        slots[0] = *config;
+        slots[1] = *config;
+        activeSlot = 0u;
+        pending = false;
+        taskEXIT_CRITICAL();
+    }
+
+    return status;
+}
+
+void ConfigChannel::onDownlink(const uint8_t * data, uint16_t length)
+{
+    Status_t status = STATUS_OKAY;
+    uint16_t sequence = 0u;
+    Status_t previousResult = STATUS_OKAY;
+    bool duplicate = false;
+    bool busy = false;
+
+    taskENTER_CRITICAL();
+    stats.commandsReceived++;
+    taskEXIT_CRITICAL();
+
+    if (    (CHECK_POINTER_VALID(data) == false)
+         || (length < (CONFIG_COMMAND_HEADER_SIZE + CONFIG_COMMAND_CRC_SIZE)))
+    {
+        status = STATUS_OUT_OF_BOUNDS;
+    }
+    else if (crc_crc16(CRC16_INIT, data, length - CONFIG_COMMAND_CRC_SIZE)
+             != getUint16(&data[length - CONFIG_COMMAND_CRC_SIZE]))
+    {
+        status = STATUS_MEMCMP_FAIL;
+    }
+    else if (data[0] != CONFIG_COMMAND_VERSION)
+    {
+        status = STATUS_OUT_OF_BOUNDS;
+    }
+    else
+    {
+        sequence = getUint16(&data[1]);
+
+        taskENTER_CRITICAL();
+        busy = pending;
+        duplicate = (busy && (sequence == pendingSequence))
+                    || (completedValid && (sequence == completedSequence));
+        previousResult = completedResult;
+        if (duplicate)
+        {
+            stats.duplicates++;
+        }
+        taskEXIT_CRITICAL();
+    }
+
+    if ((status == STATUS_OKAY) && duplicate)
+    {
+        /*! - QoS 1 may deliver twice, ack again once the command is done */
+        if (busy == false)
+        {
+            acknowledge(sequence, previousResult);
+        }
+    }
+    else if ((status == STATUS_OKAY) && busy)
+    {
+        /*! - the sampling loop owns the staging copy until it completes */
+        status = STATUS_QUEUE_FULL;
+    }
+    else if (status == STATUS_OKAY)
+    {
+        RuntimeConfig_t * staged = &slots[activeSlot ^ 1u];
+
+        *staged = slots[activeSlot];
+        status = decode(&data[CONFIG_COMMAND_HEADER_SIZE],
+                        (uint16_t)(length - CONFIG_COMMAND_HEADER_SIZE - CONFIG_COMMAND_CRC_SIZE),
+                        staged);
+
+        if (status == STATUS_OKAY)
+        {
+            taskENTER_CRITICAL();
+            pendingSequence = sequence;
+            pending = true;
+            taskEXIT_CRITICAL();
+        }
+    }
+
+    if (status != STATUS_OKAY)
+    {
+        taskENTER_CRITICAL();
+        stats.commandsRejected++;
+        taskEXIT_CRITICAL();
+        ESP_LOGE(TAG, "Error: %i, command %u rejected", status, sequence);
+
+        /*! - a command too damaged to read its sequence is still acked as 0 */
+        acknowledge(sequence, status);
+    }
+}
+
+bool ConfigChannel::getPending(RuntimeConfig_t * config)
+{
+    bool waiting = false;
+
+    if (CHECK_POINTER_VALID(config))
+    {
+        taskENTER_CRITICAL();
+        waiting = pending;
+        if (waiting)
+        {
+            *config = slots[activeSlot ^ 1u];
+        }
+        taskEXIT_CRITICAL();
+    }
+
+    return waiting;
+}
+
+void ConfigChannel::complete(Status_t result)
+{
+    uint16_t sequence = 0u;
+    bool wasPending = false;
+
+    taskENTER_CRITICAL();
+    wasPending = pending;
+    if (wasPending)
+    {
+        /*! - the swap is the single point where the new configuration
+              becomes the active one */
+        if (result == STATUS_OKAY)
+        {
+            activeSlot ^= 1u;
+            stats.commandsApplied++;
+        }
+        else
+        {
+            stats.commandsRejected++;
+        }
+        sequence = pendingSequence;
+        completedSequence = pendingSequence;
+        completedResult = result;
+        completedValid = true;
+        pending = false;
+    }
+    taskEXIT_CRITICAL();
+
+    if (wasPending)
+    {
+        if (result == STATUS_OKAY)
+        {
+            ESP_LOGI(TAG, "command %u applied", sequence);
+        }
+        else
+        {
+            ESP_LOGE(TAG, "Error: %i, command %u not applied", result, sequence);
+        }
+
+        acknowledge(sequence, result);
+    }
+}
+
+Status_t ConfigChannel::getActive(RuntimeConfig_t * config)
+{
+    Status_t status = STATUS_OKAY;
+
+    if (CHECK_POINTER_VALID(config) == false)
+    {
+        status = STATUS_NULL_POINTER;
+    }
+    else
+    {
+        taskENTER_CRITICAL();
+        *config = slots[activeSlot];
+        taskEXIT_CRITICAL();
+    }
+
+    return status;
+}
+
+Status_t ConfigChannel::getStats(ConfigChannelStats_t * _stats)
+{
+    Status_t status = STATUS_OKAY;
+
+    if (CHECK_POINTER_VALID(_stats) == false)
+    {
+        status = STATUS_NULL_POINTER;
+    }
+    else
+    {
+        taskENTER_CRITICAL();
+        *_stats = stats;
+        taskEXIT_CRITICAL();
+    }
+
+    return status;
+}
@@ -0,0 +1,179 @@
+/**
+ *******************************************************************************
+ * @file    cpu_load_reporter.cpp
+ * @author  hq
+ * @date    2025-08-09 17:52:30
+ * @brief   Cpu load reporter source file
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * INCLUDES
+ *******************************************************************************/
+#include "cpu_load_reporter.hpp"
+
+#include <string.h>
+
+extern "C"
+{
+    #include "freertos/task.h"
+    #include "esp_log.h"
+}
+
+/*******************************************************************************
+ * EXTERN VARIABLES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * PRIVATE MACROS AND DEFINES
+ *******************************************************************************/
+#define US_PER_MS (1000u)
+
+/*******************************************************************************
+ * PRIVATE TYPEDEFS
+ *******************************************************************************/
+
+/*******************************************************************************
+ * STATIC VARIABLES
+ *******************************************************************************/
+static const char *TAG = "CpuLoad";
+
+/*******************************************************************************
+ * GLOBAL VARIABLES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * STATIC FUNCTION PROTOTYPES
+ *******************************************************************************/
+static void putUint16(uint8_t * dst, uint16_t value);
+static void putUint32(uint8_t * dst, uint32_t value);
+
+/*******************************************************************************
+ * STATIC FUNCTIONS
+ *******************************************************************************/
+static void putUint16(uint8_t * dst, uint16_t value)
+{
+    dst[0] = (uint8_t)(value & 0xFFu);
+    dst[1] = (uint8_t)(value >> 8);
+}
+
+static void putUint32(uint8_t * dst, uint32_t value)
+{
+    dst[0] = (uint8_t)(value & 0xFFu);
+    dst[1] = (uint8_t)(value >> 8);
+    dst[2] = (uint8_t)(value >> 16);
+    dst[3] = (uint8_t)(value >> 24);
+}
+
+/*!
+ * \brief queues the summary upstream
+ *
+ * Record layout, little endian:
+ *  [0]     CPU_LOAD_REPORT_VERSION
+ *  [1]     number of task entries
+ *  [2..3]  idle task load, permille
+ *  [4..5]  isr load, permille
+ *  [6..9]  window, ms
+ *  [10..13] context switches in the window
+ *  then per task:
+ *  [0..7]  name, truncated and zero padded
+ *  [8..9]  load, permille
+ *  [10..11] context switches, saturated at 0xFFFF
+ */
+Status_t CpuLoadReporter::queueSummary(const CpuTaskLoad_t * entries, const CpuLoadSummary_t * summary)
+{
+    Status_t status = STATUS_OKAY;
+    NetworkingMessage_t message;
+    uint16_t length = CPU_LOAD_REPORT_HEADER_SIZE + (summary->tasks * CPU_LOAD_REPORT_ENTRY_SIZE);
+    MessageBuffer_t * buffer = messagePool.allocate(length);
+
+    if (CHECK_POINTER_VALID(buffer) == false)
+    {
+        status = STATUS_POOL_EXHAUSTED;
+    }
+
+    if (status == STATUS_OKAY)
+    {
+        uint8_t * dst = buffer->data;
+
+        dst[0] = CPU_LOAD_REPORT_VERSION;
+        dst[1] = summary->tasks;
+        putUint16(&dst[2], summary->idlePermille);
+        putUint16(&dst[4], summary->isrPermille);
+        putUint32(&dst[6], summary->windowUs / US_PER_MS);
+        putUint32(&dst[10], summary->switches);
+        dst += CPU_LOAD_REPORT_HEADER_SIZE;
+
+        for (uint8_t i = 0u; i < summary->tasks; i++)
+        {
+            memset(dst, 0, CPU_LOAD_REPORT_NAME_SIZE);
+            strncpy((char *)dst, entries[i].name, CPU_LOAD_REPORT_NAME_SIZE);
+            putUint16(&dst[CPU_LOAD_REPORT_NAME_SIZE], entries[i].loadPermille);
+            putUint16(&dst[CPU_LOAD_REPORT_NAME_SIZE + 2u],
+                      (entries[i].switches > 0xFFFFu) ? 0xFFFFu : (uint16_t)entries[i].switches);
+            dst += CPU_LOAD_REPORT_ENTRY_SIZE;
+        }
+        buffer->length = length;
+
+        message.id = MESSAGE_ID_CPU_LOAD;
+        message.timestamp = xTaskGetTickCount();
+        message.buffer = buffer;
+        status = networkingModule->queueNetworkingMessage(&message);
+    }
+
+    return status;
+}
+
+void CpuLoadReporter::dispatch(const Event_t & event)
+{
+    CpuLoadSummary_t summary;
+
+    if (event.signal == EVENT_SIGNAL_TIMEOUT)
+    {
+        uint8_t count = monitor.sample(tasks, CPU_LOAD_SLOTS, &summary);
+
+        ESP_LOGI(TAG, "%u ms, idle %u.%u%%, isr %u.%u%%, %u switches",
+                 summary.windowUs / US_PER_MS,
+                 summary.idlePermille / 10u, summary.idlePermille % 10u,
+                 summary.isrPermille / 10u, summary.isrPermille % 10u,
+                 summary.switches);
+
+        for (uint8_t i = 0u; i < count; i++)
+        {
+            ESP_LOGI(TAG, "%-16s %3u.%u%% %u switches", tasks[i].name,
+                     tasks[i].loadPermille / 10u, tasks[i].loadPermille % 10u,
+                     tasks[i].switches);
+        }
+
+        if (CHECK_POINTER_VALID(networkingModule))
+        {
+            Status_t status = queueSummary(tasks, &summary);
+
+            if (status != STATUS_OKAY)
+            {
+                ESP_LOGE(TAG, "Error: %i", status);
+            }
+        }
+    }
+}
+
+/*******************************************************************************
+ * GLOBAL FUNCTIONS
+ *******************************************************************************/
+CpuLoadReporter::CpuLoadReporter(NetworkingModule * _networkingModule) : ActiveObject("CpuLoad"),
+                                                                         networkingModule(_networkingModule)
+{
+    memset(tasks, 0, sizeof(tasks));
+}
+
+Status_t CpuLoadReporter::init(EventDispatcher & dispatcher, uint32_t periodMs)
+{
+    Status_t status = dispatcher.attach(*this);
+
+    if (status == STATUS_OKAY)
+    {
+        status = armTimer(periodMs);
+    }
+
+    return status;
+}
@@ -0,0 +1,554 @@
+/**
+ *******************************************************************************
+ * @file    duty_cycle.cpp
+ * @author  hq
+ * @date    2025-08-12 19:14:26
+ * @brief   Duty cycle source file
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * INCLUDES
+ *******************************************************************************/
+#include "duty_cycle.hpp"
+#include "timing.h"
+#include "crc.h"
+#include "persistent_config.hpp"
+
+#include <stddef.h>
+#include <string.h>
+
+extern "C"
+{
+    #include "freertos/task.h"
+    #include "esp_log.h"
+}
+
+/*******************************************************************************
+ * EXTERN VARIABLES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * PRIVATE MACROS AND DEFINES
+ *******************************************************************************/
+#define US_PER_MS                   (1000u)
+#define MJ_PER_WH                   (3600000.0f)
+#define DUTY_CYCLE_STATE_MAGIC      (0x44435943u)   /* "DCYC"   */
+#define DUTY_CYCLE_STATE_VERSION    (1u)
+
+/*******************************************************************************
+ * PRIVATE TYPEDEFS
+ *******************************************************************************/
+
+/*******************************************************************************
+ * STATIC VARIABLES
+ *******************************************************************************/
+static const char *TAG = "DutyCycle";
+
+/*******************************************************************************
+ * GLOBAL VARIABLES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * STATIC FUNCTION PROTOTYPES
+ *******************************************************************************/
+static void putUint16(uint8_t * dst, uint16_t value);
+static void putUint32(uint8_t * dst, uint32_t value);
+static void putFloat(uint8_t * dst, float value);
+static int32_t toMilli(float value);
+
+/*******************************************************************************
+ * STATIC FUNCTIONS
+ *******************************************************************************/
+static void putUint16(uint8_t * dst, uint16_t value)
+{
+    dst[0] = (uint8_t)(value & 0xFFu);
+    dst[1] = (uint8_t)(value >> 8);
+}
+
+static void putUint32(uint8_t * dst, uint32_t value)
+{
+    dst[0] = (uint8_t)(value & 0xFFu);
+    dst[1] = (uint8_t)(value >> 8);
+    dst[2] = (uint8_t)(value >> 16);
+    dst[3] = (uint8_t)(value >> 24);
+}
+
+static void putFloat(uint8_t * dst, float value)
+{
+    uint32_t bits;
+
+    memcpy(&bits, &value, sizeof(bits));
+    putUint32(dst, bits);
+}
+
+/*!
+ * \brief rounds a value to thousandths, for logging without %f
+ */
+static int32_t toMilli(float value)
+{
+    return (int32_t)((value * 1000.0f) + ((value < 0.0f) ? -0.5f : 0.5f));
+}
+
+/*!
+ * \brief starts one single shot conversion and reads its result
+ */
+Status_t Ads1115BurstSampler::convert(ads1115ConfigRegister_t * configRegister, int16_t * value)
+{
+    ads1115ConversionRegister_t conversion;
+    Status_t status = adc.setConfiguration(configRegister);
+
+    /*! - the start bit reads back as zero while the conversion runs, so
+          the read back compare of the driver fails on a started conversion */
+    if (status == STATUS_MEMCMP_FAIL)
+    {
+        status = STATUS_OKAY;
+    }
+
+    if (status == STATUS_OKAY)
+    {
+        vTaskDelay(pdMS_TO_TICKS(ADS1115_BURST_CONVERSION_WAIT_MS));
+        status = adc.getLatestReading(&conversion);
+    }
+
+    if (status == STATUS_OKAY)
+    {
+        *value = (int16_t)conversion.value;
+    }
+
+    return status;
+}
+
+/*!
+ * \brief restores the state of the previous wake, a missing or corrupted
+ * state starts over from zero
+ */
+void DutyCycle::restore(void)
+{
+    Status_t status = rtcMemory.read(DUTY_CYCLE_RTC_OFFSET, &state, sizeof(state));
+
+    if (   (status != STATUS_OKAY)
+        || (state.magic != DUTY_CYCLE_STATE_MAGIC)
+        || (state.version != DUTY_CYCLE_STATE_VERSION)
+        || (state.crc != stateCrc()))
+    {
+        ESP_LOGI(TAG, "cold start");
+
+        memset(&state, 0, sizeof(state));
+        state.magic = DUTY_CYCLE_STATE_MAGIC;
+        state.version = DUTY_CYCLE_STATE_VERSION;
+        clearRollup();
+    }
+    else
+    {
+        /*! - the cpu clock restarts on every wake, time moves on by the
+              sleep and the awake time of the previous wake   */
+        uint32_t intervalMs = config.sleepMs + state.stats.lastAwakeMs;
+
+        state.clockMs += intervalMs;
+        state.sinceLastPowerMs += intervalMs;
+    }
+}
+
+uint16_t DutyCycle::stateCrc(void) const
+{
+    const uint8_t * bytes = (const uint8_t *)&state;
+    uint32_t start = offsetof(DutyCycleState_t, clockMs);
+
+    return crc_crc16(CRC16_INIT, &bytes[start], sizeof(state) - start);
+}
+
+/*!
+ * \brief adds the mean of one burst to the energy total and the rollup
+ */
+void DutyCycle::fold(float busVoltage, float busCurrent, float power, uint32_t samples)
+{
+    /*! - trapezoidal since the last burst that sampled, the burst means
+          stand for the time the device slept   */
+    if (state.hasLastPower != 0u)
+    {
+        state.energyMj += (int64_t)(((state.lastPower + power) * 0.5f) * (float)state.sinceLastPowerMs);
+    }
+    state.lastPower = power;
+    state.hasLastPower = 1u;
+    state.sinceLastPowerMs = 0u;
+
+    if ((state.rollupWakes == 0u) || (power < state.minPower))
+    {
+        state.minPower = power;
+    }
+    if ((state.rollupWakes == 0u) || (power > state.maxPower))
+    {
+        state.maxPower = power;
+    }
+    state.sumBusVoltage += busVoltage;
+    state.sumBusCurrent += busCurrent;
+    state.sumPower += power;
+    state.rollupSamples += samples;
+    state.rollupWakes++;
+}
+
+void DutyCycle::clearRollup(void)
+{
+    state.rollupWakes = 0u;
+    state.rollupSamples = 0u;
+    state.sumBusVoltage = 0.0f;
+    state.sumBusCurrent = 0.0f;
+    state.sumPower = 0.0f;
+    state.minPower = 0.0f;
+    state.maxPower = 0.0f;
+}
+
+/*!
+ * \brief writes the rollup record
+ *
+ * Record layout, little endian:
+ *  [0]     DUTY_CYCLE_REPORT_VERSION
+ *  [1]     wakes in the rollup, saturated at 0xFF
+ *  [2..3]  samples in the rollup, saturated at 0xFFFF
+ *  [4..7]  mean bus voltage, float
+ *  [8..11] mean bus current, float
+ *  [12..15] mean power, float
+ *  [16..19] lowest burst power, float
+ *  [20..23] highest burst power, float
+ *  [24..27] energy, Wh, float
+ *  [28..31] boot to first sample of this wake, us
+ */
+Status_t DutyCycle::encodeReport(MessageBuffer_t * buffer)
+{
+    DutyCycleRollup_t rollup;
+    Status_t status = getRollup(&rollup);
+
+    if (status == STATUS_OKAY)
+    {
+        uint8_t * dst = buffer->data;
+
+        dst[0] = DUTY_CYCLE_REPORT_VERSION;
+        dst[1] = (rollup.wakes > 0xFFu) ? 0xFFu : (uint8_t)rollup.wakes;
+        putUint16(&dst[2], (rollup.samples > 0xFFFFu) ? 0xFFFFu : (uint16_t)rollup.samples);
+        putFloat(&dst[4], rollup.meanBusVoltage);
+        putFloat(&dst[8], rollup.meanBusCurrent);
+        putFloat(&dst[12], rollup.meanPower);
+        putFloat(&dst[16], rollup.minPower);
+        putFloat(&dst[20], rollup.maxPower);
+        putFloat(&dst[24], rollup.energyWh);
+        putUint32(&dst[28], state.stats.lastBootToSampleUs);
+        buffer->length = DUTY_CYCLE_REPORT_SIZE;
+    }
+
+    return status;
+}
+
+/*******************************************************************************
+ * GLOBAL FUNCTIONS
+ *******************************************************************************/
+Ads1115BurstSampler::Ads1115BurstSampler(ADS1115 & _adc, const Ads1115BurstConfig_t & _config) :
+                                         adc(_adc),
+                                         config(_config)
+{
+    memset(&voltageRegister, 0, sizeof(voltageRegister));
+    memset(&currentRegister, 0, sizeof(currentRegister));
+}
+
+Status_t Ads1115BurstSampler::start(void)
+{
+    /*! - both register words are fixed for the burst, only built once   */
+    voltageRegister.opStatus = 1u;
+    voltageRegister.mux = (uint8_t)config.voltageMux;
+    voltageRegister.pga = config.pga;
+    voltageRegister.mode = ADS1115_MODE_SINGLE_SHOT;
+    voltageRegister.dataRate = (uint8_t)ADS1115_DATA_RATE_860_SPS;
+    voltageRegister.compQueue = ADS1115_COMP_QUEUE_DISABLE;
+
+    currentRegister = voltageRegister;
+    currentRegister.mux = (uint8_t)config.currentMux;
+
+    return STATUS_OKAY;
+}
+
+Status_t Ads1115BurstSampler::read(float * busVoltage, float * busCurrent)
+{
+    Status_t status = STATUS_OKAY;
+    int16_t voltageCounts = 0;
+    int16_t currentCounts = 0;
+
+    if ((CHECK_POINTER_VALID(busVoltage) == false) || (CHECK_POINTER_VALID(busCurrent) == false))
+    {
+        status = STATUS_NULL_POINTER;
+    }
+
+    if (status == STATUS_OKAY)
+    {
+        status = convert(&voltageRegister, &voltageCounts);
+    }
+
+    if (status == STATUS_OKAY)
+    {
+        status = convert(&currentRegister, &currentCounts);
+    }
+
+    if (status == STATUS_OKAY)
+    {
+        *busVoltage = (float)voltageCounts * config.voltsPerCount;
+        *busCurrent = (float)currentCounts * config.ampsPerCount;
+    }
+
+    return status;
+}
+
+DutyCycle::DutyCycle(RtcMemory & _rtcMemory, BurstSampler & _sampler) :
+                     rtcMemory(_rtcMemory),
+                     sampler(_sampler)
+{
+    config.sleepMs = DUTY_CYCLE_DEFAULT_SLEEP_MS;
+    config.burstSamples = DUTY_CYCLE_DEFAULT_BURST_SAMPLES;
+    config.transmitEvery = DUTY_CYCLE_DEFAULT_TRANSMIT_EVERY;
+
+    memset(&state, 0, sizeof(state));
+    memset(payload, 0, sizeof(payload));
+}
+
+Status_t DutyCycle::init(const DutyCycleConfig_t * _config)
+{
+    Status_t status = STATUS_OKAY;
+
+    if (CHECK_POINTER_VALID(_config) == false)
+    {
+        status = STATUS_NULL_POINTER;
+    }
+    else if (   (_config->sleepMs < DUTY_CYCLE_MIN_SLEEP_MS)
+             || (_config->burstSamples == 0u)
+             || (_config->burstSamples > DUTY_CYCLE_MAX_BURST_SAMPLES)
+             || (_config->transmitEvery == 0u))
+    {
+        status = STATUS_OUT_OF_BOUNDS;
+    }
+    else
+    {
+        config = *_config;
+    }
+
+    return status;
+}
+
+Status_t DutyCycle::wake(bool * transmitDue)
+{
+    Status_t status = STATUS_OKAY;
+    float busVoltage = 0.0f;
+    float busCurrent = 0.0f;
+    float sumBusVoltage = 0.0f;
+    float sumBusCurrent = 0.0f;
+    float sumPower = 0.0f;
+    uint32_t samples = 0u;
+
+    if (CHECK_POINTER_VALID(transmitDue) == false)
+    {
+        status = STATUS_NULL_POINTER;
+    }
+
+    if (status == STATUS_OKAY)
+    {
+        restore();
+        state.stats.wakes++;
+        status = sampler.start();
+    }
+
+    if (status == STATUS_OKAY)
+    {
+        for (uint8_t i = 0u; i < config.burstSamples; i++)
+        {
+            if (sampler.read(&busVoltage, &busCurrent) == STATUS_OKAY)
+            {
+                /*! - the latency ends with the first usable sample   */
+                if (samples == 0u)
+                {
+                    uint32_t latencyUs = timing_getTimeUs();
+
+                    state.stats.lastBootToSampleUs = latencyUs;
+                    if ((state.latencyWakes == 0u) || (latencyUs < state.stats.minBootToSampleUs))
+                    {
+                        state.stats.minBootToSampleUs = latencyUs;
+                    }
+                    if (latencyUs > state.stats.maxBootToSampleUs)
+                    {
+                        state.stats.maxBootToSampleUs = latencyUs;
+                    }
+                    state.sumBootToSampleUs += latencyUs;
+                    state.latencyWakes++;
+                    state.stats.meanBootToSampleUs = (uint32_t)(state.sumBootToSampleUs / state.latencyWakes);
+                }
+
+                sumBusVoltage += busVoltage;
+                sumBusCurrent += busCurrent;
+                sumPower += busVoltage * busCurrent;
+                samples++;
+            }
+        }
+        sampler.stop();
+    }
+
+    if (CHECK_POINTER_VALID(transmitDue))
+    {
+        if (samples > 0u)
+        {
+            fold(sumBusVoltage / (float)samples,
+                 sumBusCurrent / (float)samples,
+                 sumPower / (float)samples,
+                 samples);
+        }
+        else
+        {
+            state.stats.sampleFailures++;
+            if (status == STATUS_OKAY)
+            {
+                status = STATUS_HAL_ERROR;
+            }
+            ESP_LOGE(TAG, "Error: %i", status);
+        }
+
+        /*! - a failed transmit keeps the rollup, so it is due again now */
+        *transmitDue = (state.rollupWakes >= config.transmitEvery);
+    }
+
+    return status;
+}
+
+Status_t DutyCycle::transmit(NetworkingTransport * transport)
+{
+    Status_t status = STATUS_OKAY;
+    NetworkingMessage_t message;
+    DutyCycleRollup_t rollup;
+    uint16_t length = 0u;
+    MessageBuffer_t * buffer = nullptr;
+
+    /*! - without a transport nothing is sent, the rollup stays for the next
+          transmit wake and no attempt is counted */
+    if (CHECK_POINTER_VALID(transport) == false)
+    {
+        status = STATUS_NULL_POINTER;
+        ESP_LOGE(TAG, "Error: %i", status);
+    }
+    else
+    {
+        buffer = messagePool.allocate(DUTY_CYCLE_REPORT_SIZE);
+
+        if (CHECK_POINTER_VALID(buffer) == false)
+        {
+            status = STATUS_POOL_EXHAUSTED;
+        }
+
+        if (status == STATUS_OKAY)
+        {
+            status = encodeReport(buffer);
+        }
+
+        /*! - newlib nano has no %f, the values are logged as milli units */
+        if (status == STATUS_OKAY)
+        {
+            getRollup(&rollup);
+            ESP_LOGI(TAG, "%u wakes, %d mV, %d mA, %d mW (%d..%d), %d mWh",
+                     rollup.wakes, toMilli(rollup.meanBusVoltage), toMilli(rollup.meanBusCurrent),
+                     toMilli(rollup.meanPower), toMilli(rollup.minPower), toMilli(rollup.maxPower),
+                     toMilli(rollup.energyWh));
+        }
+
+        /*! - published right away, the networking task is not started on a
+              wake so there is no queue or batch to wait for */
+        if (status == STATUS_OKAY)
+        {
+            message.id = MESSAGE_ID_DUTY_CYCLE;
+            message.timestamp = state.clockMs;
+            message.buffer = buffer;
+            status = serializer.serialize(&message, 1u, payload, sizeof(payload), &length);
+        }
+
+        if (status == STATUS_OKAY)
+        {
+            status = transport->publish(payload, length);
+        }
+
+        if (CHECK_POINTER_VALID(buffer))
+        {
+            messagePool.release(buffer);
+        }
+
+        if (status == STATUS_OKAY)
+        {
+            state.stats.transmits++;
+            clearRollup();
+        }
+        else
+        {
+            state.stats.transmitFailures++;
+            ESP_LOGE(TAG, "Error: %i", status);
+        }
+    }
+
+    return status;
+}
+
+Status_t DutyCycle::persist(void)
+{
+    static_assert((sizeof(DutyCycleState_t) % RTC_MEMORY_ALIGNMENT) == 0u,
+                  "duty cycle state not a multiple of the rtc word size");
+    static_assert((DUTY_CYCLE_RTC_OFFSET + sizeof(DutyCycleState_t)) <= PERSISTENT_CONFIG_RTC_OFFSET,
+                  "duty cycle state runs into the cached configuration");
+
+    state.stats.lastAwakeMs = timing_getTimeUs() / US_PER_MS;
+    state.crc = stateCrc();
+
+    return rtcMemory.write(DUTY_CYCLE_RTC_OFFSET, &state, sizeof(state));
+}
+
+bool DutyCycle::nextWakeTransmits(void) const
+{
+    return ((state.rollupWakes + 1u) >= config.transmitEvery);
+}
+
+uint64_t DutyCycle::getSleepUs(void) const
+{
+    return (uint64_t)config.sleepMs * US_PER_MS;
+}
+
+Status_t DutyCycle::getRollup(DutyCycleRollup_t * rollup)
+{
+    Status_t status = STATUS_OKAY;
+
+    if (CHECK_POINTER_VALID(rollup) == false)
+    {
+        status = STATUS_NULL_POINTER;
+    }
+    else
+    {
+        memset(rollup, 0, sizeof(DutyCycleRollup_t));
+        rollup->wakes = state.rollupWakes;
+        rollup->samples = state.rollupSamples;
+        rollup->minPower = state.minPower;
+        rollup->maxPower = state.maxPower;
+        rollup->energyWh = (float)state.energyMj / MJ_PER_WH;
+        if (state.rollupWakes > 0u)
+        {
+            rollup->meanBusVoltage = state.sumBusVoltage / (float)state.rollupWakes;
+            rollup->meanBusCurrent = state.sumBusCurrent / (float)state.rollupWakes;
+            rollup->meanPower = state.sumPower / (float)state.rollupWakes;
+        }
+    }
+
+    return status;
+}
+
+Status_t DutyCycle::getStats(DutyCycleStats_t * _stats)
+{
+    Status_t status = STATUS_OKAY;
+
+    if (CHECK_POINTER_VALID(_stats) == false)
+    {
+        status = STATUS_NULL_POINTER;
+    }
+    else
+    {
+        *_stats = state.stats;
+    }
+
+    return status;
+}
@@ -0,0 +1,117 @@
+/**
+ *******************************************************************************
+ * @file    adaptive_sampler.hpp
+ * @author  hq
+ * @date    2025-07-23 21:15:37
+ * @brief   Activity driven sampling rate controller for the ADS1115 sampling
+ *  loop. The derivative and a running variance of the raw samples select an
+ *  activity level between the configured bounds. Activity raises the level
+ *  at once, quiet periods lower it one level at a time.
+ *******************************************************************************
+ */
+
+#ifndef ADAPTIVE_SAMPLER_HPP
+#define ADAPTIVE_SAMPLER_HPP
+
+/*******************************************************************************
+ * INCLUDES
+*******************************************************************************/
+#include "common.h"
+#include "typedefs.h"
+#include "ads1115.hpp"
+
+/*******************************************************************************
+ * MACROS AND DEFINES
+*******************************************************************************/
+#define ADAPTIVE_SAMPLER_MAX_LEVELS     (8u)
+
+/*******************************************************************************
+ * TYPEDEFS
+*******************************************************************************/
+typedef struct
+{
+    ads1115DataRate_t minDataRate;      /**< data rate used when quiet              */
+    ads1115DataRate_t maxDataRate;      /**< data rate used during activity         */
+    uint16_t maxSamplePeriodMs;         /**< sample period used when quiet          */
+    uint16_t minSamplePeriodMs;         /**< sample period used during activity     */
+    uint16_t derivativeRaise;           /**< |x[n] - x[n-1]| that raises the level  */
+    uint16_t derivativeLower;           /**< |x[n] - x[n-1]| below which it is quiet */
+    uint32_t varianceRaise;             /**< variance that raises the level         */
+    uint32_t varianceLower;             /**< variance below which it is quiet       */
+    uint16_t quietSamples;              /**< quiet samples before lowering a level  */
+} AdaptiveSamplerConfig_t;
+
+typedef struct
+{
+    uint32_t samples;                   /**< samples seen since init                */
+    uint32_t levelChanges;              /**< number of rate changes                 */
+    uint32_t samplesPerLevel[ADAPTIVE_SAMPLER_MAX_LEVELS];
+    uint16_t dutyCyclePermille;         /**< average adc conversion on time         */
+    uint32_t averageRateMilliHz;        /**< average sampling frequency             */
+} AdaptiveSamplerStats_t;
+
+class AdaptiveSampler
+{
+public:
+    AdaptiveSampler();
+    ~AdaptiveSampler() = default;
+
+    /**
+     * @brief Validates the bounds and hysteresis then starts at the quiet
+     * level.
+     *
+     * @param config - pointer to the controller configuration
+     * @return Status_t - STATUS_OUT_OF_BOUNDS if a bound or threshold pair
+     * is inverted
+     */
+    Status_t init(const AdaptiveSamplerConfig_t * config);
+
+    /**
+     * @brief Feeds one raw sample to the controller.
+     *
+     * @param sample - raw ads1115 conversion value
+     * @return bool - true if the data rate or sample period changed and
+     * should be applied before the next conversion
+     */
+    bool update(int16_t sample);
+
+    /**
+     * @brief Writes the current data rate to the device config register.
+     *
+     * @param adc - ads1115 used by the sampling loop
+     * @return Status_t - status of the configuration read/write
+     */
+    Status_t applyDataRate(ADS1115 & adc);
+
+    ads1115DataRate_t getDataRate(void) const;
+    uint16_t getSamplePeriodMs(void) const;
+    Status_t getStats(AdaptiveSamplerStats_t * stats);
+
+private:
+    AdaptiveSamplerConfig_t config;
+    uint8_t level;
+    uint8_t levelCount;
+    uint16_t quietCount;
+
+    int16_t previousSample;
+    bool primed;
+    int32_t meanQ4;                     /**< running mean, 4 fractional bits    */
+    uint32_t variance;                  /**< running variance in counts^2       */
+
+    uint64_t conversionUs;              /**< adc on time accumulated            */
+    uint64_t elapsedUs;                 /**< sample periods accumulated         */
+    AdaptiveSamplerStats_t stats;
+
+    void setLevel(uint8_t newLevel);
+};
+
+/*******************************************************************************
+ * EXPORTED VARIABLES
+*******************************************************************************/
+
+/*******************************************************************************
+ * GLOBAL FUNCTION PROTOTYPES
+*******************************************************************************/
+
+
+#endif // ADAPTIVE_SAMPLER_HPP
@@ -22,16 +22,44 @@
 /*******************************************************************************
  * TYPEDEFS
 *******************************************************************************/
+/**
+ * @brief Averages the adc conversions of the shunt channel, fed and read by
+ * the task consuming the sample clock, so no locking.
+ */
 class BusCurrent
 {
 public:
-    BusCurrent() = default;
+    /**
+     * @param ampsPerCount - bus amps of one adc count, shunt included
+     */
+    explicit BusCurrent(float _ampsPerCount);
     ~BusCurrent() = default;
+
+    /**
+     * @brief Drops the conversions added so far.
+     */
     void init(void);
+
+    /**
+     * @brief Adds one conversion of the shunt channel.
+     *
+     * @param counts - signed adc result
+     */
+    void addSample(int16_t counts);
+
+    /**
+     * @brief Returns the mean of the conversions added since the last call
+     * and starts a new mean.
+     *
+     * @param value - pointer populated with the current in amps
+     * @return Status_t - STATUS_QUEUE_FAIL if nothing was added
+     */
     Status_t getFilteredCurrent(float * value);
 
     private:
-    // Add any private members or methods if necessary
+    float ampsPerCount;
+    int32_t sumCounts;
+    uint16_t count;
 };
 
 /*******************************************************************************
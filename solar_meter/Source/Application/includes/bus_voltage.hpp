@@ -26,31 +26,42 @@ extern "C" {
 /************************************
  * TYPEDEFS
  ************************************/
+/*  averages the adc conversions of the voltage channel, fed and read by
+ *  the task consuming the sample clock, so no locking */
 class BusVoltage
 {
 public:
-    BusVoltage() = default;
+    /** @param voltsPerCount - bus volts of one adc count, divider included */
+    explicit BusVoltage(float _voltsPerCount);
     ~BusVoltage() = default;
 
-    /** @brief  Initializes Bus Voltage module including
-     *  task and variables
+    /** @brief  Drops the conversions added so far
      *
      *  @param void 
      *  @return void 
      */
     void init(void);
 
-    /** @brief  Returns the filtered voltage from the
-     *  bus voltage module.
+    /** @brief  Adds one conversion of the voltage channel
+     *
+     *  @param counts - signed adc result
+     *  @return void
+     */
+    void addSample(int16_t counts);
+
+    /** @brief  Returns the mean of the conversions added since the
+     *  last call and starts a new mean.
      *
      *  @param value - pointer to a float value that will return
      *  the voltage value
-     *  @return Status_t - returns error type or success
+     *  @return Status_t - STATUS_QUEUE_FAIL if nothing was added
      */
     Status_t getFilteredVoltage(float * value);
 
     private:
-    // Add private members if needed
+    float voltsPerCount;
+    int32_t sumCounts;
+    uint16_t count;
 };
 
 /************************************
@@ -61,6 +72,7 @@ public:
  * GLOBAL FUNCTION PROTOTYPES
  ************************************/
 
+
 #ifdef __cplusplus
 }
 #endif
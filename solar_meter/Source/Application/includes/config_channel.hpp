@@ -0,0 +1,155 @@
+/**
+ *******************************************************************************
+ * @file    config_channel.hpp
+ * @author  hq
+ * @date    2025-08-04 19:12:26
+ * @brief   Runtime reconfiguration over the downlink. Commands arrive as a
+ *  compact binary record, are decoded and validated into a staging copy of
+ *  the configuration and handed over to the sampling loop, which applies
+ *  them at a safe point and swaps the active copy. Every command is
+ *  acknowledged upstream with its sequence number and result.
+ *******************************************************************************
+ */
+
+#ifndef CONFIG_CHANNEL_HPP
+#define CONFIG_CHANNEL_HPP
+
+/*******************************************************************************
+ * INCLUDES
+*******************************************************************************/
+#include "common.h"
+#include "typedefs.h"
+#include "networking.hpp"
+#include "ads1115.hpp"
+
+/*******************************************************************************
+ * MACROS AND DEFINES
+*******************************************************************************/
+#define CONFIG_COMMAND_VERSION          (1u)
+#define CONFIG_COMMAND_HEADER_SIZE      (3u)        /* version, sequence        */
+#define CONFIG_COMMAND_CRC_SIZE         (2u)
+#define CONFIG_ACK_SIZE                 (3u)        /* sequence, status         */
+#define CONFIG_MAX_FILTER_LENGTH        (16u)
+#define CONFIG_MIN_REPORT_PERIOD_MS     (10u)
+#define CONFIG_MAX_REPORT_PERIOD_MS     (3600000u)
+#define CONFIG_MAX_PGA                  (7u)        /* 3 bit register field     */
+
+/*******************************************************************************
+ * TYPEDEFS
+*******************************************************************************/
+
+/*  keys of the command record, the value size is fixed per key
+ *  add new keys at the end, keys are part of the downlink format */
+typedef enum : uint8_t
+{
+    CONFIG_KEY_REPORT_PERIOD_MS = 1u,   /**< uint32, power monitor period           */
+    CONFIG_KEY_DATA_RATE,               /**< uint8, ads1115 data rate code          */
+    CONFIG_KEY_PGA,                     /**< uint8, ads1115 pga code                */
+    CONFIG_KEY_FILTER_LENGTH,           /**< uint8, reported moving average length  */
+} ConfigKey_t;
+
+typedef struct
+{
+    uint32_t reportPeriodMs;
+    ads1115DataRate_t dataRate;
+    uint8_t pga;
+    uint8_t filterLength;
+} RuntimeConfig_t;
+
+typedef struct
+{
+    uint32_t commandsReceived;
+    uint32_t commandsApplied;
+    uint32_t commandsRejected;          /**< malformed, out of range or failed apply */
+    uint32_t duplicates;                /**< redelivered sequence numbers           */
+    uint32_t acksDropped;               /**< acks the networking queue refused      */
+} ConfigChannelStats_t;
+
+class ConfigChannel : public NetworkingReceiver
+{
+public:
+    ConfigChannel(NetworkingModule & networkingModule);
+    ~ConfigChannel() = default;
+
+    /**
+     * @brief Sets the configuration the device is running with, call before
+     * the channel is registered as the networking downlink.
+     *
+     * @param config - pointer to the configuration in effect
+     * @return Status_t - STATUS_OUT_OF_BOUNDS if a field is out of range
+     */
+    Status_t init(const RuntimeConfig_t * config);
+
+    /**
+     * @brief Decodes a command into the staging copy. Runs in the networking
+     * task, rejected commands are acknowledged right away.
+     *
+     * Command layout, little endian:
+     *  [0]     CONFIG_COMMAND_VERSION
+     *  [1..2]  sequence number, echoed in the ack
+     *  [3..]   key, value pairs, only the keys present are changed
+     *  [n-2..] crc16 ccitt over all preceding bytes
+     */
+    void onDownlink(const uint8_t * data, uint16_t length) override;
+
+    /**
+     * @brief Returns the staged configuration if a command is waiting, the
+     * sampling loop calls this at its safe point.
+     *
+     * @param config - pointer populated with the staged configuration
+     * @return bool - true if complete() must be called for the command
+     */
+    bool getPending(RuntimeConfig_t * config);
+
+    /**
+     * @brief Ends the pending command. On success the staged copy becomes
+     * the active configuration, in both cases the result is acknowledged.
+     *
+     * @param result - STATUS_OKAY if the sampling loop applied the staged
+     * configuration
+     */
+    void complete(Status_t result);
+
+    /**
+     * @brief Returns the configuration in effect.
+     */
+    Status_t getActive(RuntimeConfig_t * config);
+
+    Status_t getStats(ConfigChannelStats_t * stats);
+
+private:
+    NetworkingModule & networkingModule;
+
+    /** @brief  Active and staging copies, the staging copy is only written
+     *  by the networking task while no command is pending and only read by
+     *  the sampling loop while one is
+     */
+    RuntimeConfig_t slots[2];
+    volatile uint8_t activeSlot;
+    volatile bool pending;
+    uint16_t pendingSequence;
+
+    /** @brief  Last completed command, a redelivery is acknowledged again
+     *  without applying it twice
+     */
+    bool completedValid;
+    uint16_t completedSequence;
+    Status_t completedResult;
+
+    ConfigChannelStats_t stats;
+
+    Status_t validate(const RuntimeConfig_t * config);
+    Status_t decode(const uint8_t * data, uint16_t length, RuntimeConfig_t * config);
+    void acknowledge(uint16_t sequence, Status_t result);
+};
+
+/*******************************************************************************
+ * EXPORTED VARIABLES
+*******************************************************************************/
+
+/*******************************************************************************
+ * GLOBAL FUNCTION PROTOTYPES
+*******************************************************************************/
+
+
+#endif // CONFIG_CHANNEL_HPP
@@ -0,0 +1,76 @@
+/**
+ *******************************************************************************
+ * @file    cpu_load_reporter.hpp
+ * @author  hq
+ * @date    2025-08-09 17:52:30
+ * @brief   Periodic cpu load summary. Runs as an active object, samples the
+ *  per task cpu accounting once per period, logs it and sends it upstream
+ *  as one MESSAGE_ID_CPU_LOAD record, so starvation and headroom can be
+ *  seen on devices in the field.
+ *******************************************************************************
+ */
+
+#ifndef CPU_LOAD_REPORTER_HPP
+#define CPU_LOAD_REPORTER_HPP
+
+/*******************************************************************************
+ * INCLUDES
+*******************************************************************************/
+#include "common.h"
+#include "typedefs.h"
+#include "active_object.hpp"
+#include "cpu_load.hpp"
+#include "networking.hpp"
+
+/*******************************************************************************
+ * MACROS AND DEFINES
+*******************************************************************************/
+#define CPU_LOAD_REPORT_VERSION         (1u)
+#define CPU_LOAD_REPORT_PERIOD_MS       (60000u)
+#define CPU_LOAD_REPORT_HEADER_SIZE     (14u)
+#define CPU_LOAD_REPORT_NAME_SIZE       (8u)        /* truncated task name      */
+#define CPU_LOAD_REPORT_ENTRY_SIZE      (CPU_LOAD_REPORT_NAME_SIZE + 4u)
+
+/*******************************************************************************
+ * TYPEDEFS
+*******************************************************************************/
+class CpuLoadReporter : public ActiveObject
+{
+public:
+    /**
+     * @param networkingModule - where the summary is sent, nullptr to only
+     * log it
+     */
+    CpuLoadReporter(NetworkingModule * networkingModule);
+    ~CpuLoadReporter() = default;
+
+    /**
+     * @brief Attaches the reporter to a dispatcher and arms its period.
+     *
+     * @param dispatcher - dispatcher that runs the reporter, not started yet
+     * @param periodMs - summary period
+     * @return Status_t
+     */
+    Status_t init(EventDispatcher & dispatcher, uint32_t periodMs = CPU_LOAD_REPORT_PERIOD_MS);
+
+protected:
+    void dispatch(const Event_t & event) override;
+
+private:
+    NetworkingModule * networkingModule;
+    CpuLoadMonitor monitor;
+    CpuTaskLoad_t tasks[CPU_LOAD_SLOTS];    /**< kept off the dispatcher stack   */
+
+    Status_t queueSummary(const CpuTaskLoad_t * tasks, const CpuLoadSummary_t * summary);
+};
+
+/*******************************************************************************
+ * EXPORTED VARIABLES
+*******************************************************************************/
+
+/*******************************************************************************
+ * GLOBAL FUNCTION PROTOTYPES
+*******************************************************************************/
+
+
+#endif // CPU_LOAD_REPORTER_HPP
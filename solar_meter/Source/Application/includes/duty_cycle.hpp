@@ -0,0 +1,244 @@
+/**
+ *******************************************************************************
+ * @file    duty_cycle.hpp
+ * @author  hq
+ * @date    2025-08-12 19:14:26
+ * @brief   Deep sleep operating mode for battery installations. Every wake
+ *  restores the state kept in RTC memory, takes a short burst of single
+ *  shot conversions, folds it into the energy total and the rollup of the
+ *  wakes since the last transmit, and saves the state again before the
+ *  device sleeps. The rollup is only sent every Nth wake, the radio stays
+ *  off on the others.
+ *******************************************************************************
+ */
+
+#ifndef DUTY_CYCLE_HPP
+#define DUTY_CYCLE_HPP
+
+/*******************************************************************************
+ * INCLUDES
+*******************************************************************************/
+#include "common.h"
+#include "typedefs.h"
+#include "rtc_memory.hpp"
+#include "ads1115.hpp"
+#include "networking.hpp"
+#include "message_serializer.hpp"
+
+/*******************************************************************************
+ * MACROS AND DEFINES
+*******************************************************************************/
+#define DUTY_CYCLE_DEFAULT_SLEEP_MS         (60000u)
+#define DUTY_CYCLE_MIN_SLEEP_MS             (1000u)
+#define DUTY_CYCLE_DEFAULT_BURST_SAMPLES    (8u)
+#define DUTY_CYCLE_MAX_BURST_SAMPLES        (64u)
+#define DUTY_CYCLE_DEFAULT_TRANSMIT_EVERY   (10u)
+#define DUTY_CYCLE_RTC_OFFSET               (0u)        /* state at the start of rtc memory */
+#define DUTY_CYCLE_REPORT_VERSION           (1u)
+#define DUTY_CYCLE_REPORT_SIZE              (32u)
+#define DUTY_CYCLE_PAYLOAD_SIZE             (TLV_HEADER_SIZE + TLV_ENTRY_MAX_OVERHEAD + DUTY_CYCLE_REPORT_SIZE)
+
+/* single shot conversion at 860 SPS takes 1163 us */
+#define ADS1115_BURST_CONVERSION_WAIT_MS    (2u)
+
+/*******************************************************************************
+ * TYPEDEFS
+*******************************************************************************/
+typedef struct
+{
+    uint32_t sleepMs;                   /**< deep sleep between two wakes           */
+    uint8_t burstSamples;               /**< voltage and current pairs per wake     */
+    uint8_t transmitEvery;              /**< wakes per transmitted rollup           */
+} DutyCycleConfig_t;
+
+typedef struct
+{
+    uint32_t wakes;                     /**< folded since the last transmit         */
+    uint32_t samples;
+    float meanBusVoltage;
+    float meanBusCurrent;
+    float meanPower;
+    float minPower;                     /**< lowest burst mean                      */
+    float maxPower;                     /**< highest burst mean                     */
+    float energyWh;                     /**< since the rtc state was last lost      */
+} DutyCycleRollup_t;
+
+typedef struct
+{
+    uint32_t wakes;                     /**< since the rtc state was last lost      */
+    uint32_t sampleFailures;            /**< bursts without a single sample         */
+    uint32_t transmits;
+    uint32_t transmitFailures;
+    uint32_t lastBootToSampleUs;        /**< boot to first completed conversion     */
+    uint32_t minBootToSampleUs;
+    uint32_t maxBootToSampleUs;
+    uint32_t meanBootToSampleUs;
+    uint32_t lastAwakeMs;               /**< boot to sleep of the previous wake     */
+} DutyCycleStats_t;
+
+/**
+ * @brief Source of the burst conversions, the ads1115 implementation talks
+ * to the device, a simulated one feeds the wake cycle on the host.
+ */
+class BurstSampler
+{
+public:
+    virtual ~BurstSampler() = default;
+
+    /**
+     * @brief Prepares the device for the burst.
+     */
+    virtual Status_t start(void) = 0;
+
+    /**
+     * @brief Converts one voltage and current pair.
+     */
+    virtual Status_t read(float * busVoltage, float * busCurrent) = 0;
+
+    /**
+     * @brief Called after the burst, the device may be powered down.
+     */
+    virtual void stop(void) {}
+};
+
+typedef struct
+{
+    ads1115Mux_t voltageMux;
+    ads1115Mux_t currentMux;
+    uint8_t pga;                        /**< pga code of the config register        */
+    float voltsPerCount;                /**< bus volts per conversion count         */
+    float ampsPerCount;                 /**< bus amps per conversion count          */
+} Ads1115BurstConfig_t;
+
+/**
+ * @brief Single shot conversions at the highest data rate. The config
+ * register words are computed once, a conversion is one register write, a
+ * fixed wait and one read, no read modify write on the wake path. The
+ * ads1115 powers down by itself after each single shot conversion.
+ */
+class Ads1115BurstSampler : public BurstSampler
+{
+public:
+    Ads1115BurstSampler(ADS1115 & adc, const Ads1115BurstConfig_t & config);
+    ~Ads1115BurstSampler() = default;
+
+    Status_t start(void) override;
+    Status_t read(float * busVoltage, float * busCurrent) override;
+
+private:
+    ADS1115 & adc;
+    Ads1115BurstConfig_t config;
+    ads1115ConfigRegister_t voltageRegister;
+    ads1115ConfigRegister_t currentRegister;
+
+    Status_t convert(ads1115ConfigRegister_t * configRegister, int16_t * value);
+};
+
+/**
+ * @brief One wake of the duty cycle: wake(), transmit() if it is due,
+ * persist(), then deep sleep for getSleepUs(). Nothing here sleeps or
+ * touches the radio, the caller decides, so the cycle runs on the host
+ * with a ram RtcMemory and a simulated sampler.
+ */
+class DutyCycle
+{
+public:
+    DutyCycle(RtcMemory & rtcMemory, BurstSampler & sampler);
+    ~DutyCycle() = default;
+
+    /**
+     * @brief Sets the cycle parameters, call before wake().
+     *
+     * @param config - pointer to the sleep time, burst and transmit ratio
+     * @return Status_t - STATUS_OUT_OF_BOUNDS for a sleep below
+     * DUTY_CYCLE_MIN_SLEEP_MS, an empty or oversized burst or a zero ratio
+     */
+    Status_t init(const DutyCycleConfig_t * config);
+
+    /**
+     * @brief Restores the rtc state, takes the burst and folds it in. The
+     * boot to sample latency is taken at the first completed conversion.
+     *
+     * @param transmitDue - set if the rollup is to be sent on this wake
+     * @return Status_t - STATUS_HAL_ERROR if no conversion succeeded, the
+     * wake is still counted and the state still has to be persisted
+     */
+    Status_t wake(bool * transmitDue);
+
+    /**
+     * @brief Publishes the rollup as a DutyCycle message, TLV encoded, and
+     * starts a new rollup once it went out. A failed publish keeps the
+     * rollup, it is retried on the next wake.
+     *
+     * @param transport - transport the rollup is published on
+     * @return Status_t - STATUS_NULL_POINTER without a transport, the rollup
+     * is kept and the attempt is not counted
+     */
+    Status_t transmit(NetworkingTransport * transport);
+
+    /**
+     * @brief Saves the state for the next wake, call right before sleeping.
+     *
+     * @return Status_t - error of the rtc memory
+     */
+    Status_t persist(void);
+
+    /**
+     * @brief True if the wake after this one transmits, the radio can stay
+     * off on all others.
+     */
+    bool nextWakeTransmits(void) const;
+
+    uint64_t getSleepUs(void) const;
+
+    Status_t getRollup(DutyCycleRollup_t * rollup);
+    Status_t getStats(DutyCycleStats_t * stats);
+
+private:
+    /*  everything kept across deep sleep, a multiple of the rtc word size */
+    typedef struct
+    {
+        uint32_t magic;
+        uint16_t version;
+        uint16_t crc;                   /**< crc_crc16 of everything after it       */
+        uint32_t clockMs;               /**< awake plus sleep time since cold start */
+        int64_t energyMj;
+        float lastPower;                /**< burst mean of the previous wake        */
+        uint32_t hasLastPower;
+        uint32_t sinceLastPowerMs;      /**< time since the burst of lastPower      */
+        uint32_t rollupWakes;
+        uint32_t rollupSamples;
+        float sumBusVoltage;
+        float sumBusCurrent;
+        float sumPower;
+        float minPower;
+        float maxPower;
+        uint64_t sumBootToSampleUs;
+        uint32_t latencyWakes;          /**< wakes that contributed to the sum      */
+        DutyCycleStats_t stats;
+    } DutyCycleState_t;
+
+    RtcMemory & rtcMemory;
+    BurstSampler & sampler;
+    DutyCycleConfig_t config;
+    DutyCycleState_t state;
+    TlvSerializer serializer;
+    uint8_t payload[DUTY_CYCLE_PAYLOAD_SIZE];
+
+    void restore(void);
+    uint16_t stateCrc(void) const;
+    void fold(float busVoltage, float busCurrent, float power, uint32_t samples);
+    void clearRollup(void);
+    Status_t encodeReport(MessageBuffer_t * buffer);
+};
+
+/*******************************************************************************
+ * EXPORTED VARIABLES
+*******************************************************************************/
+
+/*******************************************************************************
+ * GLOBAL FUNCTION PROTOTYPES
+*******************************************************************************/
+
+
+#endif // DUTY_CYCLE_HPP
@@ -0,0 +1,103 @@
+/**
+ *******************************************************************************
+ * @file    message_registry.hpp
+ * @author  hq
+ * @date    2025-07-26 10:48:19
+ * @brief   Compile time registry of telemetry message ids. Messages carry a
+ *  small integer id, the name, unit and type are static data looked up only
+ *  when a message is serialized.
+ *******************************************************************************
+ */
+
+#ifndef MESSAGE_REGISTRY_HPP
+#define MESSAGE_REGISTRY_HPP
+
+/*******************************************************************************
+ * INCLUDES
+*******************************************************************************/
+#include "typedefs.h"
+
+/*******************************************************************************
+ * MACROS AND DEFINES
+*******************************************************************************/
+
+/*  X(id, name, unit, type)
+ *  add new messages at the end, ids are part of the binary telemetry format */
+#define MESSAGE_REGISTRY(X)                                                     \
+    X(MESSAGE_ID_BUS_VOLTAGE,   "BusVoltage",   "V",    MESSAGE_TYPE_FLOAT)     \
+    X(MESSAGE_ID_BUS_CURRENT,   "BusCurrent",   "A",    MESSAGE_TYPE_FLOAT)     \
+    X(MESSAGE_ID_POWER,         "Power",        "W",    MESSAGE_TYPE_FLOAT)     \
+    X(MESSAGE_ID_CAPTURE,       "Capture",      "",     MESSAGE_TYPE_BLOB)      \
+    X(MESSAGE_ID_CONFIG_ACK,    "ConfigAck",    "",     MESSAGE_TYPE_BLOB)      \
+    X(MESSAGE_ID_CPU_LOAD,      "CpuLoad",      "",     MESSAGE_TYPE_BLOB)      \
+    X(MESSAGE_ID_DUTY_CYCLE,    "DutyCycle",    "",     MESSAGE_TYPE_BLOB)
+
+/*******************************************************************************
+ * TYPEDEFS
+*******************************************************************************/
+typedef enum : uint8_t
+{
+    MESSAGE_TYPE_FLOAT,                 /**< one 32 bit float                       */
+    MESSAGE_TYPE_INT32,                 /**< one 32 bit signed integer              */
+    MESSAGE_TYPE_UINT32,                /**< one 32 bit unsigned integer            */
+    MESSAGE_TYPE_BLOB,                  /**< opaque byte payload of message size    */
+
+    TOTAL_MESSAGE_TYPES
+} MessageType_t;
+
+#define MESSAGE_REGISTRY_ENUM(id, name, unit, type)     id,
+typedef enum : uint8_t
+{
+    MESSAGE_REGISTRY(MESSAGE_REGISTRY_ENUM)
+
+    TOTAL_MESSAGE_IDS
+} MessageId_t;
+#undef MESSAGE_REGISTRY_ENUM
+
+typedef struct
+{
+    const char * name;
+    const char * unit;
+    MessageType_t type;
+} MessageInfo_t;
+
+#define MESSAGE_REGISTRY_INFO(id, name, unit, type)     { name, unit, type },
+static constexpr MessageInfo_t messageRegistry[] =
+{
+    MESSAGE_REGISTRY(MESSAGE_REGISTRY_INFO)
+};
+#undef MESSAGE_REGISTRY_INFO
+
+static_assert((sizeof(messageRegistry) / sizeof(messageRegistry[0])) == TOTAL_MESSAGE_IDS,
+              "message registry and message ids out of sync");
+
+/*******************************************************************************
+ * EXPORTED VARIABLES
+*******************************************************************************/
+
+/*******************************************************************************
+ * GLOBAL FUNCTION PROTOTYPES
+*******************************************************************************/
+
+/** @brief  Returns the static metadata of a message id
+ *
+ *  @param id - message id
+ *  @return const MessageInfo_t * - nullptr if the id is not registered
+ */
+static inline const MessageInfo_t * messageRegistry_getInfo(MessageId_t id)
+{
+    return (id < TOTAL_MESSAGE_IDS) ? &messageRegistry[id] : nullptr;
+}
+
+/** @brief  Returns the name of a message id, used by serializers only
+ *
+ *  @param id - message id
+ *  @return const char * - name or "" if the id is not registered
+ */
+static inline const char * messageRegistry_getName(MessageId_t id)
+{
+    return (id < TOTAL_MESSAGE_IDS) ? messageRegistry[id].name : "";
+}
+
+
+#endif // MESSAGE_REGISTRY_HPP
@@ -0,0 +1,137 @@
+/**
+ *******************************************************************************
+ * @file    message_serializer.hpp
+ * @author  hq
+ * @date    2025-07-29 18:37:52
+ * @brief   Serializers that turn a batch of networking messages into one
+ *  payload. The compact binary encoding keyed by message id is the default,
+ *  JSON is available for integrations that need text.
+ *******************************************************************************
+ */
+
+#ifndef MESSAGE_SERIALIZER_HPP
+#define MESSAGE_SERIALIZER_HPP
+
+/*******************************************************************************
+ * INCLUDES
+*******************************************************************************/
+#include "common.h"
+#include "typedefs.h"
+#include "networking.hpp"
+
+/*******************************************************************************
+ * MACROS AND DEFINES
+*******************************************************************************/
+#define TLV_FORMAT_VERSION              (2u)
+#define TLV_HEADER_SIZE                 (6u)    /* version, count, base timestamp   */
+#define TLV_ENTRY_MAX_OVERHEAD          (9u)    /* id, varint delta, varint length  */
+
+#define TIMESERIES_FORMAT_VERSION       (3u)
+#define TIMESERIES_SERIES_OVERHEAD      (3u)    /* id, count, padding of last byte  */
+#define TIMESERIES_BLOB_MAX_OVERHEAD    (7u)    /* timestamp, varint length         */
+#define TIMESERIES_FLOAT_SCALE          (1000.0f)   /* floats are sent in milli units */
+
+/*******************************************************************************
+ * TYPEDEFS
+*******************************************************************************/
+
+/**
+ * @brief Interface of a batch encoding. The sizes are upper bounds, the
+ * networking module uses them to close a batch before it can overflow the
+ * payload buffer.
+ */
+class MessageSerializer
+{
+public:
+    virtual ~MessageSerializer() = default;
+
+    /**
+     * @brief Returns the bytes a batch needs besides its entries.
+     */
+    virtual uint16_t getHeaderSize(void) const = 0;
+
+    /**
+     * @brief Returns the most bytes one message can encode into.
+     */
+    virtual uint16_t getEntrySize(const NetworkingMessage_t * message) const = 0;
+
+    /**
+     * @brief Encodes a batch of messages into one payload.
+     *
+     * @param messages - messages of the batch, in queue order
+     * @param count - number of messages
+     * @param payload - destination buffer
+     * @param capacity - size of the destination buffer
+     * @param length - populated with the payload length
+     * @return Status_t - STATUS_OUT_OF_BOUNDS if the batch does not fit
+     */
+    virtual Status_t serialize(const NetworkingMessage_t * messages, uint16_t count,
+                               uint8_t * payload, uint16_t capacity, uint16_t * length) = 0;
+};
+
+/**
+ * @brief Compact binary encoding, little endian:
+ *  [0]     format version
+ *  [1]     message count
+ *  [2..5]  timestamp of the first message
+ *  then per message
+ *  id, zigzag varint timestamp delta to the previous message,
+ *  varint data length, data
+ *
+ * A float sample takes 7 bytes, names and units stay on the receiving side.
+ */
+class TlvSerializer : public MessageSerializer
+{
+public:
+    uint16_t getHeaderSize(void) const override;
+    uint16_t getEntrySize(const NetworkingMessage_t * message) const override;
+    Status_t serialize(const NetworkingMessage_t * messages, uint16_t count,
+                       uint8_t * payload, uint16_t capacity, uint16_t * length) override;
+};
+
+/**
+ * @brief JSON encoding, names and units are resolved from the message
+ * registry and blobs are base64 encoded:
+ *  {"m":[{"n":"BusVoltage","t":1234,"v":12.345,"u":"V"},...]}
+ */
+class JsonSerializer : public MessageSerializer
+{
+public:
+    uint16_t getHeaderSize(void) const override;
+    uint16_t getEntrySize(const NetworkingMessage_t * message) const override;
+    Status_t serialize(const NetworkingMessage_t * messages, uint16_t count,
+                       uint8_t * payload, uint16_t capacity, uint16_t * length) override;
+};
+
+/**
+ * @brief Time series encoding. Messages are grouped per id and each scalar
+ * series is bit packed by TimeSeriesEncoder, floats as milli units:
+ *  [0]     format version
+ *  [1]     series count
+ *  then per series
+ *  [0]     message id
+ *  [1]     sample count
+ *  [2..]   scalar: codec stream, padded to a byte
+ *          blob: per message 4 byte timestamp, varint length, data
+ *
+ * A periodic, slowly changing float takes one to two bytes.
+ */
+class TimeSeriesSerializer : public MessageSerializer
+{
+public:
+    uint16_t getHeaderSize(void) const override;
+    uint16_t getEntrySize(const NetworkingMessage_t * message) const override;
+    Status_t serialize(const NetworkingMessage_t * messages, uint16_t count,
+                       uint8_t * payload, uint16_t capacity, uint16_t * length) override;
+};
+
+/*******************************************************************************
+ * EXPORTED VARIABLES
+*******************************************************************************/
+
+/*******************************************************************************
+ * GLOBAL FUNCTION PROTOTYPES
+*******************************************************************************/
+
+
+#endif // MESSAGE_SERIALIZER_HPP
@@ -0,0 +1,132 @@
+/**
+ *******************************************************************************
+ * @file    metrics_server.hpp
+ * @author  hq
+ * @date    2025-08-06 18:41:07
+ * @brief   On-device metrics endpoint. A small HTTP server answers scrapes
+ *  of /metrics with Prometheus text and /metrics.bin with the binary record
+ *  stream of MetricsWriter. Registered sources write their samples into one
+ *  fixed chunk buffer that is sent as HTTP chunked transfer encoding, so a
+ *  scrape is never assembled whole in RAM.
+ *******************************************************************************
+ */
+
+#ifndef METRICS_SERVER_HPP
+#define METRICS_SERVER_HPP
+
+/*******************************************************************************
+ * INCLUDES
+*******************************************************************************/
+#include "common.h"
+#include "typedefs.h"
+#include "Task.hpp"
+#include "socket_stream.hpp"
+#include "metrics_writer.hpp"
+
+/*******************************************************************************
+ * MACROS AND DEFINES
+*******************************************************************************/
+#define METRICS_SERVER_DEFAULT_PORT         (9100u)
+#define METRICS_SERVER_MAX_SOURCES          (8u)
+#define METRICS_SERVER_CHUNK_SIZE           (256u)
+#define METRICS_SERVER_REQUEST_SIZE         (64u)       /* request line, rest is skipped */
+#define METRICS_SERVER_REQUEST_TIMEOUT_MS   (2000u)
+#define METRICS_SERVER_ACCEPT_TIMEOUT_MS    (1000u)
+#define METRICS_SERVER_BACKLOG              (2u)
+
+/*******************************************************************************
+ * TYPEDEFS
+*******************************************************************************/
+
+/**
+ * @brief Interface of a module that exposes metrics.
+ */
+class MetricsSource
+{
+public:
+    virtual ~MetricsSource() = default;
+
+    /**
+     * @brief Writes the families of the source, called from the metrics
+     * task on every scrape. Counters are read with the getStats() snapshot
+     * of the module, nothing is reset by a scrape.
+     */
+    virtual void writeMetrics(MetricsWriter & writer) = 0;
+};
+
+typedef struct
+{
+    uint32_t scrapes;                   /**< requests answered with metrics         */
+    uint32_t badRequests;               /**< unknown path, method or timeout        */
+    uint32_t failures;                  /**< scrapes cut short by a send error      */
+    uint32_t lastScrapeBytes;           /**< body bytes of the last scrape          */
+    uint32_t lastScrapeMs;
+    uint32_t maxScrapeMs;
+} MetricsServerStats_t;
+
+/**
+ * @brief Serves one connection at a time, a scrape holds the chunk buffer
+ * and the request buffer only.
+ */
+class MetricsServer : public Task, public MetricsSource
+{
+public:
+    MetricsServer();
+    ~MetricsServer() = default;
+
+    /**
+     * @brief Adds a source, sources are written in the order they were
+     * added. Call before init().
+     *
+     * @param source - metrics source
+     * @return Status_t - STATUS_OUT_OF_BOUNDS if all slots are used
+     */
+    Status_t addSource(MetricsSource * source);
+
+    /**
+     * @brief Starts listening and starts the metrics task, call once the
+     * network interface is up.
+     *
+     * @param port - tcp port, METRICS_SERVER_DEFAULT_PORT by convention
+     * @return Status_t - STATUS_HAL_ERROR if the port can not be bound
+     */
+    Status_t init(uint16_t port);
+
+    /**
+     * @brief Writes heap, task count, message pool and scrape metrics, the
+     * server always reports these before the added sources.
+     */
+    void writeMetrics(MetricsWriter & writer) override;
+
+    Status_t getStats(MetricsServerStats_t * stats);
+
+private:
+    SocketListener listener;
+    SocketStream stream;
+    MetricsWriter writer;
+
+    MetricsSource * sources[METRICS_SERVER_MAX_SOURCES];
+    uint8_t sourceCount;
+
+    uint8_t request[METRICS_SERVER_REQUEST_SIZE];
+    uint8_t chunk[METRICS_SERVER_CHUNK_SIZE];
+
+    MetricsServerStats_t stats;
+
+    void taskRun() override;
+    Status_t readRequest(uint16_t * length);
+    void serve(void);
+    Status_t sendText(const char * text);
+    static Status_t sendChunk(void * context, const uint8_t * data, uint16_t length);
+};
+
+/*******************************************************************************
+ * EXPORTED VARIABLES
+*******************************************************************************/
+
+/*******************************************************************************
+ * GLOBAL FUNCTION PROTOTYPES
+*******************************************************************************/
+
+
+#endif // METRICS_SERVER_HPP
@@ -0,0 +1,104 @@
+/**
+ *******************************************************************************
+ * @file    metrics_sources.hpp
+ * @author  hq
+ * @date    2025-08-06 18:41:07
+ * @brief   Metrics sources of the application modules. Each source reads the
+ *  getStats() snapshot of its module on a scrape, the modules themselves do
+ *  not know about the metrics server.
+ *******************************************************************************
+ */
+
+#ifndef METRICS_SOURCES_HPP
+#define METRICS_SOURCES_HPP
+
+/*******************************************************************************
+ * INCLUDES
+*******************************************************************************/
+#include "common.h"
+#include "typedefs.h"
+#include "metrics_server.hpp"
+#include "networking.hpp"
+#include "mqtt_client.hpp"
+#include "power_monitor.hpp"
+#include "active_object.hpp"
+
+/*******************************************************************************
+ * MACROS AND DEFINES
+*******************************************************************************/
+
+/*******************************************************************************
+ * TYPEDEFS
+*******************************************************************************/
+
+/**
+ * @brief Latest measurements and loop timing of the power monitor
+ */
+class PowerMonitorMetrics : public MetricsSource
+{
+public:
+    PowerMonitorMetrics(PowerMonitor & powerMonitor) : powerMonitor(powerMonitor) {}
+    void writeMetrics(MetricsWriter & writer) override;
+
+private:
+    PowerMonitor & powerMonitor;
+};
+
+/**
+ * @brief I2c bus time, i2c queue depth and sample clock timing
+ */
+class I2cMetrics : public MetricsSource
+{
+public:
+    void writeMetrics(MetricsWriter & writer) override;
+};
+
+/**
+ * @brief Networking queue depth and batching counters
+ */
+class NetworkingMetrics : public MetricsSource
+{
+public:
+    NetworkingMetrics(NetworkingModule & networkingModule) : networkingModule(networkingModule) {}
+    void writeMetrics(MetricsWriter & writer) override;
+
+private:
+    NetworkingModule & networkingModule;
+};
+
+/**
+ * @brief MQTT publish window and connection counters
+ */
+class MqttMetrics : public MetricsSource
+{
+public:
+    MqttMetrics(MqttClient & mqttClient) : mqttClient(mqttClient) {}
+    void writeMetrics(MetricsWriter & writer) override;
+
+private:
+    MqttClient & mqttClient;
+};
+
+/**
+ * @brief Event latency and handler time of an active object dispatcher
+ */
+class DispatcherMetrics : public MetricsSource
+{
+public:
+    DispatcherMetrics(EventDispatcher & dispatcher) : dispatcher(dispatcher) {}
+    void writeMetrics(MetricsWriter & writer) override;
+
+private:
+    EventDispatcher & dispatcher;
+};
+
+/*******************************************************************************
+ * EXPORTED VARIABLES
+*******************************************************************************/
+
+/*******************************************************************************
+ * GLOBAL FUNCTION PROTOTYPES
+*******************************************************************************/
+
+
+#endif // METRICS_SOURCES_HPP
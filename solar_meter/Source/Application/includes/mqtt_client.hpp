@@ -0,0 +1,163 @@
+/**
+ *******************************************************************************
+ * @file    mqtt_client.hpp
+ * @author  hq
+ * @date    2025-08-03 16:48:09
+ * @brief   Minimal MQTT 3.1.1 publisher used as the networking transport.
+ *  Publishes go out at QoS 1 with a window of unacknowledged packets in
+ *  flight, a packet without PUBACK is sent again with the DUP flag once its
+ *  ack timeout expires. Packets are encoded by hand into fixed buffers. An
+ *  optional command topic is subscribed at QoS 1 and its payloads are handed
+ *  to the networking receiver.
+ *******************************************************************************
+ */
+
+#ifndef MQTT_CLIENT_HPP
+#define MQTT_CLIENT_HPP
+
+/*******************************************************************************
+ * INCLUDES
+*******************************************************************************/
+#include "common.h"
+#include "typedefs.h"
+#include "networking.hpp"
+#include "socket_stream.hpp"
+
+/*******************************************************************************
+ * MACROS AND DEFINES
+*******************************************************************************/
+#define MQTT_MAX_WINDOW                 (4u)
+#define MQTT_MAX_TOPIC_LENGTH           (48u)
+#define MQTT_MAX_PACKET_SIZE            (NETWORKING_MAX_PAYLOAD_SIZE + MQTT_MAX_TOPIC_LENGTH + 8u)
+#define MQTT_RX_BUFFER_SIZE             (128u)
+#define MQTT_DEFAULT_KEEP_ALIVE_S       (60u)
+#define MQTT_DEFAULT_ACK_TIMEOUT_MS     (2000u)
+#define MQTT_DEFAULT_MAX_RETRIES        (3u)
+#define MQTT_CONNECT_TIMEOUT_MS         (3000u)
+#define MQTT_RECONNECT_INTERVAL_MS      (5000u)
+
+/*******************************************************************************
+ * TYPEDEFS
+*******************************************************************************/
+typedef struct
+{
+    const char * brokerHost;            /**< dotted ipv4 address                    */
+    uint16_t brokerPort;
+    const char * clientId;
+    const char * topic;                 /**< publish topic of telemetry payloads    */
+    const char * commandTopic;          /**< downlink topic, nullptr for none       */
+    uint16_t keepAliveS;
+    uint8_t windowSize;                 /**< publishes in flight, 1 is stop and wait */
+    uint8_t maxRetries;                 /**< retransmits before the link is reset   */
+    uint32_t ackTimeoutMs;
+} MqttConfig_t;
+
+typedef struct
+{
+    uint32_t publishes;
+    uint32_t acks;
+    uint32_t retransmits;
+    uint32_t windowFull;                /**< publishes refused with a full window   */
+    uint32_t connects;
+    uint32_t connectionLosses;
+    uint32_t downlinks;                 /**< command payloads delivered             */
+    uint32_t subscribeFailures;         /**< command topic refused by the broker    */
+    uint8_t inFlight;
+    uint8_t inFlightHighWater;
+    uint32_t averageAckLatencyMs;       /**< first send to PUBACK                   */
+    uint32_t maxAckLatencyMs;
+} MqttStats_t;
+
+typedef struct
+{
+    bool used;
+    uint8_t retries;
+    uint16_t packetId;
+    uint16_t length;
+    TickType_t firstSentTick;
+    TickType_t sentTick;
+    uint8_t packet[MQTT_MAX_PACKET_SIZE];   /**< encoded PUBLISH, resent as is with DUP */
+} MqttSlot_t;
+
+class MqttClient : public NetworkingTransport
+{
+public:
+    MqttClient(ByteStream & stream);
+    ~MqttClient() = default;
+
+    /**
+     * @brief Sets the broker and window parameters, the connection is made
+     * by the first poll() or publish().
+     *
+     * @param config - pointer to the client configuration
+     * @return Status_t - STATUS_OUT_OF_BOUNDS for a window of 0 or above
+     * MQTT_MAX_WINDOW or a topic longer than MQTT_MAX_TOPIC_LENGTH
+     */
+    Status_t init(const MqttConfig_t * config);
+
+    /**
+     * @brief Sends one payload as a QoS 1 PUBLISH. Returns once the packet
+     * is sent, the PUBACK is collected later by poll() or the next publish.
+     *
+     * @return Status_t - STATUS_QUEUE_FULL if the window stays full for an
+     * ack timeout, STATUS_HAL_ERROR if there is no connection
+     */
+    Status_t publish(const uint8_t * payload, uint16_t length) override;
+
+    /**
+     * @brief Collects acks, retransmits expired packets, keeps the
+     * connection alive and reconnects after a loss.
+     */
+    void poll(void) override;
+
+    /**
+     * @brief Sets where payloads received on the command topic go.
+     */
+    void setReceiver(NetworkingReceiver * receiver) override;
+
+    Status_t getStats(MqttStats_t * stats);
+
+private:
+    ByteStream & stream;
+    NetworkingReceiver * receiver;
+    MqttConfig_t config;
+    bool configured;
+    bool connected;
+    uint16_t nextPacketId;
+    TickType_t lastConnectTick;
+    TickType_t lastSendTick;
+    TickType_t lastReceiveTick;
+
+    MqttSlot_t window[MQTT_MAX_WINDOW];
+    uint8_t inFlight;
+
+    /** @brief  Receive reassembly, packets larger than the buffer are skipped
+     */
+    uint8_t rxBuffer[MQTT_RX_BUFFER_SIZE];
+    uint16_t rxLength;
+    uint32_t rxDiscard;
+
+    MqttStats_t stats;
+    uint64_t ackLatencySumMs;
+
+    Status_t connect(void);
+    Status_t subscribe(void);
+    void connectionLost(void);
+    Status_t sendPacket(const uint8_t * packet, uint16_t length);
+    Status_t receive(uint32_t timeoutMs);
+    Status_t handlePacket(const uint8_t * packet, uint16_t headerLength, uint32_t bodyLength);
+    Status_t handlePublish(uint8_t flags, const uint8_t * body, uint32_t bodyLength);
+    void handlePuback(uint16_t packetId);
+    Status_t retransmitExpired(bool all);
+};
+
+/*******************************************************************************
+ * EXPORTED VARIABLES
+*******************************************************************************/
+
+/*******************************************************************************
+ * GLOBAL FUNCTION PROTOTYPES
+*******************************************************************************/
+
+
+#endif // MQTT_CLIENT_HPP
@@ -13,12 +13,30 @@
 /*******************************************************************************
  * INCLUDES
 *******************************************************************************/
+#include "Task.hpp"
 #include "common.h"
 #include "typedefs.h"
+#include "message_registry.hpp"
+#include "message_pool.hpp"
+
+extern "C"
+{
+    #include "freertos/queue.h"
+}
 
 /*******************************************************************************
  * MACROS AND DEFINES
 *******************************************************************************/
+#define NETWORKING_QUEUE_LENGTH                 (32u)
+#define NETWORKING_MAX_BATCH_MESSAGES           (24u)
+#define NETWORKING_MAX_PAYLOAD_SIZE             (1024u)     /* a base64 capture blob in JSON */
+#define NETWORKING_DEFAULT_BATCH_BYTES          (256u)
+#define NETWORKING_DEFAULT_BATCH_MESSAGES       (16u)
+#define NETWORKING_DEFAULT_BATCH_LATENCY_MS     (1000u)
+#define NETWORKING_DEFAULT_REPLAY_RATE          (256u)      /* bytes per second      */
+#define NETWORKING_REPLAY_BURST_BYTES           (2u * NETWORKING_MAX_PAYLOAD_SIZE)
+#define NETWORKING_REPLAY_INTERVAL_MS           (250u)
+#define NETWORKING_POLL_INTERVAL_MS             (100u)
 
 /*******************************************************************************
  * TYPEDEFS
@@ -29,21 +47,231 @@ typedef struct
      * @brief NetworkingModule packet structure
      * This structure defines the format of a networkingmodule packet.
      */
-    std::string name; // Name of the networkingmodule packet
+    MessageId_t id; // Registry id of the networkingmodule packet, name is resolved when serializing
     uint32_t timestamp; // Timestamp of the networkingmodule packet
-    uint16_t size; // Size of the networkingmodule packet in bytes
-    void * dataPtr; // Data payload of the networkingmodule packet, size can be adjusted as needed
+    MessageBuffer_t * buffer; // Pooled payload, buffer->length bytes, owned by whoever holds the message
 } NetworkingMessage_t;
 
-class NetworkingModule
+typedef struct
+{
+    uint16_t maxBytes;                  /**< publish once the payload reaches this size     */
+    uint16_t maxMessages;               /**< publish once this many messages are batched    */
+    uint32_t maxLatencyMs;              /**< publish this long after the first message      */
+} NetworkingBatchConfig_t;
+
+typedef struct
+{
+    uint32_t messagesQueued;
+    uint32_t messagesDropped;           /**< queue full or invalid message          */
+    uint32_t batchesPublished;          /**< payloads the transport took            */
+    uint32_t publishFailures;           /**< payloads it refused or had no link for */
+    uint32_t flushOnBytes;              /**< batches closed by the size threshold   */
+    uint32_t flushOnCount;              /**< batches closed by the count threshold  */
+    uint32_t flushOnLatency;            /**< batches closed by the deadline         */
+    uint32_t flushOnWindow;             /**< batches sent early to share a burst    */
+    uint32_t averageBatchMessages;      /**< over every batch closed, sent or not   */
+    uint32_t averageBatchBytes;
+    uint32_t averageLatencyMs;          /**< first message queued to publish        */
+    uint32_t maxLatencyMs;
+    uint32_t averageEncodeCycles;       /**< serializer cpu cycles per batch        */
+    uint32_t maxEncodeCycles;
+    uint32_t batchesStored;             /**< failed publishes kept in the store log */
+    uint32_t storeFailures;             /**< failed publishes that were lost        */
+    uint32_t batchesReplayed;
+    uint16_t queueDepth;                /**< messages waiting when sampled          */
+    uint16_t queueHighWater;
+} NetworkingStats_t;
+
+/**
+ * @brief Interface to whatever consumes commands sent down to the device.
+ */
+class NetworkingReceiver
+{
+public:
+    virtual ~NetworkingReceiver() = default;
+
+    /**
+     * @brief Called from the networking task with one downlink payload, the
+     * data is only valid for the duration of the call.
+     */
+    virtual void onDownlink(const uint8_t * data, uint16_t length) = 0;
+};
+
+/**
+ * @brief Interface to whatever moves a combined payload off the device.
+ */
+class NetworkingTransport
+{
+public:
+    virtual ~NetworkingTransport() = default;
+    virtual Status_t publish(const uint8_t * payload, uint16_t length) = 0;
+
+    /**
+     * @brief Called from the networking task at least every
+     * NETWORKING_POLL_INTERVAL_MS for acks, retransmits and keep alive.
+     */
+    virtual void poll(void) {}
+
+    /**
+     * @brief Sets where downlink payloads are delivered, transports without
+     * a downlink ignore it.
+     */
+    virtual void setReceiver(NetworkingReceiver * receiver) { (void)receiver; }
+};
+
+class MessageSerializer;
+class FlashRingLog;
+class TransmitScheduler;
+
+class NetworkingModule : public Task
 {
 public:
-    NetworkingModule() = default;
-    ~NetworkingModule() = default;
-    void init(void);
+    NetworkingModule();
+    ~NetworkingModule();
+
+    /**
+     * @brief Creates the message queue only. Messages queued from now on
+     * wait there until init() starts the networking task, so producers can
+     * start before the network is brought up. Up to queueLength messages
+     * are held, further ones are dropped and counted.
+     *
+     * @param queueLength - messages the queue holds
+     * @return Status_t - STATUS_OS_ERROR if the queue can not be created,
+     * STATUS_OUT_OF_BOUNDS for a zero length
+     */
+    Status_t initQueue(uint16_t queueLength = NETWORKING_QUEUE_LENGTH);
+
+    /**
+     * @brief Creates the message queue unless initQueue() already did and
+     * starts the networking task.
+     *
+     * @return Status_t - STATUS_OS_ERROR if the queue can not be created
+     */
+    Status_t init(void);
+
+    /**
+     * @brief Queues a message for transmission. The message is copied and
+     * the reference to message->buffer passes to the networking module, it
+     * is released after transmit, or right away if queueing fails.
+     *
+     * @param message - message to queue
+     * @return Status_t - STATUS_QUEUE_FULL if the queue has no space
+     */
     Status_t queueNetworkingMessage(NetworkingMessage_t * message);
+
+    /**
+     * @brief Sets the thresholds that close a batch, takes effect with the
+     * next message.
+     *
+     * @param config - pointer to the batching thresholds
+     * @return Status_t - STATUS_OUT_OF_BOUNDS if a threshold is zero or
+     * larger than the payload or batch capacity
+     */
+    Status_t setBatchConfig(const NetworkingBatchConfig_t * config);
+
+    /**
+     * @brief Sets the transport used to publish combined payloads.
+     */
+    void setTransport(NetworkingTransport * transport);
+
+    /**
+     * @brief Sets the consumer of downlink commands. Commands are delivered
+     * from the networking task while the transport is polled.
+     *
+     * @param receiver - command consumer, nullptr drops downlink payloads
+     */
+    void setDownlink(NetworkingReceiver * receiver);
+
+    /**
+     * @brief Sets the payload encoding, the compact binary serializer is used
+     * by default. Takes effect with the next batch.
+     *
+     * @param serializer - encoding to use, nullptr restores the default
+     */
+    void setSerializer(MessageSerializer * serializer);
+
+    /**
+     * @brief Sets the log that keeps payloads whose publish failed. Stored
+     * payloads are replayed, oldest first, while publishing succeeds.
+     *
+     * @param log - mounted log, nullptr disables store and forward
+     */
+    void setStoreLog(FlashRingLog * log);
+
+    /**
+     * @brief Limits the replay of stored payloads so live telemetry keeps
+     * most of the link.
+     *
+     * @param bytesPerSecond - average replay rate, bursts up to
+     * NETWORKING_REPLAY_BURST_BYTES
+     * @return Status_t - STATUS_OUT_OF_BOUNDS for a zero rate
+     */
+    Status_t setReplayRate(uint32_t bytesPerSecond);
+
+    /**
+     * @brief Sets the scheduler that aligns transmits to the radio wake
+     * windows. Batches that reach a threshold are then held until the next
+     * window and sent together with everything else pending, replay of
+     * stored payloads only runs inside these bursts.
+     *
+     * @param scheduler - initialized scheduler, nullptr sends at once
+     */
+    void setTransmitScheduler(TransmitScheduler * scheduler);
+
+    /**
+     * @brief Returns a snapshot of the queue and batching counters.
+     */
+    Status_t getStats(NetworkingStats_t * stats);
+
 private:
-    // Add any private members or methods if necessary
+    /** @brief  Messages waiting to be batched
+     */
+    QueueHandle_t msgQueue;
+
+    /** @brief  Messages of the open batch, their buffers are held until the
+     *  batch is published
+     */
+    NetworkingMessage_t batch[NETWORKING_MAX_BATCH_MESSAGES];
+    uint16_t batchCount;
+    uint16_t batchBytes;
+    TickType_t batchOpenTick;
+
+    /** @brief  Combined payload of the batch being published
+     */
+    uint8_t payload[NETWORKING_MAX_PAYLOAD_SIZE];
+
+    NetworkingBatchConfig_t batchConfig;
+    NetworkingTransport * transport;
+    NetworkingReceiver * downlink;
+    MessageSerializer * serializer;
+    MessageSerializer * batchSerializer;
+    FlashRingLog * storeLog;
+    bool linkUp;
+
+    /** @brief  Transmit windows, a due batch waits for the next one
+     */
+    TransmitScheduler * scheduler;
+    bool flushDue;
+    uint32_t * dueCounter;
+
+    /** @brief  Token bucket of the replay, refilled at replayRate
+     */
+    uint32_t replayRate;
+    uint32_t replayTokens;
+    TickType_t replayRefillTick;
+
+    NetworkingStats_t stats;
+    uint64_t latencySumMs;
+    uint64_t batchMessagesSum;
+    uint64_t batchBytesSum;
+    uint64_t encodeCyclesSum;
+
+    virtual void taskRun();
+    void addToBatch(NetworkingMessage_t * message);
+    void publishBatch(uint32_t * flushCounter);
+    void closeBatch(uint32_t * flushCounter);
+    void runBurst(void);
+    void replayStored(void);
 };
 
 /*******************************************************************************
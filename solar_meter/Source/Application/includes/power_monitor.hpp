@@ -13,27 +13,187 @@
 /*******************************************************************************
  * INCLUDES
 *******************************************************************************/
-#include "Task.hpp"
+#include "active_object.hpp"
 #include "bus_voltage.hpp"
 #include "bus_current.hpp"
-#include "networking.hpp"
+#include "config_channel.hpp"
+#include "power_subscribers.hpp"
+#include "ripple_analyzer.hpp"
+#include "transient_capture.hpp"
+#include "adaptive_sampler.hpp"
+#include "ads1115.hpp"
+#include "sample_clock.h"
 
 /*******************************************************************************
  * MACROS AND DEFINES
 *******************************************************************************/
-#define GET_POWER_NOTIFY_BIT    (0x01)
+#define POWER_MONITOR_DEFAULT_PERIOD_MS    (100u)
+
+/*  sample clock ticks per period, half the slots so a period is read out
+ *  before the slots run full */
+#define POWER_MONITOR_TICKS_PER_PERIOD     (SAMPLE_CLOCK_SLOTS / 2u)
+
+/*  sample clock trigger value of either channel */
+#define POWER_MONITOR_VOLTAGE_CHANNEL      (0u)
+#define POWER_MONITOR_CURRENT_CHANNEL      (1u)
+#define POWER_MONITOR_CHANNELS             (2u)
 
 /*******************************************************************************
  * TYPEDEFS
 *******************************************************************************/
-class PowerMonitor : public Task
+typedef struct
+{
+    uint32_t periodMs;                  /**< current period                         */
+    uint32_t phaseMs;                   /**< offset of the grid from tick zero      */
+    uint32_t cycles;                    /**< completed steps                        */
+    uint32_t missedDeadlines;           /**< periods skipped because of an overrun  */
+    uint32_t lastExecutionUs;           /**< execution time of the last step        */
+    uint32_t minExecutionUs;
+    uint32_t maxExecutionUs;            /**< worst case execution time              */
+    uint32_t meanExecutionUs;
+    uint32_t meanJitterUs;              /**< mean |wake interval - period|          */
+    uint32_t maxJitterUs;               /**< max |wake interval - period|           */
+} PowerMonitorTimingStats_t;
+
+typedef struct
+{
+    float busVoltage;                   /**< filtered, as last reported             */
+    float busCurrent;                   /**< filtered, as last reported             */
+    float power;
+} PowerMonitorMeasurements_t;
+
+/*  adc inputs and range of the sample clock, voltage and current are
+ *  converted single shot on alternate ticks */
+typedef struct
+{
+    ads1115Mux_t voltageMux;
+    ads1115Mux_t currentMux;
+    uint8_t pga;                        /**< ads1115 pga code                       */
+    ads1115DataRate_t dataRate;         /**< one conversion has to fit in a tick    */
+} PowerMonitorAcquisition_t;
+
+typedef struct
+{
+    float samples[CONFIG_MAX_FILTER_LENGTH];
+    float sum;
+    uint8_t length;                     /**< moving average length                  */
+    uint8_t count;                      /**< samples held, up to length             */
+    uint8_t index;
+} PowerMonitorFilter_t;
+
+/*  runs on a shared EventDispatcher, the period is a time event of the
+ *  dispatcher instead of a task of its own. The dispatcher task is the
+ *  consumer of the sample clock, the monitor starts the clock on its first
+ *  period and reads the conversions of the last period on every step. No
+ *  other object on the same dispatcher may wait on task notifications */
+class PowerMonitor : public ActiveObject
 {
 public:
-    PowerMonitor(NetworkingModule & networkingModule, 
+    PowerMonitor(PowerSampleTopic & sampleTopic,
                  BusVoltage & busVoltage, 
-                 BusCurrent & busCurrent);
+                 BusCurrent & busCurrent,
+                 const PowerMonitorAcquisition_t & acquisition,
+                 uint32_t periodMs = POWER_MONITOR_DEFAULT_PERIOD_MS);
     ~PowerMonitor();
 
+    /**
+     * @brief Attaches the monitor to a dispatcher and arms its period,
+     * call before the dispatcher init().
+     *
+     * @param dispatcher - dispatcher that runs the monitor
+     * @return Status_t - STATUS_REINIT_ERROR if the dispatcher runs already
+     */
+    Status_t init(EventDispatcher & dispatcher);
+
+    /**
+     * @brief Sets the period, the time event is armed again at once.
+     *
+     * @param periodMs - period in milliseconds, at least one rtos tick
+     * @return Status_t - STATUS_OUT_OF_BOUNDS if shorter than one tick
+     */
+    Status_t setPeriodMs(uint32_t periodMs);
+
+    /**
+     * @brief Sets the phase of the time event grid, a phase of a period or
+     * more wraps around.
+     */
+    void setPhaseMs(uint32_t phaseMs);
+
+    uint32_t getPeriodMs(void) const { return periodMs; }
+
+    /**
+     * @brief Returns a snapshot of the step counters. The wake interval is
+     * the time between two steps.
+     *
+     * @param stats - pointer populated with the counters
+     * @return Status_t
+     */
+    Status_t getTimingStats(PowerMonitorTimingStats_t * stats);
+
+    /**
+     * @brief Returns the values of the last period.
+     *
+     * @param measurements - pointer populated with the latest values
+     * @return Status_t
+     */
+    Status_t getMeasurements(PowerMonitorMeasurements_t * measurements);
+
+    /**
+     * @brief Connects the downlink configuration, call before the task is
+     * started. The period, data rate, pga and filter length are taken from
+     * the active configuration. Staged commands are applied between two
+     * periods, the sample clock is stopped first so a stop that fails
+     * leaves the previous configuration in effect. It is started again
+     * with the new settings on the next period.
+     *
+     * @param configChannel - staged configuration source, nullptr to detach
+     */
+    void setConfigChannel(ConfigChannel * configChannel);
+
+    /**
+     * @brief Feeds every bus voltage conversion to a ripple analyzer. The
+     * analyzer is set up again, FFT on, each time the sample clock starts,
+     * at the rate one channel is converted with. Set before init().
+     *
+     * @param rippleAnalyzer - analyzer of the raw samples, nullptr to detach
+     */
+    void setRippleAnalyzer(RippleAnalyzer * rippleAnalyzer);
+
+    /**
+     * @brief Returns the result of the last full ripple block.
+     *
+     * @param ripple - pointer populated with the latest result
+     * @return Status_t - STATUS_UNKNOWN until a block has been analysed
+     */
+    Status_t getRipple(RippleResult_t * ripple);
+
+    /**
+     * @brief Records every bus voltage conversion in a transient capture.
+     * A frozen capture is published, and re-armed, at the end of the
+     * period it froze in. Set before init().
+     *
+     * @param transientCapture - configured capture, nullptr to detach
+     */
+    void setTransientCapture(TransientCapture * transientCapture);
+
+    /**
+     * @brief Lets an adaptive sampler pick the data rate and the period
+     * from the bus voltage conversions. Its sample period is the time
+     * between two conversions of one channel. A level change is applied
+     * between two periods like a staged configuration, and takes over
+     * from the data rate and period of the last downlink command. Set
+     * before init(), the current level is applied at once.
+     *
+     * @param adaptiveSampler - initialised sampler, nullptr to detach
+     */
+    void setAdaptiveSampler(AdaptiveSampler * adaptiveSampler);
+
+protected:
+    /**
+     * @brief Runs step() on the time event.
+     */
+    void dispatch(const Event_t & event) override;
+
 private:
     /**
      * @brief Stores the latest measured bus voltage value.
@@ -56,34 +216,99 @@ private:
      */
     BusCurrent & busCurrent;
 
-    /** @brief  NetworkingModule object
-     *  This object is used to send networking data.
+    /** @brief  Topic the samples are published on, its subscribers
+     *  forward, integrate or store them.
+     */
+    PowerSampleTopic & sampleTopic;
+
+    /** @brief  Downlink configuration
+     */
+    ConfigChannel * configChannel;
+
+    /** @brief  Raw sample analysis, the copy of the last result is read
+     *  from other tasks
+     */
+    RippleAnalyzer * rippleAnalyzer;
+    bool rippleActive;                  /**< set up for the running sample clock    */
+    RippleResult_t latestRipple;
+    bool rippleValid;
+    TransientCapture * transientCapture;
+
+    /** @brief  Rate selection, set by readSamples() when the level changed
+     */
+    AdaptiveSampler * adaptiveSampler;
+    bool levelChanged;
+
+    /** @brief  Adc setup the sample clock is started with, sampling is
+     *  set while it runs
      */
-    NetworkingModule & networkingModule;
+    PowerMonitorAcquisition_t acquisition;
+    bool sampling;
 
-    /** @brief  Telemetry object
-     *  This object is used to send telemetry data.
+    /** @brief  Time event settings, armed once attached
      */
-    NetworkingMessage_t busVoltageMessage;
-    NetworkingMessage_t busCurrentMessage;
-    NetworkingMessage_t powerMessage;
+    volatile uint32_t periodMs;
+    uint32_t phaseMs;
+    bool attached;
 
-    /** @brief  Runs the power monitor task
-     *  This function is called to start the power monitor task.
+    /** @brief  Step counters, owned by the dispatcher task
      */
-    virtual void taskRun();
+    PowerMonitorTimingStats_t timingStats;
+    uint64_t jitterSumUs;
+    uint32_t jitterSamples;
+    uint64_t executionSumUs;
+    uint32_t lastStepUs;
+    bool hasInterval;                   /**< false until a step after an arm       */
+
+    /** @brief  Moving averages of the reported voltage and current
+     */
+    PowerMonitorFilter_t voltageFilter;
+    PowerMonitorFilter_t currentFilter;
+
+    /**
+     * @brief Applies a staged configuration, called between two periods.
+     */
+    void applyPendingConfig(void);
+
+    /**
+     * @brief Applies the level of the adaptive sampler, called between two
+     * periods.
+     *
+     * @return Status_t - STATUS_OUT_OF_BOUNDS if a conversion does not fit
+     * in a tick of the level
+     */
+    Status_t applySamplerLevel(void);
+
+    /**
+     * @brief Starts the sample clock with this task as the consumer.
+     */
+    Status_t startSampling(void);
+
+    /**
+     * @brief Hands the conversions completed so far to the bus voltage and
+     * bus current means, and the raw voltage to the ripple analyzer, the
+     * transient capture and the adaptive sampler.
+     */
+    void readSamples(void);
+
+    /** @brief  Measures and publishes voltage, current and power once per
+     *  period, then applies a staged configuration.
+     */
+    void step(void);
+
     /**
-     * @brief Queues the bus voltage message for transmission.
+     * @brief Counts one step, its execution time and the interval since
+     * the previous one.
      */
-    Status_t queueBusVoltageMessage(void);
+    void updateTimingStats(uint32_t stepUs, uint32_t executionUs);
     /**
-     * @brief Queues the bus current message for transmission.
+     * @brief Reads and filters the bus voltage.
      */
-    Status_t queueBusCurrentMessage(void);
+    Status_t measureBusVoltage(void);
     /**
-     * @brief Queues the power message for transmission.
+     * @brief Reads and filters the bus current.
      */
-    Status_t queuePowerMessage(void);
+    Status_t measureBusCurrent(void);
 };
 
 
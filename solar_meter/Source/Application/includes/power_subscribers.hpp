@@ -0,0 +1,94 @@
+/**
+ *******************************************************************************
+ * @file    power_subscribers.hpp
+ * @author  hq
+ * @date    2025-08-10 16:08:52
+ * @brief   Consumers of the power monitor samples and the topic that wires
+ *  them up. A new consumer is a class with onPublish() for PowerSample_t,
+ *  added to the PowerSampleTopic subscriber list and to its constructor
+ *  call, the power monitor itself does not change.
+ *******************************************************************************
+ */
+
+#ifndef POWER_SUBSCRIBERS_HPP
+#define POWER_SUBSCRIBERS_HPP
+
+/*******************************************************************************
+ * INCLUDES
+*******************************************************************************/
+#include "common.h"
+#include "typedefs.h"
+#include "message_bus.hpp"
+#include "networking.hpp"
+
+/*******************************************************************************
+ * MACROS AND DEFINES
+*******************************************************************************/
+#define ENERGY_MAX_GAP_MS       (10000u)    /* longer gaps are not integrated   */
+
+/*******************************************************************************
+ * TYPEDEFS
+*******************************************************************************/
+typedef struct
+{
+    uint32_t timestamp;                 /**< tick count of the measurement          */
+    float busVoltage;                   /**< filtered                               */
+    float busCurrent;                   /**< filtered                               */
+    float power;
+} PowerSample_t;
+
+/**
+ * @brief Forwards every sample upstream as the BusVoltage, BusCurrent and
+ * Power telemetry messages.
+ */
+class PowerTelemetry
+{
+public:
+    PowerTelemetry(NetworkingModule & networkingModule) : networkingModule(networkingModule) {}
+
+    void onPublish(const Sample<PowerSample_t> & sample);
+
+private:
+    NetworkingModule & networkingModule;
+
+    Status_t queueFloatMessage(MessageId_t id, uint32_t timestamp, float value);
+};
+
+/**
+ * @brief Integrates power over time into the energy delivered since boot,
+ * trapezoidal between two samples.
+ */
+class EnergyIntegrator
+{
+public:
+    EnergyIntegrator();
+
+    void onPublish(const Sample<PowerSample_t> & sample);
+
+    /**
+     * @brief Returns the energy integrated so far.
+     *
+     * @return float - energy in watt hours
+     */
+    float getEnergyWh(void);
+
+private:
+    int64_t energyUj;                   /**< milliwatt ms, i.e. microjoules         */
+    uint32_t lastTimestamp;
+    float lastPower;
+    bool hasLast;
+};
+
+/*  subscribers of the power monitor samples, delivered in this order */
+typedef Topic<PowerSample_t, EnergyIntegrator, PowerTelemetry> PowerSampleTopic;
+
+/*******************************************************************************
+ * EXPORTED VARIABLES
+*******************************************************************************/
+
+/*******************************************************************************
+ * GLOBAL FUNCTION PROTOTYPES
+*******************************************************************************/
+
+
+#endif // POWER_SUBSCRIBERS_HPP
@@ -0,0 +1,133 @@
+/**
+ *******************************************************************************
+ * @file    ripple_analyzer.hpp
+ * @author  hq
+ * @date    2025-07-21 19:10:42
+ * @brief   Integer only spectral analysis of the bus voltage sample stream.
+ *  Samples are collected into a fixed block, Goertzel bins are evaluated at
+ *  the configured ripple frequencies and an optional Q15 radix-2 FFT runs in
+ *  place over the Hann windowed block to find the dominant ripple tone.
+ *******************************************************************************
+ */
+
+#ifndef RIPPLE_ANALYZER_HPP
+#define RIPPLE_ANALYZER_HPP
+
+/*******************************************************************************
+ * INCLUDES
+*******************************************************************************/
+#include "common.h"
+#include "typedefs.h"
+
+/*******************************************************************************
+ * MACROS AND DEFINES
+*******************************************************************************/
+#define RIPPLE_BLOCK_LOG2               (7u)
+#define RIPPLE_BLOCK_SIZE               (1u << RIPPLE_BLOCK_LOG2)
+#define RIPPLE_MAX_GOERTZEL_BINS        (4u)
+
+/*******************************************************************************
+ * TYPEDEFS
+*******************************************************************************/
+typedef struct
+{
+    uint32_t rippleAmplitude;           /**< amplitude of the dominant tone in adc counts   */
+    uint32_t ripplePeakToPeak;          /**< max - min of the block in adc counts           */
+    uint32_t dominantFrequencyDeciHz;   /**< dominant tone frequency in 0.1 Hz              */
+    int16_t  blockMean;                 /**< dc level of the block in adc counts            */
+    uint32_t cyclesPerBlock;            /**< cpu cycles spent analysing the last block      */
+} RippleResult_t;
+
+class RippleAnalyzer
+{
+public:
+    RippleAnalyzer();
+    ~RippleAnalyzer() = default;
+
+    /**
+     * @brief Configures the analyzer for the given sample rate and clears
+     * all goertzel bins and the sample block.
+     *
+     * @param sampleRateHz - rate at which samples are pushed
+     * @param fftEnabled - run the windowed fft on every block
+     * @return Status_t - STATUS_OUT_OF_BOUNDS if the rate is zero
+     */
+    Status_t init(uint16_t sampleRateHz, bool fftEnabled);
+
+    /**
+     * @brief Adds a goertzel bin at the given frequency.
+     *
+     * @param frequencyHz - must be below the nyquist frequency
+     * @return Status_t - STATUS_OUT_OF_BOUNDS if full or frequency invalid
+     */
+    Status_t addGoertzelBin(uint16_t frequencyHz);
+
+    /**
+     * @brief Adds one raw adc sample to the current block, the block is
+     * analysed once RIPPLE_BLOCK_SIZE samples have been collected.
+     *
+     * @param sample - raw ads1115 conversion value
+     * @return bool - true if a new result became available with this sample
+     */
+    bool pushSample(int16_t sample);
+
+    /**
+     * @brief Returns the result of the last analysed block.
+     *
+     * @param result - pointer that is populated with the latest result
+     * @return Status_t - STATUS_NULL_POINTER or STATUS_UNKNOWN if no block
+     * has been analysed yet
+     */
+    Status_t getResult(RippleResult_t * result);
+
+    /**
+     * @brief Returns the amplitude in adc counts measured by a goertzel bin
+     * over the last block.
+     *
+     * @param bin - index in the order bins were added
+     * @param amplitude - pointer populated with the amplitude
+     * @return Status_t
+     */
+    Status_t getBinAmplitude(uint8_t bin, uint32_t * amplitude);
+
+private:
+    typedef struct
+    {
+        uint16_t frequencyHz;
+        int32_t  coeffQ14;              /**< 2cos(w) in Q14                  */
+        uint32_t amplitude;
+    } GoertzelBin_t;
+
+    /** @brief  real part of the block, holds raw samples until the block is
+     *  full and is then transformed in place
+     */
+    int16_t blockRe[RIPPLE_BLOCK_SIZE];
+    /** @brief  imaginary part used by the fft
+     */
+    int16_t blockIm[RIPPLE_BLOCK_SIZE];
+    uint16_t blockIndex;
+
+    GoertzelBin_t bins[RIPPLE_MAX_GOERTZEL_BINS];
+    uint8_t binCount;
+
+    uint16_t sampleRateHz;
+    bool fftEnabled;
+    bool resultValid;
+    RippleResult_t result;
+
+    void analyseBlock(void);
+    void runGoertzel(void);
+    void runFft(void);
+    void findDominantTone(void);
+};
+
+/*******************************************************************************
+ * EXPORTED VARIABLES
+*******************************************************************************/
+
+/*******************************************************************************
+ * GLOBAL FUNCTION PROTOTYPES
+*******************************************************************************/
+
+
+#endif // RIPPLE_ANALYZER_HPP
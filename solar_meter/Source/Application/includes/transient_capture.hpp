@@ -0,0 +1,163 @@
+/**
+ *******************************************************************************
+ * @file    transient_capture.hpp
+ * @author  hq
+ * @date    2025-07-22 20:41:05
+ * @brief   Pre/post trigger capture of raw adc samples. Samples are written
+ *  continuously into a fixed ring, when a level or slope trigger fires the
+ *  ring is frozen once the post trigger samples are in and the block is
+ *  handed to the networking module as one delta compressed blob.
+ *******************************************************************************
+ */
+
+#ifndef TRANSIENT_CAPTURE_HPP
+#define TRANSIENT_CAPTURE_HPP
+
+/*******************************************************************************
+ * INCLUDES
+*******************************************************************************/
+#include "common.h"
+#include "typedefs.h"
+#include "networking.hpp"
+
+/*******************************************************************************
+ * MACROS AND DEFINES
+*******************************************************************************/
+#define CAPTURE_RING_SIZE               (256u)      /* must be a power of 2     */
+#define CAPTURE_RING_MASK               (CAPTURE_RING_SIZE - 1u)
+#define CAPTURE_BLOB_HEADER_SIZE        (8u)
+#define CAPTURE_BLOB_MAX_SIZE           (CAPTURE_BLOB_HEADER_SIZE + (2u * CAPTURE_RING_SIZE))
+#define CAPTURE_BLOB_VERSION            (1u)
+#define CAPTURE_BLOB_RAW_FLAG           (0x80u)     /* in the trigger byte      */
+
+/*******************************************************************************
+ * TYPEDEFS
+*******************************************************************************/
+typedef enum
+{
+    CAPTURE_TRIGGER_LEVEL_BELOW,        /**< fires when sample < threshold              */
+    CAPTURE_TRIGGER_LEVEL_ABOVE,        /**< fires when sample > threshold              */
+    CAPTURE_TRIGGER_SLOPE_FALLING,      /**< fires when previous - sample > threshold   */
+    CAPTURE_TRIGGER_SLOPE_RISING,       /**< fires when sample - previous > threshold   */
+} CaptureTrigger_t;
+
+typedef struct
+{
+    CaptureTrigger_t trigger;
+    int16_t threshold;                  /**< level or slope in adc counts       */
+    uint16_t preSamples;                /**< samples kept before the trigger    */
+    uint16_t postSamples;               /**< samples kept from the trigger on   */
+} CaptureConfig_t;
+
+typedef enum
+{
+    CAPTURE_STATE_IDLE,
+    CAPTURE_STATE_ARMED,
+    CAPTURE_STATE_POST_TRIGGER,
+    CAPTURE_STATE_FROZEN,
+} CaptureState_t;
+
+class TransientCapture
+{
+public:
+    TransientCapture(NetworkingModule & networkingModule);
+    ~TransientCapture() = default;
+
+    /**
+     * @brief Sets the trigger and the pre/post sample counts then arms the
+     * capture.
+     *
+     * @param config - pointer to capture configuration
+     * @return Status_t - STATUS_OUT_OF_BOUNDS if pre + post does not fit the ring
+     */
+    Status_t configure(const CaptureConfig_t * config);
+
+    /**
+     * @brief Records one raw sample. The common path is one ring write and
+     * one compare, trigger handling is only entered when the compare fires
+     * or while post trigger samples are being collected.
+     *
+     * @param sample - raw ads1115 conversion value
+     */
+    inline void pushSample(int16_t sample)
+    {
+        writeBase[writeIndex & writeMask] = sample;
+        writeIndex++;
+
+        int32_t metric = ((int32_t)sample - (int32_t)(previousSample & referenceMask)) * polarity;
+        previousSample = sample;
+
+        if (metric > triggerLevel)
+        {
+            onTrigger();
+        }
+    }
+
+    /**
+     * @brief Returns the current capture state
+     */
+    CaptureState_t getState(void) const { return state; }
+
+    /**
+     * @brief Compresses the frozen block, queues it to the networking module
+     * and re-arms the capture.
+     *
+     * @return Status_t - STATUS_UNKNOWN if no block is frozen,
+     * STATUS_POOL_EXHAUSTED if no buffer is free. A block that does not
+     * compress into the blob is sent raw.
+     */
+    Status_t publishCapture(void);
+
+private:
+    /** @brief  Raw sample ring
+     */
+    int16_t ring[CAPTURE_RING_SIZE];
+    /** @brief  Write target, points at the ring while recording and at
+     *  discardSample with a zero mask while frozen so the write path never
+     *  branches.
+     */
+    int16_t * writeBase;
+    int16_t discardSample;
+    uint32_t writeMask;
+    uint32_t writeIndex;
+
+    /** @brief  Trigger compare state, metric = (sample - reference) * polarity
+     *  where the reference is zero for level triggers and the previous
+     *  sample for slope triggers.
+     */
+    int16_t previousSample;
+    int16_t referenceMask;
+    int32_t polarity;
+    int32_t triggerLevel;
+    /** @brief  Slope level held back while the first sample after arming
+     *  becomes the reference.
+     */
+    int32_t armedLevel;
+    bool awaitingReference;
+
+    CaptureConfig_t config;
+    CaptureState_t state;
+    uint32_t triggerIndex;
+    uint32_t blockStart;
+    uint16_t blockLength;
+    uint16_t postRemaining;
+
+    uint32_t triggerTick;
+    NetworkingModule & networkingModule;
+
+    void arm(void);
+    void freeze(void);
+    void onTrigger(void);
+    Status_t compressBlock(MessageBuffer_t * buffer);
+};
+
+/*******************************************************************************
+ * EXPORTED VARIABLES
+*******************************************************************************/
+
+/*******************************************************************************
+ * GLOBAL FUNCTION PROTOTYPES
+*******************************************************************************/
+
+
+#endif // TRANSIENT_CAPTURE_HPP
@@ -0,0 +1,132 @@
+/**
+ *******************************************************************************
+ * @file    transmit_scheduler.hpp
+ * @author  hq
+ * @date    2025-08-05 20:34:51
+ * @brief   Wi-Fi power save aware transmit scheduling for the networking
+ *  module. The station power save mode is picked from the reporting
+ *  interval, batches that are due are held until the next radio wake window
+ *  and everything pending is then sent in one burst. Radio on time spent on
+ *  bursts is accounted per hour.
+ *******************************************************************************
+ */
+
+#ifndef TRANSMIT_SCHEDULER_HPP
+#define TRANSMIT_SCHEDULER_HPP
+
+/*******************************************************************************
+ * INCLUDES
+*******************************************************************************/
+#include "common.h"
+#include "typedefs.h"
+
+extern "C"
+{
+    #include "freertos/FreeRTOS.h"
+}
+
+/*******************************************************************************
+ * MACROS AND DEFINES
+*******************************************************************************/
+#define TRANSMIT_DEFAULT_BEACON_INTERVAL_MS     (102u)      /* 100 TU               */
+#define TRANSMIT_DEFAULT_DTIM_PERIOD            (1u)
+#define TRANSMIT_DEFAULT_LISTEN_INTERVAL        (3u)        /* beacons, max modem   */
+#define TRANSMIT_DEFAULT_MAX_MODEM_THRESHOLD    (10000u)    /* ms of report interval */
+#define TRANSMIT_DEFAULT_RADIO_TAIL_MS          (40u)
+#define TRANSMIT_WINDOW_TOLERANCE_MS            (10u)
+#define TRANSMIT_MS_PER_HOUR                    (3600000u)
+
+/*******************************************************************************
+ * TYPEDEFS
+*******************************************************************************/
+typedef enum : uint8_t
+{
+    TRANSMIT_POWER_MIN_MODEM,           /**< WIFI_PS_MIN_MODEM, radio wakes for every DTIM beacon */
+    TRANSMIT_POWER_MAX_MODEM,           /**< WIFI_PS_MAX_MODEM, radio wakes every listen interval */
+} TransmitPowerMode_t;
+
+typedef struct
+{
+    uint32_t reportIntervalMs;          /**< how often new data is reported         */
+    uint16_t beaconIntervalMs;          /**< access point beacon interval           */
+    uint8_t dtimPeriod;                 /**< beacons per DTIM of the access point   */
+    uint8_t listenInterval;             /**< beacons between wakes in max modem     */
+    uint32_t maxModemThresholdMs;       /**< report intervals from here use max modem */
+    uint16_t radioTailMs;               /**< radio on time after the last frame     */
+} TransmitSchedulerConfig_t;
+
+typedef struct
+{
+    TransmitPowerMode_t mode;
+    uint32_t wakeIntervalMs;            /**< spacing of the transmit windows        */
+    uint32_t bursts;                    /**< windows that sent data                 */
+    uint32_t earlyBursts;               /**< sent outside a window, batch was full  */
+    uint32_t radioOnMsLastHour;         /**< burst radio on time of the last full hour */
+    uint32_t radioOnMsThisHour;         /**< same for the hour in progress          */
+    uint64_t radioOnMsTotal;
+} TransmitSchedulerStats_t;
+
+class TransmitScheduler
+{
+public:
+    TransmitScheduler();
+    ~TransmitScheduler() = default;
+
+    /**
+     * @brief Picks the power save mode for the reporting interval and sets
+     * it on the station. Call after esp_wifi_init and before connecting,
+     * the listen interval is only sent to the access point on association.
+     *
+     * @param config - pointer to the access point timing and report interval
+     * @return Status_t - STATUS_OUT_OF_BOUNDS for a zero interval,
+     * STATUS_HAL_ERROR if the wifi driver refuses the settings
+     */
+    Status_t init(const TransmitSchedulerConfig_t * config);
+
+    /**
+     * @brief Returns the ticks until the next transmit window, zero inside
+     * a window that has not had a burst yet or before the first burst.
+     */
+    TickType_t getWindowDelay(TickType_t now);
+
+    /**
+     * @brief Marks the start of a burst, the first burst anchors the window
+     * grid.
+     */
+    void burstStarted(TickType_t now);
+
+    /**
+     * @brief Marks the end of a burst and accounts its radio on time.
+     *
+     * @param now - tick count after the last frame
+     * @param transmitted - false if the burst found nothing to send
+     * @param early - true if the burst was forced outside a window
+     */
+    void burstEnded(TickType_t now, bool transmitted, bool early);
+
+    Status_t getStats(TransmitSchedulerStats_t * stats);
+
+private:
+    TransmitSchedulerConfig_t config;
+    bool anchored;
+    TickType_t anchorTick;
+    TickType_t wakeIntervalTicks;
+    uint32_t burstWindow;               /**< window index of the last burst         */
+    TickType_t burstStartTick;
+    TickType_t hourStartTick;
+
+    TransmitSchedulerStats_t stats;
+
+    void rollHour(TickType_t now);
+};
+
+/*******************************************************************************
+ * EXPORTED VARIABLES
+*******************************************************************************/
+
+/*******************************************************************************
+ * GLOBAL FUNCTION PROTOTYPES
+*******************************************************************************/
+
+
+#endif // TRANSMIT_SCHEDULER_HPP
@@ -0,0 +1,414 @@
+/**
+ *******************************************************************************
+ * @file    message_serializer.cpp
+ * @author  hq
+ * @date    2025-07-29 18:37:52
+ * @brief   Message serializer source file
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * INCLUDES
+ *******************************************************************************/
+#include "message_serializer.hpp"
+#include "json_writer.hpp"
+#include "timeseries_codec.hpp"
+
+#include <string.h>
+
+/*******************************************************************************
+ * EXTERN VARIABLES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * PRIVATE MACROS AND DEFINES
+ *******************************************************************************/
+#define VARINT_CONTINUE_BIT     (0x80u)
+#define VARINT_PAYLOAD_MASK     (0x7Fu)
+#define VARINT_PAYLOAD_BITS     (7u)
+
+#define JSON_HEADER_SIZE        (8u)    /* {"m":[ and ]}                        */
+#define JSON_ENTRY_OVERHEAD     (36u)   /* keys, quotes, separators, timestamp  */
+#define JSON_FLOAT_DECIMALS     (3u)
+#define JSON_SCALAR_MAX_SIZE    (12u)   /* -2147483.648                         */
+
+/*******************************************************************************
+ * PRIVATE TYPEDEFS
+ *******************************************************************************/
+
+/*******************************************************************************
+ * STATIC VARIABLES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * GLOBAL VARIABLES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * STATIC FUNCTION PROTOTYPES
+ *******************************************************************************/
+static uint16_t putVarint(uint8_t * dst, uint32_t value);
+static void writeValue(JsonWriter * writer, const NetworkingMessage_t * message);
+static int32_t toFixedPoint(const NetworkingMessage_t * message, MessageType_t type);
+
+/*******************************************************************************
+ * STATIC FUNCTIONS
+ *******************************************************************************/
+static uint16_t putVarint(uint8_t * dst, uint32_t value)
+{
+    uint16_t index = 0u;
+
+    while (value > VARINT_PAYLOAD_MASK)
+    {
+        dst[index++] = (uint8_t)((value & VARINT_PAYLOAD_MASK) | VARINT_CONTINUE_BIT);
+        value >>= VARINT_PAYLOAD_BITS;
+    }
+    dst[index++] = (uint8_t)value;
+
+    return index;
+}
+
+/*!
+ * \brief writes the value of a message, scalars as numbers and everything
+ * else as a base64 string
+ */
+static void writeValue(JsonWriter * writer, const NetworkingMessage_t * message)
+{
+    const MessageInfo_t * info = messageRegistry_getInfo(message->id);
+    MessageType_t type = CHECK_POINTER_VALID(info) ? info->type : MESSAGE_TYPE_BLOB;
+    uint32_t raw = 0u;
+
+    if (message->buffer->length < sizeof(raw))
+    {
+        type = MESSAGE_TYPE_BLOB;
+    }
+    else
+    {
+        memcpy(&raw, message->buffer->data, sizeof(raw));
+    }
+
+    switch (type)
+    {
+        case MESSAGE_TYPE_FLOAT:
+        {
+            float value;
+            memcpy(&value, &raw, sizeof(value));
+            writer->writeFloat(value, JSON_FLOAT_DECIMALS);
+            break;
+        }
+
+        case MESSAGE_TYPE_INT32:
+            writer->writeInt((int32_t)raw);
+            break;
+
+        case MESSAGE_TYPE_UINT32:
+            writer->writeUint(raw);
+            break;
+
+        case MESSAGE_TYPE_BLOB:
+        default:
+            writer->writeBase64(message->buffer->data, message->buffer->length);
+            break;
+    }
+}
+
+/*!
+ * \brief returns the value of a scalar message as a fixed point integer,
+ * floats are rounded to milli units and saturate at the int32 range
+ */
+static int32_t toFixedPoint(const NetworkingMessage_t * message, MessageType_t type)
+{
+    int32_t fixedPoint = 0;
+    uint32_t raw = 0u;
+
+    if (message->buffer->length >= sizeof(raw))
+    {
+        memcpy(&raw, message->buffer->data, sizeof(raw));
+    }
+
+    if (type == MESSAGE_TYPE_FLOAT)
+    {
+        float value;
+        memcpy(&value, &raw, sizeof(value));
+        value *= TIMESERIES_FLOAT_SCALE;
+
+        if (value >= 2147483520.0f)
+        {
+            fixedPoint = INT32_MAX;
+        }
+        else if (value <= -2147483520.0f)
+        {
+            fixedPoint = INT32_MIN;
+        }
+        else if (value == value)
+        {
+            /*! - NaN fails the compare above and is sent as zero   */
+            fixedPoint = (int32_t)((value < 0.0f) ? (value - 0.5f) : (value + 0.5f));
+        }
+    }
+    else
+    {
+        fixedPoint = (int32_t)raw;
+    }
+
+    return fixedPoint;
+}
+
+/*******************************************************************************
+ * GLOBAL FUNCTIONS
+ *******************************************************************************/
+uint16_t TlvSerializer::getHeaderSize(void) const
+{
+    return TLV_HEADER_SIZE;
+}
+
+uint16_t TlvSerializer::getEntrySize(const NetworkingMessage_t * message) const
+{
+    return TLV_ENTRY_MAX_OVERHEAD + message->buffer->length;
+}
+
+Status_t TlvSerializer::serialize(const NetworkingMessage_t * messages, uint16_t count,
+                                  uint8_t * payload, uint16_t capacity, uint16_t * length)
+{
+    Status_t status = STATUS_OKAY;
+    uint16_t index = TLV_HEADER_SIZE;
+    uint32_t previousTimestamp = 0u;
+
+    if (    (CHECK_POINTER_VALID(messages) == false)
+         || (CHECK_POINTER_VALID(payload) == false)
+         || (CHECK_POINTER_VALID(length) == false))
+    {
+        status = STATUS_NULL_POINTER;
+    }
+    else if ((count > UINT8_MAX) || (capacity < TLV_HEADER_SIZE))
+    {
+        status = STATUS_OUT_OF_BOUNDS;
+    }
+
+    /*! - the first timestamp is the base of the deltas, read once the
+          messages are known to be there */
+    if ((status == STATUS_OKAY) && (count > 0u))
+    {
+        previousTimestamp = messages[0].timestamp;
+    }
+
+    if (status == STATUS_OKAY)
+    {
+        payload[0] = TLV_FORMAT_VERSION;
+        payload[1] = (uint8_t)count;
+        payload[2] = (uint8_t)(previousTimestamp);
+        payload[3] = (uint8_t)(previousTimestamp >> 8);
+        payload[4] = (uint8_t)(previousTimestamp >> 16);
+        payload[5] = (uint8_t)(previousTimestamp >> 24);
+    }
+
+    for (uint16_t i = 0u; (i < count) && (status == STATUS_OKAY); i++)
+    {
+        const NetworkingMessage_t * message = &messages[i];
+        int32_t delta = (int32_t)(message->timestamp - previousTimestamp);
+
+        if ((index + getEntrySize(message)) > capacity)
+        {
+            status = STATUS_OUT_OF_BOUNDS;
+        }
+        else
+        {
+            /*! - timestamps are close together, a delta is one byte mostly  */
+            payload[index++] = (uint8_t)message->id;
+            index += putVarint(&payload[index], ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31));
+            index += putVarint(&payload[index], message->buffer->length);
+            memcpy(&payload[index], message->buffer->data, message->buffer->length);
+            index += message->buffer->length;
+            previousTimestamp = message->timestamp;
+        }
+    }
+
+    if (status == STATUS_OKAY)
+    {
+        *length = index;
+    }
+
+    return status;
+}
+
+uint16_t JsonSerializer::getHeaderSize(void) const
+{
+    return JSON_HEADER_SIZE;
+}
+
+uint16_t JsonSerializer::getEntrySize(const NetworkingMessage_t * message) const
+{
+    const MessageInfo_t * info = messageRegistry_getInfo(message->id);
+    uint16_t size = JSON_ENTRY_OVERHEAD;
+
+    if (CHECK_POINTER_VALID(info))
+    {
+        size += (uint16_t)(strlen(info->name) + strlen(info->unit));
+    }
+
+    if (CHECK_POINTER_VALID(info) && (info->type != MESSAGE_TYPE_BLOB))
+    {
+        size += JSON_SCALAR_MAX_SIZE;
+    }
+    else
+    {
+        /*! - blobs and unknown ids go out as a base64 string    */
+        size += (uint16_t)(((message->buffer->length + 2u) / 3u) * 4u + 2u);
+    }
+
+    return size;
+}
+
+Status_t JsonSerializer::serialize(const NetworkingMessage_t * messages, uint16_t count,
+                                   uint8_t * payload, uint16_t capacity, uint16_t * length)
+{
+    Status_t status = STATUS_OKAY;
+    JsonWriter writer;
+
+    if (    (CHECK_POINTER_VALID(messages) == false)
+         || (CHECK_POINTER_VALID(length) == false))
+    {
+        status = STATUS_NULL_POINTER;
+    }
+
+    if (status == STATUS_OKAY)
+    {
+        /*! - no sink, a batch that outgrows the payload fails as a whole  */
+        writer.begin(payload, capacity);
+        writer.beginObject();
+        writer.writeKey("m");
+        writer.beginArray();
+
+        for (uint16_t i = 0u; (i < count) && (writer.getStatus() == STATUS_OKAY); i++)
+        {
+            const MessageInfo_t * info = messageRegistry_getInfo(messages[i].id);
+
+            writer.beginObject();
+            writer.writeKey("n");
+            writer.writeString(messageRegistry_getName(messages[i].id));
+            writer.writeKey("t");
+            writer.writeUint(messages[i].timestamp);
+            writer.writeKey("v");
+            writeValue(&writer, &messages[i]);
+            writer.writeKey("u");
+            writer.writeString(CHECK_POINTER_VALID(info) ? info->unit : "");
+            writer.endObject();
+        }
+
+        writer.endArray();
+        writer.endObject();
+        status = writer.finish();
+    }
+
+    if (status == STATUS_OKAY)
+    {
+        *length = writer.getLength();
+    }
+
+    return status;
+}
+
+uint16_t TimeSeriesSerializer::getHeaderSize(void) const
+{
+    /*  every id may open a series   */
+    return 2u + (TOTAL_MESSAGE_IDS * TIMESERIES_SERIES_OVERHEAD);
+}
+
+uint16_t TimeSeriesSerializer::getEntrySize(const NetworkingMessage_t * message) const
+{
+    const MessageInfo_t * info = messageRegistry_getInfo(message->id);
+    uint16_t size = TIMESERIES_MAX_SAMPLE_BYTES;
+
+    if ((CHECK_POINTER_VALID(info) == false) || (info->type == MESSAGE_TYPE_BLOB))
+    {
+        size = TIMESERIES_BLOB_MAX_OVERHEAD + message->buffer->length;
+    }
+
+    return size;
+}
+
+Status_t TimeSeriesSerializer::serialize(const NetworkingMessage_t * messages, uint16_t count,
+                                         uint8_t * payload, uint16_t capacity, uint16_t * length)
+{
+    Status_t status = STATUS_OKAY;
+    TimeSeriesEncoder encoder;
+    uint16_t index = 2u;
+    uint8_t seriesCount = 0u;
+
+    if (    (CHECK_POINTER_VALID(messages) == false)
+         || (CHECK_POINTER_VALID(payload) == false)
+         || (CHECK_POINTER_VALID(length) == false))
+    {
+        status = STATUS_NULL_POINTER;
+    }
+    else if ((count > UINT8_MAX) || (capacity < 2u))
+    {
+        status = STATUS_OUT_OF_BOUNDS;
+    }
+
+    /*! - one pass per id keeps the state constant, batches are small  */
+    for (uint8_t id = 0u; (id < TOTAL_MESSAGE_IDS) && (status == STATUS_OKAY); id++)
+    {
+        MessageType_t type = messageRegistry[id].type;
+        uint8_t samples = 0u;
+
+        for (uint16_t i = 0u; i < count; i++)
+        {
+            samples += (messages[i].id == id) ? 1u : 0u;
+        }
+
+        if ((samples > 0u) && ((index + 2u) > capacity))
+        {
+            status = STATUS_OUT_OF_BOUNDS;
+        }
+        else if (samples > 0u)
+        {
+            payload[index++] = id;
+            payload[index++] = samples;
+            seriesCount++;
+            encoder.begin(&payload[index], capacity - index);
+
+            for (uint16_t i = 0u; (i < count) && (status == STATUS_OKAY); i++)
+            {
+                const NetworkingMessage_t * message = &messages[i];
+
+                if (message->id != id)
+                {
+                    /*  not part of this series  */
+                }
+                else if (type != MESSAGE_TYPE_BLOB)
+                {
+                    status = encoder.append(message->timestamp, toFixedPoint(message, type));
+                }
+                else if ((index + getEntrySize(message)) > capacity)
+                {
+                    status = STATUS_OUT_OF_BOUNDS;
+                }
+                else
+                {
+                    payload[index++] = (uint8_t)(message->timestamp);
+                    payload[index++] = (uint8_t)(message->timestamp >> 8);
+                    payload[index++] = (uint8_t)(message->timestamp >> 16);
+                    payload[index++] = (uint8_t)(message->timestamp >> 24);
+                    index += putVarint(&payload[index], message->buffer->length);
+                    memcpy(&payload[index], message->buffer->data, message->buffer->length);
+                    index += message->buffer->length;
+                }
+            }
+
+            if (type != MESSAGE_TYPE_BLOB)
+            {
+                index += encoder.finish();
+            }
+        }
+    }
+
+    if (status == STATUS_OKAY)
+    {
+        payload[0] = TIMESERIES_FORMAT_VERSION;
+        payload[1] = seriesCount;
+        *length = index;
+    }
+
+    return status;
+}
@@ -0,0 +1,478 @@
+/**
+ *******************************************************************************
+ * @file    metrics_server.cpp
+ * @author  hq
+ * @date    2025-08-06 18:41:07
+ * @brief   Metrics server source file
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * INCLUDES
+ *******************************************************************************/
+#include "metrics_server.hpp"
+#include "message_pool.hpp"
+#include "block_allocator.hpp"
+#include "boot_profile.hpp"
+
+#include <stdio.h>
+#include <string.h>
+
+extern "C"
+{
+    #include "freertos/task.h"
+    #include "esp_system.h"
+    #include "esp_log.h"
+}
+
+/*******************************************************************************
+ * EXTERN VARIABLES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * PRIVATE MACROS AND DEFINES
+ *******************************************************************************/
+#define CHUNK_HEADER_SIZE       (6u)        /* up to 4 hex digits, CRLF     */
+#define TASK_LABEL_SIZE         (32u)
+
+/*******************************************************************************
+ * PRIVATE TYPEDEFS
+ *******************************************************************************/
+
+/*******************************************************************************
+ * STATIC VARIABLES
+ *******************************************************************************/
+static const char *TAG = "MetricsServer";
+
+static const char textPath[] = "GET /metrics";
+static const char binaryPath[] = "GET /metrics.bin";
+
+static const char textHeader[] =
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Type: text/plain; version=0.0.4\r\n"
+    "Transfer-Encoding: chunked\r\n"
+    "Connection: close\r\n\r\n";
+
+static const char binaryHeader[] =
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Type: application/octet-stream\r\n"
+    "Transfer-Encoding: chunked\r\n"
+    "Connection: close\r\n\r\n";
+
+static const char notFoundResponse[] =
+    "HTTP/1.1 404 Not Found\r\n"
+    "Content-Length: 0\r\n"
+    "Connection: close\r\n\r\n";
+
+static const char lastChunk[] = "0\r\n\r\n";
+
+static const char * const poolLabels[TOTAL_MESSAGE_POOL_CLASSES] =
+{
+    "class=\"small\"",
+    "class=\"medium\"",
+    "class=\"large\"",
+};
+
+/*******************************************************************************
+ * GLOBAL VARIABLES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * STATIC FUNCTION PROTOTYPES
+ *******************************************************************************/
+static bool matchPath(const uint8_t * request, uint16_t length, const char * path);
+
+/*******************************************************************************
+ * STATIC FUNCTIONS
+ *******************************************************************************/
+
+/*!
+ * \brief true if the request line starts with the method and path, followed
+ * by the end of the path or a query string
+ */
+static bool matchPath(const uint8_t * request, uint16_t length, const char * path)
+{
+    uint16_t pathLength = (uint16_t)strlen(path);
+
+    return    (length > pathLength)
+           && (memcmp(request, path, pathLength) == 0)
+           && ((request[pathLength] == ' ') || (request[pathLength] == '?'));
+}
+
+/*!
+ * \brief sends one HTTP chunk, the writer sink of a scrape
+ */
+Status_t MetricsServer::sendChunk(void * context, const uint8_t * data, uint16_t length)
+{
+    MetricsServer * server = (MetricsServer *)context;
+    uint8_t header[CHUNK_HEADER_SIZE];
+    uint8_t headerLength = 0u;
+    Status_t status = STATUS_OKAY;
+
+    /*! - chunk size in hex, the chunk buffer keeps it to 4 digits    */
+    for (int8_t shift = 12; shift >= 0; shift -= 4)
+    {
+        uint8_t nibble = (uint8_t)((length >> shift) & 0x0Fu);
+
+        if ((nibble != 0u) || (headerLength > 0u) || (shift == 0))
+        {
+            header[headerLength++] = (uint8_t)((nibble < 10u) ? ('0' + nibble) : ('A' + nibble - 10u));
+        }
+    }
+    header[headerLength++] = '\r';
+    header[headerLength++] = '\n';
+
+    status = server->stream.sendBytes(header, headerLength);
+
+    if (status == STATUS_OKAY)
+    {
+        status = server->stream.sendBytes(data, length);
+    }
+
+    if (status == STATUS_OKAY)
+    {
+        status = server->stream.sendBytes((const uint8_t *)"\r\n", 2u);
+    }
+
+    return status;
+}
+
+Status_t MetricsServer::sendText(const char * text)
+{
+    return stream.sendBytes((const uint8_t *)text, (uint16_t)strlen(text));
+}
+
+/*!
+ * \brief reads the request up to the blank line that ends the headers,
+ * only the start of the request line is kept
+ *
+ * \param length - populated with the bytes kept in request
+ * \return Status_t - STATUS_NOTIFY_TIMEOUT if the headers do not end in
+ * time, STATUS_HAL_ERROR if the peer closed
+ */
+Status_t MetricsServer::readRequest(uint16_t * length)
+{
+    Status_t status = STATUS_OKAY;
+    TickType_t startTick = xTaskGetTickCount();
+    uint8_t lineLength = 0u;
+    bool firstLine = true;
+    bool complete = false;
+
+    *length = 0u;
+
+    while ((status == STATUS_OKAY) && (complete == false))
+    {
+        uint16_t received = 0u;
+
+        /*! - the chunk buffer is free until the response starts   */
+        status = stream.receiveBytes(chunk, sizeof(chunk), &received, METRICS_SERVER_REQUEST_TIMEOUT_MS);
+
+        if ((status == STATUS_OKAY) && (received == 0u))
+        {
+            status = STATUS_NOTIFY_TIMEOUT;
+        }
+
+        for (uint16_t i = 0u; (status == STATUS_OKAY) && (i < received) && (complete == false); i++)
+        {
+            uint8_t character = chunk[i];
+
+            if (character == '\n')
+            {
+                /*! - an empty line ends the headers    */
+                complete = (lineLength == 0u) && (firstLine == false);
+                firstLine = false;
+                lineLength = 0u;
+            }
+            else if (character != '\r')
+            {
+                if (firstLine && (*length < sizeof(request)))
+                {
+                    request[(*length)++] = character;
+                }
+                lineLength = (lineLength < UINT8_MAX) ? (uint8_t)(lineLength + 1u) : lineLength;
+            }
+        }
+
+        if (    (status == STATUS_OKAY)
+             && (complete == false)
+             && ((xTaskGetTickCount() - startTick) >= pdMS_TO_TICKS(METRICS_SERVER_REQUEST_TIMEOUT_MS)))
+        {
+            /*! - a slow client must not hold the only connection slot */
+            status = STATUS_NOTIFY_TIMEOUT;
+        }
+    }
+
+    return status;
+}
+
+/*!
+ * \brief answers one connection and closes it
+ */
+void MetricsServer::serve(void)
+{
+    Status_t status = STATUS_OKAY;
+    uint16_t length = 0u;
+    bool binary = false;
+    TickType_t startTick = xTaskGetTickCount();
+
+    status = readRequest(&length);
+
+    if ((status == STATUS_OKAY) && matchPath(request, length, binaryPath))
+    {
+        binary = true;
+    }
+    else if ((status == STATUS_OKAY) && (matchPath(request, length, textPath) == false))
+    {
+        status = STATUS_OUT_OF_BOUNDS;
+        sendText(notFoundResponse);
+    }
+
+    if (status != STATUS_OKAY)
+    {
+        taskENTER_CRITICAL();
+        stats.badRequests++;
+        taskEXIT_CRITICAL();
+    }
+    else
+    {
+        status = sendText(binary ? binaryHeader : textHeader);
+
+        writer.begin(chunk, sizeof(chunk), binary ? METRICS_FORMAT_BINARY : METRICS_FORMAT_TEXT);
+        writer.setSink(sendChunk, this);
+
+        /*! - the writer stops at the first send error, the remaining
+              sources then only format into the dead buffer   */
+        writeMetrics(writer);
+        for (uint8_t i = 0u; (i < sourceCount) && (writer.getStatus() == STATUS_OKAY); i++)
+        {
+            sources[i]->writeMetrics(writer);
+        }
+
+        if (status == STATUS_OKAY)
+        {
+            status = writer.finish();
+        }
+
+        if (status == STATUS_OKAY)
+        {
+            status = sendText(lastChunk);
+        }
+
+        uint32_t elapsedMs = (xTaskGetTickCount() - startTick) * portTICK_PERIOD_MS;
+
+        taskENTER_CRITICAL();
+        if (status == STATUS_OKAY)
+        {
+            stats.scrapes++;
+            stats.lastScrapeBytes = writer.getTotalLength();
+            stats.lastScrapeMs = elapsedMs;
+            if (elapsedMs > stats.maxScrapeMs)
+            {
+                stats.maxScrapeMs = elapsedMs;
+            }
+        }
+        else
+        {
+            stats.failures++;
+        }
+        taskEXIT_CRITICAL();
+
+        if (status != STATUS_OKAY)
+        {
+            ESP_LOGE(TAG, "Error: %i", status);
+        }
+    }
+
+    stream.closeStream();
+}
+
+void MetricsServer::taskRun()
+{
+    while (FOREVER())
+    {
+        bool accepted = false;
+        Status_t status = listener.acceptStream(stream, &accepted, METRICS_SERVER_ACCEPT_TIMEOUT_MS);
+
+        if (status != STATUS_OKAY)
+        {
+            ESP_LOGE(TAG, "Error: %i", status);
+            vTaskDelay(pdMS_TO_TICKS(METRICS_SERVER_ACCEPT_TIMEOUT_MS));
+        }
+        else if (accepted)
+        {
+            serve();
+        }
+    }
+}
+
+/*******************************************************************************
+ * GLOBAL FUNCTIONS
+ *******************************************************************************/
+MetricsServer::MetricsServer() : Task("MetricsServer", 256 * 8, ESP_LOW_PRIORITY),
+                                 sourceCount(0u)
+{
+    memset(sources, 0, sizeof(sources));
+    memset(&stats, 0, sizeof(stats));
+}
+
+Status_t MetricsServer::addSource(MetricsSource * source)
+{
+    Status_t status = STATUS_OKAY;
+
+    if (CHECK_POINTER_VALID(source) == false)
+    {
+        status = STATUS_NULL_POINTER;
+    }
+    else if (sourceCount >= METRICS_SERVER_MAX_SOURCES)
+    {
+        status = STATUS_OUT_OF_BOUNDS;
+    }
+    else
+    {
+        sources[sourceCount++] = source;
+    }
+
+    return status;
+}
+
+Status_t MetricsServer::init(uint16_t port)
+{
+    Status_t status = listener.listenOn(port, METRICS_SERVER_BACKLOG);
+
+    if (status == STATUS_OKAY)
+    {
+        status = initTask();
+    }
+
+    if (status == STATUS_OKAY)
+    {
+        ESP_LOGI(TAG, "listening on %u", port);
+    }
+    else
+    {
+        ESP_LOGE(TAG, "Error: %i", status);
+    }
+
+    return status;
+}
+
+void MetricsServer::writeMetrics(MetricsWriter & _writer)
+{
+    MessagePoolStats_t poolStats[TOTAL_MESSAGE_POOL_CLASSES];
+    BlockClassStats_t blockStats[TOTAL_BLOCK_CLASSES];
+    BlockAllocatorReport_t blockReport;
+    MetricsServerStats_t serverStats;
+    TaskStackInfo_t taskInfo[TASK_REGISTRY_SIZE];
+    uint8_t taskCount = Task::sampleStackUsage(taskInfo, TASK_REGISTRY_SIZE);
+    char label[TASK_LABEL_SIZE];
+
+    for (uint8_t i = 0u; i < TOTAL_MESSAGE_POOL_CLASSES; i++)
+    {
+        messagePool.getStats((MessagePoolClass_t)i, &poolStats[i]);
+    }
+    for (uint8_t i = 0u; i < TOTAL_BLOCK_CLASSES; i++)
+    {
+        blockAllocator.getStats((BlockClass_t)i, &blockStats[i]);
+    }
+    blockAllocator.getReport(&blockReport);
+    getStats(&serverStats);
+
+    _writer.family("solar_heap_free_bytes", METRICS_TYPE_GAUGE, "Free heap");
+    _writer.writeUint(esp_get_free_heap_size());
+    _writer.family("solar_heap_min_free_bytes", METRICS_TYPE_GAUGE, "Lowest free heap since boot");
+    _writer.writeUint(esp_get_minimum_free_heap_size());
+    _writer.family("solar_tasks", METRICS_TYPE_GAUGE, "Tasks known to the scheduler");
+    _writer.writeUint(uxTaskGetNumberOfTasks());
+    _writer.family("solar_uptime_seconds", METRICS_TYPE_GAUGE, "Time since boot");
+    _writer.writeUint(((uint64_t)xTaskGetTickCount() * portTICK_PERIOD_MS) / 1000u);
+
+    _writer.family("solar_task_stack_free", METRICS_TYPE_GAUGE, "Least free stack of a task since it started");
+    for (uint8_t i = 0u; i < taskCount; i++)
+    {
+        snprintf(label, sizeof(label), "task=\"%s\"", taskInfo[i].name);
+        _writer.writeUint(taskInfo[i].highWaterMark, label);
+    }
+
+    _writer.family("solar_message_pool_blocks", METRICS_TYPE_GAUGE, "Blocks per size class");
+    for (uint8_t i = 0u; i < TOTAL_MESSAGE_POOL_CLASSES; i++)
+    {
+        _writer.writeUint(poolStats[i].blockCount, poolLabels[i]);
+    }
+    _writer.family("solar_message_pool_in_use", METRICS_TYPE_GAUGE, "Blocks allocated");
+    for (uint8_t i = 0u; i < TOTAL_MESSAGE_POOL_CLASSES; i++)
+    {
+        _writer.writeUint(poolStats[i].inUse, poolLabels[i]);
+    }
+    _writer.family("solar_message_pool_peak_in_use", METRICS_TYPE_GAUGE, "Most blocks allocated at once");
+    for (uint8_t i = 0u; i < TOTAL_MESSAGE_POOL_CLASSES; i++)
+    {
+        _writer.writeUint(poolStats[i].peakInUse, poolLabels[i]);
+    }
+    _writer.family("solar_message_pool_failures_total", METRICS_TYPE_COUNTER, "Requests that found the class empty");
+    for (uint8_t i = 0u; i < TOTAL_MESSAGE_POOL_CLASSES; i++)
+    {
+        _writer.writeUint(poolStats[i].failures, poolLabels[i]);
+    }
+
+    _writer.family("solar_block_in_use", METRICS_TYPE_GAUGE, "Allocator blocks in use per size class");
+    for (uint8_t i = 0u; i < TOTAL_BLOCK_CLASSES; i++)
+    {
+        snprintf(label, sizeof(label), "size=\"%u\"", blockStats[i].blockSize);
+        _writer.writeUint(blockStats[i].inUse, label);
+    }
+    _writer.family("solar_block_peak_in_use", METRICS_TYPE_GAUGE, "Most allocator blocks in use at once");
+    for (uint8_t i = 0u; i < TOTAL_BLOCK_CLASSES; i++)
+    {
+        snprintf(label, sizeof(label), "size=\"%u\"", blockStats[i].blockSize);
+        _writer.writeUint(blockStats[i].peakInUse, label);
+    }
+    _writer.family("solar_block_failures_total", METRICS_TYPE_COUNTER, "Allocations that found the class empty");
+    for (uint8_t i = 0u; i < TOTAL_BLOCK_CLASSES; i++)
+    {
+        snprintf(label, sizeof(label), "size=\"%u\"", blockStats[i].blockSize);
+        _writer.writeUint(blockStats[i].failures, label);
+    }
+    _writer.family("solar_block_fragmentation_permille", METRICS_TYPE_GAUGE, "1000 - largest free block / free pool bytes");
+    _writer.writeUint(blockReport.poolFragmentationPermille);
+    _writer.family("solar_block_heap_fallbacks_total", METRICS_TYPE_COUNTER, "Allocations passed to the heap");
+    _writer.writeUint(blockReport.heapFallbacks);
+    _writer.family("solar_block_heap_live", METRICS_TYPE_GAUGE, "Heap fallbacks not freed yet");
+    _writer.writeUint(blockReport.heapLive);
+
+    _writer.family("solar_boot_milestone_us", METRICS_TYPE_GAUGE, "Time since boot a startup milestone was reached");
+    for (uint8_t i = 0u; i < TOTAL_BOOT_MILESTONES; i++)
+    {
+        uint32_t milestoneUs;
+
+        if (bootProfile.getTimeUs((BootMilestone_t)i, &milestoneUs) == STATUS_OKAY)
+        {
+            snprintf(label, sizeof(label), "milestone=\"%s\"", BootProfile::getName((BootMilestone_t)i));
+            _writer.writeUint(milestoneUs, label);
+        }
+    }
+
+    _writer.family("solar_metrics_scrapes_total", METRICS_TYPE_COUNTER, "Scrapes answered before this one");
+    _writer.writeUint(serverStats.scrapes);
+    _writer.family("solar_metrics_bad_requests_total", METRICS_TYPE_COUNTER, "Requests refused or timed out");
+    _writer.writeUint(serverStats.badRequests);
+    _writer.family("solar_metrics_last_scrape_ms", METRICS_TYPE_GAUGE, "Duration of the previous scrape");
+    _writer.writeUint(serverStats.lastScrapeMs);
+}
+
+Status_t MetricsServer::getStats(MetricsServerStats_t * _stats)
+{
+    Status_t status = STATUS_OKAY;
+
+    if (CHECK_POINTER_VALID(_stats) == false)
+    {
+        status = STATUS_NULL_POINTER;
+    }
+    else
+    {
+        taskENTER_CRITICAL();
+        *_stats = stats;
+        taskEXIT_CRITICAL();
+    }
+
+    return status;
+}
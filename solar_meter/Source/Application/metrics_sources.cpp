@@ -0,0 +1,202 @@
+/**
+ *******************************************************************************
+ * @file    metrics_sources.cpp
+ * @author  hq
+ * @date    2025-08-06 18:41:07
+ * @brief   Metrics sources source file
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * INCLUDES
+ *******************************************************************************/
+#include "metrics_sources.hpp"
+
+extern "C"
+{
+    #include "i2c_task.h"
+    #include "sample_clock.h"
+}
+
+/*******************************************************************************
+ * EXTERN VARIABLES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * PRIVATE MACROS AND DEFINES
+ *******************************************************************************/
+#define MEASUREMENT_DECIMALS    (3u)
+
+/*******************************************************************************
+ * PRIVATE TYPEDEFS
+ *******************************************************************************/
+
+/*******************************************************************************
+ * STATIC VARIABLES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * GLOBAL VARIABLES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * STATIC FUNCTION PROTOTYPES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * STATIC FUNCTIONS
+ *******************************************************************************/
+
+/*******************************************************************************
+ * GLOBAL FUNCTIONS
+ *******************************************************************************/
+void PowerMonitorMetrics::writeMetrics(MetricsWriter & writer)
+{
+    PowerMonitorMeasurements_t measurements;
+    PowerMonitorTimingStats_t timing;
+    RippleResult_t ripple;
+
+    if (    (powerMonitor.getMeasurements(&measurements) == STATUS_OKAY)
+         && (powerMonitor.getTimingStats(&timing) == STATUS_OKAY))
+    {
+        writer.family("solar_bus_voltage_volts", METRICS_TYPE_GAUGE, "Filtered bus voltage");
+        writer.writeFloat(measurements.busVoltage, MEASUREMENT_DECIMALS);
+        writer.family("solar_bus_current_amperes", METRICS_TYPE_GAUGE, "Filtered bus current");
+        writer.writeFloat(measurements.busCurrent, MEASUREMENT_DECIMALS);
+        writer.family("solar_power_watts", METRICS_TYPE_GAUGE, "Bus power");
+        writer.writeFloat(measurements.power, MEASUREMENT_DECIMALS);
+
+        writer.family("solar_monitor_period_ms", METRICS_TYPE_GAUGE, "Measurement period");
+        writer.writeUint(timing.periodMs);
+        writer.family("solar_monitor_cycles_total", METRICS_TYPE_COUNTER, "Completed periods");
+        writer.writeUint(timing.cycles);
+        writer.family("solar_monitor_missed_deadlines_total", METRICS_TYPE_COUNTER, "Periods skipped by an overrun");
+        writer.writeUint(timing.missedDeadlines);
+        writer.family("solar_monitor_execution_us", METRICS_TYPE_GAUGE, "Execution time of a period");
+        writer.writeUint(timing.minExecutionUs, "stat=\"min\"");
+        writer.writeUint(timing.meanExecutionUs, "stat=\"mean\"");
+        writer.writeUint(timing.maxExecutionUs, "stat=\"max\"");
+        writer.family("solar_monitor_max_jitter_us", METRICS_TYPE_GAUGE, "Worst wake up jitter");
+        writer.writeUint(timing.maxJitterUs);
+    }
+
+    /*! - ripple only reports once a first block has been analysed */
+    if (powerMonitor.getRipple(&ripple) == STATUS_OKAY)
+    {
+        writer.family("solar_ripple_amplitude_counts", METRICS_TYPE_GAUGE, "Dominant bus voltage ripple tone");
+        writer.writeUint(ripple.rippleAmplitude);
+        writer.family("solar_ripple_peak_to_peak_counts", METRICS_TYPE_GAUGE, "Bus voltage spread of the last block");
+        writer.writeUint(ripple.ripplePeakToPeak);
+        writer.family("solar_ripple_frequency_hertz", METRICS_TYPE_GAUGE, "Dominant bus voltage ripple frequency");
+        writer.writeFloat((float)ripple.dominantFrequencyDeciHz / 10.0f, 1u);
+    }
+}
+
+void I2cMetrics::writeMetrics(MetricsWriter & writer)
+{
+    i2c_stats_t i2cStats;
+    sample_clock_stats_t clockStats;
+
+    if (i2c_getStats(&i2cStats) == STATUS_OKAY)
+    {
+        writer.family("solar_i2c_transactions_total", METRICS_TYPE_COUNTER, "Commands run on the bus");
+        writer.writeUint(i2cStats.transactions);
+        writer.family("solar_i2c_failures_total", METRICS_TYPE_COUNTER, "Commands that failed");
+        writer.writeUint(i2cStats.failures);
+        writer.family("solar_i2c_bus_us", METRICS_TYPE_GAUGE, "Time a command held the bus");
+        writer.writeUint(i2cStats.lastBusUs, "stat=\"last\"");
+        writer.writeUint(i2cStats.meanBusUs, "stat=\"mean\"");
+        writer.writeUint(i2cStats.maxBusUs, "stat=\"max\"");
+        writer.family("solar_i2c_queue_depth", METRICS_TYPE_GAUGE, "Commands waiting for the bus");
+        writer.writeUint(i2cStats.queueDepth, "stat=\"now\"");
+        writer.writeUint(i2cStats.queueHighWater, "stat=\"max\"");
+    }
+
+    /*! - the sample clock only reports once it has been started  */
+    if ((sample_clock_getStats(&clockStats) == STATUS_OKAY) && (clockStats.ticks > 0u))
+    {
+        writer.family("solar_sample_clock_ticks_total", METRICS_TYPE_COUNTER, "Sample clock interrupts");
+        writer.writeUint(clockStats.ticks);
+        writer.family("solar_sample_clock_overruns_total", METRICS_TYPE_COUNTER, "Ticks dropped with all slots busy");
+        writer.writeUint(clockStats.overruns);
+        writer.family("solar_sample_clock_queue_failures_total", METRICS_TYPE_COUNTER, "Ticks the i2c queue was full");
+        writer.writeUint(clockStats.queueFailures);
+        writer.family("solar_sample_clock_jitter_us", METRICS_TYPE_GAUGE, "Sample period jitter");
+        writer.writeUint(clockStats.meanJitterUs, "stat=\"mean\"");
+        writer.writeUint(clockStats.maxJitterUs, "stat=\"max\"");
+    }
+}
+
+void NetworkingMetrics::writeMetrics(MetricsWriter & writer)
+{
+    NetworkingStats_t stats;
+
+    if (networkingModule.getStats(&stats) == STATUS_OKAY)
+    {
+        writer.family("solar_net_queue_depth", METRICS_TYPE_GAUGE, "Messages waiting for the networking task");
+        writer.writeUint(stats.queueDepth, "stat=\"now\"");
+        writer.writeUint(stats.queueHighWater, "stat=\"max\"");
+        writer.family("solar_net_messages_queued_total", METRICS_TYPE_COUNTER, "Messages accepted");
+        writer.writeUint(stats.messagesQueued);
+        writer.family("solar_net_messages_dropped_total", METRICS_TYPE_COUNTER, "Messages refused");
+        writer.writeUint(stats.messagesDropped);
+        writer.family("solar_net_batches_published_total", METRICS_TYPE_COUNTER, "Payloads published");
+        writer.writeUint(stats.batchesPublished);
+        writer.family("solar_net_publish_failures_total", METRICS_TYPE_COUNTER, "Payloads the transport refused");
+        writer.writeUint(stats.publishFailures);
+        writer.family("solar_net_batches_stored_total", METRICS_TYPE_COUNTER, "Payloads kept in the store log");
+        writer.writeUint(stats.batchesStored);
+        writer.family("solar_net_batches_replayed_total", METRICS_TYPE_COUNTER, "Stored payloads sent");
+        writer.writeUint(stats.batchesReplayed);
+        writer.family("solar_net_latency_ms", METRICS_TYPE_GAUGE, "First message queued to publish");
+        writer.writeUint(stats.averageLatencyMs, "stat=\"mean\"");
+        writer.writeUint(stats.maxLatencyMs, "stat=\"max\"");
+    }
+}
+
+void MqttMetrics::writeMetrics(MetricsWriter & writer)
+{
+    MqttStats_t stats;
+
+    if (mqttClient.getStats(&stats) == STATUS_OKAY)
+    {
+        writer.family("solar_mqtt_publishes_total", METRICS_TYPE_COUNTER, "PUBLISH packets sent");
+        writer.writeUint(stats.publishes);
+        writer.family("solar_mqtt_retransmits_total", METRICS_TYPE_COUNTER, "PUBLISH packets resent");
+        writer.writeUint(stats.retransmits);
+        writer.family("solar_mqtt_connection_losses_total", METRICS_TYPE_COUNTER, "Broker connections lost");
+        writer.writeUint(stats.connectionLosses);
+        writer.family("solar_mqtt_in_flight", METRICS_TYPE_GAUGE, "Publishes waiting for PUBACK");
+        writer.writeUint(stats.inFlight, "stat=\"now\"");
+        writer.writeUint(stats.inFlightHighWater, "stat=\"max\"");
+        writer.family("solar_mqtt_ack_latency_ms", METRICS_TYPE_GAUGE, "First send to PUBACK");
+        writer.writeUint(stats.averageAckLatencyMs, "stat=\"mean\"");
+        writer.writeUint(stats.maxAckLatencyMs, "stat=\"max\"");
+    }
+}
+
+void DispatcherMetrics::writeMetrics(MetricsWriter & writer)
+{
+    EventDispatcherStats_t stats;
+
+    if (dispatcher.getStats(&stats) == STATUS_OKAY)
+    {
+        writer.family("solar_dispatcher_objects", METRICS_TYPE_GAUGE, "Active objects sharing the dispatcher");
+        writer.writeUint(stats.objects);
+        writer.family("solar_dispatcher_events_total", METRICS_TYPE_COUNTER, "Events dispatched");
+        writer.writeUint(stats.events, "kind=\"posted\"");
+        writer.writeUint(stats.timeouts, "kind=\"timeout\"");
+        writer.family("solar_dispatcher_missed_timeouts_total", METRICS_TYPE_COUNTER, "Time events skipped by an overrun");
+        writer.writeUint(stats.missedTimeouts);
+        writer.family("solar_dispatcher_post_failures_total", METRICS_TYPE_COUNTER, "Posts refused with the queue full");
+        writer.writeUint(stats.postFailures);
+        writer.family("solar_dispatcher_queue_high_water", METRICS_TYPE_GAUGE, "Most events waiting at once");
+        writer.writeUint(stats.queueHighWater);
+        writer.family("solar_dispatcher_latency_us", METRICS_TYPE_GAUGE, "Post to start of dispatch");
+        writer.writeUint(stats.meanLatencyUs, "stat=\"mean\"");
+        writer.writeUint(stats.maxLatencyUs, "stat=\"max\"");
+        writer.family("solar_dispatcher_handler_us", METRICS_TYPE_GAUGE, "Time spent in one handler");
+        writer.writeUint(stats.meanDispatchUs, "stat=\"mean\"");
+        writer.writeUint(stats.maxDispatchUs, "stat=\"max\"");
+    }
+}
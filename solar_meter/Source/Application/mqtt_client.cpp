@@ -0,0 +1,685 @@
+/**
+ *******************************************************************************
+ * @file    mqtt_client.cpp
+ * @author  hq
+ * @date    2025-08-03 16:48:09
+ * @brief   MQTT client source file
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * INCLUDES
+ *******************************************************************************/
+#include "mqtt_client.hpp"
+
+#include <string.h>
+
+extern "C"
+{
+    #include "freertos/task.h"
+    #include "esp_log.h"
+}
+
+/*******************************************************************************
+ * EXTERN VARIABLES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * PRIVATE MACROS AND DEFINES
+ *******************************************************************************/
+#define MQTT_PACKET_CONNECT         (0x10u)
+#define MQTT_PACKET_CONNACK         (0x20u)
+#define MQTT_PACKET_PUBLISH         (0x30u)
+#define MQTT_PACKET_PUBACK          (0x40u)
+#define MQTT_PACKET_SUBSCRIBE       (0x82u)     /* flags are fixed to 0b0010    */
+#define MQTT_PACKET_SUBACK          (0x90u)
+#define MQTT_PACKET_PINGREQ         (0xC0u)
+#define MQTT_PACKET_PINGRESP        (0xD0u)
+#define MQTT_PACKET_TYPE_MASK       (0xF0u)
+#define MQTT_FLAG_DUP               (0x08u)
+#define MQTT_FLAG_QOS1              (0x02u)
+#define MQTT_FLAG_QOS_MASK          (0x06u)
+#define MQTT_SUBACK_FAILURE         (0x80u)
+#define MQTT_CONNECT_CLEAN_SESSION  (0x02u)
+#define MQTT_PROTOCOL_LEVEL         (4u)        /* 3.1.1                        */
+#define MQTT_MAX_CLIENT_ID_LENGTH   (23u)
+#define MQTT_CONNECT_HEADER_SIZE    (12u)       /* fixed header + variable header */
+#define MQTT_REMAINING_LENGTH_BYTES (4u)
+
+/*******************************************************************************
+ * PRIVATE TYPEDEFS
+ *******************************************************************************/
+
+/*******************************************************************************
+ * STATIC VARIABLES
+ *******************************************************************************/
+static const char *TAG = "MqttClient";
+
+/*******************************************************************************
+ * GLOBAL VARIABLES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * STATIC FUNCTION PROTOTYPES
+ *******************************************************************************/
+static uint16_t putRemainingLength(uint8_t * dst, uint32_t value);
+static uint16_t putString(uint8_t * dst, const char * value, uint16_t length);
+
+/*******************************************************************************
+ * STATIC FUNCTIONS
+ *******************************************************************************/
+static uint16_t putRemainingLength(uint8_t * dst, uint32_t value)
+{
+    uint16_t index = 0u;
+
+    do
+    {
+        uint8_t encoded = (uint8_t)(value & 0x7Fu);
+
+        value >>= 7;
+        if (value > 0u)
+        {
+            encoded |= 0x80u;
+        }
+        dst[index++] = encoded;
+    } while (value > 0u);
+
+    return index;
+}
+
+static uint16_t putString(uint8_t * dst, const char * value, uint16_t length)
+{
+    dst[0] = (uint8_t)(length >> 8);
+    dst[1] = (uint8_t)(length);
+    memcpy(&dst[2], value, length);
+
+    return (uint16_t)(length + 2u);
+}
+
+/*!
+ * \brief closes the stream, in flight packets stay in the window and are
+ * sent again after the next connect
+ */
+void MqttClient::connectionLost(void)
+{
+    stream.closeStream();
+
+    if (connected)
+    {
+        stats.connectionLosses++;
+        ESP_LOGW(TAG, "connection lost, %u in flight", inFlight);
+    }
+
+    connected = false;
+    rxLength = 0u;
+    rxDiscard = 0u;
+}
+
+Status_t MqttClient::sendPacket(const uint8_t * packet, uint16_t length)
+{
+    Status_t status = stream.sendBytes(packet, length);
+
+    if (status == STATUS_OKAY)
+    {
+        lastSendTick = xTaskGetTickCount();
+    }
+    else
+    {
+        connectionLost();
+    }
+
+    return status;
+}
+
+/*!
+ * \brief opens the stream, sends CONNECT and waits for CONNACK
+ */
+Status_t MqttClient::connect(void)
+{
+    Status_t status = STATUS_OKAY;
+    uint8_t packet[MQTT_CONNECT_HEADER_SIZE + MQTT_MAX_CLIENT_ID_LENGTH + 2u];
+    uint16_t clientIdLength = (uint16_t)strlen(config.clientId);
+    uint16_t index = 0u;
+    TickType_t start = xTaskGetTickCount();
+
+    lastConnectTick = start;
+    status = stream.openStream(config.brokerHost, config.brokerPort);
+
+    if (status == STATUS_OKAY)
+    {
+        packet[index++] = MQTT_PACKET_CONNECT;
+        index += putRemainingLength(&packet[index], 10u + 2u + clientIdLength);
+        index += putString(&packet[index], "MQTT", 4u);
+        packet[index++] = MQTT_PROTOCOL_LEVEL;
+        packet[index++] = MQTT_CONNECT_CLEAN_SESSION;
+        packet[index++] = (uint8_t)(config.keepAliveS >> 8);
+        packet[index++] = (uint8_t)(config.keepAliveS);
+        index += putString(&packet[index], config.clientId, clientIdLength);
+
+        status = sendPacket(packet, index);
+    }
+
+    /*! - CONNACK sets connected from handlePacket   */
+    while (    (status == STATUS_OKAY)
+            && (connected == false)
+            && ((xTaskGetTickCount() - start) < pdMS_TO_TICKS(MQTT_CONNECT_TIMEOUT_MS)))
+    {
+        status = receive(MQTT_CONNECT_TIMEOUT_MS - ((xTaskGetTickCount() - start) * portTICK_PERIOD_MS));
+    }
+
+    if ((status == STATUS_OKAY) && connected)
+    {
+        stats.connects++;
+        lastReceiveTick = xTaskGetTickCount();
+        ESP_LOGI(TAG, "connected to %s:%u", config.brokerHost, config.brokerPort);
+
+        /*! - a clean session drops the subscription, make it again   */
+        status = subscribe();
+    }
+
+    if ((status == STATUS_OKAY) && connected)
+    {
+        /*! - the broker may not have seen them, send the whole window again */
+        status = retransmitExpired(true);
+    }
+    else
+    {
+        status = STATUS_HAL_ERROR;
+        connectionLost();
+    }
+
+    return status;
+}
+
+/*!
+ * \brief subscribes to the command topic at QoS 1, the SUBACK is checked
+ * when it arrives
+ */
+Status_t MqttClient::subscribe(void)
+{
+    Status_t status = STATUS_OKAY;
+
+    if (CHECK_POINTER_VALID(config.commandTopic))
+    {
+        uint8_t packet[1u + MQTT_REMAINING_LENGTH_BYTES + 2u + 2u + MQTT_MAX_TOPIC_LENGTH + 1u];
+        uint16_t topicLength = (uint16_t)strlen(config.commandTopic);
+        uint16_t index = 0u;
+
+        packet[index++] = MQTT_PACKET_SUBSCRIBE;
+        index += putRemainingLength(&packet[index], 2u + 2u + topicLength + 1u);
+        packet[index++] = (uint8_t)(nextPacketId >> 8);
+        packet[index++] = (uint8_t)(nextPacketId);
+        nextPacketId = (nextPacketId == UINT16_MAX) ? 1u : (uint16_t)(nextPacketId + 1u);
+        index += putString(&packet[index], config.commandTopic, topicLength);
+        packet[index++] = MQTT_FLAG_QOS1 >> 1;
+
+        status = sendPacket(packet, index);
+    }
+
+    return status;
+}
+
+/*!
+ * \brief receives what is available and handles every complete packet
+ */
+Status_t MqttClient::receive(uint32_t timeoutMs)
+{
+    Status_t status = STATUS_OKAY;
+    uint16_t received = 0u;
+    bool parsing = true;
+
+    status = stream.receiveBytes(&rxBuffer[rxLength], MQTT_RX_BUFFER_SIZE - rxLength, &received, timeoutMs);
+
+    if (status != STATUS_OKAY)
+    {
+        connectionLost();
+    }
+    else if (received > 0u)
+    {
+        lastReceiveTick = xTaskGetTickCount();
+
+        /*! - drop the tail of a packet too large for the buffer  */
+        if (rxDiscard > 0u)
+        {
+            uint16_t skip = (rxDiscard < received) ? (uint16_t)rxDiscard : received;
+
+            memmove(&rxBuffer[rxLength], &rxBuffer[rxLength + skip], received - skip);
+            received -= skip;
+            rxDiscard -= skip;
+        }
+
+        rxLength += received;
+    }
+
+    while ((status == STATUS_OKAY) && parsing && (rxLength >= 2u))
+    {
+        uint32_t bodyLength = 0u;
+        uint16_t headerLength = 1u;
+        bool lengthComplete = false;
+
+        /*! - remaining length is a varint of up to four bytes   */
+        while ((lengthComplete == false) && (headerLength < rxLength)
+               && (headerLength <= MQTT_REMAINING_LENGTH_BYTES))
+        {
+            bodyLength |= (uint32_t)(rxBuffer[headerLength] & 0x7Fu) << (7u * (headerLength - 1u));
+            lengthComplete = ((rxBuffer[headerLength] & 0x80u) == 0u);
+            headerLength++;
+        }
+
+        if (lengthComplete == false)
+        {
+            if (headerLength > MQTT_REMAINING_LENGTH_BYTES)
+            {
+                status = STATUS_HAL_ERROR;
+                connectionLost();
+            }
+            parsing = false;
+        }
+        else if ((headerLength + bodyLength) > MQTT_RX_BUFFER_SIZE)
+        {
+            rxDiscard = headerLength + bodyLength - rxLength;
+            rxLength = 0u;
+        }
+        else if ((headerLength + bodyLength) <= rxLength)
+        {
+            uint16_t total = (uint16_t)(headerLength + bodyLength);
+
+            /*! - a failed PUBACK closes the stream and empties the buffer  */
+            status = handlePacket(rxBuffer, headerLength, bodyLength);
+
+            if (status == STATUS_OKAY)
+            {
+                memmove(rxBuffer, &rxBuffer[total], rxLength - total);
+                rxLength -= total;
+            }
+        }
+        else
+        {
+            parsing = false;
+        }
+    }
+
+    return status;
+}
+
+Status_t MqttClient::handlePacket(const uint8_t * packet, uint16_t headerLength, uint32_t bodyLength)
+{
+    Status_t status = STATUS_OKAY;
+    const uint8_t * body = &packet[headerLength];
+
+    switch (packet[0] & MQTT_PACKET_TYPE_MASK)
+    {
+        case MQTT_PACKET_CONNACK:
+            if ((bodyLength >= 2u) && (body[1] == 0u))
+            {
+                connected = true;
+            }
+            else
+            {
+                ESP_LOGE(TAG, "Error: %i, connack %u", STATUS_HAL_ERROR, (bodyLength >= 2u) ? body[1] : 0xFFu);
+            }
+            break;
+
+        case MQTT_PACKET_PUBACK:
+            if (bodyLength >= 2u)
+            {
+                handlePuback((uint16_t)((body[0] << 8) | body[1]));
+            }
+            break;
+
+        case MQTT_PACKET_PUBLISH:
+            status = handlePublish(packet[0] & (uint8_t)~MQTT_PACKET_TYPE_MASK, body, bodyLength);
+            break;
+
+        case MQTT_PACKET_SUBACK:
+            if ((bodyLength >= 3u) && (body[2] == MQTT_SUBACK_FAILURE))
+            {
+                stats.subscribeFailures++;
+                ESP_LOGE(TAG, "Error: %i, subscribe %s refused", STATUS_HAL_ERROR, config.commandTopic);
+            }
+            break;
+
+        case MQTT_PACKET_PINGRESP:
+        default:
+            /*  receive time is all that matters   */
+            break;
+    }
+
+    return status;
+}
+
+/*!
+ * \brief hands a command payload to the receiver then acks it, a command
+ * is delivered again if the link drops before the PUBACK went out
+ */
+Status_t MqttClient::handlePublish(uint8_t flags, const uint8_t * body, uint32_t bodyLength)
+{
+    Status_t status = STATUS_OKAY;
+    uint8_t qos = (uint8_t)((flags & MQTT_FLAG_QOS_MASK) >> 1);
+    uint32_t index = 2u;
+    uint16_t topicLength = 0u;
+    uint16_t packetId = 0u;
+
+    if (bodyLength >= 2u)
+    {
+        topicLength = (uint16_t)((body[0] << 8) | body[1]);
+        index += topicLength;
+    }
+
+    if (qos > 0u)
+    {
+        index += 2u;
+    }
+
+    if ((bodyLength < 2u) || (index > bodyLength) || (qos > 1u))
+    {
+        /*  only QoS 1 is subscribed, anything else is malformed  */
+        ESP_LOGE(TAG, "Error: %i, publish dropped", STATUS_OUT_OF_BOUNDS);
+    }
+    else
+    {
+        if (qos > 0u)
+        {
+            packetId = (uint16_t)((body[index - 2u] << 8) | body[index - 1u]);
+        }
+
+        if (    CHECK_POINTER_VALID(receiver)
+             && CHECK_POINTER_VALID(config.commandTopic)
+             && (strlen(config.commandTopic) == topicLength)
+             && (memcmp(&body[2], config.commandTopic, topicLength) == 0))
+        {
+            stats.downlinks++;
+            receiver->onDownlink(&body[index], (uint16_t)(bodyLength - index));
+        }
+
+        if (qos > 0u)
+        {
+            uint8_t puback[4] = { MQTT_PACKET_PUBACK, 2u, (uint8_t)(packetId >> 8), (uint8_t)packetId };
+            status = sendPacket(puback, sizeof(puback));
+        }
+    }
+
+    return status;
+}
+
+void MqttClient::handlePuback(uint16_t packetId)
+{
+    for (uint8_t i = 0u; i < MQTT_MAX_WINDOW; i++)
+    {
+        if (window[i].used && (window[i].packetId == packetId))
+        {
+            uint32_t latencyMs = (xTaskGetTickCount() - window[i].firstSentTick) * portTICK_PERIOD_MS;
+
+            window[i].used = false;
+            inFlight--;
+
+            stats.acks++;
+            ackLatencySumMs += latencyMs;
+            stats.averageAckLatencyMs = (uint32_t)(ackLatencySumMs / stats.acks);
+            if (latencyMs > stats.maxAckLatencyMs)
+            {
+                stats.maxAckLatencyMs = latencyMs;
+            }
+        }
+    }
+}
+
+/*!
+ * \brief sends packets again with DUP set, all of them after a reconnect or
+ * the ones whose ack timed out. Too many retries reset the connection.
+ */
+Status_t MqttClient::retransmitExpired(bool all)
+{
+    Status_t status = STATUS_OKAY;
+    TickType_t now = xTaskGetTickCount();
+
+    for (uint8_t i = 0u; (i < MQTT_MAX_WINDOW) && (status == STATUS_OKAY); i++)
+    {
+        MqttSlot_t * slot = &window[i];
+
+        if (    (slot->used == false)
+             || ((all == false) && ((now - slot->sentTick) < pdMS_TO_TICKS(config.ackTimeoutMs))))
+        {
+            /*  nothing to send  */
+        }
+        else if ((all == false) && (slot->retries >= config.maxRetries))
+        {
+            status = STATUS_HAL_ERROR;
+            connectionLost();
+        }
+        else
+        {
+            slot->packet[0] |= MQTT_FLAG_DUP;
+            slot->retries = all ? 0u : (uint8_t)(slot->retries + 1u);
+            slot->sentTick = now;
+            stats.retransmits++;
+            status = sendPacket(slot->packet, slot->length);
+        }
+    }
+
+    return status;
+}
+
+/*******************************************************************************
+ * GLOBAL FUNCTIONS
+ *******************************************************************************/
+MqttClient::MqttClient(ByteStream & _stream) : stream(_stream),
+                                               receiver(nullptr),
+                                               configured(false),
+                                               connected(false),
+                                               nextPacketId(1u),
+                                               lastConnectTick(0u),
+                                               lastSendTick(0u),
+                                               lastReceiveTick(0u),
+                                               inFlight(0u),
+                                               rxLength(0u),
+                                               rxDiscard(0u),
+                                               ackLatencySumMs(0u)
+{
+    memset(&config, 0, sizeof(config));
+    memset(&stats, 0, sizeof(stats));
+
+    for (uint8_t i = 0u; i < MQTT_MAX_WINDOW; i++)
+    {
+        window[i].used = false;
+    }
+}
+
+Status_t MqttClient::init(const MqttConfig_t * _config)
+{
+    Status_t status = STATUS_OKAY;
+
+    if (    (CHECK_POINTER_VALID(_config) == false)
+         || (CHECK_POINTER_VALID(_config->brokerHost) == false)
+         || (CHECK_POINTER_VALID(_config->clientId) == false)
+         || (CHECK_POINTER_VALID(_config->topic) == false))
+    {
+        status = STATUS_NULL_POINTER;
+    }
+    else if (    (_config->windowSize == 0u)
+              || (_config->windowSize > MQTT_MAX_WINDOW)
+              || (strlen(_config->topic) > MQTT_MAX_TOPIC_LENGTH)
+              || (    CHECK_POINTER_VALID(_config->commandTopic)
+                   && (strlen(_config->commandTopic) > MQTT_MAX_TOPIC_LENGTH))
+              || (strlen(_config->clientId) > MQTT_MAX_CLIENT_ID_LENGTH)
+              || (_config->ackTimeoutMs == 0u))
+    {
+        status = STATUS_OUT_OF_BOUNDS;
+    }
+
+    if (status == STATUS_OKAY)
+    {
+        config = *_config;
+        configured = true;
+
+        /*! - allow the first connect right away */
+        lastConnectTick = xTaskGetTickCount() - pdMS_TO_TICKS(MQTT_RECONNECT_INTERVAL_MS);
+    }
+
+    return status;
+}
+
+Status_t MqttClient::publish(const uint8_t * payload, uint16_t length)
+{
+    Status_t status = STATUS_OKAY;
+    uint16_t topicLength = 0u;
+    TickType_t start = xTaskGetTickCount();
+    MqttSlot_t * slot = nullptr;
+
+    if (configured == false)
+    {
+        status = STATUS_UNKNOWN;
+    }
+    else if (CHECK_POINTER_VALID(payload) == false)
+    {
+        status = STATUS_NULL_POINTER;
+    }
+    else
+    {
+        topicLength = (uint16_t)strlen(config.topic);
+
+        if ((1u + MQTT_REMAINING_LENGTH_BYTES + 2u + topicLength + 2u + length) > MQTT_MAX_PACKET_SIZE)
+        {
+            status = STATUS_OUT_OF_BOUNDS;
+        }
+    }
+
+    if (    (status == STATUS_OKAY)
+         && (connected == false)
+         && ((start - lastConnectTick) >= pdMS_TO_TICKS(MQTT_RECONNECT_INTERVAL_MS)))
+    {
+        connect();
+    }
+
+    if ((status == STATUS_OKAY) && connected)
+    {
+        /*! - collect acks that are already in  */
+        status = receive(0u);
+    }
+
+    /*! - a full window waits for acks up to one ack timeout  */
+    while (    (status == STATUS_OKAY)
+            && connected
+            && (inFlight >= config.windowSize)
+            && ((xTaskGetTickCount() - start) < pdMS_TO_TICKS(config.ackTimeoutMs)))
+    {
+        status = retransmitExpired(false);
+
+        if (status == STATUS_OKAY)
+        {
+            status = receive(config.ackTimeoutMs / 4u);
+        }
+    }
+
+    if ((status == STATUS_OKAY) && (connected == false))
+    {
+        status = STATUS_HAL_ERROR;
+    }
+    else if ((status == STATUS_OKAY) && (inFlight >= config.windowSize))
+    {
+        stats.windowFull++;
+        status = STATUS_QUEUE_FULL;
+    }
+
+    for (uint8_t i = 0u; (i < MQTT_MAX_WINDOW) && (status == STATUS_OKAY) && (slot == nullptr); i++)
+    {
+        if (window[i].used == false)
+        {
+            slot = &window[i];
+        }
+    }
+
+    if (status == STATUS_OKAY)
+    {
+        uint16_t index = 0u;
+
+        slot->packetId = nextPacketId;
+        nextPacketId = (nextPacketId == UINT16_MAX) ? 1u : (uint16_t)(nextPacketId + 1u);
+
+        slot->packet[index++] = MQTT_PACKET_PUBLISH | MQTT_FLAG_QOS1;
+        index += putRemainingLength(&slot->packet[index], 2u + topicLength + 2u + length);
+        index += putString(&slot->packet[index], config.topic, topicLength);
+        slot->packet[index++] = (uint8_t)(slot->packetId >> 8);
+        slot->packet[index++] = (uint8_t)(slot->packetId);
+        memcpy(&slot->packet[index], payload, length);
+        slot->length = (uint16_t)(index + length);
+
+        status = sendPacket(slot->packet, slot->length);
+    }
+
+    if (status == STATUS_OKAY)
+    {
+        slot->used = true;
+        slot->retries = 0u;
+        slot->firstSentTick = xTaskGetTickCount();
+        slot->sentTick = slot->firstSentTick;
+        inFlight++;
+
+        stats.publishes++;
+        if (inFlight > stats.inFlightHighWater)
+        {
+            stats.inFlightHighWater = inFlight;
+        }
+    }
+
+    return status;
+}
+
+void MqttClient::poll(void)
+{
+    TickType_t now = xTaskGetTickCount();
+
+    if (configured && (connected == false) && ((now - lastConnectTick) >= pdMS_TO_TICKS(MQTT_RECONNECT_INTERVAL_MS)))
+    {
+        connect();
+    }
+    else if (configured && connected)
+    {
+        Status_t status = receive(0u);
+
+        if (status == STATUS_OKAY)
+        {
+            status = retransmitExpired(false);
+        }
+
+        /*! - receive and retransmit stamp the last ticks, a tick from
+              before them would make the differences wrap */
+        now = xTaskGetTickCount();
+
+        /*! - ping at half the keep alive, give up after one and a half  */
+        if (    (status == STATUS_OKAY)
+             && ((now - lastSendTick) >= pdMS_TO_TICKS(config.keepAliveS * 500u)))
+        {
+            static const uint8_t pingRequest[2] = { MQTT_PACKET_PINGREQ, 0u };
+            status = sendPacket(pingRequest, sizeof(pingRequest));
+        }
+
+        if (    (status == STATUS_OKAY)
+             && ((now - lastReceiveTick) >= pdMS_TO_TICKS(config.keepAliveS * 1500u)))
+        {
+            connectionLost();
+        }
+    }
+}
+
+void MqttClient::setReceiver(NetworkingReceiver * _receiver)
+{
+    receiver = _receiver;
+}
+
+Status_t MqttClient::getStats(MqttStats_t * _stats)
+{
+    Status_t status = STATUS_OKAY;
+
+    if (CHECK_POINTER_VALID(_stats) == false)
+    {
+        status = STATUS_NULL_POINTER;
+    }
+    else
+    {
+        *_stats = stats;
+        _stats->inFlight = inFlight;
+    }
+
+    return status;
+}
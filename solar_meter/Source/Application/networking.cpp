@@ -0,0 +1,621 @@
+/**
+ *******************************************************************************
+ * @file    networking.cpp
+ * @author  hq
+ * @date    2025-07-28 19:54:06
+ * @brief   Networking module source file
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * INCLUDES
+ *******************************************************************************/
+#include "networking.hpp"
+#include "message_serializer.hpp"
+#include "flash_ring_log.hpp"
+#include "transmit_scheduler.hpp"
+#include "boot_profile.hpp"
+#include "timing.h"
+
+#include <string.h>
+
+extern "C"
+{
+    #include "esp_log.h"
+}
+
+/*******************************************************************************
+ * EXTERN VARIABLES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * PRIVATE MACROS AND DEFINES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * PRIVATE TYPEDEFS
+ *******************************************************************************/
+
+/*******************************************************************************
+ * STATIC VARIABLES
+ *******************************************************************************/
+static const char *TAG = "NetworkingModule";
+static TlvSerializer tlvSerializer;
+
+/*******************************************************************************
+ * GLOBAL VARIABLES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * STATIC FUNCTION PROTOTYPES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * STATIC FUNCTIONS
+ *******************************************************************************/
+void NetworkingModule::addToBatch(NetworkingMessage_t * message)
+{
+    if (batchCount == 0u)
+    {
+        /*! - the batch keeps the encoding it was sized for  */
+        taskENTER_CRITICAL();
+        batchSerializer = serializer;
+        taskEXIT_CRITICAL();
+
+        batchOpenTick = xTaskGetTickCount();
+        batchBytes = batchSerializer->getHeaderSize();
+    }
+
+    batch[batchCount] = *message;
+    batchCount++;
+    batchBytes += batchSerializer->getEntrySize(message);
+}
+
+/*!
+ * \brief publishes the open batch as one payload and releases its buffers
+ *
+ * \param flushCounter - stats counter of the threshold that closed the batch
+ */
+void NetworkingModule::publishBatch(uint32_t * flushCounter)
+{
+    Status_t status = STATUS_OKAY;
+    uint16_t length = 0u;
+    uint32_t latencyMs = (xTaskGetTickCount() - batchOpenTick) * portTICK_PERIOD_MS;
+    uint32_t encodeCycles = timing_getCycleCount();
+    Status_t storeStatus = STATUS_UNKNOWN;
+    uint32_t batches = 0u;
+
+    status = batchSerializer->serialize(batch, batchCount, payload, sizeof(payload), &length);
+    encodeCycles = timing_getCycleCount() - encodeCycles;
+
+    if (status == STATUS_OKAY)
+    {
+        /*! - without a transport yet the link is down like a broker that
+              does not answer, the batch is kept all the same */
+        if (CHECK_POINTER_VALID(transport))
+        {
+            status = transport->publish(payload, length);
+        }
+        else
+        {
+            status = STATUS_NULL_POINTER;
+        }
+        linkUp = (status == STATUS_OKAY);
+
+        if (linkUp)
+        {
+            bootProfile.mark(BOOT_MILESTONE_FIRST_PUBLISH);
+        }
+
+        /*! - keep what the link did not take, it is replayed once it is back */
+        if ((status != STATUS_OKAY) && CHECK_POINTER_VALID(storeLog))
+        {
+            storeStatus = storeLog->append(payload, length);
+
+            /*! - programmed right away, a reset during the outage would
+                  lose the batches still waiting in the page buffer */
+            if (storeStatus == STATUS_OKAY)
+            {
+                storeStatus = storeLog->flush();
+            }
+        }
+    }
+
+    taskENTER_CRITICAL();
+    (*flushCounter)++;
+    if (status == STATUS_OKAY)
+    {
+        stats.batchesPublished++;
+    }
+    else
+    {
+        stats.publishFailures++;
+    }
+    batches = stats.batchesPublished + stats.publishFailures;
+    if (storeStatus == STATUS_OKAY)
+    {
+        stats.batchesStored++;
+    }
+    else if (CHECK_POINTER_VALID(storeLog) && (status != STATUS_OKAY))
+    {
+        stats.storeFailures++;
+    }
+    latencySumMs += latencyMs;
+    batchMessagesSum += batchCount;
+    batchBytesSum += length;
+    encodeCyclesSum += encodeCycles;
+    if (encodeCycles > stats.maxEncodeCycles)
+    {
+        stats.maxEncodeCycles = encodeCycles;
+    }
+    if (latencyMs > stats.maxLatencyMs)
+    {
+        stats.maxLatencyMs = latencyMs;
+    }
+    stats.averageLatencyMs = (uint32_t)(latencySumMs / batches);
+    stats.averageBatchMessages = (uint32_t)(batchMessagesSum / batches);
+    stats.averageBatchBytes = (uint32_t)(batchBytesSum / batches);
+    stats.averageEncodeCycles = (uint32_t)(encodeCyclesSum / batches);
+    taskEXIT_CRITICAL();
+
+    if (status != STATUS_OKAY)
+    {
+        ESP_LOGE(TAG, "Error: %i", status);
+    }
+
+    for (uint16_t i = 0u; i < batchCount; i++)
+    {
+        messagePool.release(batch[i].buffer);
+    }
+
+    batchCount = 0u;
+    batchBytes = 0u;
+}
+
+/*!
+ * \brief publishes the batch once a threshold is reached, with a scheduler
+ * the batch stays open and is marked due for the next transmit window
+ *
+ * \param flushCounter - stats counter of the threshold that was reached
+ */
+void NetworkingModule::closeBatch(uint32_t * flushCounter)
+{
+    if (CHECK_POINTER_VALID(scheduler) == false)
+    {
+        publishBatch(flushCounter);
+    }
+    else if (flushDue == false)
+    {
+        flushDue = true;
+        dueCounter = flushCounter;
+    }
+}
+
+/*!
+ * \brief sends everything pending back to back so the radio wakes once.
+ * Queued messages join the batch first, then the stored backlog follows.
+ */
+void NetworkingModule::runBurst(void)
+{
+    NetworkingMessage_t message;
+    uint32_t sentBefore = stats.batchesPublished + stats.batchesReplayed;
+    uint32_t * counter = flushDue ? dueCounter : &stats.flushOnWindow;
+
+    scheduler->burstStarted(xTaskGetTickCount());
+
+    while (xQueueReceive(msgQueue, &message, 0) == pdTRUE)
+    {
+        if (    (batchCount > 0u)
+             && (    (batchCount >= NETWORKING_MAX_BATCH_MESSAGES)
+                  || ((batchBytes + batchSerializer->getEntrySize(&message)) > NETWORKING_MAX_PAYLOAD_SIZE)))
+        {
+            publishBatch(&stats.flushOnBytes);
+        }
+
+        addToBatch(&message);
+    }
+
+    if (batchCount > 0u)
+    {
+        publishBatch(counter);
+    }
+
+    replayStored();
+
+    flushDue = false;
+    dueCounter = nullptr;
+    scheduler->burstEnded(xTaskGetTickCount(),
+                          (stats.batchesPublished + stats.batchesReplayed) != sentBefore, false);
+}
+
+/*!
+ * \brief replays stored payloads, oldest first, as far as the token bucket
+ * allows. Only runs while the link is up so a dead link does not force
+ * partial page writes of the log.
+ */
+void NetworkingModule::replayStored(void)
+{
+    Status_t status = STATUS_OKAY;
+    TickType_t now = xTaskGetTickCount();
+    uint64_t refill = ((uint64_t)(now - replayRefillTick) * portTICK_PERIOD_MS * replayRate) / 1000u;
+    uint16_t length = 0u;
+
+    replayRefillTick = now;
+    replayTokens = (uint32_t)(((replayTokens + refill) > NETWORKING_REPLAY_BURST_BYTES)
+                              ? NETWORKING_REPLAY_BURST_BYTES : (replayTokens + refill));
+
+    while (    (status == STATUS_OKAY)
+            && linkUp
+            && CHECK_POINTER_VALID(storeLog)
+            && (storeLog->getPendingCount() > 0u))
+    {
+        /*! - the payload buffer is free between batches  */
+        status = storeLog->peek(payload, sizeof(payload), &length);
+
+        if ((status == STATUS_OKAY) && ((length == 0u) || (length > replayTokens)))
+        {
+            /*! - wait for tokens, the record stays first in line   */
+            status = STATUS_QUEUE_FULL;
+        }
+
+        if (status == STATUS_OKAY)
+        {
+            status = transport->publish(payload, length);
+            linkUp = (status == STATUS_OKAY);
+        }
+
+        if (status == STATUS_OKAY)
+        {
+            status = storeLog->consume();
+            replayTokens -= length;
+
+            taskENTER_CRITICAL();
+            stats.batchesReplayed++;
+            taskEXIT_CRITICAL();
+        }
+    }
+}
+
+/*******************************************************************************
+ * GLOBAL FUNCTIONS
+ *******************************************************************************/
+NetworkingModule::NetworkingModule() : Task("NetworkingModule", 256 * 8, ESP_LOW_PRIORITY),
+                                       msgQueue(nullptr),
+                                       batchCount(0u),
+                                       batchBytes(0u),
+                                       batchOpenTick(0u),
+                                       transport(nullptr),
+                                       downlink(nullptr),
+                                       serializer(&tlvSerializer),
+                                       batchSerializer(&tlvSerializer),
+                                       storeLog(nullptr),
+                                       linkUp(false),
+                                       scheduler(nullptr),
+                                       flushDue(false),
+                                       dueCounter(nullptr),
+                                       replayRate(NETWORKING_DEFAULT_REPLAY_RATE),
+                                       replayTokens(0u),
+                                       replayRefillTick(0u),
+                                       latencySumMs(0u),
+                                       batchMessagesSum(0u),
+                                       batchBytesSum(0u),
+                                       encodeCyclesSum(0u)
+{
+    batchConfig.maxBytes = NETWORKING_DEFAULT_BATCH_BYTES;
+    batchConfig.maxMessages = NETWORKING_DEFAULT_BATCH_MESSAGES;
+    batchConfig.maxLatencyMs = NETWORKING_DEFAULT_BATCH_LATENCY_MS;
+    memset(&stats, 0, sizeof(stats));
+}
+
+NetworkingModule::~NetworkingModule()
+{
+    for (uint16_t i = 0u; i < batchCount; i++)
+    {
+        messagePool.release(batch[i].buffer);
+    }
+
+    if (CHECK_POINTER_VALID(msgQueue))
+    {
+        vQueueDelete(msgQueue);
+    }
+}
+
+Status_t NetworkingModule::initQueue(uint16_t queueLength)
+{
+    Status_t status = STATUS_OKAY;
+
+    if (CHECK_POINTER_VALID(msgQueue))
+    {
+        status = STATUS_REINIT_ERROR;
+    }
+    else if (queueLength == 0u)
+    {
+        status = STATUS_OUT_OF_BOUNDS;
+    }
+
+    if (status == STATUS_OKAY)
+    {
+        /*  messages are copied in by value, the payload stays in the pool */
+        msgQueue = xQueueCreate(queueLength, sizeof(NetworkingMessage_t));
+
+        if (CHECK_POINTER_VALID(msgQueue) == false)
+        {
+            status = STATUS_OS_ERROR;
+        }
+    }
+
+    return status;
+}
+
+Status_t NetworkingModule::init(void)
+{
+    Status_t status = STATUS_OKAY;
+
+    if (CHECK_POINTER_VALID(msgQueue) == false)
+    {
+        status = initQueue();
+    }
+
+    /*  a second init is refused by initTask()  */
+    if (status == STATUS_OKAY)
+    {
+        status = initTask();
+    }
+
+    return status;
+}
+
+Status_t NetworkingModule::queueNetworkingMessage(NetworkingMessage_t * message)
+{
+    Status_t status = STATUS_OKAY;
+
+    if (    (CHECK_POINTER_VALID(message) == false)
+         || (CHECK_POINTER_VALID(message->buffer) == false)
+         || (CHECK_POINTER_VALID(msgQueue) == false))
+    {
+        status = STATUS_NULL_POINTER;
+    }
+
+    if (    (status == STATUS_OKAY)
+         && (xQueueSendToBack(msgQueue, message, 0) != pdTRUE))
+    {
+        status = STATUS_QUEUE_FULL;
+    }
+
+    taskENTER_CRITICAL();
+    if (status == STATUS_OKAY)
+    {
+        uint16_t depth = (uint16_t)uxQueueMessagesWaiting(msgQueue);
+
+        stats.messagesQueued++;
+        if (depth > stats.queueHighWater)
+        {
+            stats.queueHighWater = depth;
+        }
+    }
+    else
+    {
+        stats.messagesDropped++;
+    }
+    taskEXIT_CRITICAL();
+
+    /*  the buffer reference is ours either way, drop it if it was not queued */
+    if ((status != STATUS_OKAY) && CHECK_POINTER_VALID(message))
+    {
+        messagePool.release(message->buffer);
+    }
+
+    return status;
+}
+
+Status_t NetworkingModule::setBatchConfig(const NetworkingBatchConfig_t * config)
+{
+    Status_t status = STATUS_OKAY;
+
+    if (CHECK_POINTER_VALID(config) == false)
+    {
+        status = STATUS_NULL_POINTER;
+    }
+
+    if (    (status == STATUS_OKAY)
+         && (    (config->maxBytes == 0u)
+              || (config->maxBytes > NETWORKING_MAX_PAYLOAD_SIZE)
+              || (config->maxMessages == 0u)
+              || (config->maxMessages > NETWORKING_MAX_BATCH_MESSAGES)
+              || (pdMS_TO_TICKS(config->maxLatencyMs) == 0u)))
+    {
+        status = STATUS_OUT_OF_BOUNDS;
+    }
+
+    if (status == STATUS_OKAY)
+    {
+        taskENTER_CRITICAL();
+        batchConfig = *config;
+        taskEXIT_CRITICAL();
+    }
+
+    return status;
+}
+
+void NetworkingModule::setTransport(NetworkingTransport * _transport)
+{
+    transport = _transport;
+
+    if (CHECK_POINTER_VALID(transport))
+    {
+        transport->setReceiver(downlink);
+    }
+}
+
+void NetworkingModule::setDownlink(NetworkingReceiver * receiver)
+{
+    downlink = receiver;
+
+    if (CHECK_POINTER_VALID(transport))
+    {
+        transport->setReceiver(downlink);
+    }
+}
+
+void NetworkingModule::setSerializer(MessageSerializer * _serializer)
+{
+    taskENTER_CRITICAL();
+    serializer = CHECK_POINTER_VALID(_serializer) ? _serializer : &tlvSerializer;
+    taskEXIT_CRITICAL();
+}
+
+void NetworkingModule::setStoreLog(FlashRingLog * log)
+{
+    taskENTER_CRITICAL();
+    storeLog = log;
+    taskEXIT_CRITICAL();
+}
+
+Status_t NetworkingModule::setReplayRate(uint32_t bytesPerSecond)
+{
+    Status_t status = STATUS_OKAY;
+
+    if (bytesPerSecond == 0u)
+    {
+        status = STATUS_OUT_OF_BOUNDS;
+    }
+    else
+    {
+        replayRate = bytesPerSecond;
+    }
+
+    return status;
+}
+
+void NetworkingModule::setTransmitScheduler(TransmitScheduler * _scheduler)
+{
+    scheduler = _scheduler;
+}
+
+Status_t NetworkingModule::getStats(NetworkingStats_t * _stats)
+{
+    Status_t status = STATUS_OKAY;
+
+    if (CHECK_POINTER_VALID(_stats) == false)
+    {
+        status = STATUS_NULL_POINTER;
+    }
+    else
+    {
+        taskENTER_CRITICAL();
+        *_stats = stats;
+        taskEXIT_CRITICAL();
+
+        _stats->queueDepth = CHECK_POINTER_VALID(msgQueue) ? (uint16_t)uxQueueMessagesWaiting(msgQueue) : 0u;
+    }
+
+    return status;
+}
+
+void NetworkingModule::taskRun()
+{
+    NetworkingMessage_t message;
+
+    while (FOREVER())
+    {
+        NetworkingBatchConfig_t config;
+        TickType_t waitTicks = portMAX_DELAY;
+        bool backlog = linkUp && CHECK_POINTER_VALID(storeLog) && (storeLog->getPendingCount() > 0u);
+
+        taskENTER_CRITICAL();
+        config = batchConfig;
+        taskEXIT_CRITICAL();
+
+        if (flushDue)
+        {
+            /*  a due batch only waits for the next transmit window  */
+            waitTicks = scheduler->getWindowDelay(xTaskGetTickCount());
+        }
+        else if (batchCount > 0u)
+        {
+            /*  an open batch bounds the wait by its latency deadline   */
+            TickType_t ageTicks = xTaskGetTickCount() - batchOpenTick;
+            TickType_t latencyTicks = pdMS_TO_TICKS(config.maxLatencyMs);
+
+            waitTicks = (ageTicks >= latencyTicks) ? 0u : (latencyTicks - ageTicks);
+        }
+
+        /*  the transport is serviced even while no messages arrive  */
+        if (    CHECK_POINTER_VALID(transport)
+             && (waitTicks > pdMS_TO_TICKS(NETWORKING_POLL_INTERVAL_MS)))
+        {
+            waitTicks = pdMS_TO_TICKS(NETWORKING_POLL_INTERVAL_MS);
+        }
+
+        /*  a backlog is drained in steps while the link is up, in the
+            transmit windows if a scheduler is set  */
+        if (backlog && (CHECK_POINTER_VALID(scheduler) == false)
+             && (waitTicks > pdMS_TO_TICKS(NETWORKING_REPLAY_INTERVAL_MS)))
+        {
+            waitTicks = pdMS_TO_TICKS(NETWORKING_REPLAY_INTERVAL_MS);
+        }
+        else if (backlog && CHECK_POINTER_VALID(scheduler)
+                 && (waitTicks > scheduler->getWindowDelay(xTaskGetTickCount())))
+        {
+            waitTicks = scheduler->getWindowDelay(xTaskGetTickCount());
+        }
+
+        if (xQueueReceive(msgQueue, &message, waitTicks) == pdTRUE)
+        {
+            /*  close the batch first if this message does not fit   */
+            if (    (batchCount > 0u)
+                 && (    (batchCount >= NETWORKING_MAX_BATCH_MESSAGES)
+                      || ((batchBytes + batchSerializer->getEntrySize(&message)) > NETWORKING_MAX_PAYLOAD_SIZE)))
+            {
+                if (CHECK_POINTER_VALID(scheduler))
+                {
+                    /*  a full batch can not wait for the window */
+                    scheduler->burstStarted(xTaskGetTickCount());
+                    publishBatch(flushDue ? dueCounter : &stats.flushOnBytes);
+                    scheduler->burstEnded(xTaskGetTickCount(), true, true);
+                    flushDue = false;
+                    dueCounter = nullptr;
+                }
+                else
+                {
+                    publishBatch(&stats.flushOnBytes);
+                }
+            }
+
+            addToBatch(&message);
+
+            if (batchBytes >= config.maxBytes)
+            {
+                closeBatch(&stats.flushOnBytes);
+            }
+            else if (batchCount >= config.maxMessages)
+            {
+                closeBatch(&stats.flushOnCount);
+            }
+        }
+        else if (    (batchCount > 0u)
+                  && (flushDue == false)
+                  && ((xTaskGetTickCount() - batchOpenTick) >= pdMS_TO_TICKS(config.maxLatencyMs)))
+        {
+            /*  a poll or replay wake up leaves a younger batch open  */
+            closeBatch(&stats.flushOnLatency);
+        }
+
+        if (    CHECK_POINTER_VALID(scheduler)
+             && (flushDue || backlog)
+             && (scheduler->getWindowDelay(xTaskGetTickCount()) == 0u))
+        {
+            runBurst();
+        }
+
+        if (CHECK_POINTER_VALID(transport))
+        {
+            transport->poll();
+        }
+
+        if (CHECK_POINTER_VALID(scheduler) == false)
+        {
+            replayStored();
+        }
+    }
+}
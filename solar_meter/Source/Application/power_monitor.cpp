@@ -11,6 +11,8 @@
  * INCLUDES
  *******************************************************************************/
 #include "power_monitor.hpp"
+#include "boot_profile.hpp"
+#include "timing.h"
 
 extern "C"
 {
@@ -24,7 +26,8 @@ extern "C"
 /*******************************************************************************
  * PRIVATE MACROS AND DEFINES
  *******************************************************************************/
-#define CLEAR_ALL_BITS (0xFFFFFFFF)
+#define US_PER_MS               (1000u)
+#define US_PER_S                (1000000u)
 
 /*******************************************************************************
  * PRIVATE TYPEDEFS
@@ -34,6 +37,9 @@ extern "C"
  * STATIC VARIABLES
  *******************************************************************************/
 static const char *TAG = "PowerMonitor";
+
+/*  samples per second of the ads1115 data rate codes */
+static const uint16_t dataRateSps[] = { 8u, 16u, 32u, 64u, 128u, 250u, 475u, 860u };
 /*******************************************************************************
  * GLOBAL VARIABLES
  *******************************************************************************/
@@ -41,65 +47,387 @@ static const char *TAG = "PowerMonitor";
 /*******************************************************************************
  * STATIC FUNCTION PROTOTYPES
  *******************************************************************************/
+static void filterReset(PowerMonitorFilter_t * filter, uint8_t length);
+static float filterPush(PowerMonitorFilter_t * filter, float value);
+static uint32_t sampleTickUs(uint32_t periodMs);
+static uint16_t channelRateHz(uint32_t periodMs);
+static uint32_t conversionUs(ads1115DataRate_t dataRate);
 
 /*******************************************************************************
  * STATIC FUNCTIONS
  *******************************************************************************/
-Status_t PowerMonitor::queueBusVoltageMessage()
+static void filterReset(PowerMonitorFilter_t * filter, uint8_t length)
+{
+    memset(filter, 0, sizeof(PowerMonitorFilter_t));
+    filter->length = length;
+}
+
+/*!
+ * \brief adds a value to the moving average and returns the average of the
+ * values held, fewer than length right after a reset
+ */
+static float filterPush(PowerMonitorFilter_t * filter, float value)
+{
+    if (filter->count == filter->length)
+    {
+        filter->sum -= filter->samples[filter->index];
+    }
+    else
+    {
+        filter->count++;
+    }
+
+    filter->samples[filter->index] = value;
+    filter->sum += value;
+    filter->index = (uint8_t)((filter->index + 1u) % filter->length);
+
+    return filter->sum / (float)filter->count;
+}
+
+static uint32_t sampleTickUs(uint32_t periodMs)
+{
+    return (periodMs * US_PER_MS) / POWER_MONITOR_TICKS_PER_PERIOD;
+}
+
+/*!
+ * \brief the channels are converted on alternate ticks, each one at a
+ * fraction of the tick rate
+ */
+static uint16_t channelRateHz(uint32_t periodMs)
+{
+    return (uint16_t)(US_PER_S / (POWER_MONITOR_CHANNELS * sampleTickUs(periodMs)));
+}
+
+/*!
+ * \brief single shot conversion time, the data rate is only good to 10 %
+ */
+static uint32_t conversionUs(ads1115DataRate_t dataRate)
+{
+    uint32_t nominalUs = US_PER_S / dataRateSps[(uint8_t)dataRate & 0x7u];
+
+    return nominalUs + (nominalUs / 10u);
+}
+
+/*!
+ * \brief builds the trigger words of both channels and starts the sample
+ * clock, the calling task is notified of every completed read
+ */
+Status_t PowerMonitor::startSampling(void)
+{
+    Status_t status = STATUS_OKAY;
+    sample_clock_config_t clockConfig;
+    ads1115ConfigRegister_t configRegister;
+    uint32_t tickUs = sampleTickUs(getPeriodMs());
+
+    /*! - a conversion has to be done by the tick that reads it */
+    if (tickUs < conversionUs(acquisition.dataRate))
+    {
+        status = STATUS_OUT_OF_BOUNDS;
+    }
+    else
+    {
+        memset(&clockConfig, 0, sizeof(clockConfig));
+        memset(&configRegister, 0, sizeof(configRegister));
+
+        configRegister.opStatus = 1u;
+        configRegister.mux = (uint8_t)acquisition.voltageMux;
+        configRegister.pga = acquisition.pga;
+        configRegister.mode = ADS1115_MODE_SINGLE_SHOT;
+        configRegister.dataRate = (uint8_t)acquisition.dataRate;
+        configRegister.compQueue = ADS1115_COMP_QUEUE_DISABLE;
+        memcpy(clockConfig.triggerValue[POWER_MONITOR_VOLTAGE_CHANNEL], configRegister.bytes, SAMPLE_CLOCK_DATA_SIZE);
+
+        configRegister.mux = (uint8_t)acquisition.currentMux;
+        memcpy(clockConfig.triggerValue[POWER_MONITOR_CURRENT_CHANNEL], configRegister.bytes, SAMPLE_CLOCK_DATA_SIZE);
+
+        clockConfig.periodUs = tickUs;
+        clockConfig.consumerHdl = xTaskGetCurrentTaskHandle();
+        clockConfig.writeAddress = ADS1115_WRITE;
+        clockConfig.readAddress = ADS1115_READ;
+        clockConfig.readRegister = ADS1115_CONVERSION_REGISTER;
+        clockConfig.triggerEnable = true;
+        clockConfig.triggerRegister = ADS1115_CONFIG_REGISTER;
+        clockConfig.channels = POWER_MONITOR_CHANNELS;
+        clockConfig.ackCheck = ADS1115_ACK_CHECK_STATUS;
+
+        /*! - notifications of an earlier run have nothing left to read */
+        (void)ulTaskNotifyTake(pdTRUE, 0u);
+        status = sample_clock_start(&clockConfig);
+    }
+
+    /*! - a block must not span two sample rates. Below 1 Hz a channel
+          has no rate the analyzer can take, sampling goes on without it */
+    if ((status == STATUS_OKAY) && CHECK_POINTER_VALID(rippleAnalyzer))
+    {
+        rippleActive = (rippleAnalyzer->init(channelRateHz(getPeriodMs()), true) == STATUS_OKAY);
+    }
+
+    if (status == STATUS_OKAY)
+    {
+        busVoltage.init();
+        busCurrent.init();
+        sampling = true;
+    }
+
+    return status;
+}
+
+/*!
+ * \brief one notification per read the i2c task completed, the sample of
+ * a notification is the oldest one not read yet
+ */
+void PowerMonitor::readSamples(void)
+{
+    sample_clock_sample_t sample;
+    RippleResult_t ripple;
+    uint32_t completed = ulTaskNotifyTake(pdTRUE, 0u);
+
+    while (completed > 0u)
+    {
+        if (sample_clock_read(&sample) == STATUS_OKAY)
+        {
+            bootProfile.mark(BOOT_MILESTONE_FIRST_SAMPLE);
+
+            if (sample.channel == POWER_MONITOR_VOLTAGE_CHANNEL)
+            {
+                busVoltage.addSample(sample.value);
+
+                if (CHECK_POINTER_VALID(transientCapture))
+                {
+                    transientCapture->pushSample(sample.value);
+                }
+
+                if (    CHECK_POINTER_VALID(adaptiveSampler)
+                     && adaptiveSampler->update(sample.value))
+                {
+                    levelChanged = true;
+                }
+
+                if (    rippleActive
+                     && rippleAnalyzer->pushSample(sample.value)
+                     && (rippleAnalyzer->getResult(&ripple) == STATUS_OKAY))
+                {
+                    taskENTER_CRITICAL();
+                    latestRipple = ripple;
+                    rippleValid = true;
+                    taskEXIT_CRITICAL();
+                }
+            }
+            else
+            {
+                busCurrent.addSample(sample.value);
+            }
+        }
+
+        completed--;
+    }
+}
+
+void PowerMonitor::updateTimingStats(uint32_t stepUs, uint32_t executionUs)
+{
+    uint32_t nominalUs = periodMs * US_PER_MS;
+    uint32_t intervalUs = stepUs - lastStepUs;
+    uint32_t jitterUs = (intervalUs > nominalUs) ?
+                        (intervalUs - nominalUs) :
+                        (nominalUs - intervalUs);
+
+    taskENTER_CRITICAL();
+    timingStats.cycles++;
+    timingStats.lastExecutionUs = executionUs;
+    if ((timingStats.cycles == 1u) || (executionUs < timingStats.minExecutionUs))
+    {
+        timingStats.minExecutionUs = executionUs;
+    }
+    if (executionUs > timingStats.maxExecutionUs)
+    {
+        timingStats.maxExecutionUs = executionUs;
+    }
+    executionSumUs += executionUs;
+
+    /*! - the first step after an arm has no interval, time events the
+          dispatcher skipped show as an interval of several periods */
+    if (hasInterval)
+    {
+        if (intervalUs >= (2u * nominalUs))
+        {
+            timingStats.missedDeadlines += (intervalUs / nominalUs) - 1u;
+        }
+        else
+        {
+            if (jitterUs > timingStats.maxJitterUs)
+            {
+                timingStats.maxJitterUs = jitterUs;
+            }
+            jitterSumUs += jitterUs;
+            jitterSamples++;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    lastStepUs = stepUs;
+    hasInterval = true;
+}
+
+Status_t PowerMonitor::measureBusVoltage()
 {
     Status_t status = busVoltage.getFilteredVoltage(&latestBusVoltage);
     if (status == STATUS_OKAY)
     {
-        busVoltageMessage.name = "BusVoltage";
-        busVoltageMessage.timestamp = xTaskGetTickCount();
-        busVoltageMessage.size = sizeof(float);
-        busVoltageMessage.dataPtr = &latestBusVoltage;
-        status = networkingModule.queueNetworkingMessage(&busVoltageMessage);
+        latestBusVoltage = filterPush(&voltageFilter, latestBusVoltage);
     }
 
     return status;
 }
 
-Status_t PowerMonitor::queueBusCurrentMessage()
+Status_t PowerMonitor::measureBusCurrent()
 {
     Status_t status = busCurrent.getFilteredCurrent(&latestBusCurrent);
     if (status == STATUS_OKAY)
     {
-        busCurrentMessage.name = "BusCurrent";
-        busCurrentMessage.timestamp = xTaskGetTickCount();
-        busCurrentMessage.size = sizeof(float);
-        busCurrentMessage.dataPtr = &latestBusCurrent;
-        status = networkingModule.queueNetworkingMessage(&busCurrentMessage);
+        latestBusCurrent = filterPush(&currentFilter, latestBusCurrent);
     }
 
     return status;
 }
 
-Status_t PowerMonitor::queuePowerMessage()
+/*!
+ * \brief takes a staged downlink configuration, runs between two periods
+ * so no message is built with half of the old and half of the new settings
+ */
+void PowerMonitor::applyPendingConfig(void)
 {
-    latestPower = latestBusVoltage * latestBusCurrent;
+    RuntimeConfig_t next;
+    RuntimeConfig_t current;
+    Status_t status = STATUS_OKAY;
 
-    powerMessage.name = "Power";
-    powerMessage.timestamp = xTaskGetTickCount();
-    powerMessage.size = sizeof(float);
-    powerMessage.dataPtr = &latestPower;
-    
-    return networkingModule.queueNetworkingMessage(&powerMessage);
-}
+    if (CHECK_POINTER_VALID(configChannel) && configChannel->getPending(&next))
+    {
+        status = configChannel->getActive(&current);
 
+        /*! - a data rate too slow for the tick is refused up front    */
+        if (    (status == STATUS_OKAY)
+             && (sampleTickUs(next.reportPeriodMs) < conversionUs(next.dataRate)))
+        {
+            status = STATUS_OUT_OF_BOUNDS;
+        }
 
+        /*! - the clock stop is the only step that can fail, do it first.
+              The clock is not running either way, step() starts it with
+              the new settings on the next period  */
+        if (    (status == STATUS_OKAY)
+             && sampling
+             && (    (next.dataRate != current.dataRate)
+                  || (next.pga != current.pga)
+                  || (next.reportPeriodMs != current.reportPeriodMs)))
+        {
+            status = sample_clock_stop();
+            sampling = false;
+        }
+
+        if (status == STATUS_OKAY)
+        {
+            status = setPeriodMs(next.reportPeriodMs);
+        }
+
+        if (status == STATUS_OKAY)
+        {
+            acquisition.dataRate = next.dataRate;
+            acquisition.pga = next.pga;
+        }
+
+        if (status == STATUS_OKAY)
+        {
+            if (next.filterLength != current.filterLength)
+            {
+                filterReset(&voltageFilter, next.filterLength);
+                filterReset(&currentFilter, next.filterLength);
+            }
+        }
+
+        configChannel->complete(status);
+    }
+}
 
 /*******************************************************************************
  * GLOBAL FUNCTIONS
  *******************************************************************************/
-PowerMonitor::PowerMonitor(NetworkingModule &_networkingModule,
+/*!
+ * \brief takes the data rate and period of the sampler level. The clock is
+ * stopped first, as for a staged configuration, step() starts it again
+ */
+Status_t PowerMonitor::applySamplerLevel(void)
+{
+    Status_t status = STATUS_OKAY;
+    ads1115DataRate_t dataRate = adaptiveSampler->getDataRate();
+    uint32_t nextPeriodMs = ((uint32_t)adaptiveSampler->getSamplePeriodMs() * POWER_MONITOR_TICKS_PER_PERIOD)
+                          / POWER_MONITOR_CHANNELS;
+
+    levelChanged = false;
+
+    if (sampleTickUs(nextPeriodMs) < conversionUs(dataRate))
+    {
+        status = STATUS_OUT_OF_BOUNDS;
+    }
+
+    if ((status == STATUS_OKAY) && sampling)
+    {
+        status = sample_clock_stop();
+        sampling = false;
+    }
+
+    if (status == STATUS_OKAY)
+    {
+        status = setPeriodMs(nextPeriodMs);
+    }
+
+    if (status == STATUS_OKAY)
+    {
+        acquisition.dataRate = dataRate;
+    }
+
+    return status;
+}
+
+PowerMonitor::PowerMonitor(PowerSampleTopic &_sampleTopic,
                            BusVoltage &_busVoltage,
-                           BusCurrent &_busCurrent) : Task("PowerMonitor", 256 * 4),
-                                                      busVoltage(_busVoltage),
-                                                      busCurrent(_busCurrent),
-                                                      networkingModule(_networkingModule)
+                           BusCurrent &_busCurrent,
+                           const PowerMonitorAcquisition_t &_acquisition,
+                           uint32_t _periodMs) : ActiveObject("PowerMonitor"),
+                                                 latestBusVoltage(0.0f),
+                                                 latestBusCurrent(0.0f),
+                                                 latestPower(0.0f),
+                                                 busVoltage(_busVoltage),
+                                                 busCurrent(_busCurrent),
+                                                 sampleTopic(_sampleTopic),
+                                                 configChannel(nullptr),
+                                                 rippleAnalyzer(nullptr),
+                                                 rippleActive(false),
+                                                 rippleValid(false),
+                                                 transientCapture(nullptr),
+                                                 adaptiveSampler(nullptr),
+                                                 levelChanged(false),
+                                                 acquisition(_acquisition),
+                                                 sampling(false),
+                                                 periodMs(_periodMs),
+                                                 phaseMs(0u),
+                                                 attached(false),
+                                                 jitterSumUs(0u),
+                                                 jitterSamples(0u),
+                                                 executionSumUs(0u),
+                                                 lastStepUs(0u),
+                                                 hasInterval(false)
 {
-    // Constructor implementation
+    memset(&timingStats, 0, sizeof(timingStats));
+    memset(&latestRipple, 0, sizeof(latestRipple));
+
+    /*! - keep the time event valid if the period given is below one tick */
+    if (pdMS_TO_TICKS(periodMs) == 0u)
+    {
+        periodMs = portTICK_PERIOD_MS;
+    }
+
+    filterReset(&voltageFilter, 1u);
+    filterReset(&currentFilter, 1u);
 }
 
 PowerMonitor::~PowerMonitor()
@@ -109,43 +437,238 @@ PowerMonitor::~PowerMonitor()
 
 
 
-void PowerMonitor::taskRun()
+Status_t PowerMonitor::init(EventDispatcher & dispatcher)
+{
+    Status_t status = dispatcher.attach(*this);
+
+    if (status == STATUS_OKAY)
+    {
+        attached = true;
+        status = armTimer(periodMs, phaseMs);
+    }
+
+    return status;
+}
+
+Status_t PowerMonitor::setPeriodMs(uint32_t _periodMs)
 {
-    /*  initialize power monitor variables     */
+    Status_t status = STATUS_OKAY;
 
-    while (FOREVER())
+    if (pdMS_TO_TICKS(_periodMs) == 0u)
+    {
+        status = STATUS_OUT_OF_BOUNDS;
+    }
+    else if (_periodMs != periodMs)
     {
-        Status_t status = STATUS_OKAY;
-        static uint32_t notificationValue = 0;
+        periodMs = _periodMs;
+        hasInterval = false;
 
-        if (xTaskNotifyWait(0, CLEAR_ALL_BITS, &notificationValue, portMAX_DELAY) != pdTRUE)
+        /*! - before init() the period is armed by init()  */
+        if (attached)
         {
-            status = STATUS_OS_ERROR;
+            status = armTimer(periodMs, phaseMs);
         }
+    }
 
-        /*   send the voltage, current, and power packets to telemetry module */
-        if (    status == STATUS_OKAY 
-                && notificationValue & GET_POWER_NOTIFY_BIT)
+    return status;
+}
+
+void PowerMonitor::setPhaseMs(uint32_t _phaseMs)
+{
+    phaseMs = _phaseMs;
+    hasInterval = false;
+
+    if (attached)
+    {
+        (void)armTimer(periodMs, phaseMs);
+    }
+}
+
+Status_t PowerMonitor::getTimingStats(PowerMonitorTimingStats_t * stats)
+{
+    Status_t status = STATUS_OKAY;
+
+    if (CHECK_POINTER_VALID(stats) == false)
+    {
+        status = STATUS_NULL_POINTER;
+    }
+    else
+    {
+        uint64_t jitterSum;
+        uint32_t jitterCount;
+        uint64_t executionSum;
+
+        taskENTER_CRITICAL();
+        *stats = timingStats;
+        jitterSum = jitterSumUs;
+        jitterCount = jitterSamples;
+        executionSum = executionSumUs;
+        taskEXIT_CRITICAL();
+
+        stats->periodMs = periodMs;
+        stats->phaseMs = phaseMs;
+
+        if (stats->cycles > 0u)
+        {
+            stats->meanExecutionUs = (uint32_t)(executionSum / stats->cycles);
+        }
+        if (jitterCount > 0u)
         {
-            status = queueBusVoltageMessage();
+            stats->meanJitterUs = (uint32_t)(jitterSum / jitterCount);
+        }
+    }
 
-            if(status == STATUS_OKAY)
-            {
-                status = queueBusCurrentMessage();
-            }
+    return status;
+}
 
-            if(status == STATUS_OKAY)
-            {
-                status = queuePowerMessage();
-            }
+void PowerMonitor::dispatch(const Event_t & event)
+{
+    if (event.signal == EVENT_SIGNAL_TIMEOUT)
+    {
+        uint32_t stepUs = timing_getTimeUs();
+
+        step();
+        updateTimingStats(stepUs, timing_getTimeUs() - stepUs);
+    }
+}
+
+void PowerMonitor::setConfigChannel(ConfigChannel * _configChannel)
+{
+    RuntimeConfig_t active;
+
+    configChannel = _configChannel;
+
+    if (    CHECK_POINTER_VALID(configChannel)
+         && (configChannel->getActive(&active) == STATUS_OKAY))
+    {
+        setPeriodMs(active.reportPeriodMs);
+        acquisition.dataRate = active.dataRate;
+        acquisition.pga = active.pga;
+        filterReset(&voltageFilter, active.filterLength);
+        filterReset(&currentFilter, active.filterLength);
+    }
+}
+
+void PowerMonitor::setRippleAnalyzer(RippleAnalyzer * _rippleAnalyzer)
+{
+    rippleAnalyzer = _rippleAnalyzer;
+    rippleActive = false;
+}
+
+Status_t PowerMonitor::getRipple(RippleResult_t * ripple)
+{
+    Status_t status = STATUS_OKAY;
+
+    if (CHECK_POINTER_VALID(ripple) == false)
+    {
+        status = STATUS_NULL_POINTER;
+    }
+    else
+    {
+        taskENTER_CRITICAL();
+        if (rippleValid)
+        {
+            *ripple = latestRipple;
+        }
+        else
+        {
+            status = STATUS_UNKNOWN;
         }
+        taskEXIT_CRITICAL();
+    }
+
+    return status;
+}
+
+void PowerMonitor::setTransientCapture(TransientCapture * _transientCapture)
+{
+    transientCapture = _transientCapture;
+}
+
+void PowerMonitor::setAdaptiveSampler(AdaptiveSampler * _adaptiveSampler)
+{
+    adaptiveSampler = _adaptiveSampler;
+    levelChanged = false;
+
+    if (CHECK_POINTER_VALID(adaptiveSampler) && (applySamplerLevel() != STATUS_OKAY))
+    {
+        ESP_LOGE(TAG, "sampler level not applied");
+    }
+}
+
+Status_t PowerMonitor::getMeasurements(PowerMonitorMeasurements_t * measurements)
+{
+    Status_t status = STATUS_OKAY;
 
-        if (status != STATUS_OKAY)
+    if (CHECK_POINTER_VALID(measurements) == false)
+    {
+        status = STATUS_NULL_POINTER;
+    }
+    else
+    {
+        taskENTER_CRITICAL();
+        measurements->busVoltage = latestBusVoltage;
+        measurements->busCurrent = latestBusCurrent;
+        measurements->power = latestPower;
+        taskEXIT_CRITICAL();
+    }
+
+    return status;
+}
+
+void PowerMonitor::step(void)
+{
+    PowerSample_t sample;
+    Status_t status = STATUS_OKAY;
+
+    /*   the clock notifies the task that starts it, so it is started here
+         on the dispatcher task, again after a reconfiguration stopped it */
+    if (sampling == false)
+    {
+        status = startSampling();
+    }
+    else
+    {
+        /*   average the period, then hand one sample to every subscriber */
+        readSamples();
+
+        /*   the ring only records again once the frozen block is out,
+             errors are logged by the capture */
+        if (    CHECK_POINTER_VALID(transientCapture)
+             && (transientCapture->getState() == CAPTURE_STATE_FROZEN))
         {
-            ESP_LOGE(TAG, "Error: %i", status);
+            (void)transientCapture->publishCapture();
         }
 
-        // Add a delay or yield to avoid busy-waiting
-        vTaskDelay(pdMS_TO_TICKS(100)); // Delay for 100 milliseconds
+        status = measureBusVoltage();
+
+        if(status == STATUS_OKAY)
+        {
+            status = measureBusCurrent();
+        }
+
+        if(status == STATUS_OKAY)
+        {
+            latestPower = latestBusVoltage * latestBusCurrent;
+
+            sample.timestamp = xTaskGetTickCount();
+            sample.busVoltage = latestBusVoltage;
+            sample.busCurrent = latestBusCurrent;
+            sample.power = latestPower;
+            status = sampleTopic.publish(sample);
+        }
+    }
+
+    if (status != STATUS_OKAY)
+    {
+        ESP_LOGE(TAG, "Error: %i", status);
     }
-}
\ No newline at end of file
+
+    /*  safe point, the period is complete and the next has not begun */
+    applyPendingConfig();
+
+    if (levelChanged && (applySamplerLevel() != STATUS_OKAY))
+    {
+        ESP_LOGE(TAG, "sampler level not applied");
+    }
+}
@@ -0,0 +1,139 @@
+/**
+ *******************************************************************************
+ * @file    power_subscribers.cpp
+ * @author  hq
+ * @date    2025-08-10 16:08:52
+ * @brief   Power subscribers source file
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * INCLUDES
+ *******************************************************************************/
+#include "power_subscribers.hpp"
+
+extern "C"
+{
+    #include "freertos/task.h"
+    #include "esp_log.h"
+}
+
+/*******************************************************************************
+ * EXTERN VARIABLES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * PRIVATE MACROS AND DEFINES
+ *******************************************************************************/
+#define UJ_PER_WH (3600000000.0f)
+#define UJ_PER_MJ (1000.0f)
+
+/*******************************************************************************
+ * PRIVATE TYPEDEFS
+ *******************************************************************************/
+
+/*******************************************************************************
+ * STATIC VARIABLES
+ *******************************************************************************/
+static const char *TAG = "PowerSubscribers";
+
+/*******************************************************************************
+ * GLOBAL VARIABLES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * STATIC FUNCTION PROTOTYPES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * STATIC FUNCTIONS
+ *******************************************************************************/
+Status_t PowerTelemetry::queueFloatMessage(MessageId_t id, uint32_t timestamp, float value)
+{
+    Status_t status = STATUS_OKAY;
+    NetworkingMessage_t message;
+    MessageBuffer_t * buffer = messagePool.allocate(sizeof(float));
+
+    if (CHECK_POINTER_VALID(buffer) == false)
+    {
+        status = STATUS_POOL_EXHAUSTED;
+    }
+
+    if (status == STATUS_OKAY)
+    {
+        memcpy(buffer->data, &value, sizeof(float));
+        buffer->length = sizeof(float);
+
+        message.id = id;
+        message.timestamp = timestamp;
+        message.buffer = buffer;
+        status = networkingModule.queueNetworkingMessage(&message);
+    }
+
+    return status;
+}
+
+/*******************************************************************************
+ * GLOBAL FUNCTIONS
+ *******************************************************************************/
+void PowerTelemetry::onPublish(const Sample<PowerSample_t> & sample)
+{
+    /*  the telemetry format carries one value per message, so the three
+        values are split out here instead of forwarding the shared block */
+    Status_t status = queueFloatMessage(MESSAGE_ID_BUS_VOLTAGE, sample->timestamp, sample->busVoltage);
+
+    if (status == STATUS_OKAY)
+    {
+        status = queueFloatMessage(MESSAGE_ID_BUS_CURRENT, sample->timestamp, sample->busCurrent);
+    }
+
+    if (status == STATUS_OKAY)
+    {
+        status = queueFloatMessage(MESSAGE_ID_POWER, sample->timestamp, sample->power);
+    }
+
+    if (status != STATUS_OKAY)
+    {
+        ESP_LOGE(TAG, "Error: %i", status);
+    }
+}
+
+EnergyIntegrator::EnergyIntegrator() : energyUj(0),
+                                       lastTimestamp(0u),
+                                       lastPower(0.0f),
+                                       hasLast(false)
+{
+}
+
+void EnergyIntegrator::onPublish(const Sample<PowerSample_t> & sample)
+{
+    uint32_t elapsedMs = (sample->timestamp - lastTimestamp) * portTICK_PERIOD_MS;
+
+    /*! - a stalled monitor leaves a gap instead of a guessed area */
+    if (hasLast && (elapsedMs <= ENERGY_MAX_GAP_MS))
+    {
+        /*! - W times ms is mJ, kept in uJ and rounded so the slices of a
+              low power do not truncate to nothing */
+        float areaUj = ((lastPower + sample->power) * 0.5f) * (float)elapsedMs * UJ_PER_MJ;
+        int64_t area = (int64_t)(areaUj + ((areaUj < 0.0f) ? -0.5f : 0.5f));
+
+        taskENTER_CRITICAL();
+        energyUj += area;
+        taskEXIT_CRITICAL();
+    }
+
+    lastTimestamp = sample->timestamp;
+    lastPower = sample->power;
+    hasLast = true;
+}
+
+float EnergyIntegrator::getEnergyWh(void)
+{
+    int64_t energy;
+
+    taskENTER_CRITICAL();
+    energy = energyUj;
+    taskEXIT_CRITICAL();
+
+    return (float)energy / UJ_PER_WH;
+}
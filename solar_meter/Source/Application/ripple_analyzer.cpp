@@ -0,0 +1,484 @@
+/**
+ *******************************************************************************
+ * @file    ripple_analyzer.cpp
+ * @author  hq
+ * @date    2025-07-21 19:10:42
+ * @brief   Ripple analyzer source file
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * INCLUDES
+ *******************************************************************************/
+#include "ripple_analyzer.hpp"
+#include "timing.h"
+
+/*******************************************************************************
+ * EXTERN VARIABLES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * PRIVATE MACROS AND DEFINES
+ *******************************************************************************/
+#define QUARTER_BLOCK               (RIPPLE_BLOCK_SIZE / 4u)
+#define HALF_BLOCK                  (RIPPLE_BLOCK_SIZE / 2u)
+#define GOERTZEL_COEFF_SHIFT        (14u)
+#define Q15_SHIFT                   (15u)
+#define INTERP_SHIFT                (8u)
+/* first fft bin considered for the dominant tone, bin 0 and the hann leakage
+ * of the dc level into bin 1 are skipped */
+#define FIRST_RIPPLE_BIN            (2u)
+/* hann coherent gain is 0.5 and a real tone splits in two bins */
+#define HANN_AMPLITUDE_SCALE        (4u)
+
+/*******************************************************************************
+ * PRIVATE TYPEDEFS
+ *******************************************************************************/
+
+/*******************************************************************************
+ * STATIC VARIABLES
+ *******************************************************************************/
+
+/* quarter wave sine, sin(2*pi*i/RIPPLE_BLOCK_SIZE) in Q15   */
+static const int16_t sineQuarterQ15[QUARTER_BLOCK + 1u] =
+{
+        0,  1608,  3212,  4808,  6393,  7962,  9512, 11039,
+    12539, 14010, 15446, 16846, 18204, 19519, 20787, 22005,
+    23170, 24279, 25329, 26319, 27245, 28105, 28898, 29621,
+    30273, 30852, 31356, 31785, 32137, 32412, 32609, 32728,
+    32767,
+};
+
+/* first half of the periodic hann window in Q15, w[N - n] = w[n]    */
+static const int16_t hannHalfQ15[HALF_BLOCK + 1u] =
+{
+        0,    20,    79,   177,   315,   491,   705,   958,
+     1247,  1573,  1935,  2331,  2761,  3224,  3719,  4244,
+     4799,  5381,  5990,  6624,  7281,  7961,  8660,  9379,
+    10114, 10864, 11628, 12403, 13187, 13980, 14778, 15580,
+    16383, 17187, 17989, 18787, 19580, 20364, 21139, 21903,
+    22653, 23388, 24107, 24806, 25486, 26143, 26777, 27386,
+    27968, 28523, 29048, 29543, 30006, 30436, 30832, 31194,
+    31520, 31809, 32062, 32276, 32452, 32590, 32688, 32747,
+    32767,
+};
+
+/*******************************************************************************
+ * GLOBAL VARIABLES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * STATIC FUNCTION PROTOTYPES
+ *******************************************************************************/
+static int16_t sineQ15(uint32_t index);
+static int16_t cosineQ15(uint32_t index);
+static int16_t saturateQ15(int32_t value);
+static uint32_t squareRoot(uint64_t value);
+
+/*******************************************************************************
+ * STATIC FUNCTIONS
+ *******************************************************************************/
+/*!
+ * \brief returns sin(2*pi*index/RIPPLE_BLOCK_SIZE) in Q15
+ */
+static int16_t sineQ15(uint32_t index)
+{
+    int16_t retVal;
+
+    index &= (RIPPLE_BLOCK_SIZE - 1u);
+
+    if (index <= QUARTER_BLOCK)
+    {
+        retVal = sineQuarterQ15[index];
+    }
+    else if (index <= HALF_BLOCK)
+    {
+        retVal = sineQuarterQ15[HALF_BLOCK - index];
+    }
+    else if (index <= (HALF_BLOCK + QUARTER_BLOCK))
+    {
+        retVal = -sineQuarterQ15[index - HALF_BLOCK];
+    }
+    else
+    {
+        retVal = -sineQuarterQ15[RIPPLE_BLOCK_SIZE - index];
+    }
+
+    return retVal;
+}
+
+static int16_t cosineQ15(uint32_t index)
+{
+    return sineQ15(index + QUARTER_BLOCK);
+}
+
+static int16_t saturateQ15(int32_t value)
+{
+    if (value > INT16_MAX)
+    {
+        value = INT16_MAX;
+    }
+    else if (value < INT16_MIN)
+    {
+        value = INT16_MIN;
+    }
+
+    return (int16_t)value;
+}
+
+/*!
+ * \brief bitwise integer square root, rounds down
+ */
+static uint32_t squareRoot(uint64_t value)
+{
+    uint64_t root = 0u;
+    uint64_t bit = (uint64_t)1u << 62;
+
+    while (bit > value)
+    {
+        bit >>= 2;
+    }
+
+    while (bit != 0u)
+    {
+        if (value >= root + bit)
+        {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        }
+        else
+        {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+
+    return (uint32_t)root;
+}
+
+/*!
+ * \brief removes the dc level and evaluates every goertzel bin over the block
+ */
+void RippleAnalyzer::runGoertzel(void)
+{
+    for (uint8_t bin = 0u; bin < binCount; bin++)
+    {
+        int32_t coeff = bins[bin].coeffQ14;
+        int32_t s1 = 0;
+        int32_t s2 = 0;
+
+        for (uint16_t n = 0u; n < RIPPLE_BLOCK_SIZE; n++)
+        {
+            int32_t s0 = (int32_t)blockRe[n]
+                       + (int32_t)(((int64_t)coeff * s1) >> GOERTZEL_COEFF_SHIFT)
+                       - s2;
+            s2 = s1;
+            s1 = s0;
+        }
+
+        /* |X|^2 = s1^2 + s2^2 - coeff * s1 * s2   */
+        int64_t power = ((int64_t)s1 * s1)
+                      + ((int64_t)s2 * s2)
+                      - ((((int64_t)coeff * s1) >> GOERTZEL_COEFF_SHIFT) * s2);
+
+        if (power < 0)
+        {
+            power = 0;
+        }
+
+        /* a tone of amplitude A gives |X| = A * N / 2 */
+        bins[bin].amplitude = (squareRoot((uint64_t)power) * 2u) / RIPPLE_BLOCK_SIZE;
+    }
+}
+
+/*!
+ * \brief hann windows the block then runs a radix-2 decimation in time fft
+ * in place. every stage is scaled by 1/2 so the output is the dft / N and
+ * can not overflow.
+ */
+void RippleAnalyzer::runFft(void)
+{
+    /*! - apply window, the imaginary part starts at zero */
+    for (uint16_t n = 0u; n < RIPPLE_BLOCK_SIZE; n++)
+    {
+        uint16_t w = (n <= HALF_BLOCK) ? n : (RIPPLE_BLOCK_SIZE - n);
+        blockRe[n] = (int16_t)(((int32_t)blockRe[n] * hannHalfQ15[w]) >> Q15_SHIFT);
+        blockIm[n] = 0;
+    }
+
+    /*! - bit reverse reorder   */
+    for (uint16_t m = 1u, mr = 0u; m < RIPPLE_BLOCK_SIZE; m++)
+    {
+        uint16_t l = RIPPLE_BLOCK_SIZE;
+        do
+        {
+            l >>= 1;
+        } while (mr + l > (RIPPLE_BLOCK_SIZE - 1u));
+        mr = (mr & (l - 1u)) + l;
+
+        if (mr > m)
+        {
+            int16_t tmp = blockRe[m];
+            blockRe[m] = blockRe[mr];
+            blockRe[mr] = tmp;
+        }
+    }
+
+    /*! - butterflies   */
+    uint16_t twiddleShift = RIPPLE_BLOCK_LOG2 - 1u;
+    for (uint16_t l = 1u; l < RIPPLE_BLOCK_SIZE; l <<= 1)
+    {
+        uint16_t step = l << 1;
+
+        for (uint16_t m = 0u; m < l; m++)
+        {
+            uint32_t twiddle = (uint32_t)m << twiddleShift;
+            int32_t wr = cosineQ15(twiddle) >> 1;
+            int32_t wi = -sineQ15(twiddle) >> 1;
+
+            for (uint16_t i = m; i < RIPPLE_BLOCK_SIZE; i += step)
+            {
+                uint16_t j = i + l;
+                int32_t tr = ((wr * blockRe[j]) - (wi * blockIm[j])) >> Q15_SHIFT;
+                int32_t ti = ((wr * blockIm[j]) + (wi * blockRe[j])) >> Q15_SHIFT;
+                int32_t qr = blockRe[i] >> 1;
+                int32_t qi = blockIm[i] >> 1;
+
+                blockRe[j] = (int16_t)(qr - tr);
+                blockIm[j] = (int16_t)(qi - ti);
+                blockRe[i] = (int16_t)(qr + tr);
+                blockIm[i] = (int16_t)(qi + ti);
+            }
+        }
+
+        twiddleShift--;
+    }
+}
+
+/*!
+ * \brief finds the largest fft bin and refines its frequency with a
+ * parabolic fit over the neighbouring bins
+ */
+void RippleAnalyzer::findDominantTone(void)
+{
+    uint16_t peakBin = FIRST_RIPPLE_BIN;
+    uint32_t peakMag = 0u;
+    uint32_t leftMag = 0u;
+    uint32_t rightMag = 0u;
+    uint32_t prevMag = 0u;
+
+    for (uint16_t k = FIRST_RIPPLE_BIN - 1u; k < HALF_BLOCK; k++)
+    {
+        uint32_t mag = squareRoot((uint64_t)((int32_t)blockRe[k] * blockRe[k])
+                                + (uint64_t)((int32_t)blockIm[k] * blockIm[k]));
+
+        if (k == peakBin + 1u)
+        {
+            rightMag = mag;
+        }
+
+        if ((k >= FIRST_RIPPLE_BIN) && (mag > peakMag))
+        {
+            peakBin = k;
+            peakMag = mag;
+            leftMag = prevMag;
+            rightMag = 0u;
+        }
+
+        prevMag = mag;
+    }
+
+    int32_t offsetQ8 = 0;
+    int32_t denominator = (int32_t)(2u * peakMag) - (int32_t)leftMag - (int32_t)rightMag;
+    if (denominator > 0)
+    {
+        /* delta = (R - L) / (2 * (2P - L - R)), R - L may be negative so
+           it is scaled by a multiply, a left shift of it is undefined */
+        offsetQ8 = (((int32_t)rightMag - (int32_t)leftMag) * (int32_t)(1u << (INTERP_SHIFT - 1u))) / denominator;
+    }
+
+    int32_t binQ8 = ((int32_t)peakBin << INTERP_SHIFT) + offsetQ8;
+    /*! - the product passes 32 bits above about 13 kHz sample rate */
+    result.dominantFrequencyDeciHz = (uint32_t)(((int64_t)binQ8 * sampleRateHz * 10)
+                                                / (int64_t)(RIPPLE_BLOCK_SIZE << INTERP_SHIFT));
+    result.rippleAmplitude = peakMag * HANN_AMPLITUDE_SCALE;
+}
+
+void RippleAnalyzer::analyseBlock(void)
+{
+    uint32_t startCycles = timing_getCycleCount();
+    int32_t sum = 0;
+    int16_t minSample = INT16_MAX;
+    int16_t maxSample = INT16_MIN;
+
+    /*! - dc level and peak to peak of the raw block */
+    for (uint16_t n = 0u; n < RIPPLE_BLOCK_SIZE; n++)
+    {
+        sum += blockRe[n];
+        if (blockRe[n] < minSample)
+        {
+            minSample = blockRe[n];
+        }
+        if (blockRe[n] > maxSample)
+        {
+            maxSample = blockRe[n];
+        }
+    }
+
+    result.blockMean = (int16_t)(sum / (int32_t)RIPPLE_BLOCK_SIZE);
+    result.ripplePeakToPeak = (uint32_t)((int32_t)maxSample - (int32_t)minSample);
+
+    /*! - remove dc in place so bins only see the ripple  */
+    for (uint16_t n = 0u; n < RIPPLE_BLOCK_SIZE; n++)
+    {
+        blockRe[n] = saturateQ15((int32_t)blockRe[n] - result.blockMean);
+    }
+
+    runGoertzel();
+
+    if (fftEnabled)
+    {
+        runFft();
+        findDominantTone();
+    }
+    else
+    {
+        /*! - without the fft the strongest goertzel bin is the dominant tone */
+        result.rippleAmplitude = 0u;
+        result.dominantFrequencyDeciHz = 0u;
+        for (uint8_t bin = 0u; bin < binCount; bin++)
+        {
+            if (bins[bin].amplitude > result.rippleAmplitude)
+            {
+                result.rippleAmplitude = bins[bin].amplitude;
+                result.dominantFrequencyDeciHz = (uint32_t)bins[bin].frequencyHz * 10u;
+            }
+        }
+    }
+
+    result.cyclesPerBlock = timing_getCycleCount() - startCycles;
+    resultValid = true;
+}
+
+/*******************************************************************************
+ * GLOBAL FUNCTIONS
+ *******************************************************************************/
+RippleAnalyzer::RippleAnalyzer() : blockIndex(0u),
+                                   binCount(0u),
+                                   sampleRateHz(0u),
+                                   fftEnabled(false),
+                                   resultValid(false)
+{
+    memset(&result, 0, sizeof(result));
+}
+
+Status_t RippleAnalyzer::init(uint16_t _sampleRateHz, bool _fftEnabled)
+{
+    Status_t status = STATUS_OKAY;
+
+    if (_sampleRateHz == 0u)
+    {
+        status = STATUS_OUT_OF_BOUNDS;
+    }
+
+    if (status == STATUS_OKAY)
+    {
+        sampleRateHz = _sampleRateHz;
+        fftEnabled = _fftEnabled;
+        binCount = 0u;
+        blockIndex = 0u;
+        resultValid = false;
+        memset(&result, 0, sizeof(result));
+    }
+
+    return status;
+}
+
+Status_t RippleAnalyzer::addGoertzelBin(uint16_t frequencyHz)
+{
+    Status_t status = STATUS_OKAY;
+
+    if (    (binCount >= RIPPLE_MAX_GOERTZEL_BINS)
+         || (frequencyHz == 0u)
+         || ((2u * (uint32_t)frequencyHz) >= sampleRateHz))
+    {
+        status = STATUS_OUT_OF_BOUNDS;
+    }
+
+    if (status == STATUS_OKAY)
+    {
+        /*! - phase step in sine table entries with a 16 bit fraction, the
+         *  cosine is linearly interpolated between table entries */
+        uint32_t phaseQ16 = (uint32_t)((((uint64_t)frequencyHz * RIPPLE_BLOCK_SIZE) << 16)
+                                       / sampleRateHz);
+        uint32_t index = phaseQ16 >> 16;
+        int32_t fraction = (int32_t)(phaseQ16 & 0xFFFFu);
+        int32_t c0 = cosineQ15(index);
+        int32_t c1 = cosineQ15(index + 1u);
+
+        /* 2cos(w) in Q14 has the same bit pattern as cos(w) in Q15   */
+        bins[binCount].frequencyHz = frequencyHz;
+        bins[binCount].coeffQ14 = c0 + (((c1 - c0) * fraction) >> 16);
+        bins[binCount].amplitude = 0u;
+        binCount++;
+    }
+
+    return status;
+}
+
+bool RippleAnalyzer::pushSample(int16_t sample)
+{
+    bool resultReady = false;
+
+    blockRe[blockIndex] = sample;
+    blockIndex++;
+
+    if (blockIndex >= RIPPLE_BLOCK_SIZE)
+    {
+        analyseBlock();
+        blockIndex = 0u;
+        resultReady = true;
+    }
+
+    return resultReady;
+}
+
+Status_t RippleAnalyzer::getResult(RippleResult_t * _result)
+{
+    Status_t status = STATUS_OKAY;
+
+    if (CHECK_POINTER_VALID(_result) == false)
+    {
+        status = STATUS_NULL_POINTER;
+    }
+    else if (resultValid == false)
+    {
+        status = STATUS_UNKNOWN;
+    }
+    else
+    {
+        *_result = result;
+    }
+
+    return status;
+}
+
+Status_t RippleAnalyzer::getBinAmplitude(uint8_t bin, uint32_t * amplitude)
+{
+    Status_t status = STATUS_OKAY;
+
+    if (CHECK_POINTER_VALID(amplitude) == false)
+    {
+        status = STATUS_NULL_POINTER;
+    }
+    else if (bin >= binCount)
+    {
+        status = STATUS_OUT_OF_BOUNDS;
+    }
+    else
+    {
+        *amplitude = bins[bin].amplitude;
+    }
+
+    return status;
+}
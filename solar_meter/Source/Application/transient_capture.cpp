@@ -0,0 +1,355 @@
+/**
+ *******************************************************************************
+ * @file    transient_capture.cpp
+ * @author  hq
+ * @date    2025-07-22 20:41:05
+ * @brief   Transient capture source file
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * INCLUDES
+ *******************************************************************************/
+#include "transient_capture.hpp"
+
+extern "C"
+{
+    #include "freertos/task.h"
+    #include "esp_log.h"
+}
+
+/*******************************************************************************
+ * EXTERN VARIABLES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * PRIVATE MACROS AND DEFINES
+ *******************************************************************************/
+#define VARINT_MAX_BYTES        (3u)        /* zigzag of a 17 bit delta     */
+#define VARINT_CONTINUE_BIT     (0x80u)
+#define VARINT_PAYLOAD_MASK     (0x7Fu)
+#define VARINT_PAYLOAD_BITS     (7u)
+#define RAW_SAMPLE_SIZE         (2u)
+
+static_assert(CAPTURE_BLOB_MAX_SIZE <= MESSAGE_POOL_LARGE_BLOCK_SIZE,
+              "capture blob does not fit the large message pool class");
+
+/*******************************************************************************
+ * PRIVATE TYPEDEFS
+ *******************************************************************************/
+
+/*******************************************************************************
+ * STATIC VARIABLES
+ *******************************************************************************/
+static const char *TAG = "TransientCapture";
+
+/*******************************************************************************
+ * GLOBAL VARIABLES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * STATIC FUNCTION PROTOTYPES
+ *******************************************************************************/
+static void putUint16(uint8_t * dst, uint16_t value);
+
+/*******************************************************************************
+ * STATIC FUNCTIONS
+ *******************************************************************************/
+static void putUint16(uint8_t * dst, uint16_t value)
+{
+    dst[0] = (uint8_t)(value & 0xFFu);
+    dst[1] = (uint8_t)(value >> 8);
+}
+
+/*!
+ * \brief clears the ring and points the write path and trigger compare at
+ * the configured trigger
+ */
+void TransientCapture::arm(void)
+{
+    writeIndex = 0u;
+    writeBase = ring;
+    writeMask = CAPTURE_RING_MASK;
+    previousSample = 0;
+    awaitingReference = false;
+
+    switch (config.trigger)
+    {
+        case CAPTURE_TRIGGER_LEVEL_BELOW:
+            polarity = -1;
+            referenceMask = 0;
+            triggerLevel = -(int32_t)config.threshold;
+            break;
+
+        case CAPTURE_TRIGGER_LEVEL_ABOVE:
+            polarity = 1;
+            referenceMask = 0;
+            triggerLevel = config.threshold;
+            break;
+
+        case CAPTURE_TRIGGER_SLOPE_FALLING:
+            polarity = -1;
+            referenceMask = -1;
+            triggerLevel = config.threshold;
+            break;
+
+        case CAPTURE_TRIGGER_SLOPE_RISING:
+        default:
+            polarity = 1;
+            referenceMask = -1;
+            triggerLevel = config.threshold;
+            break;
+    }
+
+    /*! - a slope needs a previous sample, the first one after arming only
+          becomes the reference, it goes through the slow path once */
+    if (referenceMask != 0)
+    {
+        armedLevel = triggerLevel;
+        triggerLevel = INT32_MIN;
+        awaitingReference = true;
+    }
+
+    state = CAPTURE_STATE_ARMED;
+}
+
+/*!
+ * \brief stops recording, writes go to the discard slot until re-armed
+ */
+void TransientCapture::freeze(void)
+{
+    writeBase = &discardSample;
+    writeMask = 0u;
+    triggerLevel = INT32_MAX;
+    state = CAPTURE_STATE_FROZEN;
+}
+
+/*!
+ * \brief slow path of pushSample, entered when the trigger fires and for
+ * every post trigger sample afterwards
+ */
+void TransientCapture::onTrigger(void)
+{
+    if (awaitingReference)
+    {
+        /*! - pushSample already kept the sample as previousSample */
+        triggerLevel = armedLevel;
+        awaitingReference = false;
+    }
+    else if (state == CAPTURE_STATE_ARMED)
+    {
+        uint32_t preSamples = config.preSamples;
+
+        /*! - the sample that fired is the first post trigger sample    */
+        triggerIndex = writeIndex - 1u;
+
+        /*! - fewer pre trigger samples exist if it fired soon after arming */
+        if (preSamples > triggerIndex)
+        {
+            preSamples = triggerIndex;
+        }
+
+        blockStart = triggerIndex - preSamples;
+        blockLength = (uint16_t)(preSamples + config.postSamples);
+        postRemaining = config.postSamples - 1u;
+        triggerTick = xTaskGetTickCount();
+
+        if (postRemaining == 0u)
+        {
+            freeze();
+        }
+        else
+        {
+            /*! - every following sample comes here until the post count is in */
+            triggerLevel = INT32_MIN;
+            state = CAPTURE_STATE_POST_TRIGGER;
+        }
+    }
+    else if (state == CAPTURE_STATE_POST_TRIGGER)
+    {
+        postRemaining--;
+
+        if (postRemaining == 0u)
+        {
+            freeze();
+        }
+    }
+}
+
+/*!
+ * \brief delta encodes the frozen block into a pooled buffer, a block
+ * that does not compress into the buffer is stored raw instead
+ *
+ * Blob layout, little endian:
+ *  [0]     version
+ *  [1]     trigger type, CAPTURE_BLOB_RAW_FLAG set for a raw block
+ *  [2..3]  sample count
+ *  [4..5]  pre trigger sample count
+ *  [6..7]  first sample
+ *  [8..]   zigzag varint delta to the previous sample for the rest, or
+ *          the rest as int16 for a raw block
+ *
+ * \param buffer - destination, length is set to the blob size
+ * \return Status_t - STATUS_OUT_OF_BOUNDS if not even the raw block fits
+ */
+Status_t TransientCapture::compressBlock(MessageBuffer_t * buffer)
+{
+    uint8_t * blob = buffer->data;
+    Status_t status = STATUS_OKAY;
+    uint16_t index = CAPTURE_BLOB_HEADER_SIZE;
+    int16_t previous = ring[blockStart & CAPTURE_RING_MASK];
+
+    blob[0] = CAPTURE_BLOB_VERSION;
+    blob[1] = (uint8_t)config.trigger;
+    putUint16(&blob[2], blockLength);
+    putUint16(&blob[4], (uint16_t)(triggerIndex - blockStart));
+    putUint16(&blob[6], (uint16_t)previous);
+
+    for (uint16_t i = 1u; (i < blockLength) && (status == STATUS_OKAY); i++)
+    {
+        int16_t sample = ring[(blockStart + i) & CAPTURE_RING_MASK];
+        int32_t delta = (int32_t)sample - (int32_t)previous;
+        uint32_t zigzag = ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31);
+
+        if ((index + VARINT_MAX_BYTES) > buffer->capacity)
+        {
+            status = STATUS_OUT_OF_BOUNDS;
+        }
+
+        while ((status == STATUS_OKAY) && (zigzag > VARINT_PAYLOAD_MASK))
+        {
+            blob[index++] = (uint8_t)((zigzag & VARINT_PAYLOAD_MASK) | VARINT_CONTINUE_BIT);
+            zigzag >>= VARINT_PAYLOAD_BITS;
+        }
+
+        if (status == STATUS_OKAY)
+        {
+            blob[index++] = (uint8_t)zigzag;
+        }
+
+        previous = sample;
+    }
+
+    /*! - noise makes the deltas larger than the samples, keep them raw   */
+    if (    (status == STATUS_OUT_OF_BOUNDS)
+         && ((CAPTURE_BLOB_HEADER_SIZE + (RAW_SAMPLE_SIZE * (blockLength - 1u))) <= buffer->capacity))
+    {
+        blob[1] |= CAPTURE_BLOB_RAW_FLAG;
+        index = CAPTURE_BLOB_HEADER_SIZE;
+
+        for (uint16_t i = 1u; i < blockLength; i++)
+        {
+            putUint16(&blob[index], (uint16_t)ring[(blockStart + i) & CAPTURE_RING_MASK]);
+            index += RAW_SAMPLE_SIZE;
+        }
+
+        status = STATUS_OKAY;
+    }
+
+    buffer->length = index;
+
+    return status;
+}
+
+/*******************************************************************************
+ * GLOBAL FUNCTIONS
+ *******************************************************************************/
+TransientCapture::TransientCapture(NetworkingModule &_networkingModule) :
+                                   writeBase(&discardSample),
+                                   discardSample(0),
+                                   writeMask(0u),
+                                   writeIndex(0u),
+                                   previousSample(0),
+                                   referenceMask(0),
+                                   polarity(1),
+                                   triggerLevel(INT32_MAX),
+                                   armedLevel(INT32_MAX),
+                                   awaitingReference(false),
+                                   state(CAPTURE_STATE_IDLE),
+                                   triggerIndex(0u),
+                                   blockStart(0u),
+                                   blockLength(0u),
+                                   postRemaining(0u),
+                                   triggerTick(0u),
+                                   networkingModule(_networkingModule)
+{
+    memset(&config, 0, sizeof(config));
+}
+
+Status_t TransientCapture::configure(const CaptureConfig_t * _config)
+{
+    Status_t status = STATUS_OKAY;
+
+    if (CHECK_POINTER_VALID(_config) == false)
+    {
+        status = STATUS_NULL_POINTER;
+    }
+
+    if (    (status == STATUS_OKAY)
+         && (    (_config->postSamples == 0u)
+              || (((uint32_t)_config->preSamples + _config->postSamples) > CAPTURE_RING_SIZE)))
+    {
+        status = STATUS_OUT_OF_BOUNDS;
+    }
+
+    if (status == STATUS_OKAY)
+    {
+        config = *_config;
+        arm();
+    }
+
+    return status;
+}
+
+Status_t TransientCapture::publishCapture(void)
+{
+    Status_t status = STATUS_OKAY;
+    MessageBuffer_t * buffer = nullptr;
+    NetworkingMessage_t message;
+
+    if (state != CAPTURE_STATE_FROZEN)
+    {
+        status = STATUS_UNKNOWN;
+    }
+
+    if (status == STATUS_OKAY)
+    {
+        buffer = messagePool.allocate(CAPTURE_BLOB_MAX_SIZE);
+
+        if (CHECK_POINTER_VALID(buffer) == false)
+        {
+            status = STATUS_POOL_EXHAUSTED;
+        }
+    }
+
+    if (status == STATUS_OKAY)
+    {
+        status = compressBlock(buffer);
+    }
+
+    if (state == CAPTURE_STATE_FROZEN)
+    {
+        /*! - the ring is free again once the blob is built or dropped    */
+        arm();
+    }
+
+    if (status == STATUS_OKAY)
+    {
+        /*! - the buffer reference moves to the networking module  */
+        message.id = MESSAGE_ID_CAPTURE;
+        message.timestamp = triggerTick;
+        message.buffer = buffer;
+        status = networkingModule.queueNetworkingMessage(&message);
+    }
+    else if (CHECK_POINTER_VALID(buffer))
+    {
+        messagePool.release(buffer);
+    }
+
+    if ((status != STATUS_OKAY) && (status != STATUS_UNKNOWN))
+    {
+        ESP_LOGE(TAG, "Error: %i", status);
+    }
+
+    return status;
+}
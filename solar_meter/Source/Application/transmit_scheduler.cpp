@@ -0,0 +1,226 @@
+/**
+ *******************************************************************************
+ * @file    transmit_scheduler.cpp
+ * @author  hq
+ * @date    2025-08-05 20:34:51
+ * @brief   Transmit scheduler source file
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * INCLUDES
+ *******************************************************************************/
+#include "transmit_scheduler.hpp"
+
+extern "C"
+{
+    #include "freertos/task.h"
+    #include "esp_wifi.h"
+    #include "esp_log.h"
+}
+
+/*******************************************************************************
+ * EXTERN VARIABLES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * PRIVATE MACROS AND DEFINES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * PRIVATE TYPEDEFS
+ *******************************************************************************/
+
+/*******************************************************************************
+ * STATIC VARIABLES
+ *******************************************************************************/
+static const char *TAG = "TransmitScheduler";
+
+/*******************************************************************************
+ * GLOBAL VARIABLES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * STATIC FUNCTION PROTOTYPES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * STATIC FUNCTIONS
+ *******************************************************************************/
+
+/*!
+ * \brief moves the hour in progress to the last hour once it is complete,
+ * called with the critical section held
+ */
+void TransmitScheduler::rollHour(TickType_t now)
+{
+    TickType_t hourTicks = pdMS_TO_TICKS(TRANSMIT_MS_PER_HOUR);
+
+    if ((now - hourStartTick) >= hourTicks)
+    {
+        /*! - an hour without any burst reports zero   */
+        stats.radioOnMsLastHour = ((now - hourStartTick) >= (2u * hourTicks)) ? 0u : stats.radioOnMsThisHour;
+        stats.radioOnMsThisHour = 0u;
+        hourStartTick += ((now - hourStartTick) / hourTicks) * hourTicks;
+    }
+}
+
+/*******************************************************************************
+ * GLOBAL FUNCTIONS
+ *******************************************************************************/
+TransmitScheduler::TransmitScheduler() : anchored(false),
+                                         anchorTick(0u),
+                                         wakeIntervalTicks(1u),
+                                         burstWindow(0u),
+                                         burstStartTick(0u),
+                                         hourStartTick(0u)
+{
+    memset(&config, 0, sizeof(config));
+    memset(&stats, 0, sizeof(stats));
+}
+
+Status_t TransmitScheduler::init(const TransmitSchedulerConfig_t * _config)
+{
+    Status_t status = STATUS_OKAY;
+    wifi_ps_type_t powerSave = WIFI_PS_MIN_MODEM;
+    wifi_config_t wifiConfig;
+    uint32_t wakeIntervalMs = 0u;
+
+    if (CHECK_POINTER_VALID(_config) == false)
+    {
+        status = STATUS_NULL_POINTER;
+    }
+    else if (    (_config->reportIntervalMs == 0u)
+              || (_config->beaconIntervalMs == 0u)
+              || (_config->dtimPeriod == 0u)
+              || (_config->listenInterval == 0u))
+    {
+        status = STATUS_OUT_OF_BOUNDS;
+    }
+
+    if (status == STATUS_OKAY)
+    {
+        config = *_config;
+
+        /*! - long report intervals sleep through beacons, short ones keep
+              the DTIM cadence so downlink and acks are not delayed   */
+        if (config.reportIntervalMs >= config.maxModemThresholdMs)
+        {
+            stats.mode = TRANSMIT_POWER_MAX_MODEM;
+            powerSave = WIFI_PS_MAX_MODEM;
+            wakeIntervalMs = (uint32_t)config.beaconIntervalMs * config.listenInterval;
+        }
+        else
+        {
+            stats.mode = TRANSMIT_POWER_MIN_MODEM;
+            powerSave = WIFI_PS_MIN_MODEM;
+            wakeIntervalMs = (uint32_t)config.beaconIntervalMs * config.dtimPeriod;
+        }
+
+        stats.wakeIntervalMs = wakeIntervalMs;
+        wakeIntervalTicks = (pdMS_TO_TICKS(wakeIntervalMs) > 0u) ? pdMS_TO_TICKS(wakeIntervalMs) : 1u;
+        anchored = false;
+        hourStartTick = xTaskGetTickCount();
+    }
+
+    if (    (status == STATUS_OKAY)
+         && (stats.mode == TRANSMIT_POWER_MAX_MODEM)
+         && (esp_wifi_get_config(ESP_IF_WIFI_STA, &wifiConfig) == ESP_OK))
+    {
+        wifiConfig.sta.listen_interval = config.listenInterval;
+
+        if (esp_wifi_set_config(ESP_IF_WIFI_STA, &wifiConfig) != ESP_OK)
+        {
+            status = STATUS_HAL_ERROR;
+        }
+    }
+
+    if ((status == STATUS_OKAY) && (esp_wifi_set_ps(powerSave) != ESP_OK))
+    {
+        status = STATUS_HAL_ERROR;
+    }
+
+    if (status == STATUS_OKAY)
+    {
+        ESP_LOGI(TAG, "%s, window %u ms",
+                 (stats.mode == TRANSMIT_POWER_MAX_MODEM) ? "max modem" : "min modem", wakeIntervalMs);
+    }
+    else
+    {
+        ESP_LOGE(TAG, "Error: %i", status);
+    }
+
+    return status;
+}
+
+TickType_t TransmitScheduler::getWindowDelay(TickType_t now)
+{
+    TickType_t delay = 0u;
+
+    if (anchored)
+    {
+        TickType_t phase = (now - anchorTick) % wakeIntervalTicks;
+        uint32_t window = (now - anchorTick) / wakeIntervalTicks;
+
+        /*! - one burst per window, a second one waits for the next */
+        if ((phase > pdMS_TO_TICKS(TRANSMIT_WINDOW_TOLERANCE_MS)) || (window == burstWindow))
+        {
+            delay = wakeIntervalTicks - phase;
+        }
+    }
+
+    return delay;
+}
+
+void TransmitScheduler::burstStarted(TickType_t now)
+{
+    burstStartTick = now;
+
+    if (anchored == false)
+    {
+        /*! - the driver does not expose the beacon timing, the grid keeps
+              the spacing of the wake interval from the first burst   */
+        anchorTick = now;
+        anchored = true;
+    }
+
+    burstWindow = (now - anchorTick) / wakeIntervalTicks;
+}
+
+void TransmitScheduler::burstEnded(TickType_t now, bool transmitted, bool early)
+{
+    if (transmitted)
+    {
+        uint32_t onMs = ((now - burstStartTick) * portTICK_PERIOD_MS) + config.radioTailMs;
+
+        taskENTER_CRITICAL();
+        rollHour(now);
+        stats.bursts++;
+        if (early)
+        {
+            stats.earlyBursts++;
+        }
+        stats.radioOnMsThisHour += onMs;
+        stats.radioOnMsTotal += onMs;
+        taskEXIT_CRITICAL();
+    }
+}
+
+Status_t TransmitScheduler::getStats(TransmitSchedulerStats_t * _stats)
+{
+    Status_t status = STATUS_OKAY;
+
+    if (CHECK_POINTER_VALID(_stats) == false)
+    {
+        status = STATUS_NULL_POINTER;
+    }
+    else
+    {
+        taskENTER_CRITICAL();
+        rollHour(xTaskGetTickCount());
+        *_stats = stats;
+        taskEXIT_CRITICAL();
+    }
+
+    return status;
+}
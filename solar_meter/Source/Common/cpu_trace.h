@@ -0,0 +1,85 @@
+/**
+ ********************************************************************************
+ * @file    cpu_trace.h
+ * @author  hq
+ * @date    2025-08-09 17:52:30
+ * @brief   FreeRTOS trace hooks feeding the per task cpu accounting in
+ *  cpu_load.cpp. The project Makefile force includes this header so the
+ *  kernel picks up the trace macros, it must stay free of other includes.
+ ********************************************************************************
+ */
+
+#ifndef CPU_TRACE_H
+#define CPU_TRACE_H
+
+#ifndef __ASSEMBLER__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/************************************
+ * INCLUDES
+ ************************************/
+#include <stdint.h>
+
+/************************************
+ * MACROS AND DEFINES
+ ************************************/
+
+/* expanded inside tasks.c, where pxCurrentTCB is the task switched in */
+#define traceTASK_SWITCHED_IN()             cpu_traceTaskSwitchedIn((void *)pxCurrentTCB)
+#define traceTASK_DELETE(pxTaskToDelete)    cpu_traceTaskDeleted((void *)(pxTaskToDelete))
+
+/************************************
+ * TYPEDEFS
+ ************************************/
+
+/************************************
+ * EXPORTED VARIABLES
+ ************************************/
+
+/************************************
+ * GLOBAL FUNCTION PROTOTYPES
+ ************************************/
+
+/** @brief  Charges the cycles since the last switch to the task
+ *  switched out and counts a switch for the task switched in.
+ *  Called by the kernel with interrupts disabled
+ *
+ *  @param task - tcb of the task switched in
+ *  @return void
+ */
+void cpu_traceTaskSwitchedIn(void * task);
+
+/** @brief  Releases the accounting slot of a deleted task, its
+ *  cycles move to the shared "other" slot
+ *
+ *  @param task - tcb of the task being deleted
+ *  @return void
+ */
+void cpu_traceTaskDeleted(void * task);
+
+/** @brief  Start of an instrumented isr
+ *
+ *  @param void
+ *  @return uint32_t - cycle count to pass to cpu_traceIsrExit()
+ */
+uint32_t cpu_traceIsrEnter(void);
+
+/** @brief  End of an instrumented isr, adds its cycles to the isr
+ *  time. The same cycles are also part of the interrupted task
+ *
+ *  @param enterCycles - value returned by cpu_traceIsrEnter()
+ *  @return void
+ */
+void cpu_traceIsrExit(uint32_t enterCycles);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __ASSEMBLER__
+
+#endif //CPU_TRACE_H
@@ -0,0 +1,69 @@
+/**
+ ********************************************************************************
+ * @file    crc.h
+ * @author  hq
+ * @date    2025-08-01 18:12:47
+ * @brief   CRC-16/CCITT-FALSE used to frame records kept in flash
+ ********************************************************************************
+ */
+
+#ifndef CRC_H
+#define CRC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/************************************
+ * INCLUDES
+ ************************************/
+#include "typedefs.h"
+
+/************************************
+ * MACROS AND DEFINES
+ ************************************/
+#define CRC16_INIT (0xFFFFu)
+
+/************************************
+ * TYPEDEFS
+ ************************************/
+
+/************************************
+ * EXPORTED VARIABLES
+ ************************************/
+
+/************************************
+ * GLOBAL FUNCTION PROTOTYPES
+ ************************************/
+
+/** @brief  Updates a CRC-16/CCITT-FALSE (poly 0x1021), a nibble at a
+ *  time from a 16 entry table so no large table sits in ram
+ *
+ *  @param crc - CRC16_INIT or the result of the previous block
+ *  @param data - bytes to add
+ *  @param length - number of bytes
+ *  @return uint16_t - updated crc
+ */
+static inline uint16_t crc_crc16(uint16_t crc, const uint8_t * data, uint32_t length)
+{
+    static const uint16_t nibbleTable[16] =
+    {
+        0x0000u, 0x1021u, 0x2042u, 0x3063u, 0x4084u, 0x50A5u, 0x60C6u, 0x70E7u,
+        0x8108u, 0x9129u, 0xA14Au, 0xB16Bu, 0xC18Cu, 0xD1ADu, 0xE1CEu, 0xF1EFu,
+    };
+
+    for (uint32_t i = 0u; i < length; i++)
+    {
+        crc = (uint16_t)((crc << 4) ^ nibbleTable[(crc >> 12) ^ (data[i] >> 4)]);
+        crc = (uint16_t)((crc << 4) ^ nibbleTable[(crc >> 12) ^ (data[i] & 0x0Fu)]);
+    }
+
+    return crc;
+}
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //CRC_H
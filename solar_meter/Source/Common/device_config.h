@@ -0,0 +1,82 @@
+/**
+ ********************************************************************************
+ * @file    device_config.h
+ * @author  hq
+ * @date    2025-08-14 20:27:39
+ * @brief   Field tunable parameters of the i2c, adc, networking and task
+ *  setup. The record is stored as is in nvs and read straight into place at
+ *  boot, see persistent_config.hpp. Fields are only ever appended, a record
+ *  of an older version is a prefix of the current one.
+ ********************************************************************************
+ */
+
+#ifndef DEVICE_CONFIG_H
+#define DEVICE_CONFIG_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/************************************
+ * INCLUDES
+ ************************************/
+#include "typedefs.h"
+
+/************************************
+ * MACROS AND DEFINES
+ ************************************/
+#define DEVICE_CONFIG_MAGIC         (0x47464344u)   /* "DCFG" */
+#define DEVICE_CONFIG_VERSION       (1u)
+
+/************************************
+ * TYPEDEFS
+ ************************************/
+typedef struct
+{
+    uint32_t magic;
+    uint16_t version;                   /**< layout the payload was written with     */
+    uint16_t length;                    /**< payload bytes after the header           */
+    uint16_t crc;                       /**< crc_crc16 of the payload                 */
+    uint16_t reserved;
+}device_config_header_t;
+
+typedef struct
+{
+    /* version 1 */
+    uint8_t i2cSclIo;                   /**< gpio of the i2c master clock             */
+    uint8_t i2cSdaIo;                   /**< gpio of the i2c master data              */
+    uint16_t i2cClkStretchTicks;        /**< driver clock stretch limit               */
+    uint16_t i2cQueueLength;            /**< commands waiting for the i2c task        */
+    uint16_t i2cQueueTimeoutMs;         /**< i2c task idle wait before it logs        */
+    uint16_t i2cCommandTimeoutMs;       /**< bus time allowed to one command          */
+    uint16_t adsQueueTimeoutMs;         /**< wait for space in the i2c queue          */
+    uint16_t adsNotifyTimeoutMs;        /**< wait for the i2c task to run a command   */
+    uint16_t networkingQueueLength;     /**< messages waiting for the networking task */
+    uint8_t i2cTaskPriority;
+    uint8_t dispatcherPriority;
+    uint8_t networkingPriority;
+    uint8_t reserved;
+}device_config_t;
+
+/************************************
+ * EXPORTED VARIABLES
+ ************************************/
+
+/************************************
+ * GLOBAL FUNCTION PROTOTYPES
+ ************************************/
+
+/** @brief  Returns the configuration the firmware runs with, the defaults
+ *  until the stored record is loaded
+ *
+ *  @param void
+ *  @return const device_config_t * - never NULL
+ */
+const device_config_t * deviceConfig_get(void);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //DEVICE_CONFIG_H
@@ -0,0 +1,90 @@
+/**
+ ********************************************************************************
+ * @file    timing.h
+ * @author  hq
+ * @date    2025-07-21 19:02:11
+ * @brief   cycle counter and microsecond time helpers used for profiling
+ ********************************************************************************
+ */
+
+#ifndef TIMING_H
+#define TIMING_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/************************************
+ * INCLUDES
+ ************************************/
+#include "typedefs.h"
+#include "sdkconfig.h"
+#include "esp_timer.h"
+
+#ifndef __XTENSA__
+#include <time.h>
+#endif
+
+/************************************
+ * MACROS AND DEFINES
+ ************************************/
+#ifdef CONFIG_ESP8266_DEFAULT_CPU_FREQ_MHZ
+#define TIMING_CPU_FREQ_MHZ (CONFIG_ESP8266_DEFAULT_CPU_FREQ_MHZ)
+#else
+#define TIMING_CPU_FREQ_MHZ (80u)
+#endif
+
+/************************************
+ * TYPEDEFS
+ ************************************/
+
+/************************************
+ * EXPORTED VARIABLES
+ ************************************/
+
+/************************************
+ * GLOBAL FUNCTION PROTOTYPES
+ ************************************/
+
+/** @brief  Returns the xtensa CCOUNT register, increments once
+ *  per cpu clock and wraps every ~53 s at 80 MHz. Always inlined, so
+ *  IRAM isr code can call it with the flash cache disabled
+ *
+ *  @param void
+ *  @return uint32_t - current cycle count
+ */
+#ifdef __XTENSA__
+static inline __attribute__((always_inline)) uint32_t timing_getCycleCount(void)
+{
+    uint32_t ccount;
+    __asm__ __volatile__("rsr %0, ccount" : "=a"(ccount));
+    return ccount;
+}
+#else
+/*  host builds (Test/) count nanoseconds scaled to the target clock, so
+    cycle figures measured there are host time, not target cycles */
+static inline uint32_t timing_getCycleCount(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint32_t)((((uint64_t)now.tv_sec * 1000000000u) + (uint64_t)now.tv_nsec)
+                      * TIMING_CPU_FREQ_MHZ / 1000u);
+}
+#endif
+
+/** @brief  Returns the time since boot in microseconds
+ *
+ *  @param void
+ *  @return uint32_t - time in microseconds, wraps every ~71 minutes
+ */
+static inline uint32_t timing_getTimeUs(void)
+{
+    return (uint32_t)esp_timer_get_time();
+}
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //TIMING_H
@@ -42,6 +42,7 @@ typedef enum
     STATUS_ISR_ERROR,
     STATUS_HAL_ERROR,
     STATUS_MEMCMP_FAIL,
+    STATUS_POOL_EXHAUSTED,
     
     TOTAL_STATUS_TYPES
 }Status_t;
@@ -13,6 +13,7 @@
 extern "C" 
 {
     #include "esp_log.h"
+    #include "device_config.h"
 }
 
 #include "ads1115.hpp"
@@ -68,6 +69,7 @@ static const char *TAG = "ads1115";
 Status_t ADS1115::queueWait_ads1115I2cObject( i2c_handler_t ** i2cObjPtr)
 {
     Status_t errRet = STATUS_UNKNOWN;
+    const device_config_t * config = deviceConfig_get();
 
     /*! - check i2c Queue Handle and i2c object pointer are not null*/
     if( NULL == i2cQueueHdl && NULL != i2cObjPtr)
@@ -76,14 +78,14 @@ Status_t ADS1115::queueWait_ads1115I2cObject( i2c_handler_t ** i2cObjPtr)
     }
 
     /*! - send i2c object pointer to queue  */
-    if(STATUS_OKAY == errRet && pdTRUE != xQueueSendToBack( i2cQueueHdl, ( void *) i2cObjPtr , ( TickType_t ) 10 ))// TODO: replace literals with macro or const
+    if(STATUS_OKAY == errRet && pdTRUE != xQueueSendToBack( i2cQueueHdl, ( void *) i2cObjPtr , pdMS_TO_TICKS(config->adsQueueTimeoutMs)))
     {
-        /*! - if message fails to queue after 10 ticks, return queue fail */
+        /*! - if message fails to queue within the timeout, return queue fail */
         errRet = STATUS_QUEUE_FAIL;
     }
 
     /*! - Wait for i2c task to notify of completion    */
-    if(STATUS_OKAY == errRet && 0u == ulTaskNotifyTake(pdFALSE, ( TickType_t ) 1000)) // TODO: replace literals with macro or const
+    if(STATUS_OKAY == errRet && 0u == ulTaskNotifyTake(pdFALSE, pdMS_TO_TICKS(config->adsNotifyTimeoutMs)))
     {
         /* - if i2c task fails to notify within timeout return notify timeout fail*/
         errRet = STATUS_NOTIFY_TIMEOUT;
@@ -208,7 +210,7 @@ Status_t ADS1115::write_ads1115ConfigRegisters(ads1115ConfigRegister_t * configP
     i2c_master_stop(cmd);
 
     /*! - send to i2c handler */
-    if(ESP_OK == i2c_master_cmd_begin(I2C_NUM_0, cmd, 1000 / portTICK_RATE_MS))
+    if(ESP_OK == i2c_master_cmd_begin(I2C_NUM_0, cmd, pdMS_TO_TICKS(deviceConfig_get()->i2cCommandTimeoutMs)))
     {
         errRet = STATUS_OKAY;
     }
@@ -249,15 +251,23 @@ ADS1115::ADS1115()
     }
 }
 
-ADS1115::~ADS1115()
+ADS1115::ADS1115(const ads1115ConfigRegister_t & bootConfig)
 {
-    // Destructor implementation
+    Status_t errRet = STATUS_OKAY;
+
+    /*! - cache the configuration, the device is trusted to take it */
+    ads1115CfgObj.configReg = bootConfig;
+    errRet = write_ads1115ConfigRegisters(&ads1115CfgObj.configReg);
+
+    if(STATUS_OKAY != errRet)
+    {
+        ESP_LOGI(TAG, "Config Reg Write Fail: %i", errRet);   
+    }
 }
 
-void ADS1115::init_ads1115(void)
+ADS1115::~ADS1115()
 {
-    // static ADS1115 ads1115_instance;
-    // Optionally, add further initialization or configuration here if needed
+    // Destructor implementation
 }
 
 void ADS1115::init_ads1115(void)
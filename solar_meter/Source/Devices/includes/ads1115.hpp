@@ -41,6 +41,11 @@
 #define ADS1115_LO_THRESH_REGISTER_SIZE                 (2u)
 #define ADS1115_HI_THRESH_REGISTER_SIZE                 (2u)
 
+/* config register field values */
+#define ADS1115_MODE_CONTINUOUS                         (0u)
+#define ADS1115_MODE_SINGLE_SHOT                        (1u)
+#define ADS1115_COMP_QUEUE_DISABLE                      (3u)
+
 /*******************************************************************************
  * CLASSES & TYPEDEFS
 *******************************************************************************/
@@ -64,6 +69,18 @@ typedef enum
     ADS1115_MUX_AIN3_GND  = 0b111  // AINP = AIN3 and AINN = GND
 } ads1115Mux_t;
 
+typedef enum
+{
+    ADS1115_DATA_RATE_8_SPS   = 0b000, // 8 samples per second
+    ADS1115_DATA_RATE_16_SPS  = 0b001, // 16 samples per second
+    ADS1115_DATA_RATE_32_SPS  = 0b010, // 32 samples per second
+    ADS1115_DATA_RATE_64_SPS  = 0b011, // 64 samples per second
+    ADS1115_DATA_RATE_128_SPS = 0b100, // 128 samples per second (default)
+    ADS1115_DATA_RATE_250_SPS = 0b101, // 250 samples per second
+    ADS1115_DATA_RATE_475_SPS = 0b110, // 475 samples per second
+    ADS1115_DATA_RATE_860_SPS = 0b111  // 860 samples per second
+} ads1115DataRate_t;
+
 
 typedef union
 {
@@ -107,6 +124,17 @@ public:
      */
     ADS1115();
 
+    /**
+     * @brief Constructor for the fast boot path.
+     * 
+     * Writes a precomputed configuration instead of reading the registers,
+     * there is no read back compare either. Saves the i2c round trips in
+     * front of the first conversion.
+     * 
+     * @param bootConfig - configuration written to the device
+     */
+    explicit ADS1115(const ads1115ConfigRegister_t & bootConfig);
+
     /**
      * @brief Destructor for the ADS1115 class.
      * 
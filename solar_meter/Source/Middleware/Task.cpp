@@ -14,6 +14,9 @@ extern "C"
 
 const char *TAG = "Task";
 
+TaskStackInfo_t Task::registry[TASK_REGISTRY_SIZE];
+uint8_t Task::registryCount = 0u;
+
 
 Task::Task(const char *name, uint32_t _stackSize, UBaseType_t prio) :
     taskName(name), stackSize(_stackSize) 
@@ -21,6 +24,8 @@ Task::Task(const char *name, uint32_t _stackSize, UBaseType_t prio) :
     priority = prio;
     taskHandle = nullptr;
     suspended = false;
+    staticStack = nullptr;
+    staticTcb = nullptr;
 }
 
 Task::~Task() 
@@ -38,6 +43,8 @@ Task::~Task()
     {
         eTaskState tstate = eTaskGetState (taskHandle);
 
+        removeFromRegistry(taskHandle);
+
         if (tstate != eDeleted) 
         {
             vTaskDelete (taskHandle);
@@ -75,7 +82,21 @@ Status_t Task::initTask(void)
 
     if( (ret == STATUS_OKAY) )
     {
-        if(!xPortInIsrContext())
+        if(xPortInIsrContext())
+        {
+            ret = STATUS_ISR_ERROR;
+        }
+        else if (CHECK_POINTER_VALID(staticStack) && CHECK_POINTER_VALID(staticTcb))
+        {
+            /* stack and TCB are owned by the object, creation can not run out of heap */
+            taskHandle = xTaskCreateStatic ((TaskFunction_t)taskFunction, taskName, stackSize, (void *)this, priority, staticStack, staticTcb);
+
+            if (CHECK_POINTER_VALID(taskHandle) == false)
+            {
+                ret = STATUS_OS_ERROR;
+            }
+        }
+        else
         {
             if (xTaskCreate ((TaskFunction_t)taskFunction, taskName, (uint16_t)stackSize, (void *)this, priority, &taskHandle) != pdPASS) 
             {
@@ -83,16 +104,149 @@ Status_t Task::initTask(void)
                 ret = STATUS_OS_ERROR;
             }
         }
-        else
+    }
+
+    if (ret == STATUS_OKAY)
+    {
+        /* a full registry only costs the stack profile of this task  */
+        (void)addToRegistry(taskName, taskHandle, stackSize, CHECK_POINTER_VALID(staticStack));
+    }
+
+    return ret;
+}
+
+void Task::setStaticStorage(StackType_t *stack, StaticTask_t *tcb)
+{
+    staticStack = stack;
+    staticTcb = tcb;
+}
+
+Status_t Task::setPriority(UBaseType_t prio)
+{
+    Status_t ret = STATUS_OKAY;
+
+    if (prio >= configMAX_PRIORITIES)
+    {
+        ret = STATUS_OUT_OF_BOUNDS;
+    }
+    else
+    {
+        priority = prio;
+
+        if (CHECK_POINTER_VALID(taskHandle))
         {
-            ret = STATUS_ISR_ERROR;
+            vTaskPrioritySet(taskHandle, prio);
         }
-        
     }
 
     return ret;
 }
 
+Status_t Task::addToRegistry(const char *name, TaskHandle_t handle,
+                             uint32_t stackSize, bool staticStack)
+{
+    Status_t ret = STATUS_OKAY;
+
+    taskENTER_CRITICAL();
+    if (registryCount >= TASK_REGISTRY_SIZE)
+    {
+        ret = STATUS_OUT_OF_BOUNDS;
+    }
+    else
+    {
+        registry[registryCount].name = name;
+        registry[registryCount].handle = handle;
+        registry[registryCount].stackSize = stackSize;
+        registry[registryCount].highWaterMark = stackSize;
+        registry[registryCount].staticStack = staticStack;
+        registryCount++;
+    }
+    taskEXIT_CRITICAL();
+
+    if (ret != STATUS_OKAY)
+    {
+        ESP_LOGE(TAG, "Error: %i, %s not registered", ret, name);
+    }
+
+    return ret;
+}
+
+void Task::removeFromRegistry(TaskHandle_t handle)
+{
+    bool found = false;
+
+    taskENTER_CRITICAL();
+    for (uint8_t i = 0u; (i < registryCount) && (found == false); i++)
+    {
+        if (registry[i].handle == handle)
+        {
+            /* order does not matter, the last entry fills the gap */
+            registry[i] = registry[registryCount - 1u];
+            registryCount--;
+            found = true;
+        }
+    }
+    taskEXIT_CRITICAL();
+}
+
+Status_t Task::registerTask(const char *name, TaskHandle_t handle,
+                            uint32_t stackSize)
+{
+    Status_t ret = STATUS_OKAY;
+
+    if (CHECK_POINTER_VALID(handle) == false)
+    {
+        ret = STATUS_NULL_POINTER;
+    }
+    else
+    {
+        ret = addToRegistry(name, handle, stackSize, false);
+    }
+
+    return ret;
+}
+
+uint8_t Task::sampleStackUsage(TaskStackInfo_t *info, uint8_t capacity)
+{
+    uint8_t count = 0u;
+    bool valid = CHECK_POINTER_VALID(info);
+
+    while (valid && (count < capacity))
+    {
+        TaskStackInfo_t entry;
+
+        /* copy out under the lock, sample outside of it */
+        taskENTER_CRITICAL();
+        valid = (count < registryCount);
+        if (valid)
+        {
+            entry = registry[count];
+        }
+        taskEXIT_CRITICAL();
+
+        if (valid)
+        {
+            entry.highWaterMark = uxTaskGetStackHighWaterMark(entry.handle);
+            info[count++] = entry;
+        }
+    }
+
+    return count;
+}
+
+void Task::logStackUsage(void)
+{
+    TaskStackInfo_t info[TASK_REGISTRY_SIZE];
+    uint8_t count = sampleStackUsage(info, TASK_REGISTRY_SIZE);
+
+    for (uint8_t i = 0u; i < count; i++)
+    {
+        ESP_LOGI(TAG, "%-16s stack %5u used %5u free %5u%s", info[i].name,
+                 info[i].stackSize, info[i].stackSize - info[i].highWaterMark,
+                 info[i].highWaterMark, info[i].staticStack ? " static" : "");
+    }
+}
+
 void Task::runInCurrent() { taskRun(); }
 
 void Task::startTask(void *argument) { ((Task *)argument)->taskRun(); }
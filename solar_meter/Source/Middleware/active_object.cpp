@@ -0,0 +1,479 @@
+/**
+ *******************************************************************************
+ * @file    active_object.cpp
+ * @author  hq
+ * @date    2025-08-08 20:03:15
+ * @brief   Active object and event dispatcher source file
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * INCLUDES
+ *******************************************************************************/
+#include "active_object.hpp"
+#include "timing.h"
+
+#include <string.h>
+
+/*******************************************************************************
+ * EXTERN VARIABLES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * PRIVATE MACROS AND DEFINES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * PRIVATE TYPEDEFS
+ *******************************************************************************/
+typedef struct
+{
+    ActiveObject * target;
+    Event_t event;
+} DispatcherItem_t;
+
+/*******************************************************************************
+ * STATIC VARIABLES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * GLOBAL VARIABLES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * STATIC FUNCTION PROTOTYPES
+ *******************************************************************************/
+static bool isDue(TickType_t now, TickType_t deadline);
+
+/*******************************************************************************
+ * STATIC FUNCTIONS
+ *******************************************************************************/
+
+/*!
+ * \brief true once the tick count reached the deadline, correct across the
+ * tick counter wrap as long as the two are less than half the range apart
+ */
+static bool isDue(TickType_t now, TickType_t deadline)
+{
+    return ((int32_t)(now - deadline) >= 0);
+}
+
+Status_t EventDispatcher::enqueue(ActiveObject * target, const Event_t * event)
+{
+    Status_t status = STATUS_OKAY;
+    DispatcherItem_t item;
+
+    item.target = target;
+    item.event = *event;
+
+    if (CHECK_POINTER_VALID(eventQueue) == false)
+    {
+        status = STATUS_NULL_POINTER;
+    }
+    /*! - never block, a handler posting to its own dispatcher would wait on itself */
+    else if (xQueueSendToBack(eventQueue, &item, 0) != pdTRUE)
+    {
+        status = STATUS_QUEUE_FULL;
+    }
+
+    taskENTER_CRITICAL();
+    if (status == STATUS_QUEUE_FULL)
+    {
+        stats.postFailures++;
+    }
+    else if (status == STATUS_OKAY)
+    {
+        uint16_t depth = EVENT_DISPATCHER_QUEUE_LENGTH - uxQueueSpacesAvailable(eventQueue);
+        if (depth > stats.queueHighWater)
+        {
+            stats.queueHighWater = depth;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    return status;
+}
+
+Status_t EventDispatcher::enqueueFromIsr(ActiveObject * target, const Event_t * event,
+                                         BaseType_t * higherPriorityTaskWoken)
+{
+    Status_t status = STATUS_OKAY;
+    DispatcherItem_t item;
+
+    item.target = target;
+    item.event = *event;
+
+    if (CHECK_POINTER_VALID(eventQueue) == false)
+    {
+        status = STATUS_NULL_POINTER;
+    }
+    else if (xQueueSendToBackFromISR(eventQueue, &item, higherPriorityTaskWoken) != pdTRUE)
+    {
+        /*  no task runs while the isr does, the counter needs no lock   */
+        stats.postFailures++;
+        status = STATUS_QUEUE_FULL;
+    }
+
+    return status;
+}
+
+/*!
+ * \brief applies the timer settings of an object, the first timeout is the
+ * next grid tick after now
+ */
+void EventDispatcher::rearmTimer(ActiveObject * object)
+{
+    uint32_t periodMs;
+    uint32_t phaseMs;
+
+    taskENTER_CRITICAL();
+    periodMs = object->timerPeriodMs;
+    phaseMs = object->timerPhaseMs;
+    taskEXIT_CRITICAL();
+
+    object->timerPeriodTicks = pdMS_TO_TICKS(periodMs);
+
+    if (object->timerPeriodTicks > 0u)
+    {
+        TickType_t now = xTaskGetTickCount();
+        TickType_t periodTicks = object->timerPeriodTicks;
+        TickType_t phaseTicks = pdMS_TO_TICKS(phaseMs) % periodTicks;
+
+        object->timerDeadline = now - ((now + periodTicks - phaseTicks) % periodTicks) + periodTicks;
+    }
+}
+
+/*!
+ * \brief dispatches every time event that is due and returns the ticks to
+ * wait for the next one, portMAX_DELAY if no timer is armed
+ */
+TickType_t EventDispatcher::serviceTimers(void)
+{
+    TickType_t wait = portMAX_DELAY;
+    Event_t timeout;
+
+    timeout.signal = EVENT_SIGNAL_TIMEOUT;
+    timeout.param = 0u;
+    timeout.postedUs = 0u;
+
+    for (ActiveObject * object = objects; object != nullptr; object = object->next)
+    {
+        if ((object->timerPeriodTicks > 0u) && isDue(xTaskGetTickCount(), object->timerDeadline))
+        {
+            dispatchEvent(object, timeout, true);
+            object->timerDeadline += object->timerPeriodTicks;
+
+            /*! - a handler that ran past further deadlines skips them
+                  instead of being called back to back to catch up  */
+            TickType_t now = xTaskGetTickCount();
+            if (isDue(now, object->timerDeadline))
+            {
+                uint32_t missed = ((now - object->timerDeadline) / object->timerPeriodTicks) + 1u;
+
+                object->timerDeadline += missed * object->timerPeriodTicks;
+                taskENTER_CRITICAL();
+                stats.missedTimeouts += missed;
+                taskEXIT_CRITICAL();
+            }
+        }
+    }
+
+    /*! - handlers may have taken time, measure the wait from a fresh tick */
+    TickType_t now = xTaskGetTickCount();
+    for (ActiveObject * object = objects; object != nullptr; object = object->next)
+    {
+        if (object->timerPeriodTicks > 0u)
+        {
+            TickType_t remaining = isDue(now, object->timerDeadline) ? 0u : (object->timerDeadline - now);
+
+            if (remaining < wait)
+            {
+                wait = remaining;
+            }
+        }
+    }
+
+    return wait;
+}
+
+void EventDispatcher::dispatchEvent(ActiveObject * target, const Event_t & event, bool timeout)
+{
+    uint32_t startUs = timing_getTimeUs();
+
+    target->dispatch(event);
+
+    uint32_t dispatchUs = timing_getTimeUs() - startUs;
+
+    taskENTER_CRITICAL();
+    if (timeout)
+    {
+        stats.timeouts++;
+    }
+    else
+    {
+        uint32_t latencyUs = startUs - event.postedUs;
+
+        stats.events++;
+        latencySumUs += latencyUs;
+        if (latencyUs > stats.maxLatencyUs)
+        {
+            stats.maxLatencyUs = latencyUs;
+        }
+    }
+    dispatchSumUs += dispatchUs;
+    if (dispatchUs > stats.maxDispatchUs)
+    {
+        stats.maxDispatchUs = dispatchUs;
+    }
+    taskEXIT_CRITICAL();
+}
+
+void EventDispatcher::taskRun()
+{
+    DispatcherItem_t item;
+
+    /*! - timers armed before the start are applied here */
+    for (ActiveObject * object = objects; object != nullptr; object = object->next)
+    {
+        rearmTimer(object);
+    }
+
+    while (FOREVER())
+    {
+        TickType_t wait = serviceTimers();
+
+        if (xQueueReceive(eventQueue, &item, wait) == pdTRUE)
+        {
+            if (item.event.signal == EVENT_SIGNAL_REARM)
+            {
+                rearmTimer(item.target);
+            }
+            else
+            {
+                dispatchEvent(item.target, item.event, false);
+            }
+        }
+    }
+}
+
+/*******************************************************************************
+ * GLOBAL FUNCTIONS
+ *******************************************************************************/
+ActiveObject::ActiveObject(const char * _name) : name(_name),
+                                                 dispatcher(nullptr),
+                                                 next(nullptr),
+                                                 timerPeriodMs(0u),
+                                                 timerPhaseMs(0u),
+                                                 timerPeriodTicks(0u),
+                                                 timerDeadline(0u)
+{
+}
+
+Status_t ActiveObject::post(uint16_t signal, uint32_t param)
+{
+    Status_t status = STATUS_OKAY;
+    Event_t event;
+
+    event.signal = signal;
+    event.param = param;
+    event.postedUs = timing_getTimeUs();
+
+    if (CHECK_POINTER_VALID(dispatcher) == false)
+    {
+        status = STATUS_NULL_POINTER;
+    }
+    else if (signal < EVENT_SIGNAL_USER)
+    {
+        status = STATUS_OUT_OF_BOUNDS;
+    }
+    else
+    {
+        status = dispatcher->enqueue(this, &event);
+    }
+
+    return status;
+}
+
+Status_t ActiveObject::postFromIsr(uint16_t signal, uint32_t param, BaseType_t * higherPriorityTaskWoken)
+{
+    Status_t status = STATUS_OKAY;
+    Event_t event;
+
+    event.signal = signal;
+    event.param = param;
+    event.postedUs = timing_getTimeUs();
+
+    if (    (CHECK_POINTER_VALID(dispatcher) == false)
+         || (CHECK_POINTER_VALID(higherPriorityTaskWoken) == false))
+    {
+        status = STATUS_NULL_POINTER;
+    }
+    else if (signal < EVENT_SIGNAL_USER)
+    {
+        status = STATUS_OUT_OF_BOUNDS;
+    }
+    else
+    {
+        status = dispatcher->enqueueFromIsr(this, &event, higherPriorityTaskWoken);
+    }
+
+    return status;
+}
+
+Status_t ActiveObject::armTimer(uint32_t periodMs, uint32_t phaseMs)
+{
+    Status_t status = STATUS_OKAY;
+
+    if (CHECK_POINTER_VALID(dispatcher) == false)
+    {
+        status = STATUS_NULL_POINTER;
+    }
+    else if (pdMS_TO_TICKS(periodMs) == 0u)
+    {
+        status = STATUS_OUT_OF_BOUNDS;
+    }
+    else
+    {
+        taskENTER_CRITICAL();
+        timerPeriodMs = periodMs;
+        timerPhaseMs = phaseMs;
+        taskEXIT_CRITICAL();
+
+        /*! - before init() the dispatcher applies the settings at its start */
+        if (CHECK_POINTER_VALID(dispatcher->eventQueue))
+        {
+            Event_t event;
+
+            event.signal = EVENT_SIGNAL_REARM;
+            event.param = 0u;
+            event.postedUs = timing_getTimeUs();
+            status = dispatcher->enqueue(this, &event);
+        }
+    }
+
+    return status;
+}
+
+Status_t ActiveObject::disarmTimer(void)
+{
+    Status_t status = STATUS_OKAY;
+
+    if (CHECK_POINTER_VALID(dispatcher) == false)
+    {
+        status = STATUS_NULL_POINTER;
+    }
+    else
+    {
+        timerPeriodMs = 0u;
+
+        if (CHECK_POINTER_VALID(dispatcher->eventQueue))
+        {
+            Event_t event;
+
+            event.signal = EVENT_SIGNAL_REARM;
+            event.param = 0u;
+            event.postedUs = timing_getTimeUs();
+            status = dispatcher->enqueue(this, &event);
+        }
+    }
+
+    return status;
+}
+
+EventDispatcher::EventDispatcher(const char * name, uint32_t stackSize,
+                                 UBaseType_t prio) : Task(name, stackSize, prio),
+                                                     eventQueue(nullptr),
+                                                     objects(nullptr),
+                                                     latencySumUs(0u),
+                                                     dispatchSumUs(0u)
+{
+    memset(&stats, 0, sizeof(stats));
+}
+
+EventDispatcher::~EventDispatcher()
+{
+    if (CHECK_POINTER_VALID(eventQueue))
+    {
+        vQueueDelete(eventQueue);
+    }
+}
+
+Status_t EventDispatcher::attach(ActiveObject & object)
+{
+    Status_t status = STATUS_OKAY;
+
+    /*! - the object list is walked by the task without a lock, so it is
+          only changed before the start  */
+    if (CHECK_POINTER_VALID(eventQueue) || CHECK_POINTER_VALID(object.dispatcher))
+    {
+        status = STATUS_REINIT_ERROR;
+    }
+    else
+    {
+        object.dispatcher = this;
+        object.next = objects;
+        objects = &object;
+        stats.objects++;
+    }
+
+    return status;
+}
+
+Status_t EventDispatcher::init(void)
+{
+    Status_t status = STATUS_OKAY;
+
+    if (CHECK_POINTER_VALID(eventQueue))
+    {
+        status = STATUS_REINIT_ERROR;
+    }
+
+    if (status == STATUS_OKAY)
+    {
+        eventQueue = xQueueCreate(EVENT_DISPATCHER_QUEUE_LENGTH, sizeof(DispatcherItem_t));
+
+        if (CHECK_POINTER_VALID(eventQueue) == false)
+        {
+            status = STATUS_OS_ERROR;
+        }
+    }
+
+    if (status == STATUS_OKAY)
+    {
+        status = initTask();
+    }
+
+    return status;
+}
+
+Status_t EventDispatcher::getStats(EventDispatcherStats_t * _stats)
+{
+    Status_t status = STATUS_OKAY;
+
+    if (CHECK_POINTER_VALID(_stats) == false)
+    {
+        status = STATUS_NULL_POINTER;
+    }
+    else
+    {
+        uint64_t latencySum;
+        uint64_t dispatchSum;
+
+        taskENTER_CRITICAL();
+        *_stats = stats;
+        latencySum = latencySumUs;
+        dispatchSum = dispatchSumUs;
+        taskEXIT_CRITICAL();
+
+        if (_stats->events > 0u)
+        {
+            _stats->meanLatencyUs = (uint32_t)(latencySum / _stats->events);
+        }
+        if ((_stats->events + _stats->timeouts) > 0u)
+        {
+            _stats->meanDispatchUs = (uint32_t)(dispatchSum / (_stats->events + _stats->timeouts));
+        }
+    }
+
+    return status;
+}
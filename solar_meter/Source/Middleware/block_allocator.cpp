@@ -0,0 +1,368 @@
+/**
+ *******************************************************************************
+ * @file    block_allocator.cpp
+ * @author  hq
+ * @date    2025-08-11 18:36:05
+ * @brief   Block allocator source file
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * INCLUDES
+ *******************************************************************************/
+#include "block_allocator.hpp"
+
+#include <new>
+#include <stdlib.h>
+#include <string.h>
+
+extern "C"
+{
+    #include "freertos/FreeRTOS.h"
+    #include "freertos/task.h"
+    #include "esp_system.h"
+    #include "esp_log.h"
+}
+
+/*******************************************************************************
+ * EXTERN VARIABLES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * PRIVATE MACROS AND DEFINES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * PRIVATE TYPEDEFS
+ *******************************************************************************/
+typedef struct
+{
+    uint8_t * storage;
+    uint16_t blockSize;
+    uint16_t blockCount;
+} BlockLayout_t;
+
+/*******************************************************************************
+ * STATIC VARIABLES
+ *******************************************************************************/
+static const char *TAG = "BlockAllocator";
+
+/*  one storage array per class, aligned for any scalar a C++ object holds */
+#define BLOCK_ALLOCATOR_STORAGE(name, size, count)  alignas(8) static uint8_t name##_storage[(size) * (count)];
+BLOCK_ALLOCATOR_CLASSES(BLOCK_ALLOCATOR_STORAGE)
+#undef BLOCK_ALLOCATOR_STORAGE
+
+/*  constant initialized, valid before any static constructor runs */
+#define BLOCK_ALLOCATOR_LAYOUT(name, size, count)   { name##_storage, size, count },
+static const BlockLayout_t layout[TOTAL_BLOCK_CLASSES] =
+{
+    BLOCK_ALLOCATOR_CLASSES(BLOCK_ALLOCATOR_LAYOUT)
+};
+#undef BLOCK_ALLOCATOR_LAYOUT
+
+/*******************************************************************************
+ * GLOBAL VARIABLES
+ *******************************************************************************/
+BlockAllocator blockAllocator;
+
+/*******************************************************************************
+ * STATIC FUNCTION PROTOTYPES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * STATIC FUNCTIONS
+ *******************************************************************************/
+
+/*!
+ * \brief threads every block onto the free list of its class, called with
+ * the critical section held
+ */
+void BlockAllocator::init(void)
+{
+    for (uint8_t sizeClass = 0u; sizeClass < TOTAL_BLOCK_CLASSES; sizeClass++)
+    {
+        const BlockLayout_t * classLayout = &layout[sizeClass];
+
+        freeList[sizeClass] = nullptr;
+        for (uint16_t i = 0u; i < classLayout->blockCount; i++)
+        {
+            void * block = &classLayout->storage[i * classLayout->blockSize];
+
+            *(void **)block = freeList[sizeClass];
+            freeList[sizeClass] = block;
+        }
+
+        memset(&stats[sizeClass], 0, sizeof(BlockClassStats_t));
+        stats[sizeClass].blockSize = classLayout->blockSize;
+        stats[sizeClass].blockCount = classLayout->blockCount;
+    }
+
+    heapFallbacks = 0u;
+    heapFrees = 0u;
+    heapFailures = 0u;
+    initialized = true;
+}
+
+uint8_t * BlockAllocator::classStorage(uint8_t sizeClass)
+{
+    return layout[sizeClass].storage;
+}
+
+/*******************************************************************************
+ * GLOBAL FUNCTIONS
+ *******************************************************************************/
+void * BlockAllocator::allocate(size_t size)
+{
+    void * block = nullptr;
+    bool fits = false;
+
+    taskENTER_CRITICAL();
+
+    if (initialized == false)
+    {
+        init();
+    }
+
+    for (uint8_t sizeClass = 0u; (sizeClass < TOTAL_BLOCK_CLASSES) && (block == nullptr); sizeClass++)
+    {
+        if (size <= stats[sizeClass].blockSize)
+        {
+            /*! - count the miss against the best fit class only   */
+            if ((freeList[sizeClass] == nullptr) && (fits == false))
+            {
+                stats[sizeClass].failures++;
+            }
+
+            fits = true;
+            block = freeList[sizeClass];
+
+            if (block != nullptr)
+            {
+                freeList[sizeClass] = *(void **)block;
+
+                stats[sizeClass].allocations++;
+                stats[sizeClass].inUse++;
+                if (stats[sizeClass].inUse > stats[sizeClass].peakInUse)
+                {
+                    stats[sizeClass].peakInUse = stats[sizeClass].inUse;
+                }
+            }
+        }
+    }
+
+    taskEXIT_CRITICAL();
+
+    /*! - oversized requests and an exhausted pool go to the heap */
+    if (block == nullptr)
+    {
+        block = malloc(size);
+
+        taskENTER_CRITICAL();
+        if (block != nullptr)
+        {
+            heapFallbacks++;
+        }
+        else
+        {
+            heapFailures++;
+        }
+        taskEXIT_CRITICAL();
+    }
+
+    return block;
+}
+
+void BlockAllocator::deallocate(void * ptr)
+{
+    bool pooled = false;
+
+    if (ptr != nullptr)
+    {
+        taskENTER_CRITICAL();
+
+        for (uint8_t sizeClass = 0u; (sizeClass < TOTAL_BLOCK_CLASSES) && (pooled == false); sizeClass++)
+        {
+            uintptr_t offset = (uintptr_t)ptr - (uintptr_t)classStorage(sizeClass);
+
+            if (offset < ((uintptr_t)layout[sizeClass].blockSize * layout[sizeClass].blockCount))
+            {
+                *(void **)ptr = freeList[sizeClass];
+                freeList[sizeClass] = ptr;
+                stats[sizeClass].inUse--;
+                pooled = true;
+            }
+        }
+
+        if (pooled == false)
+        {
+            heapFrees++;
+        }
+
+        taskEXIT_CRITICAL();
+
+        if (pooled == false)
+        {
+            free(ptr);
+        }
+    }
+}
+
+Status_t BlockAllocator::getStats(BlockClass_t sizeClass, BlockClassStats_t * _stats)
+{
+    Status_t status = STATUS_OKAY;
+
+    if (CHECK_POINTER_VALID(_stats) == false)
+    {
+        status = STATUS_NULL_POINTER;
+    }
+    else if (sizeClass >= TOTAL_BLOCK_CLASSES)
+    {
+        status = STATUS_OUT_OF_BOUNDS;
+    }
+    else
+    {
+        taskENTER_CRITICAL();
+        if (initialized == false)
+        {
+            init();
+        }
+        *_stats = stats[sizeClass];
+        taskEXIT_CRITICAL();
+    }
+
+    return status;
+}
+
+Status_t BlockAllocator::getReport(BlockAllocatorReport_t * report)
+{
+    Status_t status = STATUS_OKAY;
+
+    if (CHECK_POINTER_VALID(report) == false)
+    {
+        status = STATUS_NULL_POINTER;
+    }
+    else
+    {
+        memset(report, 0, sizeof(BlockAllocatorReport_t));
+
+        taskENTER_CRITICAL();
+        if (initialized == false)
+        {
+            init();
+        }
+        for (uint8_t sizeClass = 0u; sizeClass < TOTAL_BLOCK_CLASSES; sizeClass++)
+        {
+            uint16_t freeBlocks = stats[sizeClass].blockCount - stats[sizeClass].inUse;
+
+            report->poolFreeBytes += (uint32_t)freeBlocks * stats[sizeClass].blockSize;
+            if (freeBlocks > 0u)
+            {
+                report->poolLargestFree = stats[sizeClass].blockSize;
+            }
+        }
+        report->heapFallbacks = heapFallbacks;
+        report->heapLive = heapFallbacks - heapFrees;
+        report->heapFailures = heapFailures;
+        taskEXIT_CRITICAL();
+
+        /*! - a pool with free memory only in small classes can not serve a
+              large request, the same measure as for a fragmented heap */
+        if (report->poolFreeBytes > 0u)
+        {
+            report->poolFragmentationPermille =
+                (uint16_t)(1000u - ((report->poolLargestFree * 1000u) / report->poolFreeBytes));
+        }
+
+        report->heapFreeBytes = esp_get_free_heap_size();
+        report->heapMinFreeBytes = esp_get_minimum_free_heap_size();
+    }
+
+    return status;
+}
+
+void BlockAllocator::logReport(void)
+{
+    BlockAllocatorReport_t report;
+    BlockClassStats_t classStats;
+
+    if (getReport(&report) == STATUS_OKAY)
+    {
+        ESP_LOGI(TAG, "pool %u B free, largest %u B, fragmentation %u.%u%%",
+                 report.poolFreeBytes, report.poolLargestFree,
+                 report.poolFragmentationPermille / 10u, report.poolFragmentationPermille % 10u);
+        ESP_LOGI(TAG, "heap %u B free, min %u B, %u fallbacks, %u live, %u failures",
+                 report.heapFreeBytes, report.heapMinFreeBytes,
+                 report.heapFallbacks, report.heapLive, report.heapFailures);
+    }
+
+    for (uint8_t sizeClass = 0u; sizeClass < TOTAL_BLOCK_CLASSES; sizeClass++)
+    {
+        if (getStats((BlockClass_t)sizeClass, &classStats) == STATUS_OKAY)
+        {
+            ESP_LOGI(TAG, "%4u B: %u/%u in use, peak %u, %u allocations, %u failures",
+                     classStats.blockSize, classStats.inUse, classStats.blockCount,
+                     classStats.peakInUse, classStats.allocations, classStats.failures);
+        }
+    }
+}
+
+/*  global operators, every C++ allocation of the firmware goes through the
+    block allocator. The build has no exceptions, a failed plain new aborts
+    like the library version does */
+void * operator new(size_t size)
+{
+    void * ptr = blockAllocator.allocate(size);
+
+    if (ptr == nullptr)
+    {
+        ESP_LOGE(TAG, "Error: %i, new of %u B", STATUS_POOL_EXHAUSTED, (unsigned)size);
+        abort();
+    }
+
+    return ptr;
+}
+
+void * operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void * operator new(size_t size, const std::nothrow_t &) noexcept
+{
+    return blockAllocator.allocate(size);
+}
+
+void * operator new[](size_t size, const std::nothrow_t &) noexcept
+{
+    return blockAllocator.allocate(size);
+}
+
+void operator delete(void * ptr) noexcept
+{
+    blockAllocator.deallocate(ptr);
+}
+
+void operator delete[](void * ptr) noexcept
+{
+    blockAllocator.deallocate(ptr);
+}
+
+void operator delete(void * ptr, size_t) noexcept
+{
+    blockAllocator.deallocate(ptr);
+}
+
+void operator delete[](void * ptr, size_t) noexcept
+{
+    blockAllocator.deallocate(ptr);
+}
+
+void operator delete(void * ptr, const std::nothrow_t &) noexcept
+{
+    blockAllocator.deallocate(ptr);
+}
+
+void operator delete[](void * ptr, const std::nothrow_t &) noexcept
+{
+    blockAllocator.deallocate(ptr);
+}
@@ -0,0 +1,132 @@
+/**
+ *******************************************************************************
+ * @file    boot_profile.cpp
+ * @author  hq
+ * @date    2025-08-13 21:02:44
+ * @brief   Boot profile source file
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * INCLUDES
+ *******************************************************************************/
+#include "boot_profile.hpp"
+#include "timing.h"
+
+extern "C"
+{
+    #include "freertos/FreeRTOS.h"
+    #include "freertos/task.h"
+    #include "esp_log.h"
+}
+
+/*******************************************************************************
+ * EXTERN VARIABLES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * PRIVATE MACROS AND DEFINES
+ *******************************************************************************/
+#define US_PER_MS (1000u)
+
+/*******************************************************************************
+ * PRIVATE TYPEDEFS
+ *******************************************************************************/
+
+/*******************************************************************************
+ * STATIC VARIABLES
+ *******************************************************************************/
+static const char *TAG = "BootProfile";
+
+#define BOOT_MILESTONE_NAME(milestone, name)    name,
+static const char * const milestoneNames[TOTAL_BOOT_MILESTONES] =
+{
+    BOOT_MILESTONES(BOOT_MILESTONE_NAME)
+};
+#undef BOOT_MILESTONE_NAME
+
+/*******************************************************************************
+ * GLOBAL VARIABLES
+ *******************************************************************************/
+BootProfile bootProfile;
+
+/*******************************************************************************
+ * STATIC FUNCTION PROTOTYPES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * STATIC FUNCTIONS
+ *******************************************************************************/
+
+/*******************************************************************************
+ * GLOBAL FUNCTIONS
+ *******************************************************************************/
+void BootProfile::mark(BootMilestone_t milestone)
+{
+    /*! - the check outside the critical section keeps the data path cheap
+          once the milestone is in   */
+    if ((milestone < TOTAL_BOOT_MILESTONES) && ((reached & (1u << milestone)) == 0u))
+    {
+        uint32_t nowUs = timing_getTimeUs();
+
+        taskENTER_CRITICAL();
+        if ((reached & (1u << milestone)) == 0u)
+        {
+            timeUs[milestone] = nowUs;
+            reached |= (1u << milestone);
+        }
+        taskEXIT_CRITICAL();
+    }
+}
+
+Status_t BootProfile::getTimeUs(BootMilestone_t milestone, uint32_t * _timeUs)
+{
+    Status_t status = STATUS_OKAY;
+
+    if (CHECK_POINTER_VALID(_timeUs) == false)
+    {
+        status = STATUS_NULL_POINTER;
+    }
+    else if (milestone >= TOTAL_BOOT_MILESTONES)
+    {
+        status = STATUS_OUT_OF_BOUNDS;
+    }
+    else
+    {
+        taskENTER_CRITICAL();
+        if ((reached & (1u << milestone)) == 0u)
+        {
+            status = STATUS_UNKNOWN;
+        }
+        else
+        {
+            *_timeUs = timeUs[milestone];
+        }
+        taskEXIT_CRITICAL();
+    }
+
+    return status;
+}
+
+const char * BootProfile::getName(BootMilestone_t milestone)
+{
+    return (milestone < TOTAL_BOOT_MILESTONES) ? milestoneNames[milestone] : nullptr;
+}
+
+void BootProfile::log(void)
+{
+    uint32_t milestoneUs;
+
+    for (uint8_t i = 0u; i < TOTAL_BOOT_MILESTONES; i++)
+    {
+        if (getTimeUs((BootMilestone_t)i, &milestoneUs) == STATUS_OKAY)
+        {
+            ESP_LOGI(TAG, "%-16s %6u.%03u ms", milestoneNames[i],
+                     milestoneUs / US_PER_MS, milestoneUs % US_PER_MS);
+        }
+        else
+        {
+            ESP_LOGI(TAG, "%-16s not reached", milestoneNames[i]);
+        }
+    }
+}
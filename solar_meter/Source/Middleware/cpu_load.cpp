@@ -0,0 +1,281 @@
+/**
+ *******************************************************************************
+ * @file    cpu_load.cpp
+ * @author  hq
+ * @date    2025-08-09 17:52:30
+ * @brief   Cpu load source file
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * INCLUDES
+ *******************************************************************************/
+#include "cpu_load.hpp"
+#include "timing.h"
+
+#include <string.h>
+
+extern "C"
+{
+    #include "esp_attr.h"
+}
+
+/*******************************************************************************
+ * EXTERN VARIABLES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * PRIVATE MACROS AND DEFINES
+ *******************************************************************************/
+#define OTHER_SLOT          (CPU_LOAD_MAX_TASKS)
+#define OTHER_SLOT_NAME     "other"
+
+#ifndef configIDLE_TASK_NAME
+#define configIDLE_TASK_NAME "IDLE"
+#endif
+
+/*******************************************************************************
+ * PRIVATE TYPEDEFS
+ *******************************************************************************/
+typedef struct
+{
+    void * task;                        /**< tcb, nullptr once free or deleted      */
+    uint64_t cycles;                    /**< cpu cycles charged since claimed       */
+    uint32_t switches;
+    uint32_t generation;                /**< bumped when the slot gets a new task   */
+} CpuSlot_t;
+
+/*******************************************************************************
+ * STATIC VARIABLES
+ *******************************************************************************/
+
+/*  written by the kernel hooks with interrupts disabled, read in critical
+    sections, so no further locking is needed */
+static CpuSlot_t slots[CPU_LOAD_SLOTS];
+static uint8_t currentSlot = OTHER_SLOT;
+static void * currentTask = nullptr;
+static uint32_t sliceStartCycles = 0u;
+static uint64_t isrCycles = 0u;
+static uint32_t isrCount = 0u;
+
+/*******************************************************************************
+ * GLOBAL VARIABLES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * STATIC FUNCTION PROTOTYPES
+ *******************************************************************************/
+static void chargeSlice(uint32_t nowCycles);
+static uint8_t claimSlot(void * task);
+
+/*******************************************************************************
+ * STATIC FUNCTIONS
+ *******************************************************************************/
+
+/*!
+ * \brief charges the cycles since the last switch to the running task, the
+ * difference stays correct across the 32 bit CCOUNT wrap
+ */
+static void IRAM_ATTR chargeSlice(uint32_t nowCycles)
+{
+    slots[currentSlot].cycles += (uint32_t)(nowCycles - sliceStartCycles);
+    sliceStartCycles = nowCycles;
+}
+
+/*!
+ * \brief returns the slot of a task, claims a free one the first time the
+ * task runs and falls back to the other slot once all are taken
+ */
+static uint8_t IRAM_ATTR claimSlot(void * task)
+{
+    uint8_t slot = OTHER_SLOT;
+    uint8_t freeSlot = OTHER_SLOT;
+
+    for (uint8_t i = 0u; (i < CPU_LOAD_MAX_TASKS) && (slot == OTHER_SLOT); i++)
+    {
+        if (slots[i].task == task)
+        {
+            slot = i;
+        }
+        else if ((slots[i].task == nullptr) && (freeSlot == OTHER_SLOT))
+        {
+            freeSlot = i;
+        }
+    }
+
+    if ((slot == OTHER_SLOT) && (freeSlot != OTHER_SLOT))
+    {
+        slot = freeSlot;
+        slots[slot].task = task;
+        slots[slot].cycles = 0u;
+        slots[slot].switches = 0u;
+        slots[slot].generation++;
+    }
+
+    return slot;
+}
+
+extern "C" void IRAM_ATTR cpu_traceTaskSwitchedIn(void * task)
+{
+    /*! - the kernel also calls this when the same task keeps running */
+    if (task != currentTask)
+    {
+        /*! - nothing ran under the scheduler before the first switch */
+        if (currentTask == nullptr)
+        {
+            sliceStartCycles = timing_getCycleCount();
+        }
+        chargeSlice(timing_getCycleCount());
+        currentTask = task;
+        currentSlot = claimSlot(task);
+        slots[currentSlot].switches++;
+    }
+}
+
+extern "C" void cpu_traceTaskDeleted(void * task)
+{
+    for (uint8_t i = 0u; i < CPU_LOAD_MAX_TASKS; i++)
+    {
+        if (slots[i].task == task)
+        {
+            /*! - a task deleting itself runs on until the next switch,
+                  the rest of its slice goes to the other slot  */
+            if (i == currentSlot)
+            {
+                chargeSlice(timing_getCycleCount());
+                currentSlot = OTHER_SLOT;
+            }
+
+            /*! - the totals stay until the slot is claimed again, so
+                  monitors still see the last window of the task */
+            slots[i].task = nullptr;
+        }
+    }
+}
+
+extern "C" uint32_t IRAM_ATTR cpu_traceIsrEnter(void)
+{
+    return timing_getCycleCount();
+}
+
+extern "C" void IRAM_ATTR cpu_traceIsrExit(uint32_t enterCycles)
+{
+    isrCycles += (uint32_t)(timing_getCycleCount() - enterCycles);
+    isrCount++;
+}
+
+/*******************************************************************************
+ * GLOBAL FUNCTIONS
+ *******************************************************************************/
+CpuLoadMonitor::CpuLoadMonitor() : lastIsrCycles(0u),
+                                   lastIsrCount(0u),
+                                   lastSampleUs(timing_getTimeUs())
+{
+    memset(lastCycles, 0, sizeof(lastCycles));
+    memset(lastSwitches, 0, sizeof(lastSwitches));
+    memset(lastGeneration, 0, sizeof(lastGeneration));
+}
+
+uint8_t CpuLoadMonitor::sample(CpuTaskLoad_t * tasks, uint8_t capacity, CpuLoadSummary_t * summary)
+{
+    uint64_t deltaCycles[CPU_LOAD_SLOTS];
+    uint8_t listedSlot[CPU_LOAD_SLOTS];
+    char name[CPU_LOAD_NAME_SIZE];
+    uint64_t windowCycles = 0u;
+    uint64_t idleCycles = 0u;
+    uint64_t isrTotal;
+    uint32_t isrTotalCount;
+    uint32_t switches = 0u;
+    uint32_t nowUs = timing_getTimeUs();
+    uint8_t count = 0u;
+
+    if ((CHECK_POINTER_VALID(tasks) == false) || (CHECK_POINTER_VALID(summary) == false))
+    {
+        capacity = 0u;
+    }
+
+    /*! - settle the running slice first so this task is counted up to now */
+    taskENTER_CRITICAL();
+    chargeSlice(timing_getCycleCount());
+    isrTotal = isrCycles;
+    isrTotalCount = isrCount;
+    taskEXIT_CRITICAL();
+
+    /*! - one short critical section per slot keeps the interrupt latency low */
+    for (uint8_t i = 0u; i < CPU_LOAD_SLOTS; i++)
+    {
+        uint32_t deltaSwitches;
+        bool alive;
+
+        name[0] = '\0';
+
+        taskENTER_CRITICAL();
+        if (slots[i].generation != lastGeneration[i])
+        {
+            lastGeneration[i] = slots[i].generation;
+            lastCycles[i] = 0u;
+            lastSwitches[i] = 0u;
+        }
+        deltaCycles[i] = slots[i].cycles - lastCycles[i];
+        deltaSwitches = slots[i].switches - lastSwitches[i];
+        lastCycles[i] = slots[i].cycles;
+        lastSwitches[i] = slots[i].switches;
+        alive = (slots[i].task != nullptr);
+        if (alive)
+        {
+            strncpy(name, pcTaskGetName((TaskHandle_t)slots[i].task), CPU_LOAD_NAME_SIZE - 1u);
+        }
+        taskEXIT_CRITICAL();
+
+        if (i == OTHER_SLOT)
+        {
+            alive = true;
+            strncpy(name, OTHER_SLOT_NAME, CPU_LOAD_NAME_SIZE - 1u);
+        }
+        name[CPU_LOAD_NAME_SIZE - 1u] = '\0';
+
+        /*! - a deleted task still counts towards the window, it is only
+              not listed   */
+        windowCycles += deltaCycles[i];
+        switches += deltaSwitches;
+        if (alive && (strcmp(name, configIDLE_TASK_NAME) == 0))
+        {
+            idleCycles += deltaCycles[i];
+        }
+
+        if (alive && (count < capacity))
+        {
+            memcpy(tasks[count].name, name, CPU_LOAD_NAME_SIZE);
+            tasks[count].switches = deltaSwitches;
+            listedSlot[count] = i;
+            count++;
+        }
+    }
+
+    if (capacity > 0u)
+    {
+        /*! - loads need the window length, known once every slot is read */
+        for (uint8_t n = 0u; n < count; n++)
+        {
+            tasks[n].loadPermille = (windowCycles > 0u) ?
+                                    (uint16_t)((deltaCycles[listedSlot[n]] * 1000u) / windowCycles) : 0u;
+        }
+
+        memset(summary, 0, sizeof(CpuLoadSummary_t));
+        summary->windowUs = nowUs - lastSampleUs;
+        summary->switches = switches;
+        summary->isrCount = isrTotalCount - lastIsrCount;
+        summary->tasks = count;
+        if (windowCycles > 0u)
+        {
+            summary->idlePermille = (uint16_t)((idleCycles * 1000u) / windowCycles);
+            summary->isrPermille = (uint16_t)(((isrTotal - lastIsrCycles) * 1000u) / windowCycles);
+        }
+    }
+
+    lastIsrCycles = isrTotal;
+    lastIsrCount = isrTotalCount;
+    lastSampleUs = nowUs;
+
+    return count;
+}
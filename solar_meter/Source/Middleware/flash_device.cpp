@@ -0,0 +1,130 @@
+/**
+ *******************************************************************************
+ * @file    flash_device.cpp
+ * @author  hq
+ * @date    2025-08-01 18:12:47
+ * @brief   Flash device source file
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * INCLUDES
+ *******************************************************************************/
+#include "flash_device.hpp"
+
+extern "C"
+{
+    #include "esp_log.h"
+}
+
+/*******************************************************************************
+ * EXTERN VARIABLES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * PRIVATE MACROS AND DEFINES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * PRIVATE TYPEDEFS
+ *******************************************************************************/
+
+/*******************************************************************************
+ * STATIC VARIABLES
+ *******************************************************************************/
+static const char *TAG = "PartitionFlash";
+
+/*******************************************************************************
+ * GLOBAL VARIABLES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * STATIC FUNCTION PROTOTYPES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * STATIC FUNCTIONS
+ *******************************************************************************/
+
+/*******************************************************************************
+ * GLOBAL FUNCTIONS
+ *******************************************************************************/
+PartitionFlash::PartitionFlash(const char * _label, esp_partition_subtype_t _subtype) :
+                               label(_label),
+                               subtype(_subtype),
+                               partition(nullptr)
+{
+}
+
+Status_t PartitionFlash::init(void)
+{
+    Status_t status = STATUS_OKAY;
+
+    partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, subtype, label);
+
+    if (CHECK_POINTER_VALID(partition) == false)
+    {
+        status = STATUS_HAL_ERROR;
+        ESP_LOGE(TAG, "Error: %i, no partition %s", status, label);
+    }
+
+    return status;
+}
+
+uint32_t PartitionFlash::getSize(void) const
+{
+    /*  only whole sectors are handed out   */
+    return CHECK_POINTER_VALID(partition) ? (partition->size & ~(FLASH_SECTOR_SIZE - 1u)) : 0u;
+}
+
+Status_t PartitionFlash::read(uint32_t offset, void * data, uint32_t length)
+{
+    Status_t status = STATUS_OKAY;
+
+    if (CHECK_POINTER_VALID(partition) == false)
+    {
+        status = STATUS_NULL_POINTER;
+    }
+    else if (esp_partition_read(partition, offset, data, length) != ESP_OK)
+    {
+        status = STATUS_HAL_ERROR;
+    }
+
+    return status;
+}
+
+Status_t PartitionFlash::write(uint32_t offset, const void * data, uint32_t length)
+{
+    Status_t status = STATUS_OKAY;
+
+    if (CHECK_POINTER_VALID(partition) == false)
+    {
+        status = STATUS_NULL_POINTER;
+    }
+    else if (((offset | length) & (FLASH_WRITE_ALIGNMENT - 1u)) != 0u)
+    {
+        status = STATUS_OUT_OF_BOUNDS;
+    }
+    else if (esp_partition_write(partition, offset, data, length) != ESP_OK)
+    {
+        status = STATUS_HAL_ERROR;
+    }
+
+    return status;
+}
+
+Status_t PartitionFlash::eraseSector(uint32_t offset)
+{
+    Status_t status = STATUS_OKAY;
+
+    if (CHECK_POINTER_VALID(partition) == false)
+    {
+        status = STATUS_NULL_POINTER;
+    }
+    else if (esp_partition_erase_range(partition, offset, FLASH_SECTOR_SIZE) != ESP_OK)
+    {
+        status = STATUS_HAL_ERROR;
+    }
+
+    return status;
+}
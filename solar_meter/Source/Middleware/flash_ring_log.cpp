@@ -0,0 +1,598 @@
+/**
+ *******************************************************************************
+ * @file    flash_ring_log.cpp
+ * @author  hq
+ * @date    2025-08-01 18:12:47
+ * @brief   Flash ring log source file
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * INCLUDES
+ *******************************************************************************/
+#include "flash_ring_log.hpp"
+#include "crc.h"
+
+#include <string.h>
+
+extern "C"
+{
+    #include "esp_log.h"
+}
+
+/*******************************************************************************
+ * EXTERN VARIABLES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * PRIVATE MACROS AND DEFINES
+ *******************************************************************************/
+#define SECTOR_MAGIC            (0x4C524D53u)   /* "SMRL"                       */
+#define RECORD_ERASED_LENGTH    (0xFFFFu)
+#define RECORD_STATE_PENDING    (0xFFFFFFFFu)
+#define RECORD_STATE_REPLAYED   (0x00000000u)
+#define RECORD_STATE_OFFSET     (4u)
+
+/*******************************************************************************
+ * PRIVATE TYPEDEFS
+ *******************************************************************************/
+typedef struct
+{
+    uint32_t magic;
+    uint32_t sequence;                  /**< incremented for every opened sector    */
+    uint32_t eraseCount;
+} SectorHeader_t;
+
+static_assert(sizeof(SectorHeader_t) == FLASH_RING_LOG_SECTOR_HEADER_SIZE,
+              "sector header layout");
+
+/*******************************************************************************
+ * STATIC VARIABLES
+ *******************************************************************************/
+static const char *TAG = "FlashRingLog";
+
+/*******************************************************************************
+ * GLOBAL VARIABLES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * STATIC FUNCTION PROTOTYPES
+ *******************************************************************************/
+static inline uint32_t recordSize(uint16_t length);
+
+/*******************************************************************************
+ * STATIC FUNCTIONS
+ *******************************************************************************/
+static inline uint32_t recordSize(uint16_t length)
+{
+    return (FLASH_RING_LOG_RECORD_HEADER_SIZE + length + (FLASH_WRITE_ALIGNMENT - 1u))
+           & ~(FLASH_WRITE_ALIGNMENT - 1u);
+}
+
+/*!
+ * \brief programs the buffered bytes of the current page
+ */
+Status_t FlashRingLog::writePage(void)
+{
+    Status_t status = STATUS_OKAY;
+
+    if (pageFill > pageWritten)
+    {
+        status = flash.write(pageBase + pageWritten, &page[pageWritten], pageFill - pageWritten);
+        pageWritten = pageFill;
+        stats.pageWrites++;
+    }
+
+    return status;
+}
+
+/*!
+ * \brief copies bytes into the page buffer, full pages are programmed
+ */
+Status_t FlashRingLog::putBytes(const uint8_t * data, uint32_t length)
+{
+    Status_t status = STATUS_OKAY;
+
+    while ((length > 0u) && (status == STATUS_OKAY))
+    {
+        uint32_t chunk = FLASH_PAGE_SIZE - pageFill;
+
+        if (chunk > length)
+        {
+            chunk = length;
+        }
+
+        memcpy(&page[pageFill], data, chunk);
+        pageFill += chunk;
+        data += chunk;
+        length -= chunk;
+
+        if (pageFill == FLASH_PAGE_SIZE)
+        {
+            status = writePage();
+            pageBase += FLASH_PAGE_SIZE;
+            pageWritten = 0u;
+            pageFill = 0u;
+        }
+    }
+
+    return status;
+}
+
+/*!
+ * \brief reads a record header, a position past the sector end reads as erased
+ */
+Status_t FlashRingLog::readRecordHeader(uint16_t sector, uint32_t offset, uint16_t * length,
+                                        uint16_t * crc, uint32_t * state)
+{
+    Status_t status = STATUS_OKAY;
+    uint8_t header[FLASH_RING_LOG_RECORD_HEADER_SIZE];
+
+    *length = RECORD_ERASED_LENGTH;
+
+    if ((offset + FLASH_RING_LOG_RECORD_HEADER_SIZE) <= FLASH_SECTOR_SIZE)
+    {
+        status = flash.read(sectorBase(sector) + offset, header, sizeof(header));
+    }
+    else
+    {
+        memset(header, 0xFF, sizeof(header));
+    }
+
+    if (status == STATUS_OKAY)
+    {
+        *length = (uint16_t)(header[0] | (header[1] << 8));
+        *crc = (uint16_t)(header[2] | (header[3] << 8));
+        memcpy(state, &header[RECORD_STATE_OFFSET], sizeof(*state));
+
+        /*! - a garbled length ends the sector like an erased one */
+        if ((*length != RECORD_ERASED_LENGTH) && (*length > FLASH_RING_LOG_MAX_RECORD_SIZE))
+        {
+            *length = RECORD_ERASED_LENGTH;
+        }
+    }
+
+    return status;
+}
+
+/*!
+ * \brief counts pending records of a sector from offset up to endOffset
+ */
+uint32_t FlashRingLog::countPending(uint16_t sector, uint32_t offset, uint32_t endOffset)
+{
+    uint32_t pending = 0u;
+    uint16_t length = 0u;
+    uint16_t crc;
+    uint32_t state;
+
+    while (    (offset < endOffset)
+            && (readRecordHeader(sector, offset, &length, &crc, &state) == STATUS_OKAY)
+            && (length != RECORD_ERASED_LENGTH))
+    {
+        pending += (state == RECORD_STATE_PENDING) ? 1u : 0u;
+        offset += recordSize(length);
+    }
+
+    return pending;
+}
+
+/*!
+ * \brief erases a sector, writes its header and moves the write position to it
+ */
+Status_t FlashRingLog::startSector(uint16_t sector)
+{
+    Status_t status = STATUS_OKAY;
+    SectorHeader_t header;
+
+    /*! - the erase count survives the erase through the old header  */
+    status = flash.read(sectorBase(sector), &header, sizeof(header));
+
+    if (status == STATUS_OKAY)
+    {
+        if (header.magic != SECTOR_MAGIC)
+        {
+            header.eraseCount = 0u;
+        }
+
+        header.magic = SECTOR_MAGIC;
+        header.sequence = headSequence + 1u;
+        header.eraseCount++;
+        status = flash.eraseSector(sectorBase(sector));
+    }
+
+    if (status == STATUS_OKAY)
+    {
+        status = flash.write(sectorBase(sector), &header, sizeof(header));
+    }
+
+    if (status == STATUS_OKAY)
+    {
+        stats.sectorErases++;
+        if (header.eraseCount > stats.maxEraseCount)
+        {
+            stats.maxEraseCount = header.eraseCount;
+        }
+
+        headSector = sector;
+        headSequence = header.sequence;
+        writeOffset = FLASH_RING_LOG_SECTOR_HEADER_SIZE;
+        pageBase = sectorBase(sector);
+        pageWritten = FLASH_RING_LOG_SECTOR_HEADER_SIZE;
+        pageFill = FLASH_RING_LOG_SECTOR_HEADER_SIZE;
+    }
+
+    return status;
+}
+
+/*!
+ * \brief moves on to the next sector, its pending records are overwritten
+ */
+Status_t FlashRingLog::openNextSector(void)
+{
+    Status_t status = writePage();
+    uint16_t next = nextSector(headSector);
+
+    if ((status == STATUS_OKAY) && (readSector == next))
+    {
+        /*! - the oldest data goes, replay continues with the sector after it  */
+        uint32_t lost = countPending(next, readOffset, FLASH_SECTOR_SIZE);
+
+        stats.recordsOverwritten += lost;
+        stats.recordsPending -= lost;
+        readSector = nextSector(next);
+        readOffset = FLASH_RING_LOG_SECTOR_HEADER_SIZE;
+        peekedSize = 0u;
+
+        if (lost > 0u)
+        {
+            ESP_LOGW(TAG, "%u pending records overwritten", lost);
+        }
+    }
+
+    if (status == STATUS_OKAY)
+    {
+        status = startSector(next);
+    }
+
+    return status;
+}
+
+/*******************************************************************************
+ * GLOBAL FUNCTIONS
+ *******************************************************************************/
+FlashRingLog::FlashRingLog(FlashDevice & _flash) : flash(_flash),
+                                                   mounted(false),
+                                                   headSector(0u),
+                                                   headSequence(0u),
+                                                   writeOffset(0u),
+                                                   pageBase(0u),
+                                                   pageWritten(0u),
+                                                   pageFill(0u),
+                                                   readSector(0u),
+                                                   readOffset(0u),
+                                                   peekedSize(0u)
+{
+    memset(&stats, 0, sizeof(stats));
+}
+
+Status_t FlashRingLog::mount(void)
+{
+    Status_t status = STATUS_OKAY;
+    SectorHeader_t header;
+    bool found = false;
+    uint16_t tailSector = 0u;
+    uint32_t tailSequence = UINT32_MAX;
+
+    memset(&stats, 0, sizeof(stats));
+    stats.sectorCount = (uint16_t)(flash.getSize() / FLASH_SECTOR_SIZE);
+    headSequence = 0u;
+
+    if (stats.sectorCount < 2u)
+    {
+        status = STATUS_OUT_OF_BOUNDS;
+    }
+
+    /*! - the newest sector is the head, the oldest the tail   */
+    for (uint16_t sector = 0u; (sector < stats.sectorCount) && (status == STATUS_OKAY); sector++)
+    {
+        status = flash.read(sectorBase(sector), &header, sizeof(header));
+
+        if ((status == STATUS_OKAY) && (header.magic == SECTOR_MAGIC))
+        {
+            if ((found == false) || (header.sequence > headSequence))
+            {
+                headSector = sector;
+                headSequence = header.sequence;
+            }
+            if (header.sequence < tailSequence)
+            {
+                tailSector = sector;
+                tailSequence = header.sequence;
+            }
+            if (header.eraseCount > stats.maxEraseCount)
+            {
+                stats.maxEraseCount = header.eraseCount;
+            }
+            found = true;
+        }
+    }
+
+    if ((status == STATUS_OKAY) && (found == false))
+    {
+        ESP_LOGI(TAG, "formatting %u sectors", stats.sectorCount);
+        status = startSector(0u);
+        readSector = 0u;
+        readOffset = FLASH_RING_LOG_SECTOR_HEADER_SIZE;
+    }
+    else if (status == STATUS_OKAY)
+    {
+        uint16_t length = 0u;
+        uint16_t crc;
+        uint32_t state;
+        uint32_t word;
+        bool cursorFound = false;
+
+        /*! - the write position follows the last record of the head   */
+        writeOffset = FLASH_RING_LOG_SECTOR_HEADER_SIZE;
+        while (    (readRecordHeader(headSector, writeOffset, &length, &crc, &state) == STATUS_OKAY)
+                && (length != RECORD_ERASED_LENGTH))
+        {
+            writeOffset += recordSize(length);
+        }
+
+        /*! - a garbled header leaves no room, the next append moves on  */
+        if (    ((writeOffset + FLASH_RING_LOG_RECORD_HEADER_SIZE) <= FLASH_SECTOR_SIZE)
+             && (flash.read(sectorBase(headSector) + writeOffset, &word, sizeof(word)) == STATUS_OKAY)
+             && (word != 0xFFFFFFFFu))
+        {
+            writeOffset = FLASH_SECTOR_SIZE;
+        }
+
+        pageBase = sectorBase(headSector) + (writeOffset & ~(FLASH_PAGE_SIZE - 1u));
+        pageWritten = (uint16_t)(writeOffset & (FLASH_PAGE_SIZE - 1u));
+        pageFill = pageWritten;
+
+        /*! - walk tail to head, the first pending record is the replay cursor */
+        for (uint16_t sector = tailSector; ; sector = nextSector(sector))
+        {
+            uint32_t endOffset = (sector == headSector) ? writeOffset : FLASH_SECTOR_SIZE;
+            uint32_t offset = FLASH_RING_LOG_SECTOR_HEADER_SIZE;
+
+            while (    (offset < endOffset)
+                    && (readRecordHeader(sector, offset, &length, &crc, &state) == STATUS_OKAY)
+                    && (length != RECORD_ERASED_LENGTH))
+            {
+                if (state == RECORD_STATE_PENDING)
+                {
+                    if (cursorFound == false)
+                    {
+                        readSector = sector;
+                        readOffset = offset;
+                        cursorFound = true;
+                    }
+                    stats.recordsPending++;
+                }
+                offset += recordSize(length);
+            }
+
+            if (sector == headSector)
+            {
+                break;
+            }
+        }
+
+        if (cursorFound == false)
+        {
+            readSector = headSector;
+            readOffset = writeOffset;
+        }
+    }
+
+    if (status == STATUS_OKAY)
+    {
+        mounted = true;
+        ESP_LOGI(TAG, "head %u, %u records pending", headSector, stats.recordsPending);
+    }
+    else
+    {
+        ESP_LOGE(TAG, "Error: %i", status);
+    }
+
+    return status;
+}
+
+Status_t FlashRingLog::append(const uint8_t * data, uint16_t length)
+{
+    Status_t status = STATUS_OKAY;
+    uint8_t header[FLASH_RING_LOG_RECORD_HEADER_SIZE];
+    uint32_t size = recordSize(length);
+    uint32_t padding = size - FLASH_RING_LOG_RECORD_HEADER_SIZE - length;
+    uint16_t crc = 0u;
+    static const uint8_t erased[FLASH_WRITE_ALIGNMENT] = { 0xFFu, 0xFFu, 0xFFu, 0xFFu };
+
+    if (mounted == false)
+    {
+        status = STATUS_UNKNOWN;
+    }
+    else if (CHECK_POINTER_VALID(data) == false)
+    {
+        status = STATUS_NULL_POINTER;
+    }
+    else if ((length == 0u) || (length > FLASH_RING_LOG_MAX_RECORD_SIZE))
+    {
+        status = STATUS_OUT_OF_BOUNDS;
+    }
+
+    if ((status == STATUS_OKAY) && ((writeOffset + size) > FLASH_SECTOR_SIZE))
+    {
+        status = openNextSector();
+    }
+
+    if (status == STATUS_OKAY)
+    {
+        crc = crc_crc16(CRC16_INIT, data, length);
+        header[0] = (uint8_t)(length);
+        header[1] = (uint8_t)(length >> 8);
+        header[2] = (uint8_t)(crc);
+        header[3] = (uint8_t)(crc >> 8);
+        memset(&header[RECORD_STATE_OFFSET], 0xFF, sizeof(uint32_t));
+
+        status = putBytes(header, sizeof(header));
+    }
+
+    if (status == STATUS_OKAY)
+    {
+        status = putBytes(data, length);
+    }
+
+    if (status == STATUS_OKAY)
+    {
+        status = putBytes(erased, padding);
+    }
+
+    if (status == STATUS_OKAY)
+    {
+        writeOffset += size;
+        stats.recordsAppended++;
+        stats.recordsPending++;
+        stats.bytesAppended += length;
+    }
+    else
+    {
+        ESP_LOGE(TAG, "Error: %i", status);
+    }
+
+    return status;
+}
+
+Status_t FlashRingLog::flush(void)
+{
+    return mounted ? writePage() : STATUS_UNKNOWN;
+}
+
+Status_t FlashRingLog::peek(uint8_t * data, uint16_t capacity, uint16_t * length)
+{
+    Status_t status = STATUS_OKAY;
+    bool done = false;
+
+    if (mounted == false)
+    {
+        status = STATUS_UNKNOWN;
+    }
+    else if ((CHECK_POINTER_VALID(data) == false) || (CHECK_POINTER_VALID(length) == false))
+    {
+        status = STATUS_NULL_POINTER;
+    }
+    else
+    {
+        /*! - the cursor may point at bytes still waiting in the page   */
+        *length = 0u;
+        peekedSize = 0u;
+        status = writePage();
+    }
+
+    while ((status == STATUS_OKAY) && (done == false))
+    {
+        uint16_t recordLength = 0u;
+        uint16_t crc = 0u;
+        uint32_t state = 0u;
+
+        if ((readSector == headSector) && (readOffset >= writeOffset))
+        {
+            /*! - caught up with the write position, nothing pending  */
+            done = true;
+        }
+        else
+        {
+            status = readRecordHeader(readSector, readOffset, &recordLength, &crc, &state);
+        }
+
+        if ((status != STATUS_OKAY) || done)
+        {
+            /*  nothing to read */
+        }
+        else if ((recordLength == RECORD_ERASED_LENGTH) && (readSector == headSector))
+        {
+            /*! - the rest of the head is unusable, appends go to the next sector */
+            readOffset = writeOffset;
+            done = true;
+        }
+        else if (recordLength == RECORD_ERASED_LENGTH)
+        {
+            readSector = nextSector(readSector);
+            readOffset = FLASH_RING_LOG_SECTOR_HEADER_SIZE;
+        }
+        else if (state != RECORD_STATE_PENDING)
+        {
+            readOffset += recordSize(recordLength);
+        }
+        else if (recordLength > capacity)
+        {
+            status = STATUS_OUT_OF_BOUNDS;
+        }
+        else
+        {
+            status = flash.read(sectorBase(readSector) + readOffset + FLASH_RING_LOG_RECORD_HEADER_SIZE,
+                                data, recordLength);
+
+            if ((status == STATUS_OKAY) && (crc_crc16(CRC16_INIT, data, recordLength) != crc))
+            {
+                /*! - torn or corrupted record, skip it   */
+                stats.crcErrors++;
+                stats.recordsPending--;
+                readOffset += recordSize(recordLength);
+            }
+            else if (status == STATUS_OKAY)
+            {
+                *length = recordLength;
+                peekedSize = recordSize(recordLength);
+                done = true;
+            }
+        }
+    }
+
+    return status;
+}
+
+Status_t FlashRingLog::consume(void)
+{
+    Status_t status = STATUS_OKAY;
+    static const uint32_t replayed = RECORD_STATE_REPLAYED;
+
+    if ((mounted == false) || (peekedSize == 0u))
+    {
+        status = STATUS_UNKNOWN;
+    }
+    else
+    {
+        /*! - clearing bits needs no erase   */
+        status = flash.write(sectorBase(readSector) + readOffset + RECORD_STATE_OFFSET,
+                             &replayed, sizeof(replayed));
+    }
+
+    if (status == STATUS_OKAY)
+    {
+        readOffset += peekedSize;
+        peekedSize = 0u;
+        stats.recordsPending--;
+        stats.recordsReplayed++;
+    }
+
+    return status;
+}
+
+Status_t FlashRingLog::getStats(FlashRingLogStats_t * _stats)
+{
+    Status_t status = STATUS_OKAY;
+
+    if (CHECK_POINTER_VALID(_stats) == false)
+    {
+        status = STATUS_NULL_POINTER;
+    }
+    else
+    {
+        *_stats = stats;
+    }
+
+    return status;
+}
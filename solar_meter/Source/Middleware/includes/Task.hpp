@@ -16,6 +16,17 @@ extern "C" {
     // #include "cmsis_os2.h"  // ::CMSIS:RTOS2
 }
 
+// tasks whose stack usage can be sampled, Task objects and C tasks
+#define TASK_REGISTRY_SIZE (12u)
+
+typedef struct {
+    const char *name;
+    TaskHandle_t handle;
+    uint32_t stackSize;         // as passed to task creation, StackType_t units
+    uint32_t highWaterMark;     // least free stack seen, StackType_t units
+    bool staticStack;           // stack and TCB are not on the heap
+} TaskStackInfo_t;
+
 
 class Task {
 public:
@@ -23,6 +34,18 @@ public:
          UBaseType_t prio = ESP_NORMAL_PRIORITY);
     virtual ~Task();
 
+    // adds a task created outside of this class, e.g. by a C module, to the
+    // registry. STATUS_OUT_OF_BOUNDS if the registry is full
+    static Status_t registerTask(const char *name, TaskHandle_t handle,
+                                 uint32_t stackSize);
+
+    // samples uxTaskGetStackHighWaterMark of every registered task,
+    // returns the number of entries written to info
+    static uint8_t sampleStackUsage(TaskStackInfo_t *info, uint8_t capacity);
+
+    // logs the stack usage of every registered task
+    static void logStackUsage(void);
+
     // start internal loop (main function) in new task and return
     Status_t initTask(void);
 
@@ -35,6 +58,16 @@ public:
     Status_t suspend(void);
     Status_t resume(void);
 
+    // sets the priority, a running task is changed at once, otherwise
+    // initTask() creates it with this one. STATUS_OUT_OF_BOUNDS if it is not
+    // below configMAX_PRIORITIES
+    Status_t setPriority(UBaseType_t prio);
+
+protected:
+    // makes initTask() create the task on the given storage instead of the
+    // heap, the storage must hold stackSize StackType_t and outlive the task
+    void setStaticStorage(StackType_t *stack, StaticTask_t *tcb);
+
 private:
     TaskHandle_t taskHandle;
     static void startTask(void *argument);
@@ -43,6 +76,37 @@ private:
     uint32_t stackSize;
     UBaseType_t priority;
     volatile bool suspended;
+    StackType_t *staticStack;
+    StaticTask_t *staticTcb;
+
+    static TaskStackInfo_t registry[TASK_REGISTRY_SIZE];
+    static uint8_t registryCount;
+    static Status_t addToRegistry(const char *name, TaskHandle_t handle,
+                                  uint32_t stackSize, bool staticStack);
+    static void removeFromRegistry(TaskHandle_t handle);
+};
+
+
+// Task with its stack and TCB in the object, so a global or static instance
+// needs no heap. Base is Task or a class derived from it whose constructor
+// takes (name, stackSize, ...) like Task does.
+//   class Foo : public StaticTask<1024> { Foo() : StaticTask("Foo") {} };
+template <uint32_t StackDepth, class Base = Task>
+class StaticTask : public Base {
+public:
+    template <typename... Args>
+    StaticTask(const char *name, Args... args) : Base(name, StackDepth, args...)
+    {
+        static_assert(configSUPPORT_STATIC_ALLOCATION == 1,
+                      "StaticTask needs configSUPPORT_STATIC_ALLOCATION");
+        static_assert(StackDepth >= configMINIMAL_STACK_SIZE,
+                      "StaticTask stack below configMINIMAL_STACK_SIZE");
+        this->setStaticStorage(stack, &tcb);
+    }
+
+private:
+    StackType_t stack[StackDepth];
+    StaticTask_t tcb;
 };
 
 
@@ -0,0 +1,196 @@
+/**
+ *******************************************************************************
+ * @file    active_object.hpp
+ * @author  hq
+ * @date    2025-08-08 20:03:15
+ * @brief   Active objects sharing a run-to-completion dispatcher. A module
+ *  that only reacts to events or to its own period does not need a task and
+ *  a stack of its own, it derives from ActiveObject and handles one event at
+ *  a time in dispatch(). One EventDispatcher task per priority level runs
+ *  the handlers of every object attached to it and keeps their time events,
+ *  so no timer task or blocking loop is needed either.
+ *******************************************************************************
+ */
+
+#ifndef ACTIVE_OBJECT_HPP
+#define ACTIVE_OBJECT_HPP
+
+/*******************************************************************************
+ * INCLUDES
+*******************************************************************************/
+#include "common.h"
+#include "typedefs.h"
+#include "Task.hpp"
+
+extern "C"
+{
+    #include "freertos/queue.h"
+}
+
+/*******************************************************************************
+ * MACROS AND DEFINES
+*******************************************************************************/
+#define EVENT_DISPATCHER_QUEUE_LENGTH   (16u)
+
+/*******************************************************************************
+ * TYPEDEFS
+*******************************************************************************/
+typedef enum : uint16_t
+{
+    EVENT_SIGNAL_TIMEOUT,               /**< time event of the object is due        */
+    EVENT_SIGNAL_REARM,                 /**< internal, time event settings changed  */
+
+    EVENT_SIGNAL_USER                   /**< first signal free for the modules      */
+} EventSignal_t;
+
+typedef struct
+{
+    uint16_t signal;                    /**< EventSignal_t or a module signal       */
+    uint32_t param;                     /**< small value or a pooled buffer         */
+    uint32_t postedUs;                  /**< stamped by post(), for the latency     */
+} Event_t;
+
+typedef struct
+{
+    uint8_t objects;                    /**< active objects attached                */
+    uint32_t events;                    /**< posted events dispatched               */
+    uint32_t timeouts;                  /**< time events dispatched                 */
+    uint32_t missedTimeouts;            /**< time events skipped by an overrun      */
+    uint32_t postFailures;              /**< posts refused with the queue full      */
+    uint16_t queueHighWater;
+    uint32_t meanLatencyUs;             /**< post to start of dispatch              */
+    uint32_t maxLatencyUs;
+    uint32_t meanDispatchUs;            /**< time spent in one handler              */
+    uint32_t maxDispatchUs;
+} EventDispatcherStats_t;
+
+class EventDispatcher;
+
+/**
+ * @brief Base of the modules run by an EventDispatcher. dispatch() runs to
+ * completion on the dispatcher task and must not block, a wait becomes a
+ * time event or an event posted back when the awaited thing is done.
+ */
+class ActiveObject
+{
+public:
+    ActiveObject(const char * name);
+    virtual ~ActiveObject() = default;
+
+    /**
+     * @brief Queues an event for this object, callable from any task.
+     *
+     * @param signal - EVENT_SIGNAL_USER or above
+     * @param param - passed through to dispatch()
+     * @return Status_t - STATUS_QUEUE_FULL if the dispatcher is behind,
+     * STATUS_NULL_POINTER if the object is not attached
+     */
+    Status_t post(uint16_t signal, uint32_t param = 0u);
+
+    /**
+     * @brief Same as post() for interrupt context. The caller yields with
+     * portYIELD_FROM_ISR() when higherPriorityTaskWoken is set.
+     */
+    Status_t postFromIsr(uint16_t signal, uint32_t param, BaseType_t * higherPriorityTaskWoken);
+
+    /**
+     * @brief Starts a periodic EVENT_SIGNAL_TIMEOUT on the ticks where
+     * (tick - phase) % period == 0, replacing any earlier setting.
+     *
+     * @param periodMs - period, at least one rtos tick
+     * @param phaseMs - offset of the grid, wraps around at the period
+     * @return Status_t - STATUS_OUT_OF_BOUNDS if shorter than one tick
+     */
+    Status_t armTimer(uint32_t periodMs, uint32_t phaseMs = 0u);
+
+    /**
+     * @brief Stops the time event, a timeout already queued is still
+     * delivered.
+     */
+    Status_t disarmTimer(void);
+
+    const char * getName(void) const { return name; }
+
+protected:
+    /**
+     * @brief Handles one event, called on the dispatcher task.
+     */
+    virtual void dispatch(const Event_t & event) = 0;
+
+private:
+    friend class EventDispatcher;
+
+    const char * name;
+    EventDispatcher * dispatcher;
+    ActiveObject * next;                /**< dispatcher list link                   */
+
+    /*  written by armTimer(), read by the dispatcher on EVENT_SIGNAL_REARM */
+    volatile uint32_t timerPeriodMs;    /**< zero while disarmed                    */
+    volatile uint32_t timerPhaseMs;
+
+    /*  owned by the dispatcher task */
+    TickType_t timerPeriodTicks;
+    TickType_t timerDeadline;
+};
+
+/**
+ * @brief Task that runs the handlers of its active objects one event at a
+ * time. Objects attach before init(), the dispatcher then waits on its
+ * event queue with a timeout set by the nearest time event.
+ */
+class EventDispatcher : public Task
+{
+public:
+    EventDispatcher(const char * name, uint32_t stackSize, UBaseType_t prio = ESP_NORMAL_PRIORITY);
+    ~EventDispatcher();
+
+    /**
+     * @brief Adds an object to this dispatcher.
+     *
+     * @return Status_t - STATUS_REINIT_ERROR once the dispatcher runs or if
+     * the object is already attached
+     */
+    Status_t attach(ActiveObject & object);
+
+    /**
+     * @brief Creates the event queue and starts the task.
+     */
+    Status_t init(void);
+
+    /**
+     * @brief Returns a snapshot of the event, latency and handler counters.
+     *
+     * @param stats - pointer populated with the counters
+     * @return Status_t
+     */
+    Status_t getStats(EventDispatcherStats_t * stats);
+
+private:
+    friend class ActiveObject;
+
+    QueueHandle_t eventQueue;
+    ActiveObject * objects;
+
+    EventDispatcherStats_t stats;
+    uint64_t latencySumUs;
+    uint64_t dispatchSumUs;
+
+    Status_t enqueue(ActiveObject * target, const Event_t * event);
+    Status_t enqueueFromIsr(ActiveObject * target, const Event_t * event,
+                            BaseType_t * higherPriorityTaskWoken);
+    void rearmTimer(ActiveObject * object);
+    TickType_t serviceTimers(void);
+    void dispatchEvent(ActiveObject * target, const Event_t & event, bool timeout);
+    void taskRun() override;
+};
+
+/*******************************************************************************
+ * EXPORTED VARIABLES
+*******************************************************************************/
+
+/*******************************************************************************
+ * GLOBAL FUNCTION PROTOTYPES
+*******************************************************************************/
+
+
+#endif // ACTIVE_OBJECT_HPP
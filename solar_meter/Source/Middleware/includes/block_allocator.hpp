@@ -0,0 +1,143 @@
+/**
+ *******************************************************************************
+ * @file    block_allocator.hpp
+ * @author  hq
+ * @date    2025-08-11 18:36:05
+ * @brief   Size class block allocator behind the global operator new and
+ *  delete. Small C++ allocations come from fixed blocks in static storage,
+ *  so long running objects and short lived ones never interleave on the
+ *  SDK heap. Requests larger than the largest class, or made with every
+ *  fitting class empty, fall back to the heap and are counted.
+ *******************************************************************************
+ */
+
+#ifndef BLOCK_ALLOCATOR_HPP
+#define BLOCK_ALLOCATOR_HPP
+
+/*******************************************************************************
+ * INCLUDES
+*******************************************************************************/
+#include "common.h"
+#include "typedefs.h"
+
+#include <stddef.h>
+
+/*******************************************************************************
+ * MACROS AND DEFINES
+*******************************************************************************/
+
+/*  X(class, block size, block count), sizes ascending and multiples of 8 */
+#define BLOCK_ALLOCATOR_CLASSES(X)                                              \
+    X(BLOCK_CLASS_16,   16u,    16u)                                            \
+    X(BLOCK_CLASS_32,   32u,    8u)                                             \
+    X(BLOCK_CLASS_64,   64u,    8u)                                             \
+    X(BLOCK_CLASS_128,  128u,   4u)                                             \
+    X(BLOCK_CLASS_256,  256u,   2u)
+
+/*******************************************************************************
+ * TYPEDEFS
+*******************************************************************************/
+#define BLOCK_ALLOCATOR_ENUM(name, size, count)     name,
+typedef enum : uint8_t
+{
+    BLOCK_ALLOCATOR_CLASSES(BLOCK_ALLOCATOR_ENUM)
+
+    TOTAL_BLOCK_CLASSES
+} BlockClass_t;
+#undef BLOCK_ALLOCATOR_ENUM
+
+typedef struct
+{
+    uint16_t blockSize;
+    uint16_t blockCount;
+    uint16_t inUse;
+    uint16_t peakInUse;
+    uint32_t allocations;
+    uint32_t failures;                  /**< requests that found the class empty    */
+} BlockClassStats_t;
+
+typedef struct
+{
+    uint32_t poolFreeBytes;             /**< free blocks of every class             */
+    uint32_t poolLargestFree;           /**< largest block size still free          */
+    uint16_t poolFragmentationPermille; /**< 1000 - largest free / total free       */
+    uint32_t heapFreeBytes;
+    uint32_t heapMinFreeBytes;          /**< lowest free heap since boot            */
+    uint32_t heapFallbacks;             /**< requests the pool passed to the heap   */
+    uint32_t heapLive;                  /**< of those, not freed yet                */
+    uint32_t heapFailures;              /**< requests neither could serve           */
+} BlockAllocatorReport_t;
+
+/**
+ * @brief Free list per size class, the link of a free block is stored in the
+ * block itself so the blocks carry no header. A pointer is matched to its
+ * class by address when it is freed.
+ *
+ * The allocator has no constructor on purpose: operator new can run before
+ * the static constructors of this file, the free lists are built on first
+ * use from zero initialized storage instead.
+ */
+class BlockAllocator
+{
+public:
+    /**
+     * @brief Takes a block from the smallest class that fits, larger classes
+     * are used if the best fit class is empty, the heap if none is left.
+     *
+     * @param size - bytes requested
+     * @return void * - nullptr if neither the pool nor the heap can serve it
+     */
+    void * allocate(size_t size);
+
+    /**
+     * @brief Returns a block to its class or a fallback allocation to the
+     * heap, nullptr is ignored.
+     */
+    void deallocate(void * ptr);
+
+    /**
+     * @brief Returns the usage counters of one size class.
+     *
+     * @param sizeClass - class to report
+     * @param stats - pointer populated with the counters
+     * @return Status_t - STATUS_OUT_OF_BOUNDS for an unknown class
+     */
+    Status_t getStats(BlockClass_t sizeClass, BlockClassStats_t * stats);
+
+    /**
+     * @brief Returns free memory and fragmentation of the pool and the heap.
+     *
+     * @param report - pointer populated with the report
+     * @return Status_t
+     */
+    Status_t getReport(BlockAllocatorReport_t * report);
+
+    /**
+     * @brief Logs the report and the counters of every class.
+     */
+    void logReport(void);
+
+private:
+    bool initialized;
+    void * freeList[TOTAL_BLOCK_CLASSES];
+    BlockClassStats_t stats[TOTAL_BLOCK_CLASSES];
+    uint32_t heapFallbacks;
+    uint32_t heapFrees;
+    uint32_t heapFailures;
+
+    void init(void);
+    uint8_t * classStorage(uint8_t sizeClass);
+};
+
+/*******************************************************************************
+ * EXPORTED VARIABLES
+*******************************************************************************/
+/*  allocator behind operator new and delete */
+extern BlockAllocator blockAllocator;
+
+/*******************************************************************************
+ * GLOBAL FUNCTION PROTOTYPES
+*******************************************************************************/
+
+
+#endif // BLOCK_ALLOCATOR_HPP
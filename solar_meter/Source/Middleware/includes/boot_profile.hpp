@@ -0,0 +1,92 @@
+/**
+ *******************************************************************************
+ * @file    boot_profile.hpp
+ * @author  hq
+ * @date    2025-08-13 21:02:44
+ * @brief   Time since boot of the startup milestones. Each milestone keeps
+ *  the first time it is marked, later marks are ignored, so the modules on
+ *  the data path can mark on every sample or publish at no extra cost.
+ *******************************************************************************
+ */
+
+#ifndef BOOT_PROFILE_HPP
+#define BOOT_PROFILE_HPP
+
+/*******************************************************************************
+ * INCLUDES
+*******************************************************************************/
+#include "common.h"
+#include "typedefs.h"
+
+/*******************************************************************************
+ * MACROS AND DEFINES
+*******************************************************************************/
+
+/*  X(milestone, name), in the order they are expected */
+#define BOOT_MILESTONES(X)                                                      \
+    X(BOOT_MILESTONE_APP_MAIN,          "app_main")                             \
+    X(BOOT_MILESTONE_SAMPLING_READY,    "sampling_ready")                       \
+    X(BOOT_MILESTONE_FIRST_SAMPLE,      "first_sample")                         \
+    X(BOOT_MILESTONE_NETWORK_READY,     "network_ready")                        \
+    X(BOOT_MILESTONE_FIRST_PUBLISH,     "first_publish")
+
+/*******************************************************************************
+ * TYPEDEFS
+*******************************************************************************/
+#define BOOT_MILESTONE_ENUM(milestone, name)    milestone,
+typedef enum : uint8_t
+{
+    BOOT_MILESTONES(BOOT_MILESTONE_ENUM)
+
+    TOTAL_BOOT_MILESTONES
+} BootMilestone_t;
+#undef BOOT_MILESTONE_ENUM
+
+/**
+ * @brief Milestone times in microseconds since the SDK started, the ROM and
+ * bootloader time before it is not included. No constructor, marks made
+ * from static constructors are kept.
+ */
+class BootProfile
+{
+public:
+    /**
+     * @brief Records the time of a milestone the first time it is reached.
+     */
+    void mark(BootMilestone_t milestone);
+
+    /**
+     * @brief Returns the time of a milestone.
+     *
+     * @param milestone - milestone to look up
+     * @param timeUs - populated with the time since boot
+     * @return Status_t - STATUS_UNKNOWN if it has not been reached yet
+     */
+    Status_t getTimeUs(BootMilestone_t milestone, uint32_t * timeUs);
+
+    /**
+     * @brief Returns the name of a milestone, nullptr if out of range.
+     */
+    static const char * getName(BootMilestone_t milestone);
+
+    /**
+     * @brief Logs every milestone reached so far.
+     */
+    void log(void);
+
+private:
+    uint32_t reached;                   /**< bit per milestone                      */
+    uint32_t timeUs[TOTAL_BOOT_MILESTONES];
+};
+
+/*******************************************************************************
+ * EXPORTED VARIABLES
+*******************************************************************************/
+extern BootProfile bootProfile;
+
+/*******************************************************************************
+ * GLOBAL FUNCTION PROTOTYPES
+*******************************************************************************/
+
+
+#endif // BOOT_PROFILE_HPP
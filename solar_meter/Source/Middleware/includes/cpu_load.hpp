@@ -0,0 +1,96 @@
+/**
+ *******************************************************************************
+ * @file    cpu_load.hpp
+ * @author  hq
+ * @date    2025-08-09 17:52:30
+ * @brief   Per task cpu time and context switches. The kernel switch hook in
+ *  cpu_trace.h charges the CCOUNT cycles of every slice to the task that ran
+ *  it, so Task objects, the C tasks and the SDK tasks (wifi, tcpip, idle)
+ *  are all covered. A CpuLoadMonitor turns the running totals into the load
+ *  of each task over the window since its previous sample.
+ *******************************************************************************
+ */
+
+#ifndef CPU_LOAD_HPP
+#define CPU_LOAD_HPP
+
+/*******************************************************************************
+ * INCLUDES
+*******************************************************************************/
+#include "common.h"
+#include "typedefs.h"
+#include "cpu_trace.h"
+
+extern "C"
+{
+    #include "freertos/FreeRTOS.h"
+    #include "freertos/task.h"
+}
+
+/*******************************************************************************
+ * MACROS AND DEFINES
+*******************************************************************************/
+#define CPU_LOAD_MAX_TASKS      (16u)       /* further tasks share the "other" slot */
+#define CPU_LOAD_SLOTS          (CPU_LOAD_MAX_TASKS + 1u)
+#define CPU_LOAD_NAME_SIZE      (16u)
+
+/*******************************************************************************
+ * TYPEDEFS
+*******************************************************************************/
+typedef struct
+{
+    char name[CPU_LOAD_NAME_SIZE];
+    uint16_t loadPermille;              /**< share of the window, isr time included */
+    uint32_t switches;                  /**< times switched in during the window    */
+} CpuTaskLoad_t;
+
+typedef struct
+{
+    uint32_t windowUs;                  /**< time since the previous sample         */
+    uint16_t idlePermille;              /**< share of the idle task                 */
+    uint16_t isrPermille;               /**< share of the instrumented isrs         */
+    uint32_t switches;                  /**< all context switches in the window     */
+    uint32_t isrCount;
+    uint8_t tasks;                      /**< entries written, "other" included      */
+} CpuLoadSummary_t;
+
+/**
+ * @brief Reader of the cpu accounting. Each monitor keeps its own previous
+ * totals, so the reporter and e.g. a debug console can sample at different
+ * rates without disturbing each other.
+ */
+class CpuLoadMonitor
+{
+public:
+    CpuLoadMonitor();
+    ~CpuLoadMonitor() = default;
+
+    /**
+     * @brief Closes the window and returns the load of every task seen.
+     *
+     * @param tasks - array populated with one entry per task
+     * @param capacity - entries available in tasks
+     * @param summary - populated with the window totals
+     * @return uint8_t - entries written to tasks
+     */
+    uint8_t sample(CpuTaskLoad_t * tasks, uint8_t capacity, CpuLoadSummary_t * summary);
+
+private:
+    uint64_t lastCycles[CPU_LOAD_SLOTS];
+    uint32_t lastSwitches[CPU_LOAD_SLOTS];
+    uint32_t lastGeneration[CPU_LOAD_SLOTS];
+    uint64_t lastIsrCycles;
+    uint32_t lastIsrCount;
+    uint32_t lastSampleUs;
+};
+
+/*******************************************************************************
+ * EXPORTED VARIABLES
+*******************************************************************************/
+
+/*******************************************************************************
+ * GLOBAL FUNCTION PROTOTYPES
+*******************************************************************************/
+
+
+#endif // CPU_LOAD_HPP
@@ -0,0 +1,97 @@
+/**
+ *******************************************************************************
+ * @file    flash_device.hpp
+ * @author  hq
+ * @date    2025-08-01 18:12:47
+ * @brief   Minimal NOR flash interface used by the flash ring log. Programming
+ *  can only clear bits, erasing sets a whole sector back to 0xFF. The
+ *  partition implementation maps it onto a data partition, a ram
+ *  implementation of the same interface lets the log be simulated.
+ *******************************************************************************
+ */
+
+#ifndef FLASH_DEVICE_HPP
+#define FLASH_DEVICE_HPP
+
+/*******************************************************************************
+ * INCLUDES
+*******************************************************************************/
+#include "common.h"
+#include "typedefs.h"
+
+extern "C"
+{
+    #include "esp_partition.h"
+}
+
+/*******************************************************************************
+ * MACROS AND DEFINES
+*******************************************************************************/
+#define FLASH_SECTOR_SIZE               (4096u)
+#define FLASH_PAGE_SIZE                 (256u)
+#define FLASH_WRITE_ALIGNMENT           (4u)
+
+/*******************************************************************************
+ * TYPEDEFS
+*******************************************************************************/
+class FlashDevice
+{
+public:
+    virtual ~FlashDevice() = default;
+
+    /**
+     * @brief Returns the usable size, a multiple of FLASH_SECTOR_SIZE.
+     */
+    virtual uint32_t getSize(void) const = 0;
+
+    virtual Status_t read(uint32_t offset, void * data, uint32_t length) = 0;
+
+    /**
+     * @brief Programs bytes, offset and length are multiples of
+     * FLASH_WRITE_ALIGNMENT.
+     */
+    virtual Status_t write(uint32_t offset, const void * data, uint32_t length) = 0;
+
+    /**
+     * @brief Erases the sector that starts at offset.
+     */
+    virtual Status_t eraseSector(uint32_t offset) = 0;
+};
+
+/**
+ * @brief FlashDevice on a data partition of the partition table.
+ */
+class PartitionFlash : public FlashDevice
+{
+public:
+    PartitionFlash(const char * label, esp_partition_subtype_t subtype);
+    ~PartitionFlash() = default;
+
+    /**
+     * @brief Looks the partition up.
+     *
+     * @return Status_t - STATUS_HAL_ERROR if the partition does not exist
+     */
+    Status_t init(void);
+
+    uint32_t getSize(void) const override;
+    Status_t read(uint32_t offset, void * data, uint32_t length) override;
+    Status_t write(uint32_t offset, const void * data, uint32_t length) override;
+    Status_t eraseSector(uint32_t offset) override;
+
+private:
+    const char * label;
+    esp_partition_subtype_t subtype;
+    const esp_partition_t * partition;
+};
+
+/*******************************************************************************
+ * EXPORTED VARIABLES
+*******************************************************************************/
+
+/*******************************************************************************
+ * GLOBAL FUNCTION PROTOTYPES
+*******************************************************************************/
+
+
+#endif // FLASH_DEVICE_HPP
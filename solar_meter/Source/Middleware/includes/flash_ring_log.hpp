@@ -0,0 +1,150 @@
+/**
+ *******************************************************************************
+ * @file    flash_ring_log.hpp
+ * @author  hq
+ * @date    2025-08-01 18:12:47
+ * @brief   Append only ring log of CRC framed records in a flash partition.
+ *  Records are collected in a page buffer and programmed a page at a time.
+ *  Sectors are filled in order and the oldest one is erased when the ring
+ *  wraps, so every sector sees the same number of erase cycles. Each record
+ *  carries a state word that is cleared in place once it was replayed.
+ *******************************************************************************
+ */
+
+#ifndef FLASH_RING_LOG_HPP
+#define FLASH_RING_LOG_HPP
+
+/*******************************************************************************
+ * INCLUDES
+*******************************************************************************/
+#include "common.h"
+#include "typedefs.h"
+#include "flash_device.hpp"
+
+/*******************************************************************************
+ * MACROS AND DEFINES
+*******************************************************************************/
+#define FLASH_RING_LOG_SECTOR_HEADER_SIZE   (12u)   /* magic, sequence, erase count     */
+#define FLASH_RING_LOG_RECORD_HEADER_SIZE   (8u)    /* length, crc, state               */
+#define FLASH_RING_LOG_MAX_RECORD_SIZE      (FLASH_SECTOR_SIZE - FLASH_RING_LOG_SECTOR_HEADER_SIZE \
+                                             - FLASH_RING_LOG_RECORD_HEADER_SIZE)
+
+/*******************************************************************************
+ * TYPEDEFS
+*******************************************************************************/
+typedef struct
+{
+    uint16_t sectorCount;
+    uint32_t recordsPending;            /**< appended and not yet replayed          */
+    uint32_t recordsAppended;
+    uint32_t recordsReplayed;
+    uint32_t recordsOverwritten;        /**< pending records lost when the ring wrapped */
+    uint32_t crcErrors;                 /**< records skipped on replay              */
+    uint32_t bytesAppended;
+    uint32_t pageWrites;
+    uint32_t sectorErases;
+    uint32_t maxEraseCount;             /**< highest erase count of any sector      */
+} FlashRingLogStats_t;
+
+class FlashRingLog
+{
+public:
+    FlashRingLog(FlashDevice & flash);
+    ~FlashRingLog() = default;
+
+    /**
+     * @brief Scans the sector headers and records to find the write position
+     * and the oldest pending record. A device without a valid sector is
+     * formatted.
+     *
+     * @return Status_t - STATUS_OUT_OF_BOUNDS if the device has less than two
+     * sectors
+     */
+    Status_t mount(void);
+
+    /**
+     * @brief Appends one record. The record is buffered and reaches flash
+     * when its page fills or on flush(). If the record does not fit the
+     * current sector the next sector is erased, dropping its pending records.
+     *
+     * @param data - record payload
+     * @param length - 1 to FLASH_RING_LOG_MAX_RECORD_SIZE bytes
+     * @return Status_t - STATUS_OUT_OF_BOUNDS for an invalid length
+     */
+    Status_t append(const uint8_t * data, uint16_t length);
+
+    /**
+     * @brief Programs the buffered part of the current page.
+     */
+    Status_t flush(void);
+
+    /**
+     * @brief Reads the oldest pending record without removing it. Records
+     * that fail the crc are skipped.
+     *
+     * @param data - destination
+     * @param capacity - size of the destination
+     * @param length - populated with the record length, 0 if nothing is pending
+     * @return Status_t - STATUS_OUT_OF_BOUNDS if the record does not fit
+     */
+    Status_t peek(uint8_t * data, uint16_t capacity, uint16_t * length);
+
+    /**
+     * @brief Marks the record returned by the last peek() as replayed.
+     *
+     * @return Status_t - STATUS_UNKNOWN if there was no peek() since the last
+     * consume() or the record was overwritten in between
+     */
+    Status_t consume(void);
+
+    uint32_t getPendingCount(void) const { return stats.recordsPending; }
+
+    Status_t getStats(FlashRingLogStats_t * stats);
+
+private:
+    FlashDevice & flash;
+    bool mounted;
+
+    /** @brief  Write position, sectors are opened in index order
+     */
+    uint16_t headSector;
+    uint32_t headSequence;
+    uint32_t writeOffset;
+
+    /** @brief  Page being filled, bytes below pageWritten are programmed
+     *  and bytes up to pageFill are waiting in ram
+     */
+    uint8_t page[FLASH_PAGE_SIZE];
+    uint32_t pageBase;
+    uint16_t pageWritten;
+    uint16_t pageFill;
+
+    /** @brief  Replay cursor at the oldest record not yet replayed
+     */
+    uint16_t readSector;
+    uint32_t readOffset;
+    uint32_t peekedSize;
+
+    FlashRingLogStats_t stats;
+
+    uint32_t sectorBase(uint16_t sector) const { return (uint32_t)sector * FLASH_SECTOR_SIZE; }
+    uint16_t nextSector(uint16_t sector) const { return (uint16_t)((sector + 1u) % stats.sectorCount); }
+    Status_t startSector(uint16_t sector);
+    Status_t openNextSector(void);
+    Status_t putBytes(const uint8_t * data, uint32_t length);
+    Status_t writePage(void);
+    Status_t readRecordHeader(uint16_t sector, uint32_t offset, uint16_t * length,
+                              uint16_t * crc, uint32_t * state);
+    uint32_t countPending(uint16_t sector, uint32_t offset, uint32_t endOffset);
+};
+
+/*******************************************************************************
+ * EXPORTED VARIABLES
+*******************************************************************************/
+
+/*******************************************************************************
+ * GLOBAL FUNCTION PROTOTYPES
+*******************************************************************************/
+
+
+#endif // FLASH_RING_LOG_HPP
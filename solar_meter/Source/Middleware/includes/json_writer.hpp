@@ -0,0 +1,159 @@
+/**
+ *******************************************************************************
+ * @file    json_writer.hpp
+ * @author  hq
+ * @date    2025-07-30 20:05:14
+ * @brief   Streaming JSON writer. Tokens are written straight into a caller
+ *  provided buffer, there is no heap use and no document tree. When a sink
+ *  is set a full buffer is handed to the sink and writing continues from the
+ *  start of the buffer, so documents larger than the buffer can be streamed.
+ *  Numbers are formatted with integer code only.
+ *******************************************************************************
+ */
+
+#ifndef JSON_WRITER_HPP
+#define JSON_WRITER_HPP
+
+/*******************************************************************************
+ * INCLUDES
+*******************************************************************************/
+#include "common.h"
+#include "typedefs.h"
+
+/*******************************************************************************
+ * MACROS AND DEFINES
+*******************************************************************************/
+#define JSON_WRITER_MAX_DEPTH           (32u)   /* one bit of nesting state per level  */
+#define JSON_WRITER_MAX_DECIMALS        (6u)
+
+/*******************************************************************************
+ * TYPEDEFS
+*******************************************************************************/
+
+/** @brief  Receives a full buffer, or the remainder on finish()
+ *
+ *  @param context - context passed to setSink()
+ *  @param data - bytes written since the previous chunk
+ *  @param length - number of bytes
+ *  @return Status_t - any error stops the writer
+ */
+typedef Status_t (*JsonWriterSink_t)(void * context, const uint8_t * data, uint16_t length);
+
+class JsonWriter
+{
+public:
+    JsonWriter();
+    ~JsonWriter() = default;
+
+    /**
+     * @brief Starts a new document in the given buffer.
+     *
+     * @param buffer - destination, owned by the caller
+     * @param capacity - size of the destination
+     */
+    void begin(uint8_t * buffer, uint16_t capacity);
+
+    /**
+     * @brief Sets where full chunks go. Without a sink, writing past the end
+     * of the buffer fails with STATUS_OUT_OF_BOUNDS.
+     */
+    void setSink(JsonWriterSink_t sink, void * context);
+
+    void beginObject(void);
+    void endObject(void);
+    void beginArray(void);
+    void endArray(void);
+
+    /**
+     * @brief Writes an object key, the next write is its value.
+     */
+    void writeKey(const char * key);
+
+    /**
+     * @brief Writes a quoted string, quotes, backslashes and control
+     * characters are escaped.
+     */
+    void writeString(const char * value);
+    void writeInt(int32_t value);
+    void writeUint(uint32_t value);
+    void writeNull(void);
+
+    /**
+     * @brief Writes a fixed point number, 12345 with 3 decimals is written
+     * as 12.345.
+     *
+     * @param value - value scaled by 10^decimals
+     * @param decimals - digits after the point, at most JSON_WRITER_MAX_DECIMALS
+     */
+    void writeFixed(int32_t value, uint8_t decimals);
+
+    /**
+     * @brief Writes a float rounded to a number of decimals. The float is
+     * scaled to an integer once, the digits are produced by writeFixed().
+     * Values that do not fit the scaled integer, NaN and infinity are written
+     * as null.
+     */
+    void writeFloat(float value, uint8_t decimals);
+
+    /**
+     * @brief Writes bytes as a quoted base64 string.
+     */
+    void writeBase64(const uint8_t * data, uint16_t length);
+
+    /**
+     * @brief Hands the bytes still in the buffer to the sink, if one is set.
+     *
+     * @return Status_t - first error seen by the writer, STATUS_OKAY otherwise
+     */
+    Status_t finish(void);
+
+    /**
+     * @brief Returns the bytes in the buffer that were not handed to the sink.
+     */
+    uint16_t getLength(void) const { return length; }
+
+    /**
+     * @brief Returns all bytes written since begin(), sink chunks included.
+     */
+    uint32_t getTotalLength(void) const { return flushedLength + length; }
+
+    /**
+     * @brief Returns the first error, errors are sticky until begin().
+     */
+    Status_t getStatus(void) const { return status; }
+
+private:
+    uint8_t * buffer;
+    uint16_t capacity;
+    uint16_t length;
+    uint32_t flushedLength;
+    Status_t status;
+
+    JsonWriterSink_t sink;
+    void * sinkContext;
+
+    /** @brief  Nesting state, bit n is set once level n has a member so the
+     *  next member at that level is preceded by a comma.
+     */
+    uint32_t hasMember;
+    uint8_t depth;
+    bool afterKey;
+
+    void put(char character);
+    void putText(const char * text, uint16_t textLength);
+    void putDigits(uint32_t value, uint8_t minDigits);
+    void beginValue(void);
+    void open(char character);
+    void close(char character);
+};
+
+/*******************************************************************************
+ * EXPORTED VARIABLES
+*******************************************************************************/
+
+/*******************************************************************************
+ * GLOBAL FUNCTION PROTOTYPES
+*******************************************************************************/
+
+
+#endif // JSON_WRITER_HPP
@@ -0,0 +1,218 @@
+/**
+ *******************************************************************************
+ * @file    message_bus.hpp
+ * @author  hq
+ * @date    2025-08-10 16:08:52
+ * @brief   Typed publish/subscribe topics with a subscriber set fixed at
+ *  compile time. A topic is declared with its payload type and the types of
+ *  its subscribers, publish() copies the payload once into a pooled block
+ *  and hands every subscriber a read only view of that same block. The calls
+ *  are resolved statically, there is no registration and no virtual call.
+ *
+ *      typedef Topic<Sample_t, Logger, Uplink> SampleTopic;
+ *      SampleTopic topic(logger, uplink);
+ *      topic.publish(sample);  // logger.onPublish(view); uplink.onPublish(view);
+ *******************************************************************************
+ */
+
+#ifndef MESSAGE_BUS_HPP
+#define MESSAGE_BUS_HPP
+
+/*******************************************************************************
+ * INCLUDES
+*******************************************************************************/
+#include "common.h"
+#include "typedefs.h"
+#include "message_pool.hpp"
+
+#include <string.h>
+
+extern "C"
+{
+    #include "freertos/FreeRTOS.h"
+    #include "freertos/task.h"
+}
+
+/*******************************************************************************
+ * MACROS AND DEFINES
+*******************************************************************************/
+
+/*******************************************************************************
+ * TYPEDEFS
+*******************************************************************************/
+typedef struct
+{
+    uint32_t published;
+    uint32_t poolFailures;              /**< samples lost with the pool exhausted   */
+} TopicStats_t;
+
+/**
+ * @brief Read only view of a published sample. The view is only valid inside
+ * onPublish(). A subscriber that works on the sample later, e.g. from its
+ * own queue, keeps the block with retain() and hands it back with
+ * messagePool.release() once done.
+ */
+template <typename Payload>
+class Sample
+{
+public:
+    explicit Sample(MessageBuffer_t * buffer) : buffer(buffer) {}
+
+    const Payload & get(void) const { return *reinterpret_cast<const Payload *>(buffer->data); }
+    const Payload * operator->() const { return reinterpret_cast<const Payload *>(buffer->data); }
+
+    /**
+     * @brief Adds a reference for a consumer that outlives the call.
+     *
+     * @return MessageBuffer_t * - block to release when done
+     */
+    MessageBuffer_t * retain(void) const
+    {
+        messagePool.retain(buffer);
+        return buffer;
+    }
+
+    /**
+     * @brief Payload of a block kept with retain().
+     */
+    static const Payload & of(const MessageBuffer_t * buffer)
+    {
+        return *reinterpret_cast<const Payload *>(buffer->data);
+    }
+
+private:
+    MessageBuffer_t * buffer;
+};
+
+/*  compile time list of subscriber references, deliver() unrolls into one
+    direct call per subscriber */
+template <typename Payload, typename... Subscribers>
+class SubscriberList;
+
+template <typename Payload>
+class SubscriberList<Payload>
+{
+public:
+    void deliver(const Sample<Payload> & sample) { (void)sample; }
+};
+
+template <typename Payload, typename First, typename... Rest>
+class SubscriberList<Payload, First, Rest...>
+{
+public:
+    SubscriberList(First & first, Rest &... rest) : first(first), rest(rest...) {}
+
+    void deliver(const Sample<Payload> & sample)
+    {
+        first.onPublish(sample);
+        rest.deliver(sample);
+    }
+
+private:
+    First & first;
+    SubscriberList<Payload, Rest...> rest;
+};
+
+/**
+ * @brief Topic carrying Payload to a fixed set of subscribers. Each
+ * subscriber type provides void onPublish(const Sample<Payload> &), a type
+ * subscribed to several topics overloads it per payload.
+ *
+ * Subscribers run on the publishing task in the order they are listed and
+ * must return quickly, slow work is moved to their own task with retain().
+ * Payload must be plain data, it is copied with memcpy.
+ */
+template <typename Payload, typename... Subscribers>
+class Topic
+{
+    static_assert(sizeof(Payload) <= MESSAGE_POOL_LARGE_BLOCK_SIZE,
+                  "Topic payload larger than the largest message pool block");
+
+public:
+    Topic(Subscribers &... subscribers) : subscribers(subscribers...)
+    {
+        memset(&stats, 0, sizeof(stats));
+    }
+
+    /**
+     * @brief Copies the payload into a pooled block and delivers it to every
+     * subscriber, the block returns to the pool once the last retained
+     * reference is released.
+     *
+     * @param payload - sample to publish
+     * @return Status_t - STATUS_POOL_EXHAUSTED if no block was free
+     */
+    Status_t publish(const Payload & payload)
+    {
+        Status_t status = STATUS_OKAY;
+        MessageBuffer_t * buffer = messagePool.allocate(sizeof(Payload));
+
+        if (CHECK_POINTER_VALID(buffer) == false)
+        {
+            status = STATUS_POOL_EXHAUSTED;
+        }
+
+        if (status == STATUS_OKAY)
+        {
+            memcpy(buffer->data, &payload, sizeof(Payload));
+            buffer->length = sizeof(Payload);
+
+            subscribers.deliver(Sample<Payload>(buffer));
+
+            /*! - drop the publisher reference, retained views keep the block */
+            messagePool.release(buffer);
+        }
+
+        taskENTER_CRITICAL();
+        if (status == STATUS_OKAY)
+        {
+            stats.published++;
+        }
+        else
+        {
+            stats.poolFailures++;
+        }
+        taskEXIT_CRITICAL();
+
+        return status;
+    }
+
+    /**
+     * @brief Returns a snapshot of the publish counters.
+     *
+     * @param _stats - pointer populated with the counters
+     * @return Status_t
+     */
+    Status_t getStats(TopicStats_t * _stats)
+    {
+        Status_t status = STATUS_OKAY;
+
+        if (CHECK_POINTER_VALID(_stats) == false)
+        {
+            status = STATUS_NULL_POINTER;
+        }
+        else
+        {
+            taskENTER_CRITICAL();
+            *_stats = stats;
+            taskEXIT_CRITICAL();
+        }
+
+        return status;
+    }
+
+private:
+    SubscriberList<Payload, Subscribers...> subscribers;
+    TopicStats_t stats;
+};
+
+/*******************************************************************************
+ * EXPORTED VARIABLES
+*******************************************************************************/
+
+/*******************************************************************************
+ * GLOBAL FUNCTION PROTOTYPES
+*******************************************************************************/
+
+
+#endif // MESSAGE_BUS_HPP
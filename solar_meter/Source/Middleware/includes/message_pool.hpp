@@ -0,0 +1,129 @@
+/**
+ *******************************************************************************
+ * @file    message_pool.hpp
+ * @author  hq
+ * @date    2025-07-27 14:22:31
+ * @brief   Fixed block, reference counted message buffers. Blocks come from
+ *  a few statically sized classes so memory use is bounded and the heap is
+ *  never touched. A producer fills a buffer in place and hands its reference
+ *  to the networking queue, the last release returns it to its class.
+ *******************************************************************************
+ */
+
+#ifndef MESSAGE_POOL_HPP
+#define MESSAGE_POOL_HPP
+
+/*******************************************************************************
+ * INCLUDES
+*******************************************************************************/
+#include "common.h"
+#include "typedefs.h"
+
+/*******************************************************************************
+ * MACROS AND DEFINES
+*******************************************************************************/
+#define MESSAGE_POOL_SMALL_BLOCK_SIZE       (16u)       /* scalar values            */
+#define MESSAGE_POOL_SMALL_BLOCK_COUNT      (32u)
+#define MESSAGE_POOL_MEDIUM_BLOCK_SIZE      (64u)       /* small records            */
+#define MESSAGE_POOL_MEDIUM_BLOCK_COUNT     (8u)
+#define MESSAGE_POOL_LARGE_BLOCK_SIZE       (528u)      /* capture blobs, batches   */
+#define MESSAGE_POOL_LARGE_BLOCK_COUNT      (2u)
+
+/*******************************************************************************
+ * TYPEDEFS
+*******************************************************************************/
+typedef enum : uint8_t
+{
+    MESSAGE_POOL_CLASS_SMALL,
+    MESSAGE_POOL_CLASS_MEDIUM,
+    MESSAGE_POOL_CLASS_LARGE,
+
+    TOTAL_MESSAGE_POOL_CLASSES
+} MessagePoolClass_t;
+
+typedef struct MessageBuffer
+{
+    uint8_t * data;                     /**< block storage, capacity bytes          */
+    uint16_t capacity;                  /**< block size of the class                */
+    uint16_t length;                    /**< bytes filled in by the producer        */
+    uint8_t refCount;
+    MessagePoolClass_t sizeClass;
+    struct MessageBuffer * next;        /**< free list link while not allocated     */
+} MessageBuffer_t;
+
+typedef struct
+{
+    uint16_t blockSize;
+    uint16_t blockCount;
+    uint16_t inUse;
+    uint16_t peakInUse;
+    uint32_t allocations;
+    uint32_t failures;                  /**< requests that found the class empty    */
+} MessagePoolStats_t;
+
+class MessagePool
+{
+public:
+    MessagePool();
+    ~MessagePool() = default;
+
+    /**
+     * @brief Takes a block from the smallest class that fits, larger classes
+     * are used if the best fit class is empty.
+     *
+     * @param size - bytes the producer needs
+     * @return MessageBuffer_t * - buffer with one reference and zero length,
+     * nullptr if no class can serve the request
+     */
+    MessageBuffer_t * allocate(uint16_t size);
+
+    /**
+     * @brief Adds a reference for an additional consumer of the buffer.
+     */
+    void retain(MessageBuffer_t * buffer);
+
+    /**
+     * @brief Drops a reference, the block returns to its class when the
+     * last reference is released.
+     */
+    void release(MessageBuffer_t * buffer);
+
+    /**
+     * @brief Returns the usage counters of one size class.
+     *
+     * @param sizeClass - class to report
+     * @param stats - pointer populated with the counters
+     * @return Status_t - STATUS_OUT_OF_BOUNDS for an unknown class
+     */
+    Status_t getStats(MessagePoolClass_t sizeClass, MessagePoolStats_t * stats);
+
+private:
+    MessageBuffer_t * freeList[TOTAL_MESSAGE_POOL_CLASSES];
+    MessagePoolStats_t stats[TOTAL_MESSAGE_POOL_CLASSES];
+
+    MessageBuffer_t smallBuffers[MESSAGE_POOL_SMALL_BLOCK_COUNT];
+    MessageBuffer_t mediumBuffers[MESSAGE_POOL_MEDIUM_BLOCK_COUNT];
+    MessageBuffer_t largeBuffers[MESSAGE_POOL_LARGE_BLOCK_COUNT];
+
+    /*  block sizes are multiples of 4, so with aligned storage every block
+        can hold a typed topic payload in place */
+    alignas(4) uint8_t smallStorage[MESSAGE_POOL_SMALL_BLOCK_COUNT][MESSAGE_POOL_SMALL_BLOCK_SIZE];
+    alignas(4) uint8_t mediumStorage[MESSAGE_POOL_MEDIUM_BLOCK_COUNT][MESSAGE_POOL_MEDIUM_BLOCK_SIZE];
+    alignas(4) uint8_t largeStorage[MESSAGE_POOL_LARGE_BLOCK_COUNT][MESSAGE_POOL_LARGE_BLOCK_SIZE];
+
+    void initClass(MessagePoolClass_t sizeClass, MessageBuffer_t * buffers,
+                   uint8_t * storage, uint16_t blockSize, uint16_t blockCount);
+};
+
+/*******************************************************************************
+ * EXPORTED VARIABLES
+*******************************************************************************/
+/*  message pool shared by all producers and the networking module */
+extern MessagePool messagePool;
+
+/*******************************************************************************
+ * GLOBAL FUNCTION PROTOTYPES
+*******************************************************************************/
+
+
+#endif // MESSAGE_POOL_HPP
@@ -0,0 +1,167 @@
+/**
+ *******************************************************************************
+ * @file    metrics_writer.hpp
+ * @author  hq
+ * @date    2025-08-06 18:41:07
+ * @brief   Streaming metrics writer. Samples are formatted straight into a
+ *  caller provided buffer, either as Prometheus text exposition or as a
+ *  compact binary record stream, and a full buffer is handed to a sink so a
+ *  scrape of any size passes through a few hundred bytes of RAM.
+ *******************************************************************************
+ */
+
+#ifndef METRICS_WRITER_HPP
+#define METRICS_WRITER_HPP
+
+/*******************************************************************************
+ * INCLUDES
+*******************************************************************************/
+#include "common.h"
+#include "typedefs.h"
+
+/*******************************************************************************
+ * MACROS AND DEFINES
+*******************************************************************************/
+#define METRICS_BINARY_VERSION          (1u)
+#define METRICS_WRITER_MAX_DECIMALS     (6u)
+
+/*******************************************************************************
+ * TYPEDEFS
+*******************************************************************************/
+typedef enum : uint8_t
+{
+    METRICS_FORMAT_TEXT,                /**< Prometheus text exposition 0.0.4       */
+    METRICS_FORMAT_BINARY,              /**< records described at MetricsWriter     */
+} MetricsFormat_t;
+
+typedef enum : uint8_t
+{
+    METRICS_TYPE_GAUGE,
+    METRICS_TYPE_COUNTER,
+} MetricsType_t;
+
+typedef enum : uint8_t
+{
+    METRICS_VALUE_UINT,                 /**< varint                                 */
+    METRICS_VALUE_FLOAT,                /**< 32 bit float, little endian            */
+} MetricsValue_t;
+
+/** @brief  Receives a full buffer, or the remainder on finish()
+ *
+ *  @param context - context passed to setSink()
+ *  @param data - bytes written since the previous chunk
+ *  @param length - number of bytes
+ *  @return Status_t - any error stops the writer
+ */
+typedef Status_t (*MetricsWriterSink_t)(void * context, const uint8_t * data, uint16_t length);
+
+/**
+ * @brief Writes metric families and their samples.
+ *
+ * Text, one line per sample:
+ *  # HELP name help
+ *  # TYPE name gauge|counter
+ *  name{labels} value
+ *
+ * Binary, little endian:
+ *  [0]     METRICS_BINARY_VERSION
+ *  then per sample
+ *  MetricsType_t, MetricsValue_t, varint name length, name,
+ *  varint labels length, labels in text form, value
+ */
+class MetricsWriter
+{
+public:
+    MetricsWriter();
+    ~MetricsWriter() = default;
+
+    /**
+     * @brief Starts a new scrape in the given buffer, the binary version
+     * byte is written right away.
+     *
+     * @param buffer - destination, owned by the caller
+     * @param capacity - size of the destination
+     * @param format - encoding of the scrape
+     */
+    void begin(uint8_t * buffer, uint16_t capacity, MetricsFormat_t format);
+
+    /**
+     * @brief Sets where full chunks go. Without a sink, writing past the end
+     * of the buffer fails with STATUS_OUT_OF_BOUNDS.
+     */
+    void setSink(MetricsWriterSink_t sink, void * context);
+
+    /**
+     * @brief Starts a metric family, the samples that follow belong to it.
+     *
+     * @param name - metric name, [a-zA-Z_:][a-zA-Z0-9_:]*
+     * @param type - gauge or counter, counters end in _total by convention
+     * @param help - one line description, text format only
+     */
+    void family(const char * name, MetricsType_t type, const char * help);
+
+    /**
+     * @brief Writes a sample of the current family.
+     *
+     * @param value - sample value
+     * @param labels - label pairs without braces, e.g. class="small",
+     * nullptr for none
+     */
+    void writeUint(uint64_t value, const char * labels = nullptr);
+
+    /**
+     * @brief Writes a float sample rounded to a number of decimals in text,
+     * the binary format keeps the float as is. NaN and infinity are written
+     * as NaN in text.
+     */
+    void writeFloat(float value, uint8_t decimals, const char * labels = nullptr);
+
+    /**
+     * @brief Hands the bytes still in the buffer to the sink, if one is set.
+     *
+     * @return Status_t - first error seen by the writer, STATUS_OKAY otherwise
+     */
+    Status_t finish(void);
+
+    /**
+     * @brief Returns all bytes written since begin(), sink chunks included.
+     */
+    uint32_t getTotalLength(void) const { return flushedLength + length; }
+
+    /**
+     * @brief Returns the first error, errors are sticky until begin().
+     */
+    Status_t getStatus(void) const { return status; }
+
+private:
+    uint8_t * buffer;
+    uint16_t capacity;
+    uint16_t length;
+    uint32_t flushedLength;
+    Status_t status;
+    MetricsFormat_t format;
+
+    MetricsWriterSink_t sink;
+    void * sinkContext;
+
+    const char * familyName;
+    MetricsType_t familyType;
+
+    void put(char character);
+    void putText(const char * text);
+    void putDigits(uint64_t value, uint8_t minDigits);
+    void putVarint(uint64_t value);
+    void putString(const char * text);
+    void beginSample(MetricsValue_t valueType, const char * labels);
+};
+
+/*******************************************************************************
+ * EXPORTED VARIABLES
+*******************************************************************************/
+
+/*******************************************************************************
+ * GLOBAL FUNCTION PROTOTYPES
+*******************************************************************************/
+
+
+#endif // METRICS_WRITER_HPP
@@ -0,0 +1,176 @@
+/**
+ *******************************************************************************
+ * @file    persistent_config.hpp
+ * @author  hq
+ * @date    2025-08-14 20:27:39
+ * @brief   Loads the device_config_t record at boot. The stored blob is a
+ *  header followed by the record in its in memory layout, it is read into
+ *  place in one access and only checked, nothing is parsed. A record of an
+ *  older version is completed with the defaults of the fields it lacks and
+ *  written back at the current version.
+ *******************************************************************************
+ */
+
+#ifndef PERSISTENT_CONFIG_HPP
+#define PERSISTENT_CONFIG_HPP
+
+/*******************************************************************************
+ * INCLUDES
+*******************************************************************************/
+#include "common.h"
+#include "typedefs.h"
+#include "device_config.h"
+#include "rtc_memory.hpp"
+
+/*******************************************************************************
+ * MACROS AND DEFINES
+*******************************************************************************/
+#define PERSISTENT_CONFIG_NAMESPACE     "devcfg"
+#define PERSISTENT_CONFIG_KEY           "record"
+
+/*  largest blob read, header and payload. The room after the current
+    payload takes the fields a newer firmware appended, kept on a downgrade */
+#define PERSISTENT_CONFIG_MAX_SIZE      (128u)
+
+/*  the copy kept across deep sleep, at the end of the rtc memory */
+#define PERSISTENT_CONFIG_RTC_SIZE      (sizeof(device_config_header_t) + sizeof(device_config_t))
+#define PERSISTENT_CONFIG_RTC_OFFSET    (RTC_MEMORY_SIZE - PERSISTENT_CONFIG_RTC_SIZE)
+
+#define PERSISTENT_CONFIG_MAX_GPIO      (15u)       /* gpio16 has no open drain */
+#define PERSISTENT_CONFIG_MAX_QUEUE     (64u)
+
+/*******************************************************************************
+ * TYPEDEFS
+*******************************************************************************/
+/**
+ * @brief Where the record is kept, the nvs implementation is used on the
+ * device, a ram one runs the load and migration on the host.
+ */
+class ConfigStore
+{
+public:
+    virtual ~ConfigStore() = default;
+
+    /**
+     * @brief Reads the stored blob.
+     *
+     * @param data - buffer for the blob
+     * @param length - buffer size in, blob size out, also set if it does
+     * not fit
+     * @return Status_t - STATUS_UNKNOWN if nothing is stored,
+     * STATUS_OUT_OF_BOUNDS if the blob does not fit
+     */
+    virtual Status_t read(void * data, uint32_t * length) = 0;
+
+    /**
+     * @brief Replaces the stored blob.
+     */
+    virtual Status_t write(const void * data, uint32_t length) = 0;
+};
+
+/**
+ * @brief ConfigStore in one nvs blob, nvs_flash_init() has to be called
+ * before it is used.
+ */
+class NvsConfigStore : public ConfigStore
+{
+public:
+    NvsConfigStore(const char * _nameSpace, const char * _key);
+    ~NvsConfigStore() = default;
+
+    Status_t read(void * data, uint32_t * length) override;
+    Status_t write(const void * data, uint32_t length) override;
+
+private:
+    const char * nameSpace;
+    const char * key;
+};
+
+class PersistentConfig
+{
+public:
+    PersistentConfig();
+    ~PersistentConfig() = default;
+
+    /**
+     * @brief Loads the stored record, call before the modules that use it
+     * are initialized. On any error the defaults stay in use.
+     *
+     * @param store - where the record is kept
+     * @return Status_t - STATUS_UNKNOWN if no record was stored, the
+     * defaults are written, STATUS_MEMCMP_FAIL for a bad magic, length or
+     * crc, STATUS_OUT_OF_BOUNDS if a field is out of range
+     */
+    Status_t load(ConfigStore & store);
+
+    /**
+     * @brief Takes the configuration from the copy cache() left in rtc
+     * memory, so a deep sleep wake needs no nvs access.
+     *
+     * @param rtcMemory - memory the copy is kept in
+     * @return Status_t - STATUS_MEMCMP_FAIL if there is no valid copy, the
+     * configuration in use is not changed
+     */
+    Status_t loadCached(RtcMemory & rtcMemory);
+
+    /**
+     * @brief Keeps a copy of the configuration in use in rtc memory for
+     * loadCached(). A record saved later is only used after a power loss.
+     */
+    Status_t cache(RtcMemory & rtcMemory);
+
+    /**
+     * @brief Stores a record at the current version. The firmware keeps
+     * running with the loaded one, the new one takes effect at the next boot.
+     *
+     * @param store - where the record is kept
+     * @param config - record to store
+     * @return Status_t - STATUS_OUT_OF_BOUNDS if a field is out of range
+     */
+    Status_t save(ConfigStore & store, const device_config_t * config);
+
+    /**
+     * @brief Returns the configuration in use.
+     */
+    const device_config_t & get(void) const;
+
+    /**
+     * @brief Returns the compiled in defaults.
+     */
+    static const device_config_t & getDefaults(void);
+
+private:
+    /*  the blob as stored, the payload is read straight into config */
+    typedef struct
+    {
+        device_config_header_t header;
+        device_config_t config;
+        uint8_t spare[PERSISTENT_CONFIG_MAX_SIZE - sizeof(device_config_header_t) - sizeof(device_config_t)];
+    } PersistentConfigRecord_t;
+
+    /*  the current payload behind its header, as written and cached */
+    typedef struct
+    {
+        device_config_header_t header;
+        device_config_t config;
+    } PersistentConfigBlob_t;
+
+    PersistentConfigRecord_t record;
+
+    static Status_t validate(const device_config_t * config);
+    Status_t check(uint32_t blobLength);
+    static void makeBlob(PersistentConfigBlob_t * blob, const device_config_t * config);
+    static Status_t writeRecord(ConfigStore & store, const device_config_t * config);
+};
+
+/*******************************************************************************
+ * EXPORTED VARIABLES
+*******************************************************************************/
+extern PersistentConfig persistentConfig;
+
+/*******************************************************************************
+ * GLOBAL FUNCTION PROTOTYPES
+*******************************************************************************/
+
+
+#endif // PERSISTENT_CONFIG_HPP
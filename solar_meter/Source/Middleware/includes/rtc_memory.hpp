@@ -0,0 +1,77 @@
+/**
+ *******************************************************************************
+ * @file    rtc_memory.hpp
+ * @author  hq
+ * @date    2025-08-12 19:14:26
+ * @brief   Memory that keeps its contents through deep sleep but not through
+ *  a power loss. The system implementation maps it onto the RTC slow memory,
+ *  a ram implementation of the same interface lets the wake cycle be
+ *  simulated. Contents are undefined after power up, users validate them.
+ *******************************************************************************
+ */
+
+#ifndef RTC_MEMORY_HPP
+#define RTC_MEMORY_HPP
+
+/*******************************************************************************
+ * INCLUDES
+*******************************************************************************/
+#include "common.h"
+#include "typedefs.h"
+
+/*******************************************************************************
+ * MACROS AND DEFINES
+*******************************************************************************/
+#define RTC_MEMORY_SIZE                 (256u)      /* of the 512 byte user area */
+#define RTC_MEMORY_ALIGNMENT            (4u)        /* only word access         */
+
+/*******************************************************************************
+ * TYPEDEFS
+*******************************************************************************/
+class RtcMemory
+{
+public:
+    virtual ~RtcMemory() = default;
+
+    /**
+     * @brief Returns the usable size in bytes.
+     */
+    virtual uint32_t getSize(void) const = 0;
+
+    /**
+     * @brief Reads bytes, offset and length are multiples of
+     * RTC_MEMORY_ALIGNMENT.
+     */
+    virtual Status_t read(uint32_t offset, void * data, uint32_t length) = 0;
+
+    /**
+     * @brief Writes bytes, offset and length are multiples of
+     * RTC_MEMORY_ALIGNMENT.
+     */
+    virtual Status_t write(uint32_t offset, const void * data, uint32_t length) = 0;
+};
+
+/**
+ * @brief RtcMemory in the RTC slow memory, placed there by the linker.
+ */
+class SystemRtcMemory : public RtcMemory
+{
+public:
+    SystemRtcMemory() = default;
+    ~SystemRtcMemory() = default;
+
+    uint32_t getSize(void) const override;
+    Status_t read(uint32_t offset, void * data, uint32_t length) override;
+    Status_t write(uint32_t offset, const void * data, uint32_t length) override;
+};
+
+/*******************************************************************************
+ * EXPORTED VARIABLES
+*******************************************************************************/
+
+/*******************************************************************************
+ * GLOBAL FUNCTION PROTOTYPES
+*******************************************************************************/
+
+
+#endif // RTC_MEMORY_HPP
@@ -0,0 +1,127 @@
+/**
+ *******************************************************************************
+ * @file    socket_stream.hpp
+ * @author  hq
+ * @date    2025-08-03 16:48:09
+ * @brief   Byte stream interface used by protocol clients, with a TCP
+ *  implementation on lwip sockets and a listener for local servers.
+ *******************************************************************************
+ */
+
+#ifndef SOCKET_STREAM_HPP
+#define SOCKET_STREAM_HPP
+
+/*******************************************************************************
+ * INCLUDES
+*******************************************************************************/
+#include "common.h"
+#include "typedefs.h"
+
+/*******************************************************************************
+ * MACROS AND DEFINES
+*******************************************************************************/
+
+/*******************************************************************************
+ * TYPEDEFS
+*******************************************************************************/
+class ByteStream
+{
+public:
+    virtual ~ByteStream() = default;
+
+    /**
+     * @brief Opens the stream to a host, closes a previous connection first.
+     *
+     * @param host - dotted ipv4 address
+     * @param port - tcp port
+     * @return Status_t - STATUS_HAL_ERROR if the connection fails
+     */
+    virtual Status_t openStream(const char * host, uint16_t port) = 0;
+    virtual void closeStream(void) = 0;
+
+    /**
+     * @brief Sends all bytes or fails.
+     */
+    virtual Status_t sendBytes(const uint8_t * data, uint16_t length) = 0;
+
+    /**
+     * @brief Receives what is available, waiting up to timeoutMs for the
+     * first byte.
+     *
+     * @param length - populated with the bytes received, 0 on timeout
+     * @return Status_t - STATUS_HAL_ERROR if the stream is closed or failed
+     */
+    virtual Status_t receiveBytes(uint8_t * data, uint16_t capacity, uint16_t * length,
+                                  uint32_t timeoutMs) = 0;
+};
+
+/**
+ * @brief ByteStream on an lwip TCP socket
+ */
+class SocketStream : public ByteStream
+{
+public:
+    SocketStream();
+    ~SocketStream();
+
+    Status_t openStream(const char * host, uint16_t port) override;
+    void closeStream(void) override;
+    Status_t sendBytes(const uint8_t * data, uint16_t length) override;
+    Status_t receiveBytes(uint8_t * data, uint16_t capacity, uint16_t * length,
+                     uint32_t timeoutMs) override;
+
+    /**
+     * @brief Takes over a connected socket, closes a previous connection
+     * first. Used by SocketListener for accepted connections.
+     */
+    void attachSocket(int socketFd);
+
+private:
+    int socketFd;
+};
+
+/**
+ * @brief Listening lwip TCP socket handing accepted connections to a
+ * SocketStream
+ */
+class SocketListener
+{
+public:
+    SocketListener();
+    ~SocketListener();
+
+    /**
+     * @brief Binds to a port on all interfaces and starts listening, closes
+     * a previous listener first.
+     *
+     * @param port - tcp port
+     * @param backlog - connections the stack queues while one is served
+     * @return Status_t - STATUS_HAL_ERROR if the port can not be bound
+     */
+    Status_t listenOn(uint16_t port, uint8_t backlog);
+    void closeListener(void);
+
+    /**
+     * @brief Waits up to timeoutMs for a connection and attaches it to the
+     * stream.
+     *
+     * @param stream - stream the connection is attached to
+     * @param accepted - populated with false on timeout
+     * @return Status_t - STATUS_HAL_ERROR if the listener failed
+     */
+    Status_t acceptStream(SocketStream & stream, bool * accepted, uint32_t timeoutMs);
+
+private:
+    int listenFd;
+};
+
+/*******************************************************************************
+ * EXPORTED VARIABLES
+*******************************************************************************/
+
+/*******************************************************************************
+ * GLOBAL FUNCTION PROTOTYPES
+*******************************************************************************/
+
+
+#endif // SOCKET_STREAM_HPP
@@ -0,0 +1,126 @@
+/**
+ *******************************************************************************
+ * @file    timeseries_codec.hpp
+ * @author  hq
+ * @date    2025-07-31 19:26:40
+ * @brief   Bit packed time series codec in the style of Gorilla. Timestamps
+ *  are stored as delta of delta and fixed point values as the zigzag delta
+ *  to the previous value. Both use a short prefix that selects the payload
+ *  width, so a periodic sample of a slow signal takes only a few bits. The
+ *  encoder and decoder hold a fixed amount of state and work on caller
+ *  buffers.
+ *******************************************************************************
+ */
+
+#ifndef TIMESERIES_CODEC_HPP
+#define TIMESERIES_CODEC_HPP
+
+/*******************************************************************************
+ * INCLUDES
+*******************************************************************************/
+#include "common.h"
+#include "typedefs.h"
+
+/*******************************************************************************
+ * MACROS AND DEFINES
+*******************************************************************************/
+#define TIMESERIES_MAX_SAMPLE_BITS      (72u)   /* 36 bit timestamp, 36 bit value   */
+#define TIMESERIES_MAX_SAMPLE_BYTES     ((TIMESERIES_MAX_SAMPLE_BITS + 7u) / 8u)
+
+/*******************************************************************************
+ * TYPEDEFS
+*******************************************************************************/
+class TimeSeriesEncoder
+{
+public:
+    TimeSeriesEncoder();
+    ~TimeSeriesEncoder() = default;
+
+    /**
+     * @brief Starts a new series in the given buffer.
+     *
+     * @param buffer - destination, owned by the caller
+     * @param capacity - size of the destination
+     */
+    void begin(uint8_t * buffer, uint16_t capacity);
+
+    /**
+     * @brief Appends one sample. The first sample is stored in full, later
+     * ones relative to the samples before them.
+     *
+     * @param timestamp - sample time in ticks
+     * @param value - fixed point sample value
+     * @return Status_t - STATUS_OUT_OF_BOUNDS if the buffer is full, the
+     * series then ends with the previous sample
+     */
+    Status_t append(uint32_t timestamp, int32_t value);
+
+    /**
+     * @brief Pads the last byte with zeros.
+     *
+     * @return uint16_t - length of the series in bytes
+     */
+    uint16_t finish(void);
+
+    uint16_t getSampleCount(void) const { return sampleCount; }
+
+private:
+    uint8_t * buffer;
+    uint16_t capacity;
+    uint32_t bitIndex;
+    uint16_t sampleCount;
+
+    uint32_t previousTimestamp;
+    uint32_t previousDelta;
+    int32_t previousValue;
+
+    void putBits(uint32_t value, uint8_t bitCount);
+};
+
+class TimeSeriesDecoder
+{
+public:
+    TimeSeriesDecoder();
+    ~TimeSeriesDecoder() = default;
+
+    /**
+     * @brief Starts reading a series written by TimeSeriesEncoder.
+     */
+    void begin(const uint8_t * buffer, uint16_t length);
+
+    /**
+     * @brief Reads the next sample. The caller knows the sample count, the
+     * padding of the last byte is not a sample.
+     *
+     * @return Status_t - STATUS_OUT_OF_BOUNDS if the series ends early
+     */
+    Status_t next(uint32_t * timestamp, int32_t * value);
+
+    /**
+     * @brief Returns the bytes consumed so far, rounded up to whole bytes.
+     */
+    uint16_t getLength(void) const { return (uint16_t)((bitIndex + 7u) / 8u); }
+
+private:
+    const uint8_t * buffer;
+    uint16_t length;
+    uint32_t bitIndex;
+    uint16_t sampleCount;
+
+    uint32_t previousTimestamp;
+    uint32_t previousDelta;
+    int32_t previousValue;
+
+    Status_t getBits(uint8_t bitCount, uint32_t * value);
+};
+
+/*******************************************************************************
+ * EXPORTED VARIABLES
+*******************************************************************************/
+
+/*******************************************************************************
+ * GLOBAL FUNCTION PROTOTYPES
+*******************************************************************************/
+
+
+#endif // TIMESERIES_CODEC_HPP
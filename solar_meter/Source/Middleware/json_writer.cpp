@@ -0,0 +1,357 @@
+/**
+ *******************************************************************************
+ * @file    json_writer.cpp
+ * @author  hq
+ * @date    2025-07-30 20:05:14
+ * @brief   Streaming JSON writer source file
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * INCLUDES
+ *******************************************************************************/
+#include "json_writer.hpp"
+
+#include <string.h>
+
+/*******************************************************************************
+ * EXTERN VARIABLES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * PRIVATE MACROS AND DEFINES
+ *******************************************************************************/
+#define UINT32_MAX_DIGITS       (10u)
+
+/*******************************************************************************
+ * PRIVATE TYPEDEFS
+ *******************************************************************************/
+
+/*******************************************************************************
+ * STATIC VARIABLES
+ *******************************************************************************/
+static const uint32_t powersOfTen[JSON_WRITER_MAX_DECIMALS + 1u] =
+{
+    1u, 10u, 100u, 1000u, 10000u, 100000u, 1000000u
+};
+
+static const char hexDigits[] = "0123456789abcdef";
+
+static const char base64Alphabet[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+/*******************************************************************************
+ * GLOBAL VARIABLES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * STATIC FUNCTION PROTOTYPES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * STATIC FUNCTIONS
+ *******************************************************************************/
+/*!
+ * \brief appends one byte, a full buffer goes to the sink first
+ */
+void JsonWriter::put(char character)
+{
+    if ((status == STATUS_OKAY) && (length >= capacity))
+    {
+        if (CHECK_POINTER_VALID(sink) == false)
+        {
+            status = STATUS_OUT_OF_BOUNDS;
+        }
+        else
+        {
+            status = sink(sinkContext, buffer, length);
+            flushedLength += length;
+            length = 0u;
+        }
+    }
+
+    if (status == STATUS_OKAY)
+    {
+        buffer[length++] = (uint8_t)character;
+    }
+}
+
+void JsonWriter::putText(const char * text, uint16_t textLength)
+{
+    for (uint16_t i = 0u; (i < textLength) && (status == STATUS_OKAY); i++)
+    {
+        put(text[i]);
+    }
+}
+
+/*!
+ * \brief writes an unsigned value in decimal, zero padded to minDigits
+ */
+void JsonWriter::putDigits(uint32_t value, uint8_t minDigits)
+{
+    char digits[UINT32_MAX_DIGITS];
+    uint8_t count = 0u;
+
+    /*! - digits come out least significant first   */
+    do
+    {
+        digits[count++] = (char)('0' + (value % 10u));
+        value /= 10u;
+    } while ((value > 0u) || (count < minDigits));
+
+    while (count > 0u)
+    {
+        put(digits[--count]);
+    }
+}
+
+/*!
+ * \brief separates the value from the previous member unless it follows a key
+ */
+void JsonWriter::beginValue(void)
+{
+    if (afterKey)
+    {
+        afterKey = false;
+    }
+    else if (depth > 0u)
+    {
+        uint32_t levelBit = 1u << (depth - 1u);
+
+        if (hasMember & levelBit)
+        {
+            put(',');
+        }
+        hasMember |= levelBit;
+    }
+}
+
+void JsonWriter::open(char character)
+{
+    beginValue();
+
+    if (depth >= JSON_WRITER_MAX_DEPTH)
+    {
+        status = STATUS_OUT_OF_BOUNDS;
+    }
+    else
+    {
+        put(character);
+        depth++;
+        hasMember &= ~(1u << (depth - 1u));
+    }
+}
+
+void JsonWriter::close(char character)
+{
+    if (depth == 0u)
+    {
+        status = STATUS_OUT_OF_BOUNDS;
+    }
+    else
+    {
+        depth--;
+        put(character);
+    }
+}
+
+/*******************************************************************************
+ * GLOBAL FUNCTIONS
+ *******************************************************************************/
+JsonWriter::JsonWriter() : buffer(nullptr),
+                           capacity(0u),
+                           length(0u),
+                           flushedLength(0u),
+                           status(STATUS_NULL_POINTER),
+                           sink(nullptr),
+                           sinkContext(nullptr),
+                           hasMember(0u),
+                           depth(0u),
+                           afterKey(false)
+{
+}
+
+void JsonWriter::begin(uint8_t * _buffer, uint16_t _capacity)
+{
+    buffer = _buffer;
+    capacity = _capacity;
+    length = 0u;
+    flushedLength = 0u;
+    hasMember = 0u;
+    depth = 0u;
+    afterKey = false;
+    status = (CHECK_POINTER_VALID(_buffer) && (_capacity > 0u)) ? STATUS_OKAY : STATUS_NULL_POINTER;
+}
+
+void JsonWriter::setSink(JsonWriterSink_t _sink, void * context)
+{
+    sink = _sink;
+    sinkContext = context;
+}
+
+void JsonWriter::beginObject(void)
+{
+    open('{');
+}
+
+void JsonWriter::endObject(void)
+{
+    close('}');
+}
+
+void JsonWriter::beginArray(void)
+{
+    open('[');
+}
+
+void JsonWriter::endArray(void)
+{
+    close(']');
+}
+
+void JsonWriter::writeKey(const char * key)
+{
+    writeString(key);
+    put(':');
+    afterKey = true;
+}
+
+void JsonWriter::writeString(const char * value)
+{
+    beginValue();
+    put('"');
+
+    for (const char * c = value; CHECK_POINTER_VALID(c) && (*c != '\0') && (status == STATUS_OKAY); c++)
+    {
+        uint8_t character = (uint8_t)*c;
+
+        if ((character == '"') || (character == '\\'))
+        {
+            put('\\');
+            put((char)character);
+        }
+        else if (character < 0x20u)
+        {
+            /*! - control characters as \u00XX */
+            putText("\\u00", 4u);
+            put(hexDigits[character >> 4]);
+            put(hexDigits[character & 0x0Fu]);
+        }
+        else
+        {
+            put((char)character);
+        }
+    }
+
+    put('"');
+}
+
+void JsonWriter::writeInt(int32_t value)
+{
+    beginValue();
+
+    if (value < 0)
+    {
+        put('-');
+    }
+    /*  negate in unsigned so INT32_MIN does not overflow */
+    putDigits((value < 0) ? (0u - (uint32_t)value) : (uint32_t)value, 1u);
+}
+
+void JsonWriter::writeUint(uint32_t value)
+{
+    beginValue();
+    putDigits(value, 1u);
+}
+
+void JsonWriter::writeNull(void)
+{
+    beginValue();
+    putText("null", 4u);
+}
+
+void JsonWriter::writeFixed(int32_t value, uint8_t decimals)
+{
+    uint32_t magnitude = (value < 0) ? (0u - (uint32_t)value) : (uint32_t)value;
+
+    if (decimals > JSON_WRITER_MAX_DECIMALS)
+    {
+        decimals = JSON_WRITER_MAX_DECIMALS;
+    }
+
+    beginValue();
+
+    if (value < 0)
+    {
+        put('-');
+    }
+
+    putDigits(magnitude / powersOfTen[decimals], 1u);
+
+    if (decimals > 0u)
+    {
+        put('.');
+        putDigits(magnitude % powersOfTen[decimals], decimals);
+    }
+}
+
+void JsonWriter::writeFloat(float value, uint8_t decimals)
+{
+    float scaled;
+
+    if (decimals > JSON_WRITER_MAX_DECIMALS)
+    {
+        decimals = JSON_WRITER_MAX_DECIMALS;
+    }
+
+    scaled = value * (float)powersOfTen[decimals];
+
+    /*  the compares are false for NaN as well   */
+    if ((scaled < 2147483520.0f) && (scaled > -2147483520.0f))
+    {
+        writeFixed((int32_t)((scaled < 0.0f) ? (scaled - 0.5f) : (scaled + 0.5f)), decimals);
+    }
+    else
+    {
+        writeNull();
+    }
+}
+
+void JsonWriter::writeBase64(const uint8_t * data, uint16_t dataLength)
+{
+    beginValue();
+    put('"');
+
+    for (uint16_t i = 0u; (i < dataLength) && (status == STATUS_OKAY); i += 3u)
+    {
+        uint32_t triple = (uint32_t)data[i] << 16;
+
+        if ((i + 1u) < dataLength)
+        {
+            triple |= (uint32_t)data[i + 1u] << 8;
+        }
+        if ((i + 2u) < dataLength)
+        {
+            triple |= data[i + 2u];
+        }
+
+        put(base64Alphabet[(triple >> 18) & 0x3Fu]);
+        put(base64Alphabet[(triple >> 12) & 0x3Fu]);
+        put(((i + 1u) < dataLength) ? base64Alphabet[(triple >> 6) & 0x3Fu] : '=');
+        put(((i + 2u) < dataLength) ? base64Alphabet[triple & 0x3Fu] : '=');
+    }
+
+    put('"');
+}
+
+Status_t JsonWriter::finish(void)
+{
+    if ((status == STATUS_OKAY) && CHECK_POINTER_VALID(sink) && (length > 0u))
+    {
+        status = sink(sinkContext, buffer, length);
+        flushedLength += length;
+        length = 0u;
+    }
+
+    return status;
+}
@@ -0,0 +1,184 @@
+/**
+ *******************************************************************************
+ * @file    message_pool.cpp
+ * @author  hq
+ * @date    2025-07-27 14:22:31
+ * @brief   Message pool source file
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * INCLUDES
+ *******************************************************************************/
+#include "message_pool.hpp"
+
+extern "C"
+{
+    #include "freertos/task.h"
+    #include "esp_log.h"
+}
+
+/*******************************************************************************
+ * EXTERN VARIABLES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * PRIVATE MACROS AND DEFINES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * PRIVATE TYPEDEFS
+ *******************************************************************************/
+
+/*******************************************************************************
+ * STATIC VARIABLES
+ *******************************************************************************/
+static const char *TAG = "MessagePool";
+
+/*******************************************************************************
+ * GLOBAL VARIABLES
+ *******************************************************************************/
+MessagePool messagePool;
+
+/*******************************************************************************
+ * STATIC FUNCTION PROTOTYPES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * STATIC FUNCTIONS
+ *******************************************************************************/
+void MessagePool::initClass(MessagePoolClass_t sizeClass, MessageBuffer_t * buffers,
+                            uint8_t * storage, uint16_t blockSize, uint16_t blockCount)
+{
+    freeList[sizeClass] = nullptr;
+
+    /*! - thread every block of the class onto its free list  */
+    for (uint16_t i = 0u; i < blockCount; i++)
+    {
+        buffers[i].data = &storage[i * blockSize];
+        buffers[i].capacity = blockSize;
+        buffers[i].length = 0u;
+        buffers[i].refCount = 0u;
+        buffers[i].sizeClass = sizeClass;
+        buffers[i].next = freeList[sizeClass];
+        freeList[sizeClass] = &buffers[i];
+    }
+
+    memset(&stats[sizeClass], 0, sizeof(MessagePoolStats_t));
+    stats[sizeClass].blockSize = blockSize;
+    stats[sizeClass].blockCount = blockCount;
+}
+
+/*******************************************************************************
+ * GLOBAL FUNCTIONS
+ *******************************************************************************/
+MessagePool::MessagePool()
+{
+    initClass(MESSAGE_POOL_CLASS_SMALL, smallBuffers, &smallStorage[0][0],
+              MESSAGE_POOL_SMALL_BLOCK_SIZE, MESSAGE_POOL_SMALL_BLOCK_COUNT);
+    initClass(MESSAGE_POOL_CLASS_MEDIUM, mediumBuffers, &mediumStorage[0][0],
+              MESSAGE_POOL_MEDIUM_BLOCK_SIZE, MESSAGE_POOL_MEDIUM_BLOCK_COUNT);
+    initClass(MESSAGE_POOL_CLASS_LARGE, largeBuffers, &largeStorage[0][0],
+              MESSAGE_POOL_LARGE_BLOCK_SIZE, MESSAGE_POOL_LARGE_BLOCK_COUNT);
+}
+
+MessageBuffer_t * MessagePool::allocate(uint16_t size)
+{
+    MessageBuffer_t * buffer = nullptr;
+    bool fits = false;
+
+    taskENTER_CRITICAL();
+
+    for (uint8_t sizeClass = 0u; (sizeClass < TOTAL_MESSAGE_POOL_CLASSES) && (buffer == nullptr); sizeClass++)
+    {
+        if (size <= stats[sizeClass].blockSize)
+        {
+            /*! - count the miss against the best fit class only   */
+            if ((freeList[sizeClass] == nullptr) && (fits == false))
+            {
+                stats[sizeClass].failures++;
+            }
+
+            fits = true;
+            buffer = freeList[sizeClass];
+        }
+
+        if (buffer != nullptr)
+        {
+            freeList[sizeClass] = buffer->next;
+            buffer->next = nullptr;
+            buffer->refCount = 1u;
+            buffer->length = 0u;
+
+            stats[sizeClass].allocations++;
+            stats[sizeClass].inUse++;
+            if (stats[sizeClass].inUse > stats[sizeClass].peakInUse)
+            {
+                stats[sizeClass].peakInUse = stats[sizeClass].inUse;
+            }
+        }
+    }
+
+    taskEXIT_CRITICAL();
+
+    if (buffer == nullptr)
+    {
+        ESP_LOGW(TAG, "Error: %i, size %u", STATUS_POOL_EXHAUSTED, size);
+    }
+
+    return buffer;
+}
+
+void MessagePool::retain(MessageBuffer_t * buffer)
+{
+    if (CHECK_POINTER_VALID(buffer))
+    {
+        taskENTER_CRITICAL();
+        buffer->refCount++;
+        taskEXIT_CRITICAL();
+    }
+}
+
+void MessagePool::release(MessageBuffer_t * buffer)
+{
+    if (CHECK_POINTER_VALID(buffer))
+    {
+        taskENTER_CRITICAL();
+
+        if (buffer->refCount > 0u)
+        {
+            buffer->refCount--;
+
+            if (buffer->refCount == 0u)
+            {
+                buffer->next = freeList[buffer->sizeClass];
+                freeList[buffer->sizeClass] = buffer;
+                stats[buffer->sizeClass].inUse--;
+            }
+        }
+
+        taskEXIT_CRITICAL();
+    }
+}
+
+Status_t MessagePool::getStats(MessagePoolClass_t sizeClass, MessagePoolStats_t * _stats)
+{
+    Status_t status = STATUS_OKAY;
+
+    if (CHECK_POINTER_VALID(_stats) == false)
+    {
+        status = STATUS_NULL_POINTER;
+    }
+    else if (sizeClass >= TOTAL_MESSAGE_POOL_CLASSES)
+    {
+        status = STATUS_OUT_OF_BOUNDS;
+    }
+    else
+    {
+        taskENTER_CRITICAL();
+        *_stats = stats[sizeClass];
+        taskEXIT_CRITICAL();
+    }
+
+    return status;
+}
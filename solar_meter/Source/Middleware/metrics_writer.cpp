@@ -0,0 +1,307 @@
+/**
+ *******************************************************************************
+ * @file    metrics_writer.cpp
+ * @author  hq
+ * @date    2025-08-06 18:41:07
+ * @brief   Streaming metrics writer source file
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * INCLUDES
+ *******************************************************************************/
+#include "metrics_writer.hpp"
+
+#include <string.h>
+
+/*******************************************************************************
+ * EXTERN VARIABLES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * PRIVATE MACROS AND DEFINES
+ *******************************************************************************/
+#define UINT64_MAX_DIGITS       (20u)
+
+/*******************************************************************************
+ * PRIVATE TYPEDEFS
+ *******************************************************************************/
+
+/*******************************************************************************
+ * STATIC VARIABLES
+ *******************************************************************************/
+static const uint32_t powersOfTen[METRICS_WRITER_MAX_DECIMALS + 1u] =
+{
+    1u, 10u, 100u, 1000u, 10000u, 100000u, 1000000u
+};
+
+static const char * const typeNames[] =
+{
+    "gauge",
+    "counter",
+};
+
+/*******************************************************************************
+ * GLOBAL VARIABLES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * STATIC FUNCTION PROTOTYPES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * STATIC FUNCTIONS
+ *******************************************************************************/
+/*!
+ * \brief appends one byte, a full buffer goes to the sink first
+ */
+void MetricsWriter::put(char character)
+{
+    if ((status == STATUS_OKAY) && (length >= capacity))
+    {
+        if (CHECK_POINTER_VALID(sink) == false)
+        {
+            status = STATUS_OUT_OF_BOUNDS;
+        }
+        else
+        {
+            status = sink(sinkContext, buffer, length);
+            flushedLength += length;
+            length = 0u;
+        }
+    }
+
+    if (status == STATUS_OKAY)
+    {
+        buffer[length++] = (uint8_t)character;
+    }
+}
+
+void MetricsWriter::putText(const char * text)
+{
+    while ((*text != '\0') && (status == STATUS_OKAY))
+    {
+        put(*text++);
+    }
+}
+
+/*!
+ * \brief writes an unsigned value in decimal, zero padded to minDigits
+ */
+void MetricsWriter::putDigits(uint64_t value, uint8_t minDigits)
+{
+    char digits[UINT64_MAX_DIGITS];
+    uint8_t count = 0u;
+
+    /*! - digits come out least significant first   */
+    do
+    {
+        digits[count++] = (char)('0' + (value % 10u));
+        value /= 10u;
+    } while ((value > 0u) || (count < minDigits));
+
+    while (count > 0u)
+    {
+        put(digits[--count]);
+    }
+}
+
+void MetricsWriter::putVarint(uint64_t value)
+{
+    while (value >= 0x80u)
+    {
+        put((char)((value & 0x7Fu) | 0x80u));
+        value >>= 7;
+    }
+    put((char)value);
+}
+
+/*!
+ * \brief writes a length prefixed string of the binary format
+ */
+void MetricsWriter::putString(const char * text)
+{
+    if (CHECK_POINTER_VALID(text))
+    {
+        putVarint(strlen(text));
+        putText(text);
+    }
+    else
+    {
+        putVarint(0u);
+    }
+}
+
+/*!
+ * \brief writes everything of a sample that comes before its value
+ */
+void MetricsWriter::beginSample(MetricsValue_t valueType, const char * labels)
+{
+    if (CHECK_POINTER_VALID(familyName) == false)
+    {
+        status = (status == STATUS_OKAY) ? STATUS_NULL_POINTER : status;
+    }
+    else if (format == METRICS_FORMAT_BINARY)
+    {
+        put((char)familyType);
+        put((char)valueType);
+        putString(familyName);
+        putString(labels);
+    }
+    else
+    {
+        putText(familyName);
+
+        if (CHECK_POINTER_VALID(labels))
+        {
+            put('{');
+            putText(labels);
+            put('}');
+        }
+
+        put(' ');
+    }
+}
+
+/*******************************************************************************
+ * GLOBAL FUNCTIONS
+ *******************************************************************************/
+MetricsWriter::MetricsWriter() : buffer(nullptr),
+                                 capacity(0u),
+                                 length(0u),
+                                 flushedLength(0u),
+                                 status(STATUS_NULL_POINTER),
+                                 format(METRICS_FORMAT_TEXT),
+                                 sink(nullptr),
+                                 sinkContext(nullptr),
+                                 familyName(nullptr),
+                                 familyType(METRICS_TYPE_GAUGE)
+{
+}
+
+void MetricsWriter::begin(uint8_t * _buffer, uint16_t _capacity, MetricsFormat_t _format)
+{
+    buffer = _buffer;
+    capacity = _capacity;
+    length = 0u;
+    flushedLength = 0u;
+    format = _format;
+    familyName = nullptr;
+    status = (CHECK_POINTER_VALID(_buffer) && (_capacity > 0u)) ? STATUS_OKAY : STATUS_NULL_POINTER;
+
+    if (format == METRICS_FORMAT_BINARY)
+    {
+        put((char)METRICS_BINARY_VERSION);
+    }
+}
+
+void MetricsWriter::setSink(MetricsWriterSink_t _sink, void * context)
+{
+    sink = _sink;
+    sinkContext = context;
+}
+
+void MetricsWriter::family(const char * name, MetricsType_t type, const char * help)
+{
+    familyName = name;
+    familyType = type;
+
+    /*! - the binary records carry the type, help stays on the host   */
+    if ((format == METRICS_FORMAT_TEXT) && CHECK_POINTER_VALID(name))
+    {
+        if (CHECK_POINTER_VALID(help))
+        {
+            putText("# HELP ");
+            putText(name);
+            put(' ');
+            putText(help);
+            put('\n');
+        }
+
+        putText("# TYPE ");
+        putText(name);
+        put(' ');
+        putText(typeNames[type]);
+        put('\n');
+    }
+}
+
+void MetricsWriter::writeUint(uint64_t value, const char * labels)
+{
+    beginSample(METRICS_VALUE_UINT, labels);
+
+    if (format == METRICS_FORMAT_BINARY)
+    {
+        putVarint(value);
+    }
+    else
+    {
+        putDigits(value, 1u);
+        put('\n');
+    }
+}
+
+void MetricsWriter::writeFloat(float value, uint8_t decimals, const char * labels)
+{
+    beginSample(METRICS_VALUE_FLOAT, labels);
+
+    if (format == METRICS_FORMAT_BINARY)
+    {
+        uint8_t bytes[sizeof(float)];
+
+        memcpy(bytes, &value, sizeof(float));
+        for (uint8_t i = 0u; i < sizeof(float); i++)
+        {
+            put((char)bytes[i]);
+        }
+    }
+    else
+    {
+        float scaled;
+
+        if (decimals > METRICS_WRITER_MAX_DECIMALS)
+        {
+            decimals = METRICS_WRITER_MAX_DECIMALS;
+        }
+
+        scaled = value * (float)powersOfTen[decimals];
+
+        /*  the compares are false for NaN as well   */
+        if ((scaled < 2147483520.0f) && (scaled > -2147483520.0f))
+        {
+            int32_t rounded = (int32_t)((scaled < 0.0f) ? (scaled - 0.5f) : (scaled + 0.5f));
+            uint32_t magnitude = (rounded < 0) ? (0u - (uint32_t)rounded) : (uint32_t)rounded;
+
+            if (rounded < 0)
+            {
+                put('-');
+            }
+
+            putDigits(magnitude / powersOfTen[decimals], 1u);
+
+            if (decimals > 0u)
+            {
+                put('.');
+                putDigits(magnitude % powersOfTen[decimals], decimals);
+            }
+        }
+        else
+        {
+            putText("NaN");
+        }
+
+        put('\n');
+    }
+}
+
+Status_t MetricsWriter::finish(void)
+{
+    if ((status == STATUS_OKAY) && CHECK_POINTER_VALID(sink) && (length > 0u))
+    {
+        status = sink(sinkContext, buffer, length);
+        flushedLength += length;
+        length = 0u;
+    }
+
+    return status;
+}
@@ -0,0 +1,418 @@
+/**
+ *******************************************************************************
+ * @file    persistent_config.cpp
+ * @author  hq
+ * @date    2025-08-14 20:27:39
+ * @brief   Persistent config source file
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * INCLUDES
+ *******************************************************************************/
+#include "persistent_config.hpp"
+#include "crc.h"
+
+#include <string.h>
+
+extern "C"
+{
+    #include "freertos/FreeRTOS.h"
+    #include "freertos/task.h"
+    #include "esp_log.h"
+    #include "nvs.h"
+}
+
+/*******************************************************************************
+ * EXTERN VARIABLES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * PRIVATE MACROS AND DEFINES
+ *******************************************************************************/
+#define HEADER_SIZE     (sizeof(device_config_header_t))
+#define CONFIG_SIZE     (sizeof(device_config_t))
+
+/*  a field added without a version bump would be read from the wrong place */
+#define DEVICE_CONFIG_V1_SIZE   (20u)
+static_assert(CONFIG_SIZE == DEVICE_CONFIG_V1_SIZE, "device_config_t changed, bump DEVICE_CONFIG_VERSION");
+
+/*******************************************************************************
+ * PRIVATE TYPEDEFS
+ *******************************************************************************/
+
+/*******************************************************************************
+ * STATIC VARIABLES
+ *******************************************************************************/
+static const char *TAG = "PersistentConfig";
+
+/*  the values the firmware was written with */
+static const device_config_t defaultConfig =
+{
+    5u,                     /* i2cSclIo                 */
+    4u,                     /* i2cSdaIo                 */
+    300u,                   /* i2cClkStretchTicks, about 210 us */
+    10u,                    /* i2cQueueLength           */
+    2000u,                  /* i2cQueueTimeoutMs        */
+    1000u,                  /* i2cCommandTimeoutMs      */
+    10u,                    /* adsQueueTimeoutMs        */
+    1000u,                  /* adsNotifyTimeoutMs       */
+    32u,                    /* networkingQueueLength    */
+    5u,                     /* i2cTaskPriority          */
+    ESP_NORMAL_PRIORITY,    /* dispatcherPriority       */
+    ESP_LOW_PRIORITY,       /* networkingPriority       */
+    0u,
+};
+
+/*******************************************************************************
+ * GLOBAL VARIABLES
+ *******************************************************************************/
+PersistentConfig persistentConfig;
+
+/*******************************************************************************
+ * STATIC FUNCTION PROTOTYPES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * STATIC FUNCTIONS
+ *******************************************************************************/
+
+/*!
+ * \brief Range check of every field, a record that passes can be used as is.
+ */
+Status_t PersistentConfig::validate(const device_config_t * config)
+{
+    Status_t status = STATUS_OKAY;
+
+    if (CHECK_POINTER_VALID(config) == false)
+    {
+        status = STATUS_NULL_POINTER;
+    }
+    else if (    (config->i2cSclIo > PERSISTENT_CONFIG_MAX_GPIO)
+              || (config->i2cSdaIo > PERSISTENT_CONFIG_MAX_GPIO)
+              || (config->i2cSclIo == config->i2cSdaIo)
+              || (config->i2cClkStretchTicks == 0u))
+    {
+        status = STATUS_OUT_OF_BOUNDS;
+    }
+    else if (    (config->i2cQueueLength == 0u)
+              || (config->i2cQueueLength > PERSISTENT_CONFIG_MAX_QUEUE)
+              || (config->networkingQueueLength == 0u)
+              || (config->networkingQueueLength > PERSISTENT_CONFIG_MAX_QUEUE))
+    {
+        status = STATUS_OUT_OF_BOUNDS;
+    }
+    else if (    (config->i2cQueueTimeoutMs == 0u)
+              || (config->i2cCommandTimeoutMs == 0u)
+              || (config->adsQueueTimeoutMs == 0u)
+              || (config->adsNotifyTimeoutMs == 0u))
+    {
+        status = STATUS_OUT_OF_BOUNDS;
+    }
+    else if (    (config->i2cTaskPriority == 0u)
+              || (config->i2cTaskPriority >= configMAX_PRIORITIES)
+              || (config->dispatcherPriority == 0u)
+              || (config->dispatcherPriority >= configMAX_PRIORITIES)
+              || (config->networkingPriority == 0u)
+              || (config->networkingPriority >= configMAX_PRIORITIES))
+    {
+        status = STATUS_OUT_OF_BOUNDS;
+    }
+
+    return status;
+}
+
+/*!
+ * \brief Checks the blob read into record and completes an older payload
+ * with the defaults of the fields appended since.
+ *
+ * \param blobLength - bytes read from the store
+ * \return Status_t - STATUS_MEMCMP_FAIL if the header does not match the
+ * blob or the crc fails, STATUS_OUT_OF_BOUNDS if a field is out of range
+ */
+Status_t PersistentConfig::check(uint32_t blobLength)
+{
+    static_assert(sizeof(PersistentConfigRecord_t) == PERSISTENT_CONFIG_MAX_SIZE,
+                  "padding between config and spare, a newer payload would be read apart");
+
+    Status_t status = STATUS_OKAY;
+    const device_config_header_t * header = &record.header;
+    uint32_t length = header->length;
+
+    /*! - a payload is never shorter than the version 1 layout, an older
+          version is shorter and a newer one longer than the current one.
+          The crc covers the whole stored payload, also the newer fields
+          that run on into spare */
+    if (    (blobLength < (HEADER_SIZE + DEVICE_CONFIG_V1_SIZE))
+         || (header->magic != DEVICE_CONFIG_MAGIC)
+         || (length != (blobLength - HEADER_SIZE))
+         || ((header->version < DEVICE_CONFIG_VERSION) && (length >= CONFIG_SIZE))
+         || ((header->version == DEVICE_CONFIG_VERSION) && (length != CONFIG_SIZE))
+         || ((header->version > DEVICE_CONFIG_VERSION) && (length <= CONFIG_SIZE)))
+    {
+        status = STATUS_MEMCMP_FAIL;
+    }
+    else if (crc_crc16(CRC16_INIT, (const uint8_t *)&record.config, length) != header->crc)
+    {
+        status = STATUS_MEMCMP_FAIL;
+    }
+    else
+    {
+        if (length < CONFIG_SIZE)
+        {
+            memcpy((uint8_t *)&record.config + length,
+                   (const uint8_t *)&defaultConfig + length,
+                   CONFIG_SIZE - length);
+        }
+
+        status = validate(&record.config);
+    }
+
+    return status;
+}
+
+/*!
+ * \brief Puts the header of the current version in front of a record.
+ */
+void PersistentConfig::makeBlob(PersistentConfigBlob_t * blob, const device_config_t * config)
+{
+    blob->header.magic = DEVICE_CONFIG_MAGIC;
+    blob->header.version = DEVICE_CONFIG_VERSION;
+    blob->header.length = CONFIG_SIZE;
+    blob->header.reserved = 0u;
+    blob->config = *config;
+    blob->header.crc = crc_crc16(CRC16_INIT, (const uint8_t *)&blob->config, CONFIG_SIZE);
+}
+
+Status_t PersistentConfig::writeRecord(ConfigStore & store, const device_config_t * config)
+{
+    Status_t status = validate(config);
+    PersistentConfigBlob_t blob;
+
+    if (status == STATUS_OKAY)
+    {
+        makeBlob(&blob, config);
+        status = store.write(&blob, sizeof(blob));
+    }
+
+    return status;
+}
+
+/*******************************************************************************
+ * GLOBAL FUNCTIONS
+ *******************************************************************************/
+NvsConfigStore::NvsConfigStore(const char * _nameSpace, const char * _key) : nameSpace(_nameSpace),
+                                                                            key(_key)
+{
+}
+
+Status_t NvsConfigStore::read(void * data, uint32_t * length)
+{
+    Status_t status = STATUS_OKAY;
+
+    if ((CHECK_POINTER_VALID(data) == false) || (CHECK_POINTER_VALID(length) == false))
+    {
+        status = STATUS_NULL_POINTER;
+    }
+    else
+    {
+        nvs_handle handle;
+        size_t size = 0u;
+        esp_err_t err = nvs_open(nameSpace, NVS_READONLY, &handle);
+
+        /*! - the size is asked for first, a blob longer than the buffer is
+              reported with its length instead of failing the read */
+        if (err == ESP_OK)
+        {
+            err = nvs_get_blob(handle, key, NULL, &size);
+
+            if ((err == ESP_OK) && (size > *length))
+            {
+                err = ESP_ERR_NVS_INVALID_LENGTH;
+            }
+
+            if (err == ESP_OK)
+            {
+                err = nvs_get_blob(handle, key, data, &size);
+            }
+
+            nvs_close(handle);
+        }
+
+        /*! - the namespace does not exist either before the first write */
+        if (err == ESP_OK)
+        {
+            *length = size;
+        }
+        else if (err == ESP_ERR_NVS_NOT_FOUND)
+        {
+            status = STATUS_UNKNOWN;
+        }
+        else if (err == ESP_ERR_NVS_INVALID_LENGTH)
+        {
+            *length = size;
+            status = STATUS_OUT_OF_BOUNDS;
+        }
+        else
+        {
+            status = STATUS_HAL_ERROR;
+        }
+    }
+
+    return status;
+}
+
+Status_t NvsConfigStore::write(const void * data, uint32_t length)
+{
+    Status_t status = STATUS_OKAY;
+
+    if (CHECK_POINTER_VALID(data) == false)
+    {
+        status = STATUS_NULL_POINTER;
+    }
+    else
+    {
+        nvs_handle handle;
+        esp_err_t err = nvs_open(nameSpace, NVS_READWRITE, &handle);
+
+        if (err == ESP_OK)
+        {
+            err = nvs_set_blob(handle, key, data, length);
+
+            if (err == ESP_OK)
+            {
+                err = nvs_commit(handle);
+            }
+
+            nvs_close(handle);
+        }
+
+        if (err != ESP_OK)
+        {
+            status = STATUS_HAL_ERROR;
+        }
+    }
+
+    return status;
+}
+
+PersistentConfig::PersistentConfig()
+{
+    memset(&record, 0, sizeof(record));
+    record.config = defaultConfig;
+}
+
+Status_t PersistentConfig::load(ConfigStore & store)
+{
+    uint32_t blobLength = sizeof(record);
+    Status_t status = store.read(&record, &blobLength);
+
+    if (status == STATUS_OKAY)
+    {
+        status = check(blobLength);
+    }
+
+    if (status != STATUS_OKAY)
+    {
+        record.config = defaultConfig;
+    }
+
+    if (status == STATUS_OKAY)
+    {
+        /*! - a newer record is used as far as this firmware knows it and
+              left as is, so its fields survive a downgrade    */
+        if (record.header.version < DEVICE_CONFIG_VERSION)
+        {
+            ESP_LOGI(TAG, "migrating version %u to %u", record.header.version, DEVICE_CONFIG_VERSION);
+
+            if (writeRecord(store, &record.config) != STATUS_OKAY)
+            {
+                ESP_LOGE(TAG, "migrated record not saved");
+            }
+        }
+    }
+    else if (status == STATUS_UNKNOWN)
+    {
+        ESP_LOGI(TAG, "no record, storing the defaults");
+
+        if (writeRecord(store, &defaultConfig) != STATUS_OKAY)
+        {
+            ESP_LOGE(TAG, "default record not saved");
+        }
+    }
+    else if (status == STATUS_OUT_OF_BOUNDS)
+    {
+        ESP_LOGE(TAG, "record of %u bytes does not fit in %u", blobLength, (uint32_t)sizeof(record));
+    }
+    else
+    {
+        /*! - a bad record is kept for inspection, it is replaced by save() */
+        ESP_LOGE(TAG, "Error: %i", status);
+    }
+
+    return status;
+}
+
+Status_t PersistentConfig::loadCached(RtcMemory & rtcMemory)
+{
+    static_assert((PERSISTENT_CONFIG_RTC_SIZE % RTC_MEMORY_ALIGNMENT) == 0u,
+                  "cached configuration not a multiple of the rtc word size");
+    static_assert(sizeof(PersistentConfigBlob_t) == PERSISTENT_CONFIG_RTC_SIZE,
+                  "cached configuration has padding");
+
+    PersistentConfigBlob_t blob;
+    Status_t status = rtcMemory.read(PERSISTENT_CONFIG_RTC_OFFSET, &blob, sizeof(blob));
+
+    /*! - rtc memory is undefined after a power loss, only a copy of the
+          current version is taken */
+    if (status == STATUS_OKAY)
+    {
+        if (    (blob.header.magic != DEVICE_CONFIG_MAGIC)
+             || (blob.header.version != DEVICE_CONFIG_VERSION)
+             || (blob.header.length != CONFIG_SIZE)
+             || (crc_crc16(CRC16_INIT, (const uint8_t *)&blob.config, CONFIG_SIZE) != blob.header.crc))
+        {
+            status = STATUS_MEMCMP_FAIL;
+        }
+        else
+        {
+            status = validate(&blob.config);
+        }
+    }
+
+    if (status == STATUS_OKAY)
+    {
+        record.config = blob.config;
+    }
+
+    return status;
+}
+
+Status_t PersistentConfig::cache(RtcMemory & rtcMemory)
+{
+    PersistentConfigBlob_t blob;
+
+    makeBlob(&blob, &record.config);
+
+    return rtcMemory.write(PERSISTENT_CONFIG_RTC_OFFSET, &blob, sizeof(blob));
+}
+
+Status_t PersistentConfig::save(ConfigStore & store, const device_config_t * config)
+{
+    return writeRecord(store, config);
+}
+
+const device_config_t & PersistentConfig::get(void) const
+{
+    return record.config;
+}
+
+const device_config_t & PersistentConfig::getDefaults(void)
+{
+    return defaultConfig;
+}
+
+extern "C" const device_config_t * deviceConfig_get(void)
+{
+    return &persistentConfig.get();
+}
@@ -0,0 +1,124 @@
+/**
+ *******************************************************************************
+ * @file    rtc_memory.cpp
+ * @author  hq
+ * @date    2025-08-12 19:14:26
+ * @brief   Rtc memory source file
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * INCLUDES
+ *******************************************************************************/
+#include "rtc_memory.hpp"
+
+#include <string.h>
+
+extern "C"
+{
+    #include "esp_attr.h"
+}
+
+/*******************************************************************************
+ * EXTERN VARIABLES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * PRIVATE MACROS AND DEFINES
+ *******************************************************************************/
+#define RTC_MEMORY_WORDS                (RTC_MEMORY_SIZE / RTC_MEMORY_ALIGNMENT)
+
+/*******************************************************************************
+ * PRIVATE TYPEDEFS
+ *******************************************************************************/
+
+/*******************************************************************************
+ * STATIC VARIABLES
+ *******************************************************************************/
+
+/*  not cleared by the startup code, survives deep sleep */
+static RTC_DATA_ATTR uint32_t rtcWords[RTC_MEMORY_WORDS];
+
+/*******************************************************************************
+ * GLOBAL VARIABLES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * STATIC FUNCTION PROTOTYPES
+ *******************************************************************************/
+static bool checkRange(uint32_t offset, uint32_t length);
+
+/*******************************************************************************
+ * STATIC FUNCTIONS
+ *******************************************************************************/
+static bool checkRange(uint32_t offset, uint32_t length)
+{
+    return    (((offset | length) & (RTC_MEMORY_ALIGNMENT - 1u)) == 0u)
+           && (offset <= RTC_MEMORY_SIZE)
+           && (length <= (RTC_MEMORY_SIZE - offset));
+}
+
+/*******************************************************************************
+ * GLOBAL FUNCTIONS
+ *******************************************************************************/
+uint32_t SystemRtcMemory::getSize(void) const
+{
+    return RTC_MEMORY_SIZE;
+}
+
+Status_t SystemRtcMemory::read(uint32_t offset, void * data, uint32_t length)
+{
+    Status_t status = STATUS_OKAY;
+
+    if (CHECK_POINTER_VALID(data) == false)
+    {
+        status = STATUS_NULL_POINTER;
+    }
+    else if (checkRange(offset, length) == false)
+    {
+        status = STATUS_OUT_OF_BOUNDS;
+    }
+    else
+    {
+        /*! - the slow memory only takes 32 bit accesses, the caller buffer
+              may be unaligned so each word is moved through a local  */
+        uint8_t * dst = (uint8_t *)data;
+
+        for (uint32_t i = 0u; i < (length / RTC_MEMORY_ALIGNMENT); i++)
+        {
+            uint32_t word = rtcWords[(offset / RTC_MEMORY_ALIGNMENT) + i];
+
+            memcpy(&dst[i * RTC_MEMORY_ALIGNMENT], &word, RTC_MEMORY_ALIGNMENT);
+        }
+    }
+
+    return status;
+}
+
+Status_t SystemRtcMemory::write(uint32_t offset, const void * data, uint32_t length)
+{
+    Status_t status = STATUS_OKAY;
+
+    if (CHECK_POINTER_VALID(data) == false)
+    {
+        status = STATUS_NULL_POINTER;
+    }
+    else if (checkRange(offset, length) == false)
+    {
+        status = STATUS_OUT_OF_BOUNDS;
+    }
+    else
+    {
+        const uint8_t * src = (const uint8_t *)data;
+
+        for (uint32_t i = 0u; i < (length / RTC_MEMORY_ALIGNMENT); i++)
+        {
+            uint32_t word;
+
+            memcpy(&word, &src[i * RTC_MEMORY_ALIGNMENT], RTC_MEMORY_ALIGNMENT);
+            rtcWords[(offset / RTC_MEMORY_ALIGNMENT) + i] = word;
+        }
+    }
+
+    return status;
+}
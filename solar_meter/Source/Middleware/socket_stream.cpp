@@ -0,0 +1,357 @@
+/**
+ *******************************************************************************
+ * @file    socket_stream.cpp
+ * @author  hq
+ * @date    2025-08-03 16:48:09
+ * @brief   Socket stream source file
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * INCLUDES
+ *******************************************************************************/
+#include "socket_stream.hpp"
+
+#include <string.h>
+#include <errno.h>
+
+extern "C"
+{
+    #include "lwip/sockets.h"
+    #include "esp_log.h"
+}
+
+/*******************************************************************************
+ * EXTERN VARIABLES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * PRIVATE MACROS AND DEFINES
+ *******************************************************************************/
+#define SOCKET_INVALID              (-1)
+#define SOCKET_SEND_TIMEOUT_MS      (2000u)
+#define SOCKET_CONNECT_TIMEOUT_MS   (3000u)     /* same as the CONNACK wait */
+
+/*******************************************************************************
+ * PRIVATE TYPEDEFS
+ *******************************************************************************/
+
+/*******************************************************************************
+ * STATIC VARIABLES
+ *******************************************************************************/
+static const char *TAG = "SocketStream";
+
+/*******************************************************************************
+ * GLOBAL VARIABLES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * STATIC FUNCTION PROTOTYPES
+ *******************************************************************************/
+static Status_t connectSocket(int socketFd, const struct sockaddr_in * address, uint32_t timeoutMs);
+
+/*******************************************************************************
+ * STATIC FUNCTIONS
+ *******************************************************************************/
+
+/*!
+ * \brief Connects without blocking for longer than timeoutMs, the socket is
+ * made blocking again afterwards.
+ *
+ * \return Status_t - STATUS_NOTIFY_TIMEOUT if the peer did not answer in
+ * time, STATUS_HAL_ERROR if it refused
+ */
+static Status_t connectSocket(int socketFd, const struct sockaddr_in * address, uint32_t timeoutMs)
+{
+    Status_t status = STATUS_OKAY;
+    fd_set writeSet;
+    struct timeval timeout;
+    int flags = lwip_fcntl(socketFd, F_GETFL, 0);
+    int socketError = 0;
+    socklen_t errorLength = sizeof(socketError);
+    int result;
+
+    if ((flags < 0) || (lwip_fcntl(socketFd, F_SETFL, flags | O_NONBLOCK) < 0))
+    {
+        status = STATUS_HAL_ERROR;
+    }
+
+    if (status == STATUS_OKAY)
+    {
+        result = lwip_connect(socketFd, (const struct sockaddr *)address, sizeof(*address));
+
+        /*! - an unreachable broker no longer holds the caller for the tcp
+              retry time, writable means the handshake finished */
+        if ((result != 0) && (errno != EINPROGRESS))
+        {
+            status = STATUS_HAL_ERROR;
+        }
+        else if (result != 0)
+        {
+            FD_ZERO(&writeSet);
+            FD_SET(socketFd, &writeSet);
+            timeout.tv_sec = timeoutMs / 1000u;
+            timeout.tv_usec = (timeoutMs % 1000u) * 1000u;
+
+            result = lwip_select(socketFd + 1, nullptr, &writeSet, nullptr, &timeout);
+
+            if (result == 0)
+            {
+                status = STATUS_NOTIFY_TIMEOUT;
+            }
+            else if (    (result < 0)
+                      || (lwip_getsockopt(socketFd, SOL_SOCKET, SO_ERROR, &socketError, &errorLength) != 0)
+                      || (socketError != 0))
+            {
+                status = STATUS_HAL_ERROR;
+            }
+        }
+    }
+
+    if ((status == STATUS_OKAY) && (lwip_fcntl(socketFd, F_SETFL, flags) < 0))
+    {
+        status = STATUS_HAL_ERROR;
+    }
+
+    return status;
+}
+
+/*******************************************************************************
+ * GLOBAL FUNCTIONS
+ *******************************************************************************/
+SocketStream::SocketStream() : socketFd(SOCKET_INVALID)
+{
+}
+
+SocketStream::~SocketStream()
+{
+    closeStream();
+}
+
+Status_t SocketStream::openStream(const char * host, uint16_t port)
+{
+    Status_t status = STATUS_OKAY;
+    struct sockaddr_in address;
+    struct timeval timeout;
+    int noDelay = 1;
+
+    closeStream();
+
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = inet_addr(host);
+
+    socketFd = lwip_socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+
+    if (socketFd < 0)
+    {
+        status = STATUS_HAL_ERROR;
+    }
+
+    if (status == STATUS_OKAY)
+    {
+        /*! - bounded sends, small control packets skip nagle  */
+        timeout.tv_sec = SOCKET_SEND_TIMEOUT_MS / 1000u;
+        timeout.tv_usec = 0;
+        lwip_setsockopt(socketFd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        lwip_setsockopt(socketFd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+
+        status = connectSocket(socketFd, &address, SOCKET_CONNECT_TIMEOUT_MS);
+    }
+
+    if (status != STATUS_OKAY)
+    {
+        ESP_LOGE(TAG, "Error: %i, connect %s:%u", status, host, port);
+        closeStream();
+    }
+
+    return status;
+}
+
+void SocketStream::closeStream(void)
+{
+    if (socketFd >= 0)
+    {
+        lwip_close(socketFd);
+        socketFd = SOCKET_INVALID;
+    }
+}
+
+Status_t SocketStream::sendBytes(const uint8_t * data, uint16_t length)
+{
+    Status_t status = (socketFd >= 0) ? STATUS_OKAY : STATUS_HAL_ERROR;
+    uint16_t sent = 0u;
+
+    while ((status == STATUS_OKAY) && (sent < length))
+    {
+        int result = lwip_send(socketFd, &data[sent], length - sent, 0);
+
+        if (result <= 0)
+        {
+            status = STATUS_HAL_ERROR;
+        }
+        else
+        {
+            sent += (uint16_t)result;
+        }
+    }
+
+    return status;
+}
+
+Status_t SocketStream::receiveBytes(uint8_t * data, uint16_t capacity, uint16_t * length,
+                               uint32_t timeoutMs)
+{
+    Status_t status = (socketFd >= 0) ? STATUS_OKAY : STATUS_HAL_ERROR;
+    fd_set readSet;
+    struct timeval timeout;
+    int result = 0;
+
+    *length = 0u;
+
+    if (status == STATUS_OKAY)
+    {
+        FD_ZERO(&readSet);
+        FD_SET(socketFd, &readSet);
+        timeout.tv_sec = timeoutMs / 1000u;
+        timeout.tv_usec = (timeoutMs % 1000u) * 1000u;
+
+        result = lwip_select(socketFd + 1, &readSet, nullptr, nullptr, &timeout);
+
+        if (result < 0)
+        {
+            status = STATUS_HAL_ERROR;
+        }
+    }
+
+    if ((status == STATUS_OKAY) && (result > 0))
+    {
+        result = lwip_recv(socketFd, data, capacity, 0);
+
+        /*! - readable with nothing to read means the peer closed    */
+        if (result <= 0)
+        {
+            status = STATUS_HAL_ERROR;
+        }
+        else
+        {
+            *length = (uint16_t)result;
+        }
+    }
+
+    return status;
+}
+
+void SocketStream::attachSocket(int _socketFd)
+{
+    struct timeval timeout;
+
+    closeStream();
+    socketFd = _socketFd;
+
+    if (socketFd >= 0)
+    {
+        /*! - a stalled peer must not block the serving task forever   */
+        timeout.tv_sec = SOCKET_SEND_TIMEOUT_MS / 1000u;
+        timeout.tv_usec = 0;
+        lwip_setsockopt(socketFd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    }
+}
+
+SocketListener::SocketListener() : listenFd(SOCKET_INVALID)
+{
+}
+
+SocketListener::~SocketListener()
+{
+    closeListener();
+}
+
+Status_t SocketListener::listenOn(uint16_t port, uint8_t backlog)
+{
+    Status_t status = STATUS_OKAY;
+    struct sockaddr_in address;
+    int reuse = 1;
+
+    closeListener();
+
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+
+    listenFd = lwip_socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+
+    if (listenFd < 0)
+    {
+        status = STATUS_HAL_ERROR;
+    }
+
+    if (status == STATUS_OKAY)
+    {
+        lwip_setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+        if (    (lwip_bind(listenFd, (struct sockaddr *)&address, sizeof(address)) != 0)
+             || (lwip_listen(listenFd, backlog) != 0))
+        {
+            status = STATUS_HAL_ERROR;
+        }
+    }
+
+    if (status != STATUS_OKAY)
+    {
+        ESP_LOGE(TAG, "Error: %i, listen %u", status, port);
+        closeListener();
+    }
+
+    return status;
+}
+
+void SocketListener::closeListener(void)
+{
+    if (listenFd >= 0)
+    {
+        lwip_close(listenFd);
+        listenFd = SOCKET_INVALID;
+    }
+}
+
+Status_t SocketListener::acceptStream(SocketStream & stream, bool * accepted, uint32_t timeoutMs)
+{
+    Status_t status = (listenFd >= 0) ? STATUS_OKAY : STATUS_HAL_ERROR;
+    fd_set readSet;
+    struct timeval timeout;
+    int result = 0;
+
+    *accepted = false;
+
+    if (status == STATUS_OKAY)
+    {
+        FD_ZERO(&readSet);
+        FD_SET(listenFd, &readSet);
+        timeout.tv_sec = timeoutMs / 1000u;
+        timeout.tv_usec = (timeoutMs % 1000u) * 1000u;
+
+        result = lwip_select(listenFd + 1, &readSet, nullptr, nullptr, &timeout);
+
+        if (result < 0)
+        {
+            status = STATUS_HAL_ERROR;
+        }
+    }
+
+    if ((status == STATUS_OKAY) && (result > 0))
+    {
+        result = lwip_accept(listenFd, nullptr, nullptr);
+
+        /*! - a connection reset before accept is not a listener failure */
+        if (result >= 0)
+        {
+            stream.attachSocket(result);
+            *accepted = true;
+        }
+    }
+
+    return status;
+}
@@ -0,0 +1,307 @@
+/**
+ *******************************************************************************
+ * @file    timeseries_codec.cpp
+ * @author  hq
+ * @date    2025-07-31 19:26:40
+ * @brief   Time series codec source file
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * INCLUDES
+ *******************************************************************************/
+#include "timeseries_codec.hpp"
+
+/*******************************************************************************
+ * EXTERN VARIABLES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * PRIVATE MACROS AND DEFINES
+ *******************************************************************************/
+#define BUCKET_COUNT            (5u)
+
+/*******************************************************************************
+ * PRIVATE TYPEDEFS
+ *******************************************************************************/
+typedef struct
+{
+    uint8_t prefix;                     /**< prefix code, read msb first    */
+    uint8_t prefixBits;
+    uint8_t payloadBits;                /**< zigzag payload width           */
+} Bucket_t;
+
+/*******************************************************************************
+ * STATIC VARIABLES
+ *******************************************************************************/
+
+/*  timestamps are ticks of a nearly fixed period, the delta of delta is
+ *  mostly zero and otherwise a little jitter                              */
+static const Bucket_t timestampBuckets[BUCKET_COUNT] =
+{
+    { 0x0u, 1u,  0u },                  /* 0                */
+    { 0x2u, 2u,  7u },                  /* 10   +-64        */
+    { 0x6u, 3u,  9u },                  /* 110  +-256       */
+    { 0xEu, 4u, 12u },                  /* 1110 +-2048      */
+    { 0xFu, 4u, 32u },                  /* 1111 any         */
+};
+
+/*  values are milli units of slow signals, the delta is mostly adc noise  */
+static const Bucket_t valueBuckets[BUCKET_COUNT] =
+{
+    { 0x0u, 1u,  0u },                  /* 0                */
+    { 0x2u, 2u,  6u },                  /* 10   +-32        */
+    { 0x6u, 3u, 13u },                  /* 110  +-4096      */
+    { 0xEu, 4u, 20u },                  /* 1110 +-524288    */
+    { 0xFu, 4u, 32u },                  /* 1111 any         */
+};
+
+/*******************************************************************************
+ * GLOBAL VARIABLES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * STATIC FUNCTION PROTOTYPES
+ *******************************************************************************/
+static inline uint32_t zigzagEncode(int32_t value);
+static inline int32_t zigzagDecode(uint32_t value);
+static const Bucket_t * selectBucket(const Bucket_t * buckets, uint32_t zigzag);
+
+/*******************************************************************************
+ * STATIC FUNCTIONS
+ *******************************************************************************/
+static inline uint32_t zigzagEncode(int32_t value)
+{
+    return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+static inline int32_t zigzagDecode(uint32_t value)
+{
+    return (int32_t)((value >> 1) ^ (0u - (value & 1u)));
+}
+
+/*!
+ * \brief returns the narrowest bucket that holds the zigzag value
+ */
+static const Bucket_t * selectBucket(const Bucket_t * buckets, uint32_t zigzag)
+{
+    uint8_t i = 0u;
+
+    while (    (i < (BUCKET_COUNT - 1u))
+            && (buckets[i].payloadBits < 32u)
+            && (zigzag >= (1u << buckets[i].payloadBits)))
+    {
+        i++;
+    }
+
+    return &buckets[i];
+}
+
+/*!
+ * \brief appends bits msb first, the caller checked the capacity
+ */
+void TimeSeriesEncoder::putBits(uint32_t value, uint8_t bitCount)
+{
+    while (bitCount > 0u)
+    {
+        uint8_t bit = (uint8_t)((value >> (bitCount - 1u)) & 1u);
+        uint32_t byteIndex = bitIndex >> 3;
+        uint8_t shift = (uint8_t)(7u - (bitIndex & 7u));
+
+        if (shift == 7u)
+        {
+            buffer[byteIndex] = 0u;
+        }
+        buffer[byteIndex] |= (uint8_t)(bit << shift);
+
+        bitIndex++;
+        bitCount--;
+    }
+}
+
+Status_t TimeSeriesDecoder::getBits(uint8_t bitCount, uint32_t * value)
+{
+    Status_t status = STATUS_OKAY;
+    uint32_t result = 0u;
+
+    if ((bitIndex + bitCount) > ((uint32_t)length * 8u))
+    {
+        status = STATUS_OUT_OF_BOUNDS;
+    }
+
+    while ((status == STATUS_OKAY) && (bitCount > 0u))
+    {
+        uint8_t shift = (uint8_t)(7u - (bitIndex & 7u));
+
+        result = (result << 1) | ((buffer[bitIndex >> 3] >> shift) & 1u);
+        bitIndex++;
+        bitCount--;
+    }
+
+    *value = result;
+
+    return status;
+}
+
+/*******************************************************************************
+ * GLOBAL FUNCTIONS
+ *******************************************************************************/
+TimeSeriesEncoder::TimeSeriesEncoder() : buffer(nullptr),
+                                         capacity(0u),
+                                         bitIndex(0u),
+                                         sampleCount(0u),
+                                         previousTimestamp(0u),
+                                         previousDelta(0u),
+                                         previousValue(0)
+{
+}
+
+void TimeSeriesEncoder::begin(uint8_t * _buffer, uint16_t _capacity)
+{
+    buffer = _buffer;
+    capacity = CHECK_POINTER_VALID(_buffer) ? _capacity : 0u;
+    bitIndex = 0u;
+    sampleCount = 0u;
+    previousTimestamp = 0u;
+    previousDelta = 0u;
+    previousValue = 0;
+}
+
+Status_t TimeSeriesEncoder::append(uint32_t timestamp, int32_t value)
+{
+    Status_t status = STATUS_OKAY;
+
+    /*! - worst case check keeps the sample whole or not written at all  */
+    if ((bitIndex + TIMESERIES_MAX_SAMPLE_BITS) > ((uint32_t)capacity * 8u))
+    {
+        status = STATUS_OUT_OF_BOUNDS;
+    }
+    else if (sampleCount == 0u)
+    {
+        /*! - the first sample anchors the series  */
+        putBits(timestamp, 32u);
+        putBits((uint32_t)value, 32u);
+        previousDelta = 0u;
+    }
+    else
+    {
+        /*! - wrapping arithmetic, the decoder undoes it the same way  */
+        uint32_t delta = timestamp - previousTimestamp;
+        uint32_t timestampZigzag = zigzagEncode((int32_t)(delta - previousDelta));
+        uint32_t valueZigzag = zigzagEncode((int32_t)((uint32_t)value - (uint32_t)previousValue));
+        const Bucket_t * bucket = selectBucket(timestampBuckets, timestampZigzag);
+
+        putBits(bucket->prefix, bucket->prefixBits);
+        putBits(timestampZigzag, bucket->payloadBits);
+
+        bucket = selectBucket(valueBuckets, valueZigzag);
+        putBits(bucket->prefix, bucket->prefixBits);
+        putBits(valueZigzag, bucket->payloadBits);
+
+        previousDelta = delta;
+    }
+
+    if (status == STATUS_OKAY)
+    {
+        previousTimestamp = timestamp;
+        previousValue = value;
+        sampleCount++;
+    }
+
+    return status;
+}
+
+uint16_t TimeSeriesEncoder::finish(void)
+{
+    /*  putBits clears each byte it starts, the padding is already zero   */
+    return (uint16_t)((bitIndex + 7u) / 8u);
+}
+
+TimeSeriesDecoder::TimeSeriesDecoder() : buffer(nullptr),
+                                         length(0u),
+                                         bitIndex(0u),
+                                         sampleCount(0u),
+                                         previousTimestamp(0u),
+                                         previousDelta(0u),
+                                         previousValue(0)
+{
+}
+
+void TimeSeriesDecoder::begin(const uint8_t * _buffer, uint16_t _length)
+{
+    buffer = _buffer;
+    length = CHECK_POINTER_VALID(_buffer) ? _length : 0u;
+    bitIndex = 0u;
+    sampleCount = 0u;
+    previousTimestamp = 0u;
+    previousDelta = 0u;
+    previousValue = 0;
+}
+
+Status_t TimeSeriesDecoder::next(uint32_t * timestamp, int32_t * value)
+{
+    Status_t status = STATUS_OKAY;
+    uint32_t bits = 0u;
+
+    if (    (CHECK_POINTER_VALID(timestamp) == false)
+         || (CHECK_POINTER_VALID(value) == false))
+    {
+        status = STATUS_NULL_POINTER;
+    }
+    else if (sampleCount == 0u)
+    {
+        status = getBits(32u, &bits);
+        *timestamp = bits;
+
+        if (status == STATUS_OKAY)
+        {
+            status = getBits(32u, &bits);
+            *value = (int32_t)bits;
+        }
+    }
+    else
+    {
+        const Bucket_t * buckets[2] = { timestampBuckets, valueBuckets };
+        uint32_t zigzag[2] = { 0u, 0u };
+
+        /*! - a prefix is up to four bits, ones until a zero or the fourth bit */
+        for (uint8_t field = 0u; (field < 2u) && (status == STATUS_OKAY); field++)
+        {
+            uint8_t bucket = 0u;
+
+            status = getBits(1u, &bits);
+
+            while ((status == STATUS_OKAY) && (bits == 1u) && (bucket < (BUCKET_COUNT - 1u)))
+            {
+                bucket++;
+                if (bucket < (BUCKET_COUNT - 1u))
+                {
+                    status = getBits(1u, &bits);
+                }
+            }
+
+            if (status == STATUS_OKAY)
+            {
+                status = getBits(buckets[field][bucket].payloadBits, &zigzag[field]);
+            }
+        }
+
+        if (status == STATUS_OKAY)
+        {
+            uint32_t delta = previousDelta + (uint32_t)zigzagDecode(zigzag[0]);
+
+            *timestamp = previousTimestamp + delta;
+            *value = (int32_t)((uint32_t)previousValue + (uint32_t)zigzagDecode(zigzag[1]));
+            previousDelta = delta;
+        }
+    }
+
+    if (status == STATUS_OKAY)
+    {
+        previousTimestamp = *timestamp;
+        previousValue = *value;
+        sampleCount++;
+    }
+
+    return status;
+}
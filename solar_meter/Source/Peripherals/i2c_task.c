@@ -19,6 +19,8 @@
 #include "esp_log.h"
 #include "esp_err.h"
 #include "i2c_task.h"
+#include "timing.h"
+#include "device_config.h"
 
 /************************************
  * EXTERN VARIABLES
@@ -27,12 +29,8 @@
 /************************************
  * PRIVATE MACROS AND DEFINES
  ************************************/
-#define QUEUE_LENGTH                (10u)
 #define ITEM_SIZE                   (sizeof(i2c_handler_t *))
-#define QUEUE_TIMEOUT               (2000)
 #define I2C_CHANNEL_NUM              I2C_NUM_0        /*!< I2C port number for master dev */
-#define I2C_EXAMPLE_MASTER_SCL_IO           5                /*!< gpio number for I2C master clock */
-#define I2C_EXAMPLE_MASTER_SDA_IO           4               /*!< gpio number for I2C master data  */
 
 /************************************
  * PRIVATE TYPEDEFS
@@ -46,6 +44,13 @@ static const char *TAG = "i2c task";
 /*  create queue handle */
 QueueHandle_t i2cQueueHdl;
 
+/*  i2c task handle */
+static TaskHandle_t i2cTaskHdl = NULL;
+
+/*  bus time and queue statistics, written by the i2c task only   */
+static i2c_stats_t i2cStats;
+static uint64_t busSumUs;
+
 /************************************
  * GLOBAL VARIABLES
  ************************************/
@@ -73,13 +78,14 @@ static void i2c_Task(void *arg);
 static esp_err_t i2c_example_master_init()
 {
     int i2c_master_port = I2C_CHANNEL_NUM;
+    const device_config_t * config = deviceConfig_get();
     i2c_config_t conf;
     conf.mode = I2C_MODE_MASTER;
-    conf.sda_io_num = I2C_EXAMPLE_MASTER_SDA_IO;
+    conf.sda_io_num = config->i2cSdaIo;
     conf.sda_pullup_en = 1;
-    conf.scl_io_num = I2C_EXAMPLE_MASTER_SCL_IO;
+    conf.scl_io_num = config->i2cSclIo;
     conf.scl_pullup_en = 1;
-    conf.clk_stretch_tick = 300; // 300 ticks, Clock stretch is about 210us, you can make changes according to the actual situation.
+    conf.clk_stretch_tick = config->i2cClkStretchTicks; // 300 ticks by default, Clock stretch is about 210us, you can make changes according to the actual situation.
     ESP_ERROR_CHECK(i2c_driver_install(i2c_master_port, conf.mode));
     ESP_ERROR_CHECK(i2c_param_config(i2c_master_port, &conf));
     return ESP_OK;
@@ -90,15 +96,16 @@ static esp_err_t i2c_example_master_init()
  ************************************/
 void init_i2cHandler(void)
 {
+    const device_config_t * config = deviceConfig_get();
 
     i2c_example_master_init();
 
     /* queue to queue pointers to i2c command objects   */
-    i2cQueueHdl = xQueueCreate( QUEUE_LENGTH, 
+    i2cQueueHdl = xQueueCreate( config->i2cQueueLength, 
                                 ITEM_SIZE );
 
     /*  create i2c task */
-    xTaskCreate(i2c_Task, "i2c_task", 1024, NULL, 5, NULL);
+    xTaskCreate(i2c_Task, "i2c_task", I2C_TASK_STACK_SIZE, NULL, config->i2cTaskPriority, &i2cTaskHdl);
 }
 
 
@@ -114,6 +121,11 @@ static void i2c_Task(void *arg)
     /* esp error type   */
     esp_err_t errRet = ESP_FAIL;
 
+    /* timeouts are fixed once the configuration is loaded  */
+    const device_config_t * config = deviceConfig_get();
+    TickType_t queueTimeout = pdMS_TO_TICKS(config->i2cQueueTimeoutMs);
+    TickType_t commandTimeout = pdMS_TO_TICKS(config->i2cCommandTimeoutMs);
+
     /* while i2c data exists send out data  */
     ESP_LOGI(TAG, "init i2c task\r\n");
 
@@ -125,20 +137,44 @@ static void i2c_Task(void *arg)
         /* receive command from queue, this should block until receive or timeout   */
         retVal = xQueueReceive( i2cQueueHdl,
                                 &i2cObjPtr,
-                                QUEUE_TIMEOUT);
+                                queueTimeout);
 
-        ESP_LOGI(TAG, "got data from queue\r\n");
+        ESP_LOGD(TAG, "got data from queue\r\n");
         /* if received data, process data*/
         if(pdPASS == retVal)
         {
-            ESP_LOGI(TAG, "i2cObjPtr: %p\r\n", (void *)i2cObjPtr);
+            ESP_LOGD(TAG, "i2cObjPtr: %p\r\n", (void *)i2cObjPtr);
 
             if( i2cObjPtr != NULL && 
                 i2cObjPtr->cmd != NULL &&
                 i2cObjPtr->taskHdl != NULL)
             {
+                /* the received command counts as waiting  */
+                uint16_t depth = (uint16_t)uxQueueMessagesWaiting(i2cQueueHdl) + 1u;
+                uint32_t startUs = timing_getTimeUs();
+                uint32_t busUs;
+
                 /* objptr now has pointer begin i2c command */
-                errRet = i2c_master_cmd_begin(I2C_CHANNEL_NUM, i2cObjPtr->cmd, 1000 / portTICK_RATE_MS);
+                errRet = i2c_master_cmd_begin(I2C_CHANNEL_NUM, i2cObjPtr->cmd, commandTimeout);
+                busUs = timing_getTimeUs() - startUs;
+
+                taskENTER_CRITICAL();
+                i2cStats.transactions++;
+                if (errRet != ESP_OK)
+                {
+                    i2cStats.failures++;
+                }
+                i2cStats.lastBusUs = busUs;
+                if (busUs > i2cStats.maxBusUs)
+                {
+                    i2cStats.maxBusUs = busUs;
+                }
+                if (depth > i2cStats.queueHighWater)
+                {
+                    i2cStats.queueHighWater = depth;
+                }
+                busSumUs += busUs;
+                taskEXIT_CRITICAL();
 
                 if(errRet == ESP_FAIL)
                 {
@@ -161,4 +197,38 @@ static void i2c_Task(void *arg)
             ESP_LOGI(TAG, "i2c queue timeout\r\n");
         }
     }
-}
\ No newline at end of file
+}
+
+Status_t i2c_getStats(i2c_stats_t * stats)
+{
+    Status_t errRet = STATUS_OKAY;
+
+    if (NULL == stats)
+    {
+        errRet = STATUS_NULL_POINTER;
+    }
+
+    if (STATUS_OKAY == errRet)
+    {
+        uint64_t busSum;
+
+        taskENTER_CRITICAL();
+        *stats = i2cStats;
+        busSum = busSumUs;
+        taskEXIT_CRITICAL();
+
+        stats->queueDepth = (NULL != i2cQueueHdl) ? (uint16_t)uxQueueMessagesWaiting(i2cQueueHdl) : 0u;
+
+        if (stats->transactions > 0u)
+        {
+            stats->meanBusUs = (uint32_t)(busSum / stats->transactions);
+        }
+    }
+
+    return errRet;
+}
+
+TaskHandle_t i2c_getTaskHandle(void)
+{
+    return i2cTaskHdl;
+}
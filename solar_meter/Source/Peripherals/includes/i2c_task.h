@@ -17,16 +17,28 @@ extern "C" {
 /************************************
  * INCLUDES
  ************************************/
+#include "typedefs.h"
 #include "i2c_handler.h"
 #include "freertos/queue.h"
 
 /************************************
  * MACROS AND DEFINES
  ************************************/
+#define I2C_TASK_STACK_SIZE         (1024u)
 
 /************************************
  * TYPEDEFS
  ************************************/
+typedef struct
+{
+    uint32_t transactions;              /**< commands run on the bus                  */
+    uint32_t failures;                  /**< commands the driver reported failed      */
+    uint32_t lastBusUs;                 /**< time the last command held the bus       */
+    uint32_t meanBusUs;
+    uint32_t maxBusUs;
+    uint16_t queueDepth;                /**< commands waiting when sampled            */
+    uint16_t queueHighWater;            /**< most commands seen waiting               */
+}i2c_stats_t;
 
 /************************************
  * EXPORTED VARIABLES
@@ -46,6 +58,21 @@ extern QueueHandle_t i2cQueueHdl;
  */
 void init_i2cHandler(void);
 
+/** @brief  Returns the transaction latency and queue statistics
+ *
+ *  @param stats - pointer populated with a snapshot of the statistics
+ *  @return Status_t
+ */
+Status_t i2c_getStats(i2c_stats_t * stats);
+
+/** @brief  Returns the handle of the i2c task, used to register the
+ *  task for stack profiling
+ *
+ *  @param void
+ *  @return TaskHandle_t - NULL before init_i2cHandler
+ */
+TaskHandle_t i2c_getTaskHandle(void);
+
 
 #ifdef __cplusplus
 }
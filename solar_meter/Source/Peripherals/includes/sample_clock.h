@@ -0,0 +1,128 @@
+/**
+ ********************************************************************************
+ * @file    sample_clock.h
+ * @author  hq
+ * @date    2025-07-24 18:37:52
+ * @brief   Hardware timer (FRC1) paced sample clock. The timer isr stamps
+ *  every tick in microseconds and queues a prebuilt i2c read to the i2c
+ *  task, the i2c task notifies the consumer task once the read completed.
+ ********************************************************************************
+ */
+
+#ifndef SAMPLE_CLOCK_H
+#define SAMPLE_CLOCK_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/************************************
+ * INCLUDES
+ ************************************/
+#include "typedefs.h"
+#include "i2c_handler.h"
+
+/************************************
+ * MACROS AND DEFINES
+ ************************************/
+#define SAMPLE_CLOCK_SLOTS                  (8u)        /* must be a power of 2 */
+#define SAMPLE_CLOCK_MIN_PERIOD_US          (1000u)
+#define SAMPLE_CLOCK_DATA_SIZE              (2u)
+#define SAMPLE_CLOCK_MAX_CHANNELS           (2u)        /* must divide SAMPLE_CLOCK_SLOTS */
+
+/************************************
+ * TYPEDEFS
+ ************************************/
+
+/*
+    sample_clock_config_t describes the i2c transaction run on every
+    tick. The read register is read first, then if trigger is enabled the
+    trigger value is written to the trigger register to start the next
+    conversion, so the value read on a tick was started on the tick before.
+    With more than one channel the trigger values are written in turn, the
+    sample read on a tick belongs to the channel triggered on the tick
+    before, e.g. a single shot conversion of the other adc input.
+*/
+typedef struct
+{
+    uint32_t periodUs;                  /**< tick period in microseconds              */
+    TaskHandle_t consumerHdl;           /**< task notified once per completed sample  */
+    uint8_t writeAddress;               /**< device address byte with the write bit   */
+    uint8_t readAddress;                /**< device address byte with the read bit    */
+    uint8_t readRegister;               /**< register read every tick                 */
+    bool triggerEnable;                 /**< write trigger value after every read     */
+    uint8_t triggerRegister;
+    uint8_t channels;                   /**< trigger values used, 1 without trigger   */
+    uint8_t triggerValue[SAMPLE_CLOCK_MAX_CHANNELS][SAMPLE_CLOCK_DATA_SIZE];
+    bool ackCheck;
+}sample_clock_config_t;
+
+typedef struct
+{
+    uint32_t timestampUs;               /**< tick that started the conversion         */
+    int16_t value;                      /**< big endian register value                */
+    uint8_t channel;                    /**< trigger value the conversion started with */
+}sample_clock_sample_t;
+
+typedef struct
+{
+    uint32_t nominalPeriodUs;
+    uint32_t ticks;                     /**< timer interrupts since start             */
+    uint32_t overruns;                  /**< ticks dropped because all slots were busy */
+    uint32_t queueFailures;             /**< ticks the i2c queue was full             */
+    uint32_t minPeriodUs;
+    uint32_t maxPeriodUs;
+    uint32_t meanPeriodUs;              /**< achieved period                          */
+    uint32_t meanJitterUs;              /**< mean |period - nominal|                  */
+    uint32_t maxJitterUs;               /**< max |period - nominal|                   */
+}sample_clock_stats_t;
+
+/************************************
+ * EXPORTED VARIABLES
+ ************************************/
+
+/************************************
+ * GLOBAL FUNCTION PROTOTYPES
+ ************************************/
+
+/** @brief  Builds the per slot i2c commands and starts the hardware
+ *  timer, init_i2cHandler must have been called first. Commands a failed
+ *  stop could not reclaim are reclaimed first.
+ *
+ *  @param config - tick period, consumer task and i2c transaction
+ *  @return Status_t - STATUS_REINIT_ERROR if already running,
+ *  STATUS_QUEUE_FULL if the commands of the last run are still queued
+ */
+Status_t sample_clock_start(const sample_clock_config_t * config);
+
+/** @brief  Stops the hardware timer, waits until the i2c task ran the
+ *  commands still queued and releases them. Samples not read yet are
+ *  dropped. Blocks for up to a command timeout per slot, not for isr use.
+ *
+ *  @param void
+ *  @return Status_t - STATUS_QUEUE_FULL if the i2c task did not get through
+ *  the queue in time, the commands are kept and freed by the next call
+ */
+Status_t sample_clock_stop(void);
+
+/** @brief  Pops the oldest completed sample, call once per notification
+ *  received by the consumer task.
+ *
+ *  @param sample - pointer populated with value and timestamp
+ *  @return Status_t - STATUS_QUEUE_FAIL if no sample is pending
+ */
+Status_t sample_clock_read(sample_clock_sample_t * sample);
+
+/** @brief  Returns the achieved period and jitter statistics
+ *
+ *  @param stats - pointer populated with a snapshot of the statistics
+ *  @return Status_t
+ */
+Status_t sample_clock_getStats(sample_clock_stats_t * stats);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //SAMPLE_CLOCK_H
@@ -0,0 +1,464 @@
+/**
+ ********************************************************************************
+ * @file    sample_clock.c
+ * @author  hq
+ * @date    2025-07-24 18:37:52
+ * @brief   This module paces sampling with the FRC1 hardware timer instead of
+ *  the RTOS tick. The isr only stamps the tick and queues work, the i2c read
+ *  itself runs in the i2c task.
+ ********************************************************************************
+ */
+
+/************************************
+ * INCLUDES
+ ************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "driver/hw_timer.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "i2c_task.h"
+#include "device_config.h"
+#include "sample_clock.h"
+#include "timing.h"
+#include "cpu_trace.h"
+
+/************************************
+ * EXTERN VARIABLES
+ ************************************/
+
+/************************************
+ * PRIVATE MACROS AND DEFINES
+ ************************************/
+#define SLOT_MASK                   (SAMPLE_CLOCK_SLOTS - 1u)
+
+/************************************
+ * PRIVATE TYPEDEFS
+ ************************************/
+
+/*
+    one slot per outstanding read, each owns an i2c command built once at
+    start that reads straight into the slot data buffer
+*/
+typedef struct
+{
+    i2c_handler_t handler;
+    uint32_t timestampUs;
+    uint8_t data[SAMPLE_CLOCK_DATA_SIZE];
+    uint8_t channel;
+    volatile bool busy;
+    bool valid;
+}sample_slot_t;
+
+/************************************
+ * STATIC VARIABLES
+ ************************************/
+static const char *TAG = "sample clock";
+
+static sample_slot_t slots[SAMPLE_CLOCK_SLOTS];
+static volatile uint32_t slotHead;
+static uint32_t slotTail;
+static bool running = false;
+static bool slotCommandsHeld = false;
+static bool triggerEnable;
+
+/* isr owned statistics, copied out in a critical section */
+static sample_clock_stats_t isrStats;
+static uint32_t lastTickUs;
+static uint32_t lastTickCycles;
+static uint32_t cycleRemainder;
+static uint32_t lastQueuedUs;
+static uint64_t periodSumUs;
+static uint64_t jitterSumUs;
+
+/************************************
+ * GLOBAL VARIABLES
+ ************************************/
+
+/************************************
+ * STATIC FUNCTION PROTOTYPES
+ ************************************/
+static void sample_clock_isr(void *arg);
+static Status_t build_slotCommand(sample_slot_t * slot, const sample_clock_config_t * config, uint8_t channels, uint32_t index);
+static void delete_slotCommands(void);
+static Status_t wait_i2cIdle(void);
+
+/************************************
+ * STATIC FUNCTIONS
+ ************************************/
+
+/** @brief  FRC1 alarm callback, runs in isr context
+ *
+ *  Updates the period statistics, claims the next free slot, stamps it and
+ *  queues its i2c command. Nothing here blocks or touches the i2c bus.
+ *  The time is carried forward from CCOUNT, esp_timer is not in IRAM.
+ */
+static void IRAM_ATTR sample_clock_isr(void *arg)
+{
+    uint32_t enterCycles = cpu_traceIsrEnter();
+    BaseType_t higherPriorityTaskWoken = pdFALSE;
+    uint32_t nowCycles = timing_getCycleCount();
+    uint32_t elapsedCycles = (nowCycles - lastTickCycles) + cycleRemainder;
+    uint32_t nowUs = lastTickUs + (elapsedCycles / TIMING_CPU_FREQ_MHZ);
+    uint32_t previousTickUs = lastTickUs;
+
+    (void)arg;
+
+    /* the sub microsecond rest is kept so the time does not drift */
+    cycleRemainder = elapsedCycles % TIMING_CPU_FREQ_MHZ;
+    lastTickCycles = nowCycles;
+
+    if (isrStats.ticks != 0u)
+    {
+        uint32_t periodUs = nowUs - previousTickUs;
+        uint32_t jitterUs = (periodUs > isrStats.nominalPeriodUs) ?
+                            (periodUs - isrStats.nominalPeriodUs) :
+                            (isrStats.nominalPeriodUs - periodUs);
+
+        periodSumUs += periodUs;
+        jitterSumUs += jitterUs;
+
+        if (periodUs < isrStats.minPeriodUs)
+        {
+            isrStats.minPeriodUs = periodUs;
+        }
+        if (periodUs > isrStats.maxPeriodUs)
+        {
+            isrStats.maxPeriodUs = periodUs;
+        }
+        if (jitterUs > isrStats.maxJitterUs)
+        {
+            isrStats.maxJitterUs = jitterUs;
+        }
+    }
+
+    lastTickUs = nowUs;
+
+    sample_slot_t * slot = &slots[slotHead & SLOT_MASK];
+
+    if (slot->busy)
+    {
+        /* consumer fell behind, drop this tick */
+        isrStats.overruns++;
+    }
+    else
+    {
+        i2c_handler_t * handlerPtr = &slot->handler;
+
+        /* with a trigger the value read now was started by the last
+           queued tick, a dropped tick wrote no trigger */
+        slot->timestampUs = triggerEnable ? lastQueuedUs : nowUs;
+        slot->valid = (triggerEnable == false) || (slotHead != 0u);
+
+        if (pdTRUE == xQueueSendToBackFromISR(i2cQueueHdl, &handlerPtr, &higherPriorityTaskWoken))
+        {
+            slot->busy = true;
+            slotHead++;
+            lastQueuedUs = nowUs;
+        }
+        else
+        {
+            isrStats.queueFailures++;
+        }
+    }
+
+    isrStats.ticks++;
+
+    cpu_traceIsrExit(enterCycles);
+
+    if (higherPriorityTaskWoken == pdTRUE)
+    {
+        portYIELD_FROM_ISR();
+    }
+}
+
+/** @brief  Builds the i2c command for one slot
+ *
+ *  Slots are used in order and their count is a multiple of the channel
+ *  count, so a slot always reads the same channel and triggers the next.
+ *
+ *  @param slot - slot that owns the command and the read buffer
+ *  @param config - transaction description
+ *  @param channels - trigger values in turn, 1 without trigger
+ *  @param index - position of the slot
+ *  @return Status_t - STATUS_NULL_POINTER or STATUS_HAL_ERROR on failure
+ */
+static Status_t build_slotCommand(sample_slot_t * slot, const sample_clock_config_t * config, uint8_t channels, uint32_t index)
+{
+    Status_t errRet = STATUS_OKAY;
+    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+    const uint8_t * triggerValue = config->triggerValue[(index + 1u) % channels];
+
+    slot->handler.cmd = cmd;
+    slot->handler.taskHdl = config->consumerHdl;
+    slot->channel = (uint8_t)(index % channels);
+
+    if (NULL == cmd)
+    {
+        errRet = STATUS_NULL_POINTER;
+    }
+
+    /* point at the read register and read it back   */
+    if (    STATUS_OKAY == errRet
+         && (    ESP_OK != i2c_master_start(cmd)
+              || ESP_OK != i2c_master_write_byte(cmd, config->writeAddress, config->ackCheck)
+              || ESP_OK != i2c_master_write_byte(cmd, config->readRegister, config->ackCheck)
+              || ESP_OK != i2c_master_start(cmd)
+              || ESP_OK != i2c_master_write_byte(cmd, config->readAddress, config->ackCheck)
+              || ESP_OK != i2c_master_read(cmd, slot->data, SAMPLE_CLOCK_DATA_SIZE, I2C_MASTER_LAST_NACK)))
+    {
+        errRet = STATUS_HAL_ERROR;
+    }
+
+    /* start the next conversion    */
+    if (    STATUS_OKAY == errRet
+         && config->triggerEnable
+         && (    ESP_OK != i2c_master_start(cmd)
+              || ESP_OK != i2c_master_write_byte(cmd, config->writeAddress, config->ackCheck)
+              || ESP_OK != i2c_master_write_byte(cmd, config->triggerRegister, config->ackCheck)
+              || ESP_OK != i2c_master_write(cmd, (uint8_t *)triggerValue, SAMPLE_CLOCK_DATA_SIZE, config->ackCheck)))
+    {
+        errRet = STATUS_HAL_ERROR;
+    }
+
+    if (STATUS_OKAY == errRet && ESP_OK != i2c_master_stop(cmd))
+    {
+        errRet = STATUS_HAL_ERROR;
+    }
+
+    return errRet;
+}
+
+static void delete_slotCommands(void)
+{
+    for (uint32_t i = 0u; i < SAMPLE_CLOCK_SLOTS; i++)
+    {
+        if (NULL != slots[i].handler.cmd)
+        {
+            i2c_cmd_link_delete(slots[i].handler.cmd);
+            slots[i].handler.cmd = NULL;
+        }
+        slots[i].busy = false;
+    }
+
+    slotTail = slotHead;
+    slotCommandsHeld = false;
+}
+
+/** @brief  Waits until the i2c task ran every queued command
+ *
+ *  The i2c task serves its queue in order and only blocks on the queue,
+ *  so with the queue empty and the task blocked none of the slot commands
+ *  is queued or on the bus any more.
+ *
+ *  @return Status_t - STATUS_QUEUE_FULL if that took longer than a command
+ *  timeout per slot
+ */
+static Status_t wait_i2cIdle(void)
+{
+    Status_t errRet = STATUS_OKAY;
+    TaskHandle_t i2cTaskHdl = i2c_getTaskHandle();
+    TickType_t limit = pdMS_TO_TICKS(deviceConfig_get()->i2cCommandTimeoutMs) * (SAMPLE_CLOCK_SLOTS + 1u);
+    TickType_t waited = 0u;
+
+    while (    (waited < limit)
+            && (    (0u != uxQueueMessagesWaiting(i2cQueueHdl))
+                 || (eBlocked != eTaskGetState(i2cTaskHdl))))
+    {
+        vTaskDelay(1);
+        waited++;
+    }
+
+    if (waited >= limit)
+    {
+        errRet = STATUS_QUEUE_FULL;
+    }
+
+    return errRet;
+}
+
+/************************************
+ * GLOBAL FUNCTIONS
+ ************************************/
+Status_t sample_clock_start(const sample_clock_config_t * config)
+{
+    Status_t errRet = STATUS_OKAY;
+    bool commandsBuilt = false;
+
+    if (NULL == config || NULL == config->consumerHdl || NULL == i2cQueueHdl)
+    {
+        errRet = STATUS_NULL_POINTER;
+    }
+
+    if (STATUS_OKAY == errRet && running)
+    {
+        errRet = STATUS_REINIT_ERROR;
+    }
+
+    if (    STATUS_OKAY == errRet
+         && (    config->periodUs < SAMPLE_CLOCK_MIN_PERIOD_US
+              || (config->triggerEnable && (0u == config->channels || config->channels > SAMPLE_CLOCK_MAX_CHANNELS))))
+    {
+        errRet = STATUS_OUT_OF_BOUNDS;
+    }
+
+    /* a stop that timed out left the commands with the i2c task */
+    if (STATUS_OKAY == errRet && slotCommandsHeld)
+    {
+        errRet = sample_clock_stop();
+    }
+
+    if (STATUS_OKAY == errRet)
+    {
+        uint8_t channels = config->triggerEnable ? config->channels : 1u;
+
+        memset(slots, 0, sizeof(slots));
+        memset(&isrStats, 0, sizeof(isrStats));
+        slotHead = 0u;
+        slotTail = 0u;
+        periodSumUs = 0u;
+        jitterSumUs = 0u;
+        triggerEnable = config->triggerEnable;
+        isrStats.nominalPeriodUs = config->periodUs;
+        isrStats.minPeriodUs = UINT32_MAX;
+        lastTickUs = timing_getTimeUs();
+        lastTickCycles = timing_getCycleCount();
+        cycleRemainder = 0u;
+        lastQueuedUs = lastTickUs;
+        slotCommandsHeld = true;
+        commandsBuilt = true;
+
+        for (uint32_t i = 0u; STATUS_OKAY == errRet && i < SAMPLE_CLOCK_SLOTS; i++)
+        {
+            errRet = build_slotCommand(&slots[i], config, channels, i);
+        }
+    }
+
+    if (    STATUS_OKAY == errRet
+         && (    ESP_OK != hw_timer_init(sample_clock_isr, NULL)
+              || ESP_OK != hw_timer_alarm_us(config->periodUs, true)))
+    {
+        errRet = STATUS_HAL_ERROR;
+    }
+
+    if (STATUS_OKAY == errRet)
+    {
+        running = true;
+        ESP_LOGI(TAG, "started, period %u us\r\n", config->periodUs);
+    }
+    else
+    {
+        /* the timer did not start, nothing of this run was queued */
+        if (commandsBuilt)
+        {
+            delete_slotCommands();
+        }
+        ESP_LOGE(TAG, "Error: %i", errRet);
+    }
+
+    return errRet;
+}
+
+Status_t sample_clock_stop(void)
+{
+    Status_t errRet = STATUS_OKAY;
+
+    if (running == false && slotCommandsHeld == false)
+    {
+        errRet = STATUS_UNKNOWN;
+    }
+
+    if (STATUS_OKAY == errRet && running)
+    {
+        hw_timer_enable(false);
+        hw_timer_deinit();
+        running = false;
+    }
+
+    /* busy slots are queued or on the bus, their commands are freed once
+       the i2c task is through with them, done or not read by the consumer */
+    if (STATUS_OKAY == errRet)
+    {
+        errRet = wait_i2cIdle();
+    }
+
+    if (STATUS_OKAY == errRet)
+    {
+        delete_slotCommands();
+    }
+    else if (STATUS_QUEUE_FULL == errRet)
+    {
+        ESP_LOGE(TAG, "i2c task busy, commands kept until the next stop");
+    }
+
+    return errRet;
+}
+
+Status_t sample_clock_read(sample_clock_sample_t * sample)
+{
+    Status_t errRet = STATUS_QUEUE_FAIL;
+
+    if (NULL == sample)
+    {
+        errRet = STATUS_NULL_POINTER;
+    }
+
+    /* slots complete in order, the i2c task serves its queue fifo, so
+       the oldest slot is the one the notification was for */
+    if (STATUS_QUEUE_FAIL == errRet && slotTail != slotHead)
+    {
+        sample_slot_t * slot = &slots[slotTail & SLOT_MASK];
+
+        /* the first read after start has no conversion behind it */
+        if (slot->valid)
+        {
+            sample->timestampUs = slot->timestampUs;
+            sample->value = (int16_t)(((uint16_t)slot->data[0] << 8) | slot->data[1]);
+            sample->channel = slot->channel;
+            errRet = STATUS_OKAY;
+        }
+
+        slot->busy = false;
+        slotTail++;
+    }
+
+    return errRet;
+}
+
+Status_t sample_clock_getStats(sample_clock_stats_t * stats)
+{
+    Status_t errRet = STATUS_OKAY;
+
+    if (NULL == stats)
+    {
+        errRet = STATUS_NULL_POINTER;
+    }
+
+    if (STATUS_OKAY == errRet)
+    {
+        uint64_t periodSum;
+        uint64_t jitterSum;
+
+        taskENTER_CRITICAL();
+        *stats = isrStats;
+        periodSum = periodSumUs;
+        jitterSum = jitterSumUs;
+        taskEXIT_CRITICAL();
+
+        if (stats->ticks > 1u)
+        {
+            stats->meanPeriodUs = (uint32_t)(periodSum / (stats->ticks - 1u));
+            stats->meanJitterUs = (uint32_t)(jitterSum / (stats->ticks - 1u));
+        }
+        else
+        {
+            stats->minPeriodUs = 0u;
+        }
+    }
+
+    return errRet;
+}
@@ -1,5 +1,8 @@
 #
-# "main" pseudo-component makefile.
+# Application component makefile, pulled in through EXTRA_COMPONENT_DIRS in
+# the project Makefile.
 #
-# (Uses default behaviour of compiling all source files in directory, adding 'include' to include path.)
+# Sources are split by layer, each layer keeps its headers in includes/.
 
+COMPONENT_SRCDIRS := . Application Middleware Devices Peripherals
+COMPONENT_ADD_INCLUDEDIRS := Common Application/includes Middleware/includes Devices/includes Peripherals/includes
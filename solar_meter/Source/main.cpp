@@ -16,16 +16,145 @@
 #include "driver/adc.h"
 #include "driver/i2c.h"
 #include "esp_log.h"
+#include "esp_sleep.h"
+#include "esp_wifi.h"
+#include "esp_event.h"
+#include "tcpip_adapter.h"
+#include "nvs_flash.h"
 
 #include "i2c_task.h"
 #include "ads1115.hpp"
-#include "bus_voltage.h"
+#include "bus_voltage.hpp"
+#include "bus_current.hpp"
+#include "power_monitor.hpp"
+#include "Task.hpp"
+#include "active_object.hpp"
+#include "cpu_load_reporter.hpp"
+#include "block_allocator.hpp"
+#include "duty_cycle.hpp"
+#include "networking.hpp"
+#include "message_serializer.hpp"
+#include "mqtt_client.hpp"
+#include "transmit_scheduler.hpp"
+#include "metrics_sources.hpp"
+#include "socket_stream.hpp"
+#include "flash_device.hpp"
+#include "flash_ring_log.hpp"
+#include "boot_profile.hpp"
+#include "persistent_config.hpp"
 
 
 /* static variables    */
 static const char *TAG = "main";
 
+/* seconds between two stack usage reports   */
+#define STACK_LOG_INTERVAL_S    (60u)
 
+/* one stack for every module that runs as an active object  */
+#define APP_DISPATCHER_STACK_SIZE   (256u * 4u)
+
+static StaticTask<APP_DISPATCHER_STACK_SIZE, EventDispatcher> appDispatcher("app_dispatcher");
+
+/* brought up in the background once sampling runs, its queue holds the
+   samples until then   */
+static NetworkingModule networkingModule;
+
+/* bit packed series instead of TLV, for links where bytes are expensive.
+   The receiver has to decode the same encoding */
+#define TIMESERIES_ENCODING
+#undef  TIMESERIES_ENCODING
+
+#ifdef TIMESERIES_ENCODING
+static TimeSeriesSerializer timeSeriesSerializer;
+#endif
+
+static CpuLoadReporter cpuLoadReporter(&networkingModule);
+
+/* transport of the networking task, and of the rollup in duty cycle mode */
+static SocketStream socketStream;
+static MqttClient mqttClient(socketStream);
+
+/* batches the link did not take wait on the telemetry partition */
+#define TELEMETRY_PARTITION_LABEL   "telemetry"
+#define TELEMETRY_PARTITION_SUBTYPE (0x40)
+
+static PartitionFlash telemetryFlash(TELEMETRY_PARTITION_LABEL, (esp_partition_subtype_t)TELEMETRY_PARTITION_SUBTYPE);
+static FlashRingLog storeLog(telemetryFlash);
+
+#define NET_STARTUP_STACK_SIZE      (256u * 4u)
+
+/* +-4.096 V range, bus voltage on AIN0, shunt across AIN1 and AIN3. The
+   sample clock converts both single shot on alternate ticks */
+#define ADC_VOLTS_PER_COUNT         (0.000125f)
+#define ADC_AMPS_PER_COUNT          (0.000125f)
+
+static const PowerMonitorAcquisition_t powerAcquisition =
+{
+    ADS1115_MUX_AIN0_GND,
+    ADS1115_MUX_AIN1_AIN3,
+    0b001u,
+    ADS1115_DATA_RATE_860_SPS,
+};
+
+static BusVoltage busVoltage(ADC_VOLTS_PER_COUNT);
+static BusCurrent busCurrent(ADC_AMPS_PER_COUNT);
+static EnergyIntegrator energyIntegrator;
+static PowerTelemetry powerTelemetry(networkingModule);
+static PowerSampleTopic powerSampleTopic(energyIntegrator, powerTelemetry);
+
+/* settings the monitor boots with, commands on the downlink change them
+   between two periods. No averaging of the reported values */
+static const RuntimeConfig_t bootRuntimeConfig =
+{
+    POWER_MONITOR_DEFAULT_PERIOD_MS,
+    ADS1115_DATA_RATE_860_SPS,
+    0b001u,
+    1u,
+};
+
+static ConfigChannel configChannel(networkingModule);
+
+/* consumer of the sample clock on app_dispatcher, publishes one averaged
+   sample per period */
+static PowerMonitor powerMonitor(powerSampleTopic, busVoltage, busCurrent, powerAcquisition);
+
+/* raw bus voltage conversions of the monitor, the result goes out with
+   the monitor metrics */
+static RippleAnalyzer rippleAnalyzer;
+
+/* a bus voltage drop of 0.5 V from one conversion to the next, with the
+   64 voltage conversions before and after it */
+static const CaptureConfig_t captureConfig =
+{
+    CAPTURE_TRIGGER_SLOPE_FALLING,
+    4000,
+    64u,
+    64u,
+};
+
+static TransientCapture transientCapture(networkingModule);
+
+/* quiet bus: 128 SPS and one conversion per channel a second, a 2 s
+   period. Activity: 860 SPS and 50 ms, the 100 ms default period. A step
+   of 0.1 V or a spread of 50 mV raises the rate, four levels in between */
+static const AdaptiveSamplerConfig_t samplerConfig =
+{
+    ADS1115_DATA_RATE_128_SPS,
+    ADS1115_DATA_RATE_860_SPS,
+    1000u,
+    50u,
+    800u,
+    80u,
+    160000u,
+    1600u,
+    20u,
+};
+
+static AdaptiveSampler adaptiveSampler;
+
+/* battery installations sleep between sample bursts, no task keeps running */
+#define DUTY_CYCLE_MODE
+#undef  DUTY_CYCLE_MODE
 
 #define TEST_I2C_TASK
 #undef  TEST_I2C_TASK
@@ -120,21 +249,512 @@ static void testAds1115Task(void)
 #endif //TEST_ADS1115_TASK
 
 
+/* broker of the installation, the station joins the access point saved in
+   nvs when the device was provisioned */
+#ifndef BROKER_HOST
+#define BROKER_HOST                 "192.168.1.10"
+#endif
+#define BROKER_PORT                 (1883u)
+#define STATION_CONNECT_TIMEOUT_MS  (10000u)
+#define STATION_POLL_MS             (50u)
+
+/* static function prototypes    */
+static esp_err_t initNvs(void);
+static void loadDeviceConfig(void);
+static Status_t startStation(void);
+static Status_t connectStation(void);
+
+/*  nvs holds the configuration record and the saved access point */
+static esp_err_t initNvs(void)
+{
+    esp_err_t err = nvs_flash_init();
+
+    /* a partition without free pages is erased, the defaults are stored again */
+    if (err == ESP_ERR_NVS_NO_FREE_PAGES)
+    {
+        err = nvs_flash_erase();
+
+        if (err == ESP_OK)
+        {
+            err = nvs_flash_init();
+        }
+    }
+
+    return err;
+}
+
+/*  stage 0: the record the modules take their pins, queue lengths,
+ *  timeouts and priorities from. On any failure the defaults stay in use */
+static void loadDeviceConfig(void)
+{
+    static NvsConfigStore configStore(PERSISTENT_CONFIG_NAMESPACE, PERSISTENT_CONFIG_KEY);
+
+    if (initNvs() != ESP_OK)
+    {
+        ESP_LOGE(TAG, "nvs not initialized, configuration defaults in use");
+    }
+    else
+    {
+        /* errors are logged by the load */
+        (void)persistentConfig.load(configStore);
+    }
+}
+
+
+/*  starts the wifi driver in station mode, nothing is sent yet. Power save
+ *  settings that go out on association are made between this and
+ *  connectStation() */
+static Status_t startStation(void)
+{
+    Status_t status = STATUS_OKAY;
+    wifi_init_config_t wifiConfig = WIFI_INIT_CONFIG_DEFAULT();
+
+    tcpip_adapter_init();
+
+    if (    (initNvs() != ESP_OK)
+         || (esp_event_loop_create_default() != ESP_OK)
+         || (esp_wifi_init(&wifiConfig) != ESP_OK)
+         || (esp_wifi_set_mode(WIFI_MODE_STA) != ESP_OK))
+    {
+        status = STATUS_HAL_ERROR;
+    }
+
+    return status;
+}
+
+/*  joins the access point and waits for the dhcp address. The duty cycle
+ *  brings the station up only on the wakes that transmit. No event handler,
+ *  the address is polled */
+static Status_t connectStation(void)
+{
+    Status_t status = STATUS_OKAY;
+    tcpip_adapter_ip_info_t ipInfo;
+    uint32_t waitedMs = 0u;
+
+    if (    (esp_wifi_start() != ESP_OK)
+         || (esp_wifi_connect() != ESP_OK))
+    {
+        status = STATUS_HAL_ERROR;
+    }
+
+    ipInfo.ip.addr = 0u;
+
+    while ((status == STATUS_OKAY) && (ipInfo.ip.addr == 0u))
+    {
+        if (waitedMs >= STATION_CONNECT_TIMEOUT_MS)
+        {
+            status = STATUS_NOTIFY_TIMEOUT;
+        }
+        else
+        {
+            vTaskDelay(pdMS_TO_TICKS(STATION_POLL_MS));
+            waitedMs += STATION_POLL_MS;
+            (void)tcpip_adapter_get_ip_info(TCPIP_ADAPTER_IF_STA, &ipInfo);
+        }
+    }
+
+    return status;
+}
+
+
+#ifdef DUTY_CYCLE_MODE
+
+/* written as is at wake, no read back of the device before the burst:
+   AIN0 to ground, +-4.096 V, single shot, 860 SPS, comparator off. The burst
+   writes its own configuration with every conversion, single shot keeps the
+   device powered down between wakes */
+static const ads1115ConfigRegister_t bootAdcConfig =
+{
+    {
+        0u,
+        (uint8_t)ADS1115_MUX_AIN0_GND,
+        0b001u,
+        ADS1115_MODE_SINGLE_SHOT,
+        (uint8_t)ADS1115_DATA_RATE_860_SPS,
+        0u,
+        0u,
+        0u,
+        ADS1115_COMP_QUEUE_DISABLE,
+    }
+};
+
+/* deep sleep rf options of the sdk */
+#define RF_OPTION_NO_CALIBRATION    (2u)
+#define RF_OPTION_DISABLED          (4u)
+
+static const DutyCycleConfig_t dutyCycleConfig =
+{
+    DUTY_CYCLE_DEFAULT_SLEEP_MS,
+    DUTY_CYCLE_DEFAULT_BURST_SAMPLES,
+    DUTY_CYCLE_DEFAULT_TRANSMIT_EVERY,
+};
+
+/* +-4.096 V range, bus voltage on AIN0, shunt across AIN1 and AIN3 */
+static const Ads1115BurstConfig_t burstConfig =
+{
+    ADS1115_MUX_AIN0_GND,
+    ADS1115_MUX_AIN1_AIN3,
+    0b001u,
+    0.000125f,
+    0.000125f,
+};
+
+static const MqttConfig_t dutyCycleMqttConfig =
+{
+    BROKER_HOST,
+    BROKER_PORT,
+    "solar_meter",
+    "solar_meter/duty_cycle",
+    nullptr,
+    MQTT_DEFAULT_KEEP_ALIVE_S,
+    1u,
+    MQTT_DEFAULT_MAX_RETRIES,
+    MQTT_DEFAULT_ACK_TIMEOUT_MS,
+};
+
+/* static function prototypes    */
+static void waitForAcks(MqttClient & client);
+static void runDutyCycle(void);
+
+/*  gives the PUBACK one ack timeout before the radio goes off, the client
+ *  collects it in poll() */
+static void waitForAcks(MqttClient & client)
+{
+    MqttStats_t stats;
+    uint32_t waitedMs = 0u;
+
+    stats.inFlight = 1u;
+
+    while ((stats.inFlight > 0u) && (waitedMs < MQTT_DEFAULT_ACK_TIMEOUT_MS))
+    {
+        vTaskDelay(pdMS_TO_TICKS(STATION_POLL_MS));
+        waitedMs += STATION_POLL_MS;
+        client.poll();
+        (void)client.getStats(&stats);
+    }
+}
+
+/*  one wake: burst, rollup, maybe transmit, then deep sleep. Only the i2c
+ *  task is started, the rest of app_main never runs in this mode  */
+static void runDutyCycle(void)
+{
+    static SystemRtcMemory rtcMemory;
+    bool transmitDue = false;
+    Status_t status = STATUS_OKAY;
+
+    /* nvs is only read after a power loss, a wake takes the record from the
+       copy kept in rtc memory */
+    if (persistentConfig.loadCached(rtcMemory) != STATUS_OKAY)
+    {
+        loadDeviceConfig();
+
+        if (persistentConfig.cache(rtcMemory) != STATUS_OKAY)
+        {
+            ESP_LOGE(TAG, "configuration not cached");
+        }
+    }
+
+    init_i2cHandler();
+
+    /* the configuration is written as is, the device is not read back */
+    ADS1115 adc(bootAdcConfig);
+    Ads1115BurstSampler sampler(adc, burstConfig);
+    DutyCycle dutyCycle(rtcMemory, sampler);
+
+    if (dutyCycle.init(&dutyCycleConfig) == STATUS_OKAY)
+    {
+        dutyCycle.wake(&transmitDue);
+    }
+
+    /* the radio is only brought up on the wakes that transmit, a failed
+       transmit keeps the rollup for the next one */
+    if (transmitDue)
+    {
+        status = startStation();
+
+        if (status == STATUS_OKAY)
+        {
+            status = connectStation();
+        }
+
+        if (status == STATUS_OKAY)
+        {
+            status = mqttClient.init(&dutyCycleMqttConfig);
+        }
+
+        if (status == STATUS_OKAY)
+        {
+            status = dutyCycle.transmit(&mqttClient);
+        }
+
+        if (status == STATUS_OKAY)
+        {
+            waitForAcks(mqttClient);
+        }
+        else
+        {
+            ESP_LOGE(TAG, "rollup not transmitted, Error: %i", status);
+        }
+    }
+
+    /* rf calibration is skipped and the radio stays off unless the next
+       wake transmits */
+    esp_deep_sleep_set_rf_option(dutyCycle.nextWakeTransmits() ? RF_OPTION_NO_CALIBRATION : RF_OPTION_DISABLED);
+
+    if (dutyCycle.persist() != STATUS_OKAY)
+    {
+        ESP_LOGE(TAG, "duty cycle state not saved");
+    }
+
+    esp_deep_sleep(dutyCycle.getSleepUs());
+}
+#endif //DUTY_CYCLE_MODE
+
+
+/* telemetry goes to the broker at QoS 1 with the full window in flight,
+   configuration commands come back on their own topic */
+static const MqttConfig_t mqttConfig =
+{
+    BROKER_HOST,
+    BROKER_PORT,
+    "solar_meter",
+    "solar_meter/telemetry",
+    "solar_meter/config",
+    MQTT_DEFAULT_KEEP_ALIVE_S,
+    MQTT_MAX_WINDOW,
+    MQTT_DEFAULT_MAX_RETRIES,
+    MQTT_DEFAULT_ACK_TIMEOUT_MS,
+};
+
+/* a batch closes at least once a second, transmits wait for the DTIM
+   beacon of a 102 ms beacon interval */
+static const TransmitSchedulerConfig_t schedulerConfig =
+{
+    NETWORKING_DEFAULT_BATCH_LATENCY_MS,
+    TRANSMIT_DEFAULT_BEACON_INTERVAL_MS,
+    TRANSMIT_DEFAULT_DTIM_PERIOD,
+    TRANSMIT_DEFAULT_LISTEN_INTERVAL,
+    TRANSMIT_DEFAULT_MAX_MODEM_THRESHOLD,
+    TRANSMIT_DEFAULT_RADIO_TAIL_MS,
+};
+
+static TransmitScheduler transmitScheduler;
+
+/* scrape endpoint on the station address, every source reads the getStats()
+   snapshot of its module */
+static MetricsServer metricsServer;
+static PowerMonitorMetrics powerMonitorMetrics(powerMonitor);
+static I2cMetrics i2cMetrics;
+static NetworkingMetrics networkingMetrics(networkingModule);
+static MqttMetrics mqttMetrics(mqttClient);
+static DispatcherMetrics dispatcherMetrics(appDispatcher);
+
+/* static function prototypes    */
+static void netStartupTask(void * argument);
+static Status_t startMetricsServer(void);
+
+/*  the sources are fixed, only a port that can not be bound fails */
+static Status_t startMetricsServer(void)
+{
+    Status_t status = metricsServer.addSource(&powerMonitorMetrics);
+
+    if (status == STATUS_OKAY)
+    {
+        status = metricsServer.addSource(&i2cMetrics);
+    }
+
+    if (status == STATUS_OKAY)
+    {
+        status = metricsServer.addSource(&networkingMetrics);
+    }
+
+    if (status == STATUS_OKAY)
+    {
+        status = metricsServer.addSource(&mqttMetrics);
+    }
+
+    if (status == STATUS_OKAY)
+    {
+        status = metricsServer.addSource(&dispatcherMetrics);
+    }
+
+    if (status == STATUS_OKAY)
+    {
+        status = metricsServer.init(METRICS_SERVER_DEFAULT_PORT);
+    }
+
+    return status;
+}
+
+/*  background bring up of the networking, runs once and deletes itself.
+ *  Wi-Fi association and the transport go here, sampling is not held up */
+static void netStartupTask(void * argument)
+{
+    (void)argument;
+
+    /* the partition scan of the mount stays off the sampling path */
+    if ((telemetryFlash.init() == STATUS_OKAY) && (storeLog.mount() == STATUS_OKAY))
+    {
+        networkingModule.setStoreLog(&storeLog);
+    }
+    else
+    {
+        ESP_LOGE(TAG, "store log not mounted, failed batches are dropped");
+    }
+
+    /* the power save mode is set before association, the access point only
+       learns the listen interval then. Without the scheduler batches go out
+       as soon as they close */
+    if (startStation() != STATUS_OKAY)
+    {
+        ESP_LOGE(TAG, "station not started");
+    }
+    else if (transmitScheduler.init(&schedulerConfig) == STATUS_OKAY)
+    {
+        networkingModule.setTransmitScheduler(&transmitScheduler);
+    }
+    else
+    {
+        ESP_LOGE(TAG, "transmit scheduler not started");
+    }
+
+    /* without an address the client keeps reconnecting from the networking
+       task and the batches go to the store log until the link is up */
+    if (connectStation() != STATUS_OKAY)
+    {
+        ESP_LOGE(TAG, "station not connected");
+    }
+
+    if (mqttClient.init(&mqttConfig) == STATUS_OKAY)
+    {
+        networkingModule.setTransport(&mqttClient);
+    }
+    else
+    {
+        ESP_LOGE(TAG, "mqtt client not configured, batches are stored");
+    }
+
+    if (networkingModule.init() == STATUS_OKAY)
+    {
+        bootProfile.mark(BOOT_MILESTONE_NETWORK_READY);
+    }
+    else
+    {
+        ESP_LOGE(TAG, "networking not started");
+    }
+
+    if (startMetricsServer() != STATUS_OKAY)
+    {
+        ESP_LOGE(TAG, "metrics server not started");
+    }
+
+    vTaskDelete(NULL);
+}
+
+
 extern "C" void app_main()
 {
+    bootProfile.mark(BOOT_MILESTONE_APP_MAIN);
+
+#ifdef DUTY_CYCLE_MODE
+    runDutyCycle();
+#endif
+
+    loadDeviceConfig();
+    const device_config_t & config = persistentConfig.get();
 
     /* initialize task */
     // float voltageValue;
     // Status_t errRet;
 
-    /* initialize i2c handler task and i2c module    */
+    /* stage 1, sampling: i2c task, then the monitor on the dispatcher. The
+       sample clock writes the adc configuration with every trigger, the
+       device is not read or configured up front */
     init_i2cHandler();
+    Task::registerTask("i2c_task", i2c_getTaskHandle(), I2C_TASK_STACK_SIZE);
+
+    /* priorities are range checked by the load, they can not fail here */
+    (void)networkingModule.setPriority(config.networkingPriority);
+    (void)appDispatcher.setPriority(config.dispatcherPriority);
+
+#ifdef TIMESERIES_ENCODING
+    networkingModule.setSerializer(&timeSeriesSerializer);
+#endif
+
+    /* samples queue up from here on, whether networking is up or not */
+    if (networkingModule.initQueue(config.networkingQueueLength) != STATUS_OKAY)
+    {
+        ESP_LOGE(TAG, "networking queue not created");
+    }
+
+    /*  attach the active objects, then start their shared dispatcher.
+        The monitor starts the sample clock on its first period  */
+    if (configChannel.init(&bootRuntimeConfig) == STATUS_OKAY)
+    {
+        powerMonitor.setConfigChannel(&configChannel);
 
-    /*  initialize bus voltage module   */
-    init_BusVoltage();
+        /* handed to the transport once net_startup sets it */
+        networkingModule.setDownlink(&configChannel);
+    }
+    else
+    {
+        ESP_LOGE(TAG, "config channel not started, downlink commands are dropped");
+    }
+
+    powerMonitor.setRippleAnalyzer(&rippleAnalyzer);
+
+    if (transientCapture.configure(&captureConfig) == STATUS_OKAY)
+    {
+        powerMonitor.setTransientCapture(&transientCapture);
+    }
+    else
+    {
+        ESP_LOGE(TAG, "transient capture not configured");
+    }
+
+    if (adaptiveSampler.init(&samplerConfig) == STATUS_OKAY)
+    {
+        powerMonitor.setAdaptiveSampler(&adaptiveSampler);
+    }
+    else
+    {
+        ESP_LOGE(TAG, "adaptive sampler not started, fixed rate in use");
+    }
+
+    if (powerMonitor.init(appDispatcher) != STATUS_OKAY)
+    {
+        ESP_LOGE(TAG, "power monitor not attached");
+    }
+
+    if (cpuLoadReporter.init(appDispatcher) != STATUS_OKAY)
+    {
+        ESP_LOGE(TAG, "cpu load reporter not attached");
+    }
+
+    if (appDispatcher.init() != STATUS_OKAY)
+    {
+        ESP_LOGE(TAG, "dispatcher not started");
+    }
+    bootProfile.mark(BOOT_MILESTONE_SAMPLING_READY);
+
+    /* stage 2, networking in the background  */
+    if (xTaskCreate(netStartupTask, "net_startup", NET_STARTUP_STACK_SIZE, NULL, config.networkingPriority, NULL) != pdPASS)
+    {
+        ESP_LOGE(TAG, "networking startup not created");
+    }
+
+    uint32_t loopCount = 0u;
     
     while (1) 
     {
+        /* report measured stack and heap needs so both can be trimmed */
+        if ((loopCount++ % STACK_LOG_INTERVAL_S) == 0u)
+        {
+            Task::logStackUsage();
+            blockAllocator.logReport();
+            bootProfile.log();
+        }
+
         // /* get filtered voltage and current */
         // errRet = get_filtered_voltage(&voltageValue);
 
@@ -0,0 +1,443 @@
+/**
+ *******************************************************************************
+ * @file    bench_active_object.cpp
+ * @author  hq
+ * @date    2026-10-19 20:14:08
+ * @brief   RAM and latency of three modules as tasks of their own, as before
+ *  the active object migration, and as active objects on one
+ *  EventDispatcher. Two modules are periodic like PowerMonitor and
+ *  CpuLoadReporter, the third handles commands posted from another task like
+ *  the config channel. The periodic modules measure the jitter of their
+ *  interval, the command module the time from the post to its handler. The
+ *  second case gives the command handler the cost of a downlink change that
+ *  stops the sample clock.
+ *
+ *  usage: bench_active_object [seconds]
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * INCLUDES
+ *******************************************************************************/
+#include "host_test.h"
+#include "active_object.hpp"
+#include "timing.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+extern "C"
+{
+    #include "freertos/FreeRTOS.h"
+    #include "freertos/task.h"
+    #include "freertos/queue.h"
+    #include "esp_log.h"
+}
+
+/*******************************************************************************
+ * PRIVATE MACROS AND DEFINES
+ *******************************************************************************/
+#define BENCH_DEFAULT_SECONDS       (5u)
+#define BENCH_CASE_COUNT            (2u)
+#define BENCH_STACK_SIZE            (1024u)     /* of PowerMonitor as a task    */
+#define BENCH_TASK_QUEUE_LENGTH     (4u)
+#define BENCH_TARGET_POINTER_SIZE   (4u)
+#define BENCH_MONITOR_PERIOD_MS     (10u)
+#define BENCH_MONITOR_WORK_US       (200u)
+#define BENCH_REPORTER_PERIOD_MS    (100u)
+#define BENCH_REPORTER_WORK_US      (500u)
+#define BENCH_COMMAND_INTERVAL_MS   (7u)
+#define BENCH_MAX_SAMPLES           (16384u)
+#define BENCH_PERCENTILE            (99u)
+
+#define BENCH_SIGNAL_COMMAND        (EVENT_SIGNAL_USER)
+
+/*******************************************************************************
+ * PRIVATE TYPEDEFS
+ *******************************************************************************/
+typedef struct
+{
+    uint32_t count;
+    uint64_t sumUs;
+    uint32_t maxUs;
+    uint32_t samplesUs[BENCH_MAX_SAMPLES];
+} BenchTiming_t;
+
+typedef struct
+{
+    BenchTiming_t jitter;               /* |interval - period| of both periodic modules */
+    BenchTiming_t latency;              /* post to start of the command handler         */
+    uint32_t postFailures;
+} BenchResult_t;
+
+typedef struct
+{
+    const char * name;
+    uint32_t commandWorkUs;
+} BenchCase_t;
+
+/*  the interval of one periodic module, as PowerMonitor measures it    */
+typedef struct
+{
+    uint32_t periodMs;
+    uint32_t workUs;
+    uint32_t lastUs;
+    bool hasInterval;
+} BenchPeriodic_t;
+
+class PeriodicModuleTask : public Task
+{
+public:
+    BenchPeriodic_t periodic = {};
+    BenchResult_t * result = nullptr;
+    volatile bool running = true;
+
+    PeriodicModuleTask() : Task("bench_periodic", BENCH_STACK_SIZE) {}
+
+private:
+    void taskRun() override;
+};
+
+class CommandModuleTask : public Task
+{
+public:
+    QueueHandle_t queue = nullptr;
+    uint32_t workUs = 0u;
+    BenchResult_t * result = nullptr;
+
+    CommandModuleTask() : Task("bench_command", BENCH_STACK_SIZE) {}
+
+private:
+    void taskRun() override;
+};
+
+class PeriodicModuleObject : public ActiveObject
+{
+public:
+    BenchPeriodic_t periodic = {};
+    BenchResult_t * result = nullptr;
+
+    PeriodicModuleObject() : ActiveObject("bench_periodic") {}
+
+protected:
+    void dispatch(const Event_t & event) override;
+};
+
+class CommandModuleObject : public ActiveObject
+{
+public:
+    uint32_t workUs = 0u;
+    BenchResult_t * result = nullptr;
+
+    CommandModuleObject() : ActiveObject("bench_command") {}
+
+protected:
+    void dispatch(const Event_t & event) override;
+};
+
+/*  the modules of one run */
+typedef struct
+{
+    PeriodicModuleTask monitor;
+    PeriodicModuleTask reporter;
+    CommandModuleTask command;
+} TaskRun_t;
+
+typedef struct
+{
+    EventDispatcher dispatcher { "bench_dispatcher", BENCH_STACK_SIZE };
+    PeriodicModuleObject monitor;
+    PeriodicModuleObject reporter;
+    CommandModuleObject command;
+} DispatcherRun_t;
+
+/*******************************************************************************
+ * STATIC VARIABLES
+ *******************************************************************************/
+static const BenchCase_t benchCases[BENCH_CASE_COUNT] =
+{
+    { "light",          50u   },
+    { "slow command",   2000u },
+};
+
+static BenchResult_t taskResult;
+static BenchResult_t dispatcherResult;
+
+/*******************************************************************************
+ * GLOBAL VARIABLES
+ *******************************************************************************/
+HOST_TEST_MAIN_VARIABLES;
+
+/*******************************************************************************
+ * STATIC FUNCTIONS
+ *******************************************************************************/
+
+/*!
+ * \brief busy for the given time, as a handler doing its work
+ */
+static void spinUs(uint32_t us)
+{
+    uint32_t start = timing_getTimeUs();
+
+    while ((timing_getTimeUs() - start) < us)
+    {
+    }
+}
+
+static void addTiming(BenchTiming_t * timing, uint32_t us)
+{
+    taskENTER_CRITICAL();
+    if (timing->count < BENCH_MAX_SAMPLES)
+    {
+        timing->samplesUs[timing->count] = us;
+    }
+    timing->count++;
+    timing->sumUs += us;
+    if (us > timing->maxUs)
+    {
+        timing->maxUs = us;
+    }
+    taskEXIT_CRITICAL();
+}
+
+/*!
+ * \brief one step of a periodic module, the first step has no interval
+ */
+static void stepPeriodic(BenchPeriodic_t * periodic, BenchResult_t * result)
+{
+    uint32_t nowUs = timing_getTimeUs();
+    uint32_t intervalUs = nowUs - periodic->lastUs;
+    uint32_t nominalUs = periodic->periodMs * 1000u;
+
+    if (periodic->hasInterval)
+    {
+        addTiming(&result->jitter, (intervalUs > nominalUs) ? (intervalUs - nominalUs) : (nominalUs - intervalUs));
+    }
+    periodic->lastUs = nowUs;
+    periodic->hasInterval = true;
+
+    spinUs(periodic->workUs);
+}
+
+void PeriodicModuleTask::taskRun()
+{
+    TickType_t wakeTick = xTaskGetTickCount();
+
+    while (running)
+    {
+        vTaskDelayUntil(&wakeTick, pdMS_TO_TICKS(periodic.periodMs));
+        if (running)
+        {
+            stepPeriodic(&periodic, result);
+        }
+    }
+
+    /*! - a task must not return, it stays blocked once the run is over */
+    for (;;)
+    {
+        (void)ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+}
+
+void CommandModuleTask::taskRun()
+{
+    Event_t event;
+
+    for (;;)
+    {
+        if (xQueueReceive(queue, &event, portMAX_DELAY) == pdTRUE)
+        {
+            addTiming(&result->latency, timing_getTimeUs() - event.postedUs);
+            spinUs(workUs);
+        }
+    }
+}
+
+void PeriodicModuleObject::dispatch(const Event_t & event)
+{
+    if (event.signal == EVENT_SIGNAL_TIMEOUT)
+    {
+        stepPeriodic(&periodic, result);
+    }
+}
+
+void CommandModuleObject::dispatch(const Event_t & event)
+{
+    if (event.signal == BENCH_SIGNAL_COMMAND)
+    {
+        addTiming(&result->latency, timing_getTimeUs() - event.postedUs);
+        spinUs(workUs);
+    }
+}
+
+static void setPeriodic(BenchPeriodic_t * periodic, uint32_t periodMs, uint32_t workUs)
+{
+    periodic->periodMs = periodMs;
+    periodic->workUs = workUs;
+    periodic->hasInterval = false;
+}
+
+static void runTasks(TaskRun_t * run, const BenchCase_t & benchCase, uint32_t seconds, BenchResult_t * result)
+{
+    TickType_t endTick = 0u;
+
+    memset(result, 0, sizeof(*result));
+    setPeriodic(&run->monitor.periodic, BENCH_MONITOR_PERIOD_MS, BENCH_MONITOR_WORK_US);
+    setPeriodic(&run->reporter.periodic, BENCH_REPORTER_PERIOD_MS, BENCH_REPORTER_WORK_US);
+    run->monitor.result = result;
+    run->reporter.result = result;
+    run->command.result = result;
+    run->command.workUs = benchCase.commandWorkUs;
+    run->command.queue = xQueueCreate(BENCH_TASK_QUEUE_LENGTH, sizeof(Event_t));
+    HOST_CHECK(CHECK_POINTER_VALID(run->command.queue));
+
+    HOST_CHECK_EQUAL(STATUS_OKAY, run->monitor.initTask());
+    HOST_CHECK_EQUAL(STATUS_OKAY, run->reporter.initTask());
+    HOST_CHECK_EQUAL(STATUS_OKAY, run->command.initTask());
+
+    endTick = xTaskGetTickCount() + pdMS_TO_TICKS(seconds * 1000u);
+    while (xTaskGetTickCount() < endTick)
+    {
+        Event_t event;
+
+        event.signal = BENCH_SIGNAL_COMMAND;
+        event.param = 0u;
+        event.postedUs = timing_getTimeUs();
+        if (xQueueSendToBack(run->command.queue, &event, 0u) != pdTRUE)
+        {
+            result->postFailures++;
+        }
+        vTaskDelay(pdMS_TO_TICKS(BENCH_COMMAND_INTERVAL_MS));
+    }
+
+    run->monitor.running = false;
+    run->reporter.running = false;
+    vTaskDelay(pdMS_TO_TICKS(BENCH_REPORTER_PERIOD_MS + BENCH_REPORTER_WORK_US / 1000u + 1u));
+}
+
+static void runDispatcher(DispatcherRun_t * run, const BenchCase_t & benchCase, uint32_t seconds, BenchResult_t * result)
+{
+    EventDispatcherStats_t stats;
+    TickType_t endTick = 0u;
+
+    memset(result, 0, sizeof(*result));
+    setPeriodic(&run->monitor.periodic, BENCH_MONITOR_PERIOD_MS, BENCH_MONITOR_WORK_US);
+    setPeriodic(&run->reporter.periodic, BENCH_REPORTER_PERIOD_MS, BENCH_REPORTER_WORK_US);
+    run->monitor.result = result;
+    run->reporter.result = result;
+    run->command.result = result;
+    run->command.workUs = benchCase.commandWorkUs;
+
+    HOST_CHECK_EQUAL(STATUS_OKAY, run->dispatcher.attach(run->monitor));
+    HOST_CHECK_EQUAL(STATUS_OKAY, run->dispatcher.attach(run->reporter));
+    HOST_CHECK_EQUAL(STATUS_OKAY, run->dispatcher.attach(run->command));
+    HOST_CHECK_EQUAL(STATUS_OKAY, run->monitor.armTimer(BENCH_MONITOR_PERIOD_MS));
+    HOST_CHECK_EQUAL(STATUS_OKAY, run->reporter.armTimer(BENCH_REPORTER_PERIOD_MS));
+    HOST_CHECK_EQUAL(STATUS_OKAY, run->dispatcher.init());
+
+    endTick = xTaskGetTickCount() + pdMS_TO_TICKS(seconds * 1000u);
+    while (xTaskGetTickCount() < endTick)
+    {
+        if (run->command.post(BENCH_SIGNAL_COMMAND) != STATUS_OKAY)
+        {
+            result->postFailures++;
+        }
+        vTaskDelay(pdMS_TO_TICKS(BENCH_COMMAND_INTERVAL_MS));
+    }
+
+    HOST_CHECK_EQUAL(STATUS_OKAY, run->monitor.disarmTimer());
+    HOST_CHECK_EQUAL(STATUS_OKAY, run->reporter.disarmTimer());
+    vTaskDelay(pdMS_TO_TICKS(benchCase.commandWorkUs / 1000u + 1u));
+
+    /*! - the dispatcher saw the same posts the module counted */
+    HOST_CHECK_EQUAL(STATUS_OKAY, run->dispatcher.getStats(&stats));
+    HOST_CHECK_EQUAL(result->postFailures, stats.postFailures);
+    HOST_CHECK(stats.events >= result->latency.count);
+}
+
+static uint32_t meanUs(const BenchTiming_t & timing)
+{
+    return (timing.count > 0u) ? (uint32_t)(timing.sumUs / timing.count) : 0u;
+}
+
+static int compareUs(const void * a, const void * b)
+{
+    uint32_t left = *(const uint32_t *)a;
+    uint32_t right = *(const uint32_t *)b;
+
+    return (left > right) - (left < right);
+}
+
+/*!
+ * \brief the percentile of the samples kept, sorts them in place
+ */
+static uint32_t percentileUs(BenchTiming_t & timing)
+{
+    uint32_t kept = (timing.count < BENCH_MAX_SAMPLES) ? timing.count : BENCH_MAX_SAMPLES;
+    uint32_t value = 0u;
+
+    if (kept > 0u)
+    {
+        qsort(timing.samplesUs, kept, sizeof(uint32_t), compareUs);
+        value = timing.samplesUs[((kept - 1u) * BENCH_PERCENTILE) / 100u];
+    }
+
+    return value;
+}
+
+static void printResult(const char * caseName, const char * variant, BenchResult_t & result)
+{
+    printf("| %-12s | %-10s | %6u | %6u | %6u | %6u | %6u | %6u |\n", caseName, variant,
+           (unsigned)meanUs(result.jitter), (unsigned)percentileUs(result.jitter),
+           (unsigned)result.jitter.maxUs,
+           (unsigned)meanUs(result.latency), (unsigned)percentileUs(result.latency),
+           (unsigned)result.latency.maxUs);
+}
+
+/*******************************************************************************
+ * GLOBAL FUNCTIONS
+ *******************************************************************************/
+int main(int argc, char ** argv)
+{
+    uint32_t seconds = (argc > 1) ? (uint32_t)strtoul(argv[1], nullptr, 0) : BENCH_DEFAULT_SECONDS;
+    /*  a dispatcher queue item is the target pointer and the event */
+    uint32_t dispatcherQueueBytes = EVENT_DISPATCHER_QUEUE_LENGTH * (BENCH_TARGET_POINTER_SIZE + sizeof(Event_t));
+
+    esp_log_level_set("*", ESP_LOG_WARN);
+    if (seconds == 0u)
+    {
+        seconds = 1u;
+    }
+
+    /*! - the RAM follows from the configuration, the host stacks are not
+          the target stacks */
+    printf("RAM on the target, stacks and queue storage\n");
+    printf("| %-10s | %5s | %7s | %6s | %7s |\n", "variant", "tasks", "stack B", "queues", "queue B");
+    printf("| %-10s | %5u | %7u | %6u | %7u |\n", "tasks", 3u, (unsigned)(3u * BENCH_STACK_SIZE),
+           1u, (unsigned)(BENCH_TASK_QUEUE_LENGTH * sizeof(Event_t)));
+    printf("| %-10s | %5u | %7u | %6u | %7u |\n", "dispatcher", 1u, (unsigned)BENCH_STACK_SIZE,
+           1u, (unsigned)dispatcherQueueBytes);
+
+    printf("%u s per run, periods %u ms and %u ms, a command every %u ms, host threads\n",
+           (unsigned)seconds, (unsigned)BENCH_MONITOR_PERIOD_MS, (unsigned)BENCH_REPORTER_PERIOD_MS,
+           (unsigned)BENCH_COMMAND_INTERVAL_MS);
+    printf("| %-12s | %-10s | %6s | %6s | %6s | %6s | %6s | %6s |\n",
+           "case", "variant", "jit", "jit 99", "jit mx", "lat", "lat 99", "lat mx");
+    for (uint32_t i = 0u; i < BENCH_CASE_COUNT; i++)
+    {
+        /*! - never deleted, their threads stay blocked to the end of the
+              process and a destructor would pull their queues away */
+        runTasks(new TaskRun_t, benchCases[i], seconds, &taskResult);
+        runDispatcher(new DispatcherRun_t, benchCases[i], seconds, &dispatcherResult);
+
+        HOST_CHECK(taskResult.jitter.count > 0u);
+        HOST_CHECK(dispatcherResult.jitter.count > 0u);
+        HOST_CHECK_EQUAL(0u, taskResult.postFailures);
+        HOST_CHECK_EQUAL(0u, dispatcherResult.postFailures);
+
+        printResult(benchCases[i].name, "tasks", taskResult);
+        printResult(benchCases[i].name, "dispatcher", dispatcherResult);
+    }
+
+    return hostTestFailures;
+}
@@ -0,0 +1,228 @@
+/**
+ *******************************************************************************
+ * @file    bench_block_allocator.cpp
+ * @author  hq
+ * @date    2026-10-19 20:52:43
+ * @brief   Long running soak of the BlockAllocator behind operator new. A
+ *  few long lived blocks are taken first and held, then random allocations
+ *  and frees of firmware sized objects churn the pool. The report is read
+ *  after every operation, and the fragmentation and the largest free block
+ *  against the free pool bytes are printed at checkpoints. Every block is
+ *  filled and checked on its free, and the pool has to be whole again once
+ *  everything is freed.
+ *
+ *  usage: bench_block_allocator [operations]
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * INCLUDES
+ *******************************************************************************/
+#include "host_test.h"
+#include "block_allocator.hpp"
+
+#include <stdlib.h>
+#include <string.h>
+
+extern "C"
+{
+    #include "esp_log.h"
+}
+
+/*******************************************************************************
+ * PRIVATE MACROS AND DEFINES
+ *******************************************************************************/
+#define BENCH_DEFAULT_OPERATIONS    (1000000u)
+#define BENCH_CHECKPOINTS           (10u)
+#define BENCH_MAX_LIVE              (40u)
+#define BENCH_LONG_LIVED            (6u)
+#define BENCH_LARGEST_CLASS         (256u)
+
+/*******************************************************************************
+ * PRIVATE TYPEDEFS
+ *******************************************************************************/
+typedef struct
+{
+    uint16_t maxSize;
+    uint8_t weight;                     /* percent of the requests  */
+} BenchSizeBand_t;
+
+typedef struct
+{
+    uint8_t * block;
+    uint16_t size;
+    uint8_t pattern;
+} BenchSlot_t;
+
+/*******************************************************************************
+ * STATIC VARIABLES
+ *******************************************************************************/
+
+/*  mostly small objects, a few buffers, now and then one past the pool   */
+static const BenchSizeBand_t sizeBands[] =
+{
+    { 16u,  50u },
+    { 32u,  25u },
+    { 64u,  13u },
+    { 128u, 7u  },
+    { 256u, 4u  },
+    { 512u, 1u  },
+};
+
+static BenchSlot_t slots[BENCH_MAX_LIVE];
+static uint32_t liveCount = 0u;
+static uint32_t oversizedRequests = 0u;
+
+/*******************************************************************************
+ * GLOBAL VARIABLES
+ *******************************************************************************/
+HOST_TEST_MAIN_VARIABLES;
+
+/*******************************************************************************
+ * STATIC FUNCTIONS
+ *******************************************************************************/
+static uint16_t randomSize(void)
+{
+    uint32_t pick = (uint32_t)rand() % 100u;
+    uint16_t lowerSize = 0u;
+    uint16_t size = 1u;
+    bool found = false;
+
+    for (const BenchSizeBand_t & band : sizeBands)
+    {
+        if ((found == false) && (pick < band.weight))
+        {
+            size = (uint16_t)(lowerSize + 1u + ((uint32_t)rand() % (band.maxSize - lowerSize)));
+            found = true;
+        }
+        pick -= (found == false) ? band.weight : 0u;
+        lowerSize = band.maxSize;
+    }
+
+    return size;
+}
+
+static void allocateSlot(uint32_t index)
+{
+    BenchSlot_t * slot = &slots[index];
+
+    slot->size = randomSize();
+    slot->pattern = (uint8_t)rand();
+    oversizedRequests += (slot->size > BENCH_LARGEST_CLASS) ? 1u : 0u;
+    slot->block = (uint8_t *)blockAllocator.allocate(slot->size);
+    HOST_CHECK(slot->block != nullptr);
+    if (slot->block != nullptr)
+    {
+        memset(slot->block, slot->pattern, slot->size);
+    }
+}
+
+/*!
+ * \brief checks that no other allocation wrote into the block, then frees it
+ */
+static void freeSlot(uint32_t index)
+{
+    BenchSlot_t * slot = &slots[index];
+    bool intact = true;
+
+    for (uint16_t i = 0u; (slot->block != nullptr) && (i < slot->size); i++)
+    {
+        intact = intact && (slot->block[i] == slot->pattern);
+    }
+    HOST_CHECK(intact);
+
+    blockAllocator.deallocate(slot->block);
+    slot->block = nullptr;
+}
+
+/*******************************************************************************
+ * GLOBAL FUNCTIONS
+ *******************************************************************************/
+int main(int argc, char ** argv)
+{
+    uint32_t operations = (argc > 1) ? (uint32_t)strtoul(argv[1], nullptr, 0) : BENCH_DEFAULT_OPERATIONS;
+    BlockAllocatorReport_t baseline;
+    BlockAllocatorReport_t report;
+    uint64_t fragmentationSum = 0u;
+    uint16_t maxFragmentation = 0u;
+    uint32_t minLargestFree = UINT32_MAX;
+    uint32_t largeBlocked = 0u;
+    uint32_t checkpoint = 0u;
+
+    esp_log_level_set("*", ESP_LOG_WARN);
+    srand(1u);
+    if (operations < BENCH_CHECKPOINTS)
+    {
+        operations = BENCH_CHECKPOINTS;
+    }
+
+    HOST_CHECK_EQUAL(STATUS_OKAY, blockAllocator.getReport(&baseline));
+    printf("%u operations, up to %u live blocks, %u held to the end, pool %u B free at the start\n",
+           (unsigned)operations, (unsigned)BENCH_MAX_LIVE, (unsigned)BENCH_LONG_LIVED,
+           (unsigned)baseline.poolFreeBytes);
+    printf("| %9s | %4s | %6s | %7s | %5s | %9s | %9s |\n",
+           "ops", "live", "free B", "largest", "frag", "fallbacks", "heap live");
+
+    /*! - the long lived objects are taken first, as at boot */
+    for (liveCount = 0u; liveCount < BENCH_LONG_LIVED; liveCount++)
+    {
+        allocateSlot(liveCount);
+    }
+
+    for (uint32_t op = 1u; op <= operations; op++)
+    {
+        if ((liveCount == BENCH_LONG_LIVED) || ((liveCount < BENCH_MAX_LIVE) && ((rand() % 2) == 0)))
+        {
+            allocateSlot(liveCount++);
+        }
+        else
+        {
+            /*! - the last slot moves into the gap, the order stays random */
+            uint32_t index = BENCH_LONG_LIVED + ((uint32_t)rand() % (liveCount - BENCH_LONG_LIVED));
+
+            freeSlot(index);
+            slots[index] = slots[--liveCount];
+        }
+
+        HOST_CHECK_EQUAL(STATUS_OKAY, blockAllocator.getReport(&report));
+        fragmentationSum += report.poolFragmentationPermille;
+        if (report.poolFragmentationPermille > maxFragmentation)
+        {
+            maxFragmentation = report.poolFragmentationPermille;
+        }
+        if (report.poolLargestFree < minLargestFree)
+        {
+            minLargestFree = report.poolLargestFree;
+        }
+        largeBlocked += (report.poolLargestFree < BENCH_LARGEST_CLASS) ? 1u : 0u;
+
+        if (op >= (((checkpoint + 1u) * (uint64_t)operations) / BENCH_CHECKPOINTS))
+        {
+            checkpoint++;
+            printf("| %9u | %4u | %6u | %7u | %5u | %9u | %9u |\n",
+                   (unsigned)op, (unsigned)liveCount, (unsigned)report.poolFreeBytes,
+                   (unsigned)report.poolLargestFree, (unsigned)report.poolFragmentationPermille,
+                   (unsigned)report.heapFallbacks, (unsigned)report.heapLive);
+        }
+    }
+
+    printf("fragmentation mean %u, max %u permille, smallest largest free %u B, "
+           "no free %u B block in %.1f %% of the operations\n",
+           (unsigned)(fragmentationSum / operations), (unsigned)maxFragmentation,
+           (unsigned)minLargestFree, (unsigned)BENCH_LARGEST_CLASS,
+           (100.0 * largeBlocked) / operations);
+    printf("%u heap fallbacks, %u of them larger than the largest class\n",
+           (unsigned)report.heapFallbacks, (unsigned)oversizedRequests);
+
+    /*! - nothing leaks, the pool and the heap are back where they started */
+    while (liveCount > 0u)
+    {
+        freeSlot(--liveCount);
+    }
+    HOST_CHECK_EQUAL(STATUS_OKAY, blockAllocator.getReport(&report));
+    HOST_CHECK_EQUAL(baseline.poolFreeBytes, report.poolFreeBytes);
+    HOST_CHECK_EQUAL(baseline.heapLive, report.heapLive);
+    HOST_CHECK_EQUAL(0u, report.heapFailures);
+
+    return hostTestFailures;
+}
@@ -0,0 +1,142 @@
+/**
+ *******************************************************************************
+ * @file    bench_flash_ring_log.cpp
+ * @author  hq
+ * @date    2026-10-19 16:20:31
+ * @brief   Write throughput and wear of the FlashRingLog on the ported
+ *  telemetry partition, 64 sectors of RAM with NOR flash semantics. Every
+ *  append is followed by a flush, as the Networking Module does for each
+ *  stored batch. The last records are replayed and checked.
+ *
+ *  usage: bench_flash_ring_log [appends]
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * INCLUDES
+ *******************************************************************************/
+#include "host_test.h"
+#include "flash_device.hpp"
+#include "flash_ring_log.hpp"
+
+#include <string.h>
+
+extern "C"
+{
+    #include "host_port.h"
+    #include "esp_log.h"
+}
+
+/*******************************************************************************
+ * PRIVATE MACROS AND DEFINES
+ *******************************************************************************/
+#define BENCH_DEFAULT_APPENDS       (100000u)
+#define BENCH_PARTITION_LABEL       "telemetry"
+#define BENCH_PARTITION_SUBTYPE     (0x40)
+#define BENCH_MAX_RECORD_SIZE       (600u)
+
+/*******************************************************************************
+ * PRIVATE TYPEDEFS
+ *******************************************************************************/
+typedef struct
+{
+    const char * name;
+    uint16_t recordSize;
+} BenchCase_t;
+
+/*******************************************************************************
+ * STATIC VARIABLES
+ *******************************************************************************/
+static const BenchCase_t benchCases[] =
+{
+    { "time series batch",  46u  },
+    { "TLV batch",          118u },
+    { "large payload",      600u },
+};
+
+/*******************************************************************************
+ * GLOBAL VARIABLES
+ *******************************************************************************/
+HOST_TEST_MAIN_VARIABLES;
+
+/*******************************************************************************
+ * STATIC FUNCTIONS
+ *******************************************************************************/
+static void fillRecord(uint8_t * data, uint16_t size, uint32_t index)
+{
+    for (uint16_t i = 0u; i < size; i++)
+    {
+        data[i] = (uint8_t)(index + (i * 7u));
+    }
+}
+
+static void runCase(const BenchCase_t & benchCase, uint32_t appends)
+{
+    PartitionFlash flash(BENCH_PARTITION_LABEL, (esp_partition_subtype_t)BENCH_PARTITION_SUBTYPE);
+    FlashRingLog log(flash);
+    FlashRingLogStats_t stats;
+    host_flash_stats_t flashStats;
+    uint8_t record[BENCH_MAX_RECORD_SIZE];
+    uint8_t readBack[BENCH_MAX_RECORD_SIZE];
+    uint16_t length = 0u;
+
+    host_flashReset();
+    HOST_CHECK_EQUAL(STATUS_OKAY, flash.init());
+    HOST_CHECK_EQUAL(STATUS_OKAY, log.mount());
+
+    for (uint32_t i = 0u; i < appends; i++)
+    {
+        fillRecord(record, benchCase.recordSize, i);
+        HOST_CHECK_EQUAL(STATUS_OKAY, log.append(record, benchCase.recordSize));
+        HOST_CHECK_EQUAL(STATUS_OKAY, log.flush());
+    }
+
+    HOST_CHECK_EQUAL(STATUS_OKAY, log.getStats(&stats));
+    HOST_CHECK_EQUAL(ESP_OK, host_flashGetStats(BENCH_PARTITION_LABEL, &flashStats));
+    HOST_CHECK_EQUAL(0u, flashStats.programErrors);
+    HOST_CHECK_EQUAL(appends, stats.recordsAppended);
+    HOST_CHECK_EQUAL(appends, stats.recordsPending + stats.recordsOverwritten);
+
+    /*! - the oldest record left is intact after all the wraps */
+    uint32_t oldest = appends - stats.recordsPending;
+    fillRecord(record, benchCase.recordSize, oldest);
+    HOST_CHECK_EQUAL(STATUS_OKAY, log.peek(readBack, sizeof(readBack), &length));
+    HOST_CHECK_EQUAL(benchCase.recordSize, length);
+    HOST_CHECK(memcmp(record, readBack, benchCase.recordSize) == 0);
+    HOST_CHECK_EQUAL(STATUS_OKAY, log.consume());
+
+    uint32_t erases = (stats.sectorErases > 0u) ? stats.sectorErases : 1u;
+    printf("| %-17s | %5u | %8u | %8u | %6.2f | %6.1f | %5u |\n",
+           benchCase.name, (unsigned)benchCase.recordSize,
+           (unsigned)stats.recordsPending,
+           (unsigned)(stats.bytesAppended / erases),
+           (double)stats.pageWrites / appends,
+           (double)stats.sectorErases / stats.sectorCount,
+           (unsigned)stats.maxEraseCount);
+}
+
+/*******************************************************************************
+ * GLOBAL FUNCTIONS
+ *******************************************************************************/
+int main(int argc, char ** argv)
+{
+    uint32_t appends = (argc > 1) ? (uint32_t)strtoul(argv[1], nullptr, 0) : BENCH_DEFAULT_APPENDS;
+
+    /*! - the ring wraps on purpose, each wrap warns of overwritten records */
+    esp_log_level_set("*", ESP_LOG_ERROR);
+    if (appends == 0u)
+    {
+        appends = 1u;
+    }
+
+    printf("%u appends, each flushed, on the %s partition\n",
+           (unsigned)appends, BENCH_PARTITION_LABEL);
+    printf("| %-17s | %5s | %8s | %8s | %6s | %6s | %5s |\n",
+           "case", "bytes", "kept", "B/erase", "pages", "erases", "max");
+    for (const BenchCase_t & benchCase : benchCases)
+    {
+        runCase(benchCase, appends);
+    }
+
+    return hostTestFailures;
+}
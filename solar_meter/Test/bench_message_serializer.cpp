@@ -0,0 +1,450 @@
+/**
+ *******************************************************************************
+ * @file    bench_message_serializer.cpp
+ * @author  hq
+ * @date    2026-10-19 19:31:54
+ * @brief   Bytes per sample and encode cycles of the TLV and JSON encodings
+ *  on the trace in data/, cut into batches the way the Networking Module
+ *  fills them, voltage, current and power of a sample one after the other.
+ *  One case closes every batch with a capture blob. The JSON payloads are
+ *  checked for one object per message. The snprintf formatter JsonWriter
+ *  replaced runs on the same batches as a comparator, and has to produce the
+ *  same document.
+ *
+ *  usage: bench_message_serializer <trace.csv>
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * INCLUDES
+ *******************************************************************************/
+#include "host_test.h"
+#include "message_serializer.hpp"
+#include "timing.h"
+
+#include <stdio.h>
+#include <string.h>
+
+extern "C"
+{
+    #include "esp_log.h"
+}
+
+/*******************************************************************************
+ * PRIVATE MACROS AND DEFINES
+ *******************************************************************************/
+#define BENCH_MAX_SAMPLES           (8192u)
+#define BENCH_MAX_BATCH             (24u)
+#define BENCH_PAYLOAD_SIZE          (2048u)
+#define BENCH_LINE_SIZE             (64u)
+#define BENCH_BLOB_SIZE             (32u)
+#define BENCH_SERIES_COUNT          (3u)
+
+#define SNPRINTF_HEADER             "{\"m\":["
+#define SNPRINTF_TRAILER            "]}"
+#define SNPRINTF_SCALAR_EXTRA       (36u)   /* widest %.3f of a float is 48, not 12 */
+
+/*******************************************************************************
+ * PRIVATE TYPEDEFS
+ *******************************************************************************/
+typedef struct
+{
+    uint32_t tick;
+    int32_t voltageMv;
+    int32_t currentMa;
+} TraceSample_t;
+
+typedef struct
+{
+    const char * name;
+    uint16_t batchMessages;
+    bool blob;                          /* last message of a batch is a capture */
+} BenchCase_t;
+
+typedef struct
+{
+    uint32_t bytes;
+    uint64_t cycles;
+} SerializerResult_t;
+
+/*  the JSON encoding as it was written before JsonWriter, with snprintf */
+class SnprintfJsonSerializer : public JsonSerializer
+{
+public:
+    uint16_t getEntrySize(const NetworkingMessage_t * message) const override;
+    Status_t serialize(const NetworkingMessage_t * messages, uint16_t count,
+                       uint8_t * payload, uint16_t capacity, uint16_t * length) override;
+};
+
+/*******************************************************************************
+ * STATIC VARIABLES
+ *******************************************************************************/
+static const BenchCase_t benchCases[] =
+{
+    { "8 messages",         8u,  false },
+    { "16 messages",        16u, false },
+    { "24 messages",        24u, false },
+    { "16 messages + blob", 16u, true  },
+};
+
+static const MessageId_t seriesIds[BENCH_SERIES_COUNT] =
+{
+    MESSAGE_ID_BUS_VOLTAGE,
+    MESSAGE_ID_BUS_CURRENT,
+    MESSAGE_ID_POWER,
+};
+
+static const char base64Alphabet[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+static TraceSample_t trace[BENCH_MAX_SAMPLES];
+static uint32_t traceLength = 0u;
+
+static uint8_t blobData[BENCH_BLOB_SIZE];
+static uint8_t payload[BENCH_PAYLOAD_SIZE];
+static uint8_t comparePayload[BENCH_PAYLOAD_SIZE];
+
+/*******************************************************************************
+ * GLOBAL VARIABLES
+ *******************************************************************************/
+HOST_TEST_MAIN_VARIABLES;
+
+/*******************************************************************************
+ * STATIC FUNCTIONS
+ *******************************************************************************/
+
+/*!
+ * \brief reads tick, millivolts and milliamps per line, skips the comments
+ * and the column names
+ */
+static bool loadTrace(const char * path)
+{
+    FILE * file = fopen(path, "r");
+    char line[BENCH_LINE_SIZE];
+
+    while ((file != nullptr) && (fgets(line, sizeof(line), file) != nullptr) && (traceLength < BENCH_MAX_SAMPLES))
+    {
+        unsigned long tick = 0u;
+        long voltage = 0;
+        long current = 0;
+
+        if ((line[0] != '#') && (sscanf(line, "%lu,%ld,%ld", &tick, &voltage, &current) == 3))
+        {
+            trace[traceLength].tick = (uint32_t)tick;
+            trace[traceLength].voltageMv = (int32_t)voltage;
+            trace[traceLength].currentMa = (int32_t)current;
+            traceLength++;
+        }
+    }
+
+    if (file != nullptr)
+    {
+        fclose(file);
+    }
+
+    return (traceLength > 0u);
+}
+
+/*!
+ * \brief the float a series carries for the sample, as the power monitor
+ * queues it
+ */
+static float seriesValue(const TraceSample_t & sample, uint8_t series)
+{
+    float voltage = (float)sample.voltageMv / 1000.0f;
+    float current = (float)sample.currentMa / 1000.0f;
+    float value = voltage;
+
+    if (series == 1u)
+    {
+        value = current;
+    }
+    else if (series == 2u)
+    {
+        value = voltage * current;
+    }
+
+    return value;
+}
+
+static uint16_t putBase64(char * dst, const uint8_t * src, uint16_t length)
+{
+    uint16_t index = 0u;
+
+    for (uint16_t i = 0u; i < length; i += 3u)
+    {
+        uint32_t triple = (uint32_t)src[i] << 16;
+
+        if ((i + 1u) < length)
+        {
+            triple |= (uint32_t)src[i + 1u] << 8;
+        }
+        if ((i + 2u) < length)
+        {
+            triple |= src[i + 2u];
+        }
+
+        dst[index++] = base64Alphabet[(triple >> 18) & 0x3Fu];
+        dst[index++] = base64Alphabet[(triple >> 12) & 0x3Fu];
+        dst[index++] = ((i + 1u) < length) ? base64Alphabet[(triple >> 6) & 0x3Fu] : '=';
+        dst[index++] = ((i + 2u) < length) ? base64Alphabet[triple & 0x3Fu] : '=';
+    }
+
+    return index;
+}
+
+/*!
+ * \brief formats the value of a scalar message as a JSON number
+ *
+ * \return int - characters written, negative if the type is not a scalar
+ */
+static int formatValue(char * dst, uint16_t size, const NetworkingMessage_t * message)
+{
+    const MessageInfo_t * info = messageRegistry_getInfo(message->id);
+    int written = -1;
+
+    if (    (CHECK_POINTER_VALID(info))
+         && (message->buffer->length >= sizeof(uint32_t)))
+    {
+        switch (info->type)
+        {
+            case MESSAGE_TYPE_FLOAT:
+            {
+                float value;
+                memcpy(&value, message->buffer->data, sizeof(value));
+                written = snprintf(dst, size, "%.3f", (double)value);
+                break;
+            }
+
+            case MESSAGE_TYPE_INT32:
+            {
+                int32_t value;
+                memcpy(&value, message->buffer->data, sizeof(value));
+                written = snprintf(dst, size, "%ld", (long)value);
+                break;
+            }
+
+            case MESSAGE_TYPE_UINT32:
+            {
+                uint32_t value;
+                memcpy(&value, message->buffer->data, sizeof(value));
+                written = snprintf(dst, size, "%lu", (unsigned long)value);
+                break;
+            }
+
+            default:
+                break;
+        }
+    }
+
+    return written;
+}
+
+uint16_t SnprintfJsonSerializer::getEntrySize(const NetworkingMessage_t * message) const
+{
+    return JsonSerializer::getEntrySize(message) + SNPRINTF_SCALAR_EXTRA;
+}
+
+Status_t SnprintfJsonSerializer::serialize(const NetworkingMessage_t * messages, uint16_t count,
+                                           uint8_t * payload, uint16_t capacity, uint16_t * length)
+{
+    Status_t status = STATUS_OKAY;
+    char * out = (char *)payload;
+    uint16_t index = 0u;
+
+    if (    (CHECK_POINTER_VALID(messages) == false)
+         || (CHECK_POINTER_VALID(payload) == false)
+         || (CHECK_POINTER_VALID(length) == false))
+    {
+        status = STATUS_NULL_POINTER;
+    }
+    else if (capacity < getHeaderSize())
+    {
+        status = STATUS_OUT_OF_BOUNDS;
+    }
+
+    if (status == STATUS_OKAY)
+    {
+        memcpy(out, SNPRINTF_HEADER, sizeof(SNPRINTF_HEADER) - 1u);
+        index = sizeof(SNPRINTF_HEADER) - 1u;
+    }
+
+    for (uint16_t i = 0u; (i < count) && (status == STATUS_OKAY); i++)
+    {
+        const NetworkingMessage_t * message = &messages[i];
+        const MessageInfo_t * info = messageRegistry_getInfo(message->id);
+        int written;
+
+        if ((index + getEntrySize(message) + sizeof(SNPRINTF_TRAILER)) > capacity)
+        {
+            status = STATUS_OUT_OF_BOUNDS;
+        }
+        else
+        {
+            written = snprintf(&out[index], capacity - index, "%s{\"n\":\"%s\",\"t\":%lu,\"v\":",
+                               (i > 0u) ? "," : "",
+                               messageRegistry_getName(message->id),
+                               (unsigned long)message->timestamp);
+            index += (uint16_t)written;
+
+            written = formatValue(&out[index], capacity - index, message);
+            if (written >= 0)
+            {
+                index += (uint16_t)written;
+            }
+            else
+            {
+                out[index++] = '"';
+                index += putBase64(&out[index], message->buffer->data, message->buffer->length);
+                out[index++] = '"';
+            }
+
+            written = snprintf(&out[index], capacity - index, ",\"u\":\"%s\"}",
+                               CHECK_POINTER_VALID(info) ? info->unit : "");
+            index += (uint16_t)written;
+        }
+    }
+
+    if (status == STATUS_OKAY)
+    {
+        memcpy(&out[index], SNPRINTF_TRAILER, sizeof(SNPRINTF_TRAILER) - 1u);
+        index += sizeof(SNPRINTF_TRAILER) - 1u;
+        *length = index;
+    }
+
+    return status;
+}
+
+/*!
+ * \brief encodes one batch into the destination, returns its length
+ */
+static uint16_t serializeBatch(MessageSerializer & serializer, const NetworkingMessage_t * messages,
+                               uint16_t count, uint8_t * destination, SerializerResult_t * result)
+{
+    uint16_t length = 0u;
+    uint32_t start = timing_getCycleCount();
+    Status_t status = serializer.serialize(messages, count, destination, BENCH_PAYLOAD_SIZE, &length);
+    uint32_t cycles = timing_getCycleCount() - start;
+
+    HOST_CHECK_EQUAL(STATUS_OKAY, status);
+    result->bytes += length;
+    result->cycles += cycles;
+
+    return length;
+}
+
+/*!
+ * \brief counts the objects of the "m" array, one per message
+ */
+static uint16_t countJsonEntries(uint16_t length)
+{
+    uint16_t entries = 0u;
+
+    for (uint16_t i = 0u; i < length; i++)
+    {
+        entries += (memcmp(&payload[i], "{\"n\":", 5u) == 0) ? 1u : 0u;
+    }
+
+    return entries;
+}
+
+/*!
+ * \brief the whole trace in batches, every encoding of every batch
+ */
+static void runCase(const BenchCase_t & benchCase)
+{
+    TlvSerializer tlv;
+    JsonSerializer json;
+    SnprintfJsonSerializer snprintfJson;
+    NetworkingMessage_t messages[BENCH_MAX_BATCH];
+    MessageBuffer_t buffers[BENCH_MAX_BATCH];
+    float values[BENCH_MAX_BATCH];
+    SerializerResult_t tlvResult = {};
+    SerializerResult_t jsonResult = {};
+    SerializerResult_t snprintfResult = {};
+    uint32_t totalMessages = traceLength * BENCH_SERIES_COUNT;
+    uint32_t serialized = 0u;
+    uint32_t batches = 0u;
+    uint32_t m = 0u;
+
+    memset(buffers, 0, sizeof(buffers));
+
+    while (m < totalMessages)
+    {
+        uint16_t scalars = benchCase.blob ? (uint16_t)(benchCase.batchMessages - 1u) : benchCase.batchMessages;
+        uint16_t count = 0u;
+        uint16_t length = 0u;
+
+        /*! - a batch may end between the series of one sample */
+        for (; (m < totalMessages) && (count < scalars); m++)
+        {
+            const TraceSample_t & sample = trace[m / BENCH_SERIES_COUNT];
+            uint8_t series = (uint8_t)(m % BENCH_SERIES_COUNT);
+
+            values[count] = seriesValue(sample, series);
+            buffers[count].data = (uint8_t *)&values[count];
+            buffers[count].capacity = sizeof(float);
+            buffers[count].length = sizeof(float);
+            messages[count].id = seriesIds[series];
+            messages[count].timestamp = sample.tick;
+            messages[count].buffer = &buffers[count];
+            count++;
+        }
+
+        if (benchCase.blob)
+        {
+            buffers[count].data = blobData;
+            buffers[count].capacity = sizeof(blobData);
+            buffers[count].length = sizeof(blobData);
+            messages[count].id = MESSAGE_ID_CAPTURE;
+            messages[count].timestamp = messages[count - 1u].timestamp;
+            messages[count].buffer = &buffers[count];
+            count++;
+        }
+
+        (void)serializeBatch(tlv, messages, count, payload, &tlvResult);
+        length = serializeBatch(json, messages, count, payload, &jsonResult);
+        HOST_CHECK_EQUAL(count, countJsonEntries(length));
+
+        /*! - the comparator writes the same document, finite floats only */
+        HOST_CHECK_EQUAL(length, serializeBatch(snprintfJson, messages, count, comparePayload, &snprintfResult));
+        HOST_CHECK(memcmp(payload, comparePayload, length) == 0);
+
+        serialized += count;
+        batches++;
+    }
+
+    printf("| %-18s | %6.2f | %6.2f | %8u | %8u | %8u |\n", benchCase.name,
+           (double)tlvResult.bytes / serialized, (double)jsonResult.bytes / serialized,
+           (unsigned)(tlvResult.cycles / batches), (unsigned)(jsonResult.cycles / batches),
+           (unsigned)(snprintfResult.cycles / batches));
+}
+
+/*******************************************************************************
+ * GLOBAL FUNCTIONS
+ *******************************************************************************/
+int main(int argc, char ** argv)
+{
+    const char * path = (argc > 1) ? argv[1] : "data/solar_day_trace.csv";
+
+    esp_log_level_set("*", ESP_LOG_WARN);
+    for (uint16_t i = 0u; i < sizeof(blobData); i++)
+    {
+        blobData[i] = (uint8_t)(i * 37u);
+    }
+
+    HOST_CHECK(loadTrace(path));
+    if (traceLength > 0u)
+    {
+        printf("%u samples from %s, host cycles at %u MHz\n",
+               (unsigned)traceLength, path, (unsigned)TIMING_CPU_FREQ_MHZ);
+        printf("| %-18s | %6s | %6s | %8s | %8s | %8s |\n",
+               "batch", "TLV B", "JSON B", "TLV c/b", "JSON c/b", "snprintf");
+        for (const BenchCase_t & benchCase : benchCases)
+        {
+            runCase(benchCase);
+        }
+    }
+
+    return hostTestFailures;
+}
@@ -0,0 +1,417 @@
+/**
+ *******************************************************************************
+ * @file    bench_mqtt_loopback.cpp
+ * @author  hq
+ * @date    2026-10-19 17:05:48
+ * @brief   Publish throughput and PUBACK latency of the MqttClient over a
+ *  loopback TCP connection, for stop and wait and for the full window. The
+ *  broker stand-in below answers CONNECT, PUBLISH, SUBSCRIBE and PINGREQ.
+ *  It holds every PUBACK for a set round trip, and drops a set share of the
+ *  PUBLISH packets to stand for a lost packet or a lost ack. Every payload
+ *  must reach the broker at least once.
+ *
+ *  usage: bench_mqtt_loopback [publishes]
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * INCLUDES
+ *******************************************************************************/
+#include "host_test.h"
+#include "mqtt_client.hpp"
+#include "socket_stream.hpp"
+
+#include <string.h>
+
+extern "C"
+{
+    #include "freertos/FreeRTOS.h"
+    #include "freertos/task.h"
+    #include "esp_log.h"
+    #include "esp_timer.h"
+}
+
+/*******************************************************************************
+ * PRIVATE MACROS AND DEFINES
+ *******************************************************************************/
+#define BENCH_DEFAULT_PUBLISHES     (500u)
+#define BENCH_BROKER_HOST           "127.0.0.1"
+#define BENCH_BROKER_PORT           (18830u)
+#define BENCH_PORT_ATTEMPTS         (16u)
+#define BENCH_ROUND_TRIP_MS         (10u)
+#define BENCH_ACK_TIMEOUT_MS        (100u)
+#define BENCH_MAX_RETRIES           (8u)
+#define BENCH_PAYLOAD_SIZE          (118u)      /* TLV batch of 16 samples  */
+#define BENCH_DRAIN_MS              (5000u)
+#define BENCH_BROKER_STACK_SIZE     (4096u)
+
+#define BROKER_RX_BUFFER_SIZE       (1024u)
+#define BROKER_MAX_PENDING_ACKS     (16u)
+#define BROKER_POLL_MS              (1u)
+
+/*******************************************************************************
+ * PRIVATE TYPEDEFS
+ *******************************************************************************/
+typedef struct
+{
+    uint8_t windowSize;
+    uint8_t lossPercent;
+} BenchCase_t;
+
+typedef struct
+{
+    uint16_t packetId;
+    TickType_t dueTick;
+} PendingAck_t;
+
+/*  MQTT 3.1.1 broker stand-in for one client at a time, on its own task */
+class TestBroker
+{
+public:
+    volatile uint8_t lossPercent = 0u;
+    volatile uint32_t publishesReceived = 0u;
+    volatile uint32_t publishesDropped = 0u;
+
+    Status_t start(uint16_t * port);
+    void stop(void);
+
+    /*  distinct packet ids seen since the last reset, duplicates excluded */
+    uint32_t getDelivered(void) const { return delivered; }
+    void reset(void);
+
+private:
+    SocketListener listener;
+    SocketStream stream;
+    volatile bool running = false;
+    volatile bool stopped = false;
+
+    uint8_t rxBuffer[BROKER_RX_BUFFER_SIZE];
+    uint16_t rxLength = 0u;
+    PendingAck_t pending[BROKER_MAX_PENDING_ACKS];
+    uint8_t pendingCount = 0u;
+    uint8_t seen[UINT16_MAX + 1u];
+    volatile uint32_t delivered = 0u;
+
+    static void taskEntry(void * argument);
+    void serve(void);
+    bool handlePacket(const uint8_t * packet, uint32_t headerLength, uint32_t bodyLength);
+    bool sendAcksDue(void);
+};
+
+/*******************************************************************************
+ * STATIC VARIABLES
+ *******************************************************************************/
+static const BenchCase_t benchCases[] =
+{
+    { 1u,               0u  },
+    { 1u,               2u  },
+    { 1u,               10u },
+    { MQTT_MAX_WINDOW,  0u  },
+    { MQTT_MAX_WINDOW,  2u  },
+    { MQTT_MAX_WINDOW,  10u },
+};
+
+static TestBroker broker;
+
+/*******************************************************************************
+ * GLOBAL VARIABLES
+ *******************************************************************************/
+HOST_TEST_MAIN_VARIABLES;
+
+/*******************************************************************************
+ * STATIC FUNCTIONS
+ *******************************************************************************/
+Status_t TestBroker::start(uint16_t * port)
+{
+    Status_t status = STATUS_HAL_ERROR;
+
+    /*! - parallel runs may hold the first ports */
+    for (uint16_t i = 0u; (i < BENCH_PORT_ATTEMPTS) && (status != STATUS_OKAY); i++)
+    {
+        *port = (uint16_t)(BENCH_BROKER_PORT + i);
+        status = listener.listenOn(*port, 1u);
+    }
+
+    if (status == STATUS_OKAY)
+    {
+        running = true;
+        if (xTaskCreate(taskEntry, "broker", BENCH_BROKER_STACK_SIZE, this, 5u, nullptr) != pdPASS)
+        {
+            status = STATUS_OS_ERROR;
+        }
+    }
+
+    return status;
+}
+
+void TestBroker::stop(void)
+{
+    running = false;
+    while (stopped == false)
+    {
+        vTaskDelay(1u);
+    }
+}
+
+void TestBroker::reset(void)
+{
+    memset(seen, 0, sizeof(seen));
+    delivered = 0u;
+    publishesReceived = 0u;
+    publishesDropped = 0u;
+}
+
+void TestBroker::taskEntry(void * argument)
+{
+    static_cast<TestBroker *>(argument)->serve();
+    vTaskDelete(nullptr);
+}
+
+/*!
+ * \brief accepts one client at a time and answers it until it goes away
+ */
+void TestBroker::serve(void)
+{
+    while (running)
+    {
+        bool accepted = false;
+
+        (void)listener.acceptStream(stream, &accepted, BENCH_ACK_TIMEOUT_MS);
+        rxLength = 0u;
+        pendingCount = 0u;
+
+        while (running && accepted)
+        {
+            uint16_t received = 0u;
+
+            if (stream.receiveBytes(&rxBuffer[rxLength], BROKER_RX_BUFFER_SIZE - rxLength,
+                                    &received, BROKER_POLL_MS) != STATUS_OKAY)
+            {
+                accepted = false;
+            }
+            rxLength += received;
+
+            /*! - handle every complete packet, the remaining length is a
+                  varint of up to four bytes */
+            bool parsing = accepted;
+            while (parsing && (rxLength >= 2u))
+            {
+                uint32_t bodyLength = 0u;
+                uint32_t headerLength = 1u;
+                bool lengthComplete = false;
+
+                while ((lengthComplete == false) && (headerLength < rxLength) && (headerLength <= 4u))
+                {
+                    bodyLength |= (uint32_t)(rxBuffer[headerLength] & 0x7Fu) << (7u * (headerLength - 1u));
+                    lengthComplete = ((rxBuffer[headerLength] & 0x80u) == 0u);
+                    headerLength++;
+                }
+
+                if (lengthComplete && ((headerLength + bodyLength) <= rxLength))
+                {
+                    uint32_t total = headerLength + bodyLength;
+
+                    accepted = handlePacket(rxBuffer, headerLength, bodyLength);
+                    memmove(rxBuffer, &rxBuffer[total], rxLength - total);
+                    rxLength = (uint16_t)(rxLength - total);
+                    parsing = accepted;
+                }
+                else
+                {
+                    parsing = false;
+                }
+            }
+
+            if (accepted)
+            {
+                accepted = sendAcksDue();
+            }
+        }
+
+        stream.closeStream();
+    }
+
+    listener.closeListener();
+    stopped = true;
+}
+
+bool TestBroker::handlePacket(const uint8_t * packet, uint32_t headerLength, uint32_t bodyLength)
+{
+    const uint8_t * body = &packet[headerLength];
+    bool ok = true;
+
+    switch (packet[0] & 0xF0u)
+    {
+        case 0x10u:
+        {
+            static const uint8_t connack[4] = { 0x20u, 2u, 0u, 0u };
+            ok = (stream.sendBytes(connack, sizeof(connack)) == STATUS_OKAY);
+            break;
+        }
+
+        case 0x30u:
+        {
+            uint16_t topicLength = (uint16_t)((body[0] << 8) | body[1]);
+            uint16_t packetId = (uint16_t)((body[2u + topicLength] << 8) | body[3u + topicLength]);
+
+            publishesReceived++;
+            if ((uint32_t)(rand() % 100) < lossPercent)
+            {
+                publishesDropped++;
+            }
+            else
+            {
+                if (seen[packetId] == 0u)
+                {
+                    seen[packetId] = 1u;
+                    delivered++;
+                }
+                if (pendingCount < BROKER_MAX_PENDING_ACKS)
+                {
+                    pending[pendingCount].packetId = packetId;
+                    pending[pendingCount].dueTick = xTaskGetTickCount() + pdMS_TO_TICKS(BENCH_ROUND_TRIP_MS);
+                    pendingCount++;
+                }
+            }
+            break;
+        }
+
+        case 0x80u:
+        {
+            uint8_t suback[5] = { 0x90u, 3u, body[0], body[1], 1u };
+            ok = (stream.sendBytes(suback, sizeof(suback)) == STATUS_OKAY);
+            break;
+        }
+
+        case 0xC0u:
+        {
+            static const uint8_t pingResponse[2] = { 0xD0u, 0u };
+            ok = (stream.sendBytes(pingResponse, sizeof(pingResponse)) == STATUS_OKAY);
+            break;
+        }
+
+        default:
+            break;
+    }
+
+    (void)bodyLength;
+
+    return ok;
+}
+
+/*!
+ * \brief sends the PUBACKs whose round trip is over, in arrival order
+ */
+bool TestBroker::sendAcksDue(void)
+{
+    bool ok = true;
+    TickType_t now = xTaskGetTickCount();
+
+    while (ok && (pendingCount > 0u) && ((int32_t)(now - pending[0].dueTick) >= 0))
+    {
+        uint8_t puback[4] = { 0x40u, 2u, (uint8_t)(pending[0].packetId >> 8), (uint8_t)pending[0].packetId };
+
+        ok = (stream.sendBytes(puback, sizeof(puback)) == STATUS_OKAY);
+        pendingCount--;
+        memmove(&pending[0], &pending[1], pendingCount * sizeof(PendingAck_t));
+    }
+
+    return ok;
+}
+
+static void runCase(const BenchCase_t & benchCase, uint16_t port, uint32_t publishes)
+{
+    SocketStream clientStream;
+    MqttClient client(clientStream);
+    MqttStats_t stats;
+    uint8_t payload[BENCH_PAYLOAD_SIZE];
+    const MqttConfig_t config =
+    {
+        BENCH_BROKER_HOST,
+        port,
+        "bench",
+        "solar_meter/telemetry",
+        nullptr,
+        MQTT_DEFAULT_KEEP_ALIVE_S,
+        benchCase.windowSize,
+        BENCH_MAX_RETRIES,
+        BENCH_ACK_TIMEOUT_MS,
+    };
+    uint32_t refused = 0u;
+    uint32_t waitedMs = 0u;
+
+    memset(payload, 0x5A, sizeof(payload));
+    broker.reset();
+    broker.lossPercent = benchCase.lossPercent;
+    HOST_CHECK_EQUAL(STATUS_OKAY, client.init(&config));
+
+    int64_t startUs = esp_timer_get_time();
+
+    /*! - a refused publish is offered again, as the store log would */
+    for (uint32_t i = 0u; i < publishes; )
+    {
+        if (client.publish(payload, sizeof(payload)) == STATUS_OKAY)
+        {
+            i++;
+        }
+        else
+        {
+            refused++;
+            client.poll();
+        }
+    }
+
+    (void)client.getStats(&stats);
+    while ((stats.inFlight > 0u) && (waitedMs++ < BENCH_DRAIN_MS))
+    {
+        vTaskDelay(1u);
+        client.poll();
+        (void)client.getStats(&stats);
+    }
+
+    int64_t elapsedUs = esp_timer_get_time() - startUs;
+
+    HOST_CHECK_EQUAL(0u, stats.inFlight);
+    HOST_CHECK_EQUAL(publishes, stats.acks);
+    HOST_CHECK_EQUAL(publishes, broker.getDelivered());
+    HOST_CHECK_EQUAL(1u, stats.connects);
+
+    printf("| %6u | %4u %% | %8.1f | %6u | %6u | %6u | %7u |\n",
+           (unsigned)benchCase.windowSize, (unsigned)benchCase.lossPercent,
+           (double)publishes * 1000000.0 / (double)elapsedUs,
+           (unsigned)stats.averageAckLatencyMs, (unsigned)stats.maxAckLatencyMs,
+           (unsigned)stats.retransmits, (unsigned)refused);
+}
+
+/*******************************************************************************
+ * GLOBAL FUNCTIONS
+ *******************************************************************************/
+int main(int argc, char ** argv)
+{
+    uint32_t publishes = (argc > 1) ? (uint32_t)strtoul(argv[1], nullptr, 0) : BENCH_DEFAULT_PUBLISHES;
+    uint16_t port = 0u;
+
+    /*! - the client logs every connect */
+    esp_log_level_set("*", ESP_LOG_ERROR);
+    srand(1u);
+    if (publishes == 0u)
+    {
+        publishes = 1u;
+    }
+
+    HOST_CHECK_EQUAL(STATUS_OKAY, broker.start(&port));
+
+    printf("%u publishes of %u B, %u ms round trip, %u ms ack timeout\n",
+           (unsigned)publishes, (unsigned)BENCH_PAYLOAD_SIZE,
+           (unsigned)BENCH_ROUND_TRIP_MS, (unsigned)BENCH_ACK_TIMEOUT_MS);
+    printf("| %6s | %6s | %8s | %6s | %6s | %6s | %7s |\n",
+           "window", "loss", "pub/s", "avg ms", "max ms", "resent", "refused");
+    for (const BenchCase_t & benchCase : benchCases)
+    {
+        runCase(benchCase, port, publishes);
+    }
+
+    broker.stop();
+
+    return hostTestFailures;
+}
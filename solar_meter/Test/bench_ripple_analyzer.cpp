@@ -0,0 +1,166 @@
+/**
+ *******************************************************************************
+ * @file    bench_ripple_analyzer.cpp
+ * @author  hq
+ * @date    2026-10-19 10:05:12
+ * @brief   Cycles per 128 sample block of the RippleAnalyzer, for the
+ *  goertzel bins alone, the fft alone and both. The synthetic ripple also
+ *  checks the frequency and amplitude found, including tones that fall
+ *  between two fft bins on either side.
+ *
+ *  usage: bench_ripple_analyzer [blocks]
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * INCLUDES
+ *******************************************************************************/
+#include "host_test.h"
+#include "ripple_analyzer.hpp"
+#include "timing.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+extern "C"
+{
+    #include "esp_log.h"
+}
+
+/*******************************************************************************
+ * PRIVATE MACROS AND DEFINES
+ *******************************************************************************/
+#define BENCH_SAMPLE_RATE_HZ        (860u)      /* ADS1115 fastest rate     */
+#define BENCH_DEFAULT_BLOCKS        (2000u)
+#define BENCH_DC_COUNTS             (12000)
+#define BENCH_NOISE_COUNTS          (8)
+#define BENCH_PI                    (3.14159265358979)
+
+/*******************************************************************************
+ * PRIVATE TYPEDEFS
+ *******************************************************************************/
+typedef struct
+{
+    const char * name;
+    uint8_t goertzelBins;
+    bool fftEnabled;
+} BenchCase_t;
+
+/*******************************************************************************
+ * STATIC VARIABLES
+ *******************************************************************************/
+static const BenchCase_t benchCases[] =
+{
+    { "goertzel x1",        1u, false },
+    { "goertzel x4",        4u, false },
+    { "fft",                0u, true  },
+    { "fft + goertzel x4",  4u, true  },
+};
+
+static const uint16_t goertzelFrequencies[RIPPLE_MAX_GOERTZEL_BINS] = { 50u, 100u, 120u, 200u };
+
+/*******************************************************************************
+ * GLOBAL VARIABLES
+ *******************************************************************************/
+HOST_TEST_MAIN_VARIABLES;
+
+/*******************************************************************************
+ * STATIC FUNCTIONS
+ *******************************************************************************/
+static int16_t rippleSample(uint32_t n, double frequencyHz, double amplitude)
+{
+    double t = (double)n / (double)BENCH_SAMPLE_RATE_HZ;
+    int noise = (rand() % (2 * BENCH_NOISE_COUNTS + 1)) - BENCH_NOISE_COUNTS;
+
+    return (int16_t)lround(BENCH_DC_COUNTS + (amplitude * sin(2.0 * BENCH_PI * frequencyHz * t)) + noise);
+}
+
+static Status_t setUp(RippleAnalyzer & analyzer, const BenchCase_t & benchCase)
+{
+    Status_t status = analyzer.init(BENCH_SAMPLE_RATE_HZ, benchCase.fftEnabled);
+
+    for (uint8_t i = 0u; (i < benchCase.goertzelBins) && (status == STATUS_OKAY); i++)
+    {
+        status = analyzer.addGoertzelBin(goertzelFrequencies[i]);
+    }
+
+    return status;
+}
+
+/*!
+ * \brief the dominant tone must land within a fraction of a bin, whether
+ * it sits left or right of the bin centre
+ */
+static void checkTone(double frequencyHz, double amplitude)
+{
+    RippleAnalyzer analyzer;
+    RippleResult_t result;
+    double binHz = (double)BENCH_SAMPLE_RATE_HZ / RIPPLE_BLOCK_SIZE;
+
+    HOST_CHECK_EQUAL(STATUS_OKAY, analyzer.init(BENCH_SAMPLE_RATE_HZ, true));
+    for (uint32_t n = 0u; n < (4u * RIPPLE_BLOCK_SIZE); n++)
+    {
+        (void)analyzer.pushSample(rippleSample(n, frequencyHz, amplitude));
+    }
+
+    HOST_CHECK_EQUAL(STATUS_OKAY, analyzer.getResult(&result));
+    HOST_CHECK_NEAR(frequencyHz, result.dominantFrequencyDeciHz / 10.0, 0.25 * binHz);
+    HOST_CHECK_NEAR(amplitude, (double)result.rippleAmplitude, 0.2 * amplitude);
+    HOST_CHECK_NEAR(2.0 * amplitude, (double)result.ripplePeakToPeak, 0.1 * amplitude + 2 * BENCH_NOISE_COUNTS);
+    HOST_CHECK_NEAR(BENCH_DC_COUNTS, result.blockMean, 0.05 * amplitude);
+}
+
+static void runCase(const BenchCase_t & benchCase, uint32_t blocks)
+{
+    RippleAnalyzer analyzer;
+    RippleResult_t result;
+    uint64_t sumCycles = 0u;
+    uint32_t maxCycles = 0u;
+    uint32_t n = 0u;
+
+    HOST_CHECK_EQUAL(STATUS_OKAY, setUp(analyzer, benchCase));
+
+    for (uint32_t block = 0u; block < blocks; block++)
+    {
+        while (analyzer.pushSample(rippleSample(n++, 100.0, 400.0)) == false)
+        {
+        }
+        HOST_CHECK_EQUAL(STATUS_OKAY, analyzer.getResult(&result));
+        sumCycles += result.cyclesPerBlock;
+        if (result.cyclesPerBlock > maxCycles)
+        {
+            maxCycles = result.cyclesPerBlock;
+        }
+    }
+
+    printf("| %-18s | %8llu | %8u |\n", benchCase.name,
+           (unsigned long long)(sumCycles / blocks), (unsigned)maxCycles);
+}
+
+/*******************************************************************************
+ * GLOBAL FUNCTIONS
+ *******************************************************************************/
+int main(int argc, char ** argv)
+{
+    uint32_t blocks = (argc > 1) ? (uint32_t)strtoul(argv[1], nullptr, 0) : BENCH_DEFAULT_BLOCKS;
+
+    esp_log_level_set("*", ESP_LOG_WARN);
+    srand(1u);
+
+    /*! - tones at, left of and right of a bin centre   */
+    checkTone(100.0, 400.0);
+    checkTone(47.0, 200.0);
+    checkTone(121.3, 800.0);
+    checkTone(180.9, 300.0);
+
+    printf("%u blocks of %u samples at %u SPS, host cycles at %u MHz\n",
+           (unsigned)blocks, (unsigned)RIPPLE_BLOCK_SIZE, (unsigned)BENCH_SAMPLE_RATE_HZ,
+           (unsigned)TIMING_CPU_FREQ_MHZ);
+    printf("| %-18s | %8s | %8s |\n", "case", "mean", "max");
+    for (const BenchCase_t & benchCase : benchCases)
+    {
+        runCase(benchCase, (blocks > 0u) ? blocks : 1u);
+    }
+
+    return hostTestFailures;
+}
@@ -0,0 +1,327 @@
+/**
+ *******************************************************************************
+ * @file    bench_timeseries_codec.cpp
+ * @author  hq
+ * @date    2026-10-19 19:02:37
+ * @brief   Bytes per sample and cycles of the time series encoding on the
+ *  trace in data/, against the TLV encoding of the same batches. The trace
+ *  is cut into batches the way the Networking Module fills them, voltage,
+ *  current and power of a sample one after the other. Every payload is
+ *  decoded again and checked against the fixed point input.
+ *
+ *  usage: bench_timeseries_codec <trace.csv>
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * INCLUDES
+ *******************************************************************************/
+#include "host_test.h"
+#include "message_serializer.hpp"
+#include "timeseries_codec.hpp"
+#include "timing.h"
+
+#include <stdio.h>
+#include <string.h>
+
+extern "C"
+{
+    #include "esp_log.h"
+}
+
+/*******************************************************************************
+ * PRIVATE MACROS AND DEFINES
+ *******************************************************************************/
+#define BENCH_MAX_SAMPLES           (8192u)
+#define BENCH_SERIES_SAMPLES        (1000u)
+#define BENCH_MAX_BATCH             (24u)
+#define BENCH_PAYLOAD_SIZE          (512u)
+#define BENCH_LINE_SIZE             (64u)
+
+/*******************************************************************************
+ * PRIVATE TYPEDEFS
+ *******************************************************************************/
+typedef struct
+{
+    uint32_t tick;
+    int32_t voltageMv;
+    int32_t currentMa;
+} TraceSample_t;
+
+typedef struct
+{
+    const char * name;
+    uint16_t batchMessages;
+    uint8_t seriesCount;                /* voltage, then current and power  */
+} BenchCase_t;
+
+/*******************************************************************************
+ * STATIC VARIABLES
+ *******************************************************************************/
+static const BenchCase_t benchCases[] =
+{
+    { "16 messages, V",     16u, 1u },
+    { "16 messages, V I P", 16u, 3u },
+    { "24 messages, V I P", 24u, 3u },
+};
+
+static const MessageId_t seriesIds[] =
+{
+    MESSAGE_ID_BUS_VOLTAGE,
+    MESSAGE_ID_BUS_CURRENT,
+    MESSAGE_ID_POWER,
+};
+
+static TraceSample_t trace[BENCH_MAX_SAMPLES];
+static uint32_t traceLength = 0u;
+
+/*******************************************************************************
+ * GLOBAL VARIABLES
+ *******************************************************************************/
+HOST_TEST_MAIN_VARIABLES;
+
+/*******************************************************************************
+ * STATIC FUNCTIONS
+ *******************************************************************************/
+
+/*!
+ * \brief reads tick, millivolts and milliamps per line, skips the comments
+ * and the column names
+ */
+static bool loadTrace(const char * path)
+{
+    FILE * file = fopen(path, "r");
+    char line[BENCH_LINE_SIZE];
+
+    while ((file != nullptr) && (fgets(line, sizeof(line), file) != nullptr) && (traceLength < BENCH_MAX_SAMPLES))
+    {
+        unsigned long tick = 0u;
+        long voltage = 0;
+        long current = 0;
+
+        if ((line[0] != '#') && (sscanf(line, "%lu,%ld,%ld", &tick, &voltage, &current) == 3))
+        {
+            trace[traceLength].tick = (uint32_t)tick;
+            trace[traceLength].voltageMv = (int32_t)voltage;
+            trace[traceLength].currentMa = (int32_t)current;
+            traceLength++;
+        }
+    }
+
+    if (file != nullptr)
+    {
+        fclose(file);
+    }
+
+    return (traceLength > 0u);
+}
+
+/*!
+ * \brief the float a series carries for the sample, as the power monitor
+ * queues it
+ */
+static float seriesValue(const TraceSample_t & sample, uint8_t series)
+{
+    float voltage = (float)sample.voltageMv / 1000.0f;
+    float current = (float)sample.currentMa / 1000.0f;
+    float value = voltage;
+
+    if (series == 1u)
+    {
+        value = current;
+    }
+    else if (series == 2u)
+    {
+        value = voltage * current;
+    }
+
+    return value;
+}
+
+/*!
+ * \brief the milli units the serializer sends for a float, rounded the
+ * same way
+ */
+static int32_t toMilli(float value)
+{
+    value *= TIMESERIES_FLOAT_SCALE;
+    return (int32_t)((value < 0.0f) ? (value - 0.5f) : (value + 0.5f));
+}
+
+/*!
+ * \brief decodes each series of a time series payload and checks it
+ * against the messages of its id, returns the decode cycles
+ */
+static uint32_t checkPayload(const uint8_t * payload, uint16_t length,
+                             const NetworkingMessage_t * messages, uint16_t count)
+{
+    TimeSeriesDecoder decoder;
+    uint32_t cycles = 0u;
+    uint16_t index = 2u;
+    uint16_t decoded = 0u;
+
+    HOST_CHECK_EQUAL(TIMESERIES_FORMAT_VERSION, payload[0]);
+
+    for (uint8_t series = 0u; (series < payload[1]) && ((index + 2u) <= length); series++)
+    {
+        MessageId_t id = (MessageId_t)payload[index++];
+        uint8_t samples = payload[index++];
+        uint16_t next = 0u;
+        uint32_t start = timing_getCycleCount();
+
+        decoder.begin(&payload[index], length - index);
+        for (uint8_t i = 0u; i < samples; i++)
+        {
+            uint32_t timestamp = 0u;
+            int32_t value = 0;
+            float expected = 0.0f;
+
+            HOST_CHECK_EQUAL(STATUS_OKAY, decoder.next(&timestamp, &value));
+            while ((next < count) && (messages[next].id != id))
+            {
+                next++;
+            }
+            if (next < count)
+            {
+                memcpy(&expected, messages[next].buffer->data, sizeof(expected));
+                HOST_CHECK_EQUAL(messages[next].timestamp, timestamp);
+                HOST_CHECK_EQUAL(toMilli(expected), value);
+                next++;
+            }
+            decoded++;
+        }
+        cycles += timing_getCycleCount() - start;
+        index += decoder.getLength();
+    }
+
+    HOST_CHECK_EQUAL(length, index);
+    HOST_CHECK_EQUAL(count, decoded);
+
+    return cycles;
+}
+
+/*!
+ * \brief one series of voltage samples through the bare codec
+ */
+static void runEncoder(void)
+{
+    static uint8_t buffer[BENCH_SERIES_SAMPLES * TIMESERIES_MAX_SAMPLE_BYTES];
+    TimeSeriesEncoder encoder;
+    TimeSeriesDecoder decoder;
+    uint32_t samples = (traceLength < BENCH_SERIES_SAMPLES) ? traceLength : BENCH_SERIES_SAMPLES;
+    uint32_t encodeCycles = 0u;
+    uint32_t decodeCycles = 0u;
+    uint32_t start = timing_getCycleCount();
+    uint16_t length = 0u;
+
+    encoder.begin(buffer, sizeof(buffer));
+    for (uint32_t i = 0u; i < samples; i++)
+    {
+        HOST_CHECK_EQUAL(STATUS_OKAY, encoder.append(trace[i].tick, trace[i].voltageMv));
+    }
+    length = encoder.finish();
+    encodeCycles = timing_getCycleCount() - start;
+
+    start = timing_getCycleCount();
+    decoder.begin(buffer, length);
+    for (uint32_t i = 0u; i < samples; i++)
+    {
+        uint32_t timestamp = 0u;
+        int32_t value = 0;
+
+        HOST_CHECK_EQUAL(STATUS_OKAY, decoder.next(&timestamp, &value));
+        HOST_CHECK_EQUAL(trace[i].tick, timestamp);
+        HOST_CHECK_EQUAL(trace[i].voltageMv, value);
+    }
+    decodeCycles = timing_getCycleCount() - start;
+
+    printf("| %-18s | %6.2f | %6s | %7u | %7u | %7s |\n", "1000 samples, V",
+           (double)length / samples, "-",
+           (unsigned)(encodeCycles / samples), (unsigned)(decodeCycles / samples), "-");
+}
+
+/*!
+ * \brief the whole trace in batches, both encodings of every batch
+ */
+static void runCase(const BenchCase_t & benchCase)
+{
+    TimeSeriesSerializer timeSeries;
+    TlvSerializer tlv;
+    NetworkingMessage_t messages[BENCH_MAX_BATCH];
+    MessageBuffer_t buffers[BENCH_MAX_BATCH];
+    float values[BENCH_MAX_BATCH];
+    uint8_t payload[BENCH_PAYLOAD_SIZE];
+    uint32_t totalMessages = traceLength * benchCase.seriesCount;
+    uint32_t timeSeriesBytes = 0u;
+    uint32_t tlvBytes = 0u;
+    uint64_t encodeCycles = 0u;
+    uint64_t decodeCycles = 0u;
+    uint64_t tlvCycles = 0u;
+
+    memset(buffers, 0, sizeof(buffers));
+
+    for (uint32_t first = 0u; first < totalMessages; first += benchCase.batchMessages)
+    {
+        uint16_t count = 0u;
+        uint16_t length = 0u;
+        uint32_t start = 0u;
+
+        /*! - a batch may end between the series of one sample */
+        for (uint32_t m = first; (m < totalMessages) && (count < benchCase.batchMessages); m++)
+        {
+            const TraceSample_t & sample = trace[m / benchCase.seriesCount];
+            uint8_t series = (uint8_t)(m % benchCase.seriesCount);
+
+            values[count] = seriesValue(sample, series);
+            buffers[count].data = (uint8_t *)&values[count];
+            buffers[count].capacity = sizeof(float);
+            buffers[count].length = sizeof(float);
+            messages[count].id = seriesIds[series];
+            messages[count].timestamp = sample.tick;
+            messages[count].buffer = &buffers[count];
+            count++;
+        }
+
+        start = timing_getCycleCount();
+        HOST_CHECK_EQUAL(STATUS_OKAY, timeSeries.serialize(messages, count, payload, sizeof(payload), &length));
+        encodeCycles += timing_getCycleCount() - start;
+        timeSeriesBytes += length;
+        decodeCycles += checkPayload(payload, length, messages, count);
+
+        start = timing_getCycleCount();
+        HOST_CHECK_EQUAL(STATUS_OKAY, tlv.serialize(messages, count, payload, sizeof(payload), &length));
+        tlvCycles += timing_getCycleCount() - start;
+        tlvBytes += length;
+    }
+
+    printf("| %-18s | %6.2f | %6.2f | %7u | %7u | %7u |\n", benchCase.name,
+           (double)timeSeriesBytes / totalMessages, (double)tlvBytes / totalMessages,
+           (unsigned)(encodeCycles / totalMessages), (unsigned)(decodeCycles / totalMessages),
+           (unsigned)(tlvCycles / totalMessages));
+}
+
+/*******************************************************************************
+ * GLOBAL FUNCTIONS
+ *******************************************************************************/
+int main(int argc, char ** argv)
+{
+    const char * path = (argc > 1) ? argv[1] : "data/solar_day_trace.csv";
+
+    esp_log_level_set("*", ESP_LOG_WARN);
+
+    HOST_CHECK(loadTrace(path));
+    if (traceLength > 0u)
+    {
+        printf("%u samples from %s, host cycles at %u MHz\n",
+               (unsigned)traceLength, path, (unsigned)TIMING_CPU_FREQ_MHZ);
+        printf("| %-18s | %6s | %6s | %7s | %7s | %7s |\n",
+               "input", "TS B", "TLV B", "TS enc", "TS dec", "TLV enc");
+        runEncoder();
+        for (const BenchCase_t & benchCase : benchCases)
+        {
+            runCase(benchCase);
+        }
+    }
+
+    return hostTestFailures;
+}
@@ -0,0 +1,237 @@
+/**
+ *******************************************************************************
+ * @file    bench_transmit_scheduler.cpp
+ * @author  hq
+ * @date    2026-10-19 17:48:26
+ * @brief   Radio on time, wake ups and latency over a simulated stretch of
+ *  reporting, with and without the TransmitScheduler. Runs on the manual
+ *  clock in one thread. Values arrive at random times, a batch closes one
+ *  latency threshold after its first value, and a publish keeps the radio
+ *  busy for a fixed time. Without the scheduler every closed batch is a
+ *  publish and a wake up of its own. With it, a closed batch waits for the
+ *  next window and takes every value that arrived in between.
+ *
+ *  usage: bench_transmit_scheduler [seconds]
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * INCLUDES
+ *******************************************************************************/
+#include "host_test.h"
+#include "transmit_scheduler.hpp"
+
+extern "C"
+{
+    #include "freertos/FreeRTOS.h"
+    #include "freertos/task.h"
+    #include "host_port.h"
+    #include "esp_log.h"
+}
+
+/*******************************************************************************
+ * PRIVATE MACROS AND DEFINES
+ *******************************************************************************/
+#define BENCH_DEFAULT_SECONDS       (3600u)
+#define BENCH_VALUES_PER_SECOND     (3u)
+#define BENCH_LATENCY_MS            (1000u)
+#define BENCH_PUBLISH_MS            (5u)
+#define BENCH_BEACON_INTERVAL_MS    (102u)
+#define BENCH_DTIM_PERIOD           (3u)
+#define BENCH_MAX_QUEUED            (64u)
+
+/*******************************************************************************
+ * PRIVATE TYPEDEFS
+ *******************************************************************************/
+typedef struct
+{
+    uint32_t publishes;
+    uint32_t earlyPublishes;
+    uint64_t radioOnMs;
+    uint64_t latencySumMs;
+    uint32_t maxLatencyMs;
+    uint32_t values;
+} BenchResult_t;
+
+/*******************************************************************************
+ * STATIC VARIABLES
+ *******************************************************************************/
+static const TransmitSchedulerConfig_t schedulerConfig =
+{
+    BENCH_LATENCY_MS,
+    BENCH_BEACON_INTERVAL_MS,
+    BENCH_DTIM_PERIOD,
+    TRANSMIT_DEFAULT_LISTEN_INTERVAL,
+    TRANSMIT_DEFAULT_MAX_MODEM_THRESHOLD,
+    TRANSMIT_DEFAULT_RADIO_TAIL_MS,
+};
+
+/*******************************************************************************
+ * GLOBAL VARIABLES
+ *******************************************************************************/
+HOST_TEST_MAIN_VARIABLES;
+
+/*******************************************************************************
+ * STATIC FUNCTIONS
+ *******************************************************************************/
+
+/*!
+ * \brief whether a value arrives on this tick, BENCH_VALUES_PER_SECOND on
+ * average. A hash of the tick, so both runs see the same arrivals
+ */
+static bool valueArrives(TickType_t tick)
+{
+    uint32_t hash = (uint32_t)tick * 2654435761u;
+
+    hash ^= hash >> 15;
+    hash *= 2246822519u;
+    hash ^= hash >> 13;
+
+    return ((hash % configTICK_RATE_HZ) < BENCH_VALUES_PER_SECOND);
+}
+
+/*!
+ * \brief one run over the simulated time, a scheduler of nullptr publishes
+ * every batch as soon as it closes
+ */
+static BenchResult_t run(TransmitScheduler * scheduler, uint32_t seconds)
+{
+    BenchResult_t result = {};
+    TickType_t arrivals[BENCH_MAX_QUEUED];
+    uint32_t queued = 0u;
+    TickType_t dueTick = 0u;
+    bool due = false;
+    TickType_t nextTick = 0u;
+    TickType_t endTick = 0u;
+
+    host_setManualClock(0);
+    if (CHECK_POINTER_VALID(scheduler))
+    {
+        HOST_CHECK_EQUAL(STATUS_OKAY, scheduler->init(&schedulerConfig));
+    }
+    nextTick = xTaskGetTickCount();
+    endTick = nextTick + pdMS_TO_TICKS(seconds * 1000u);
+
+    while (xTaskGetTickCount() < endTick)
+    {
+        TickType_t now = xTaskGetTickCount();
+
+        /*! - values that arrived while the task was sending wait too */
+        for (; (int32_t)(now - nextTick) >= 0; nextTick++)
+        {
+            if (valueArrives(nextTick) && (queued < BENCH_MAX_QUEUED))
+            {
+                if (queued == 0u)
+                {
+                    dueTick = nextTick + pdMS_TO_TICKS(BENCH_LATENCY_MS);
+                }
+                arrivals[queued++] = nextTick;
+            }
+        }
+
+        if ((queued > 0u) && ((int32_t)(now - dueTick) >= 0))
+        {
+            due = true;
+        }
+
+        if (    due
+             && (    (CHECK_POINTER_VALID(scheduler) == false)
+                  || (scheduler->getWindowDelay(now) == 0u)))
+        {
+            if (CHECK_POINTER_VALID(scheduler))
+            {
+                scheduler->burstStarted(now);
+            }
+
+            for (uint32_t i = 0u; i < queued; i++)
+            {
+                uint32_t latencyMs = (now - arrivals[i]) * portTICK_PERIOD_MS;
+
+                result.latencySumMs += latencyMs;
+                if (latencyMs > result.maxLatencyMs)
+                {
+                    result.maxLatencyMs = latencyMs;
+                }
+            }
+            result.values += queued;
+            result.publishes++;
+            queued = 0u;
+            due = false;
+
+            /*! - the publish itself */
+            vTaskDelay(pdMS_TO_TICKS(BENCH_PUBLISH_MS));
+
+            if (CHECK_POINTER_VALID(scheduler))
+            {
+                scheduler->burstEnded(xTaskGetTickCount(), true, false);
+            }
+            else
+            {
+                result.radioOnMs += BENCH_PUBLISH_MS + TRANSMIT_DEFAULT_RADIO_TAIL_MS;
+            }
+        }
+        else
+        {
+            vTaskDelay(1u);
+        }
+    }
+
+    if (CHECK_POINTER_VALID(scheduler))
+    {
+        TransmitSchedulerStats_t stats;
+
+        HOST_CHECK_EQUAL(STATUS_OKAY, scheduler->getStats(&stats));
+        HOST_CHECK_EQUAL(result.publishes, stats.bursts);
+        result.radioOnMs = stats.radioOnMsTotal;
+        result.earlyPublishes = stats.earlyBursts;
+    }
+
+    host_useRealClock();
+
+    return result;
+}
+
+static void printResult(const char * name, const BenchResult_t & result)
+{
+    uint32_t values = (result.values > 0u) ? result.values : 1u;
+
+    printf("| %-9s | %7u | %6u | %8.1f | %8u | %6u |\n", name,
+           (unsigned)result.publishes, (unsigned)result.earlyPublishes,
+           (double)result.radioOnMs / 1000.0,
+           (unsigned)(result.latencySumMs / values), (unsigned)result.maxLatencyMs);
+}
+
+/*******************************************************************************
+ * GLOBAL FUNCTIONS
+ *******************************************************************************/
+int main(int argc, char ** argv)
+{
+    uint32_t seconds = (argc > 1) ? (uint32_t)strtoul(argv[1], nullptr, 0) : BENCH_DEFAULT_SECONDS;
+    TransmitScheduler scheduler;
+    BenchResult_t direct;
+    BenchResult_t scheduled;
+
+    esp_log_level_set("*", ESP_LOG_WARN);
+    if (seconds == 0u)
+    {
+        seconds = 1u;
+    }
+
+    direct = run(nullptr, seconds);
+    scheduled = run(&scheduler, seconds);
+
+    /*! - the same values go out, only the last batch may still wait */
+    HOST_CHECK(scheduled.values + (BENCH_VALUES_PER_SECOND * 2u) >= direct.values);
+    HOST_CHECK(scheduled.publishes <= direct.publishes);
+    HOST_CHECK(scheduled.radioOnMs <= direct.radioOnMs);
+
+    printf("%u s, %u values/s, %u ms latency threshold, %u ms beacon, DTIM %u, %u ms publish\n",
+           (unsigned)seconds, (unsigned)BENCH_VALUES_PER_SECOND, (unsigned)BENCH_LATENCY_MS,
+           (unsigned)BENCH_BEACON_INTERVAL_MS, (unsigned)BENCH_DTIM_PERIOD, (unsigned)BENCH_PUBLISH_MS);
+    printf("| %-9s | %7s | %6s | %8s | %8s | %6s |\n",
+           "case", "wakes", "early", "radio s", "avg ms", "max ms");
+    printResult("direct", direct);
+    printResult("scheduled", scheduled);
+
+    return hostTestFailures;
+}
@@ -0,0 +1,78 @@
+/**
+ ********************************************************************************
+ * @file    host_test.h
+ * @author  hq
+ * @date    2026-10-19 09:12:40
+ * @brief   Checks shared by the host tests. A failed check prints where it
+ *  failed and the test carries on, main returns the number of failures.
+ ********************************************************************************
+ */
+
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+
+/************************************
+ * INCLUDES
+ ************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+/************************************
+ * MACROS AND DEFINES
+ ************************************/
+#define HOST_CHECK(condition)                                                   \
+    do                                                                          \
+    {                                                                           \
+        if (!(condition))                                                       \
+        {                                                                       \
+            printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #condition);         \
+            hostTestFailures++;                                                 \
+        }                                                                       \
+    } while (0)
+
+#define HOST_CHECK_EQUAL(expected, actual)                                      \
+    do                                                                          \
+    {                                                                           \
+        long long expected_ = (long long)(expected);                            \
+        long long actual_ = (long long)(actual);                                \
+        if (expected_ != actual_)                                               \
+        {                                                                       \
+            printf("FAIL %s:%d: %s == %s, expected %lld, got %lld\n",           \
+                   __FILE__, __LINE__, #expected, #actual, expected_, actual_); \
+            hostTestFailures++;                                                 \
+        }                                                                       \
+    } while (0)
+
+#define HOST_CHECK_NEAR(expected, actual, tolerance)                            \
+    do                                                                          \
+    {                                                                           \
+        double expected_ = (double)(expected);                                  \
+        double actual_ = (double)(actual);                                      \
+        if (fabs(expected_ - actual_) > (double)(tolerance))                    \
+        {                                                                       \
+            printf("FAIL %s:%d: %s ~ %s, expected %g, got %g\n",                \
+                   __FILE__, __LINE__, #expected, #actual, expected_, actual_); \
+            hostTestFailures++;                                                 \
+        }                                                                       \
+    } while (0)
+
+/*  runs one test function and names it in the output */
+#define HOST_RUN(test)                                                          \
+    do                                                                          \
+    {                                                                           \
+        int before_ = hostTestFailures;                                         \
+        test();                                                                 \
+        printf("%s %s\n", (hostTestFailures == before_) ? "ok  " : "FAIL", #test); \
+    } while (0)
+
+/************************************
+ * EXPORTED VARIABLES
+ ************************************/
+
+/*  defined once by every test, through HOST_TEST_MAIN_VARIABLES */
+extern int hostTestFailures;
+
+#define HOST_TEST_MAIN_VARIABLES        int hostTestFailures = 0
+
+#endif //HOST_TEST_H
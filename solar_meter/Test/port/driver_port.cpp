@@ -0,0 +1,280 @@
+/**
+ *******************************************************************************
+ * @file    driver_port.cpp
+ * @author  hq
+ * @date    2026-10-19 09:12:40
+ * @brief   Host port of the i2c master and FRC1 timer drivers. An i2c
+ *  command link is recorded and replayed against the device model set
+ *  with host_i2cSetDevice(), the timer alarm fires when a test says so.
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * INCLUDES
+ *******************************************************************************/
+#include "host_port.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+extern "C"
+{
+    #include "driver/i2c.h"
+    #include "driver/hw_timer.h"
+}
+
+/*******************************************************************************
+ * EXTERN VARIABLES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * PRIVATE MACROS AND DEFINES
+ *******************************************************************************/
+#define I2C_MAX_OPERATIONS          (16u)
+#define I2C_MAX_WRITE               (8u)
+
+/*******************************************************************************
+ * PRIVATE TYPEDEFS
+ *******************************************************************************/
+typedef enum
+{
+    I2C_OP_START,
+    I2C_OP_WRITE,
+    I2C_OP_READ,
+    I2C_OP_STOP
+} I2cOperationType_t;
+
+typedef struct
+{
+    I2cOperationType_t type;
+    uint8_t bytes[I2C_MAX_WRITE];       /**< copy of the written bytes              */
+    uint8_t * readBuffer;
+    size_t length;
+} I2cOperation_t;
+
+typedef struct
+{
+    I2cOperation_t operations[I2C_MAX_OPERATIONS];
+    uint32_t count;
+} I2cCommandLink_t;
+
+/*******************************************************************************
+ * STATIC VARIABLES
+ *******************************************************************************/
+static host_i2c_write_t deviceWrite = nullptr;
+static host_i2c_read_t deviceRead = nullptr;
+static void * deviceArg = nullptr;
+
+static hw_timer_callback_t timerCallback = nullptr;
+static void * timerArg = nullptr;
+static bool timerEnabled = false;
+
+/*******************************************************************************
+ * GLOBAL VARIABLES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * STATIC FUNCTION PROTOTYPES
+ *******************************************************************************/
+static esp_err_t addOperation(i2c_cmd_handle_t cmd_handle, I2cOperationType_t type,
+                              const uint8_t * bytes, uint8_t * readBuffer, size_t length);
+
+/*******************************************************************************
+ * STATIC FUNCTIONS
+ *******************************************************************************/
+static esp_err_t addOperation(i2c_cmd_handle_t cmd_handle, I2cOperationType_t type,
+                              const uint8_t * bytes, uint8_t * readBuffer, size_t length)
+{
+    esp_err_t err = ESP_OK;
+    I2cCommandLink_t * link = (I2cCommandLink_t *)cmd_handle;
+
+    if (   (link == nullptr)
+        || (link->count >= I2C_MAX_OPERATIONS)
+        || ((bytes != nullptr) && (length > I2C_MAX_WRITE)))
+    {
+        err = ESP_ERR_INVALID_ARG;
+    }
+    else
+    {
+        I2cOperation_t * operation = &link->operations[link->count++];
+
+        operation->type = type;
+        operation->readBuffer = readBuffer;
+        operation->length = length;
+        if (bytes != nullptr)
+        {
+            memcpy(operation->bytes, bytes, length);
+        }
+    }
+
+    return err;
+}
+
+/*******************************************************************************
+ * GLOBAL FUNCTIONS
+ *******************************************************************************/
+extern "C" void host_i2cSetDevice(host_i2c_write_t write, host_i2c_read_t read, void * arg)
+{
+    deviceWrite = write;
+    deviceRead = read;
+    deviceArg = arg;
+}
+
+extern "C" esp_err_t i2c_driver_install(i2c_port_t i2c_num, i2c_mode_t mode)
+{
+    return ((i2c_num < I2C_NUM_MAX) && (mode == I2C_MODE_MASTER)) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+extern "C" esp_err_t i2c_driver_delete(i2c_port_t i2c_num)
+{
+    return (i2c_num < I2C_NUM_MAX) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+extern "C" esp_err_t i2c_param_config(i2c_port_t i2c_num, const i2c_config_t * i2c_conf)
+{
+    return ((i2c_num < I2C_NUM_MAX) && (i2c_conf != nullptr)) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+extern "C" i2c_cmd_handle_t i2c_cmd_link_create(void)
+{
+    return calloc(1u, sizeof(I2cCommandLink_t));
+}
+
+extern "C" void i2c_cmd_link_delete(i2c_cmd_handle_t cmd_handle)
+{
+    free(cmd_handle);
+}
+
+extern "C" esp_err_t i2c_master_start(i2c_cmd_handle_t cmd_handle)
+{
+    return addOperation(cmd_handle, I2C_OP_START, nullptr, nullptr, 0u);
+}
+
+extern "C" esp_err_t i2c_master_stop(i2c_cmd_handle_t cmd_handle)
+{
+    return addOperation(cmd_handle, I2C_OP_STOP, nullptr, nullptr, 0u);
+}
+
+extern "C" esp_err_t i2c_master_write_byte(i2c_cmd_handle_t cmd_handle, uint8_t data, bool ack_en)
+{
+    (void)ack_en;
+
+    return addOperation(cmd_handle, I2C_OP_WRITE, &data, nullptr, 1u);
+}
+
+extern "C" esp_err_t i2c_master_write(i2c_cmd_handle_t cmd_handle, uint8_t * data, size_t data_len, bool ack_en)
+{
+    (void)ack_en;
+
+    return addOperation(cmd_handle, I2C_OP_WRITE, data, nullptr, data_len);
+}
+
+extern "C" esp_err_t i2c_master_read_byte(i2c_cmd_handle_t cmd_handle, uint8_t * data, i2c_ack_type_t ack)
+{
+    (void)ack;
+
+    return addOperation(cmd_handle, I2C_OP_READ, nullptr, data, 1u);
+}
+
+extern "C" esp_err_t i2c_master_read(i2c_cmd_handle_t cmd_handle, uint8_t * data, size_t data_len, i2c_ack_type_t ack)
+{
+    (void)ack;
+
+    return addOperation(cmd_handle, I2C_OP_READ, nullptr, data, data_len);
+}
+
+/*!
+ * \brief the first byte written after a start is the address byte, the
+ * rest of the writes and the reads go to the device model
+ */
+extern "C" esp_err_t i2c_master_cmd_begin(i2c_port_t i2c_num, i2c_cmd_handle_t cmd_handle, TickType_t ticks_to_wait)
+{
+    esp_err_t err = ESP_OK;
+    I2cCommandLink_t * link = (I2cCommandLink_t *)cmd_handle;
+    uint8_t address = 0u;
+    bool addressPending = false;
+
+    (void)ticks_to_wait;
+
+    if ((i2c_num >= I2C_NUM_MAX) || (link == nullptr))
+    {
+        err = ESP_ERR_INVALID_ARG;
+    }
+
+    for (uint32_t i = 0u; (err == ESP_OK) && (i < link->count); i++)
+    {
+        I2cOperation_t * operation = &link->operations[i];
+
+        if (operation->type == I2C_OP_START)
+        {
+            addressPending = true;
+        }
+        else if (operation->type == I2C_OP_WRITE)
+        {
+            const uint8_t * bytes = operation->bytes;
+            size_t length = operation->length;
+
+            if (addressPending && (length > 0u))
+            {
+                address = bytes[0] >> 1;
+                addressPending = false;
+                bytes++;
+                length--;
+            }
+            if ((length > 0u) && (deviceWrite != nullptr))
+            {
+                err = deviceWrite(address, bytes, length, deviceArg);
+            }
+        }
+        else if (operation->type == I2C_OP_READ)
+        {
+            memset(operation->readBuffer, 0, operation->length);
+            if (deviceRead != nullptr)
+            {
+                err = deviceRead(address, operation->readBuffer, operation->length, deviceArg);
+            }
+        }
+    }
+
+    return err;
+}
+
+extern "C" esp_err_t hw_timer_init(hw_timer_callback_t callback, void * arg)
+{
+    timerCallback = callback;
+    timerArg = arg;
+
+    return (callback != nullptr) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+extern "C" esp_err_t hw_timer_deinit(void)
+{
+    timerCallback = nullptr;
+    timerEnabled = false;
+
+    return ESP_OK;
+}
+
+extern "C" esp_err_t hw_timer_alarm_us(uint32_t value, bool reload)
+{
+    (void)value;
+    (void)reload;
+    timerEnabled = true;
+
+    return ESP_OK;
+}
+
+extern "C" esp_err_t hw_timer_enable(bool en)
+{
+    timerEnabled = en;
+
+    return ESP_OK;
+}
+
+extern "C" void host_hwTimerFire(void)
+{
+    if (timerEnabled && (timerCallback != nullptr))
+    {
+        host_runIsr(timerCallback, timerArg);
+    }
+}
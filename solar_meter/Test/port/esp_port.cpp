@@ -0,0 +1,541 @@
+/**
+ *******************************************************************************
+ * @file    esp_port.cpp
+ * @author  hq
+ * @date    2026-10-19 09:12:40
+ * @brief   Host port of the SDK services the firmware calls: logging, heap
+ *  queries, the partition api over ram with nor flash semantics, nvs blobs
+ *  and the wifi power save settings.
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * INCLUDES
+ *******************************************************************************/
+#include "host_port.h"
+
+#include <malloc.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <mutex>
+
+extern "C"
+{
+    #include "esp_log.h"
+    #include "esp_timer.h"
+    #include "esp_system.h"
+    #include "esp_partition.h"
+    #include "esp_wifi.h"
+    #include "nvs_flash.h"
+    #include "sdkconfig.h"
+}
+
+/*******************************************************************************
+ * EXTERN VARIABLES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * PRIVATE MACROS AND DEFINES
+ *******************************************************************************/
+#define NVS_NAME_LENGTH             (16u)
+#define NVS_MAX_ENTRIES             (16u)
+#define NVS_MAX_BLOB_SIZE           (512u)
+#define NVS_MAX_NAMESPACES          (4u)
+
+/*******************************************************************************
+ * PRIVATE TYPEDEFS
+ *******************************************************************************/
+typedef struct
+{
+    esp_partition_t info;
+    uint8_t * data;
+    uint32_t * sectorErases;
+    host_flash_stats_t stats;
+} HostPartition_t;
+
+typedef struct
+{
+    bool used;
+    uint32_t handle;                    /**< namespace index + 1                    */
+    char key[NVS_NAME_LENGTH];
+    uint8_t data[NVS_MAX_BLOB_SIZE];
+    size_t length;
+} NvsEntry_t;
+
+/*******************************************************************************
+ * STATIC VARIABLES
+ *******************************************************************************/
+static esp_log_level_t logLevel = (esp_log_level_t)CONFIG_LOG_DEFAULT_LEVEL;
+
+static size_t heapBaseline = 0u;
+static uint32_t minimumFreeHeap = HOST_HEAP_SIZE;
+
+/*  the data partitions of partitions.csv */
+static HostPartition_t partitions[] =
+{
+    { { ESP_PARTITION_TYPE_DATA, 0x02, 0x9000u, 0x6000u, "nvs", false }, nullptr, nullptr, {} },
+    { { ESP_PARTITION_TYPE_DATA, 0x40, 0x100000u, 0x40000u, "telemetry", false }, nullptr, nullptr, {} },
+};
+
+static std::mutex flashLock;
+
+static std::mutex nvsLock;
+static bool nvsInitialized = false;
+static char nvsNamespaces[NVS_MAX_NAMESPACES][NVS_NAME_LENGTH];
+static NvsEntry_t nvsEntries[NVS_MAX_ENTRIES];
+
+static wifi_ps_type_t wifiPowerSave = WIFI_PS_MIN_MODEM;
+static wifi_config_t wifiStaConfig;
+
+/*******************************************************************************
+ * GLOBAL VARIABLES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * STATIC FUNCTION PROTOTYPES
+ *******************************************************************************/
+static HostPartition_t * findPartition(const esp_partition_t * partition);
+static void mountPartition(HostPartition_t * partition);
+static NvsEntry_t * findEntry(nvs_handle handle, const char * key);
+
+/*******************************************************************************
+ * STATIC FUNCTIONS
+ *******************************************************************************/
+static HostPartition_t * findPartition(const esp_partition_t * partition)
+{
+    HostPartition_t * found = nullptr;
+
+    for (size_t i = 0u; i < (sizeof(partitions) / sizeof(partitions[0])); i++)
+    {
+        if (&partitions[i].info == partition)
+        {
+            found = &partitions[i];
+        }
+    }
+
+    return found;
+}
+
+/*!
+ * \brief backs a partition with erased ram the first time it is used
+ */
+static void mountPartition(HostPartition_t * partition)
+{
+    if (partition->data == nullptr)
+    {
+        partition->data = (uint8_t *)malloc(partition->info.size);
+        partition->sectorErases = (uint32_t *)calloc(partition->info.size / HOST_FLASH_SECTOR_SIZE,
+                                                     sizeof(uint32_t));
+        memset(partition->data, 0xFF, partition->info.size);
+    }
+}
+
+static NvsEntry_t * findEntry(nvs_handle handle, const char * key)
+{
+    NvsEntry_t * found = nullptr;
+
+    for (uint32_t i = 0u; (i < NVS_MAX_ENTRIES) && (found == nullptr); i++)
+    {
+        if (   nvsEntries[i].used
+            && (nvsEntries[i].handle == handle)
+            && (strncmp(nvsEntries[i].key, key, NVS_NAME_LENGTH) == 0))
+        {
+            found = &nvsEntries[i];
+        }
+    }
+
+    return found;
+}
+
+/*******************************************************************************
+ * GLOBAL FUNCTIONS
+ *******************************************************************************/
+extern "C" void esp_log_level_set(const char * tag, esp_log_level_t level)
+{
+    if (strcmp(tag, "*") == 0)
+    {
+        logLevel = level;
+    }
+}
+
+extern "C" uint32_t esp_log_timestamp(void)
+{
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+extern "C" void esp_log_write(esp_log_level_t level, const char * tag, const char * format, ...)
+{
+    (void)tag;
+
+    if (level <= logLevel)
+    {
+        va_list args;
+
+        va_start(args, format);
+        vprintf(format, args);
+        va_end(args);
+    }
+}
+
+extern "C" uint32_t esp_get_free_heap_size(void)
+{
+    size_t used = mallinfo2().uordblks;
+    uint32_t freeHeap = HOST_HEAP_SIZE;
+
+    if (heapBaseline == 0u)
+    {
+        heapBaseline = used;
+    }
+
+    if (used > heapBaseline)
+    {
+        size_t grown = used - heapBaseline;
+
+        freeHeap = (grown < HOST_HEAP_SIZE) ? (uint32_t)(HOST_HEAP_SIZE - grown) : 0u;
+    }
+
+    if (freeHeap < minimumFreeHeap)
+    {
+        minimumFreeHeap = freeHeap;
+    }
+
+    return freeHeap;
+}
+
+extern "C" uint32_t esp_get_minimum_free_heap_size(void)
+{
+    esp_get_free_heap_size();
+
+    return minimumFreeHeap;
+}
+
+extern "C" const esp_partition_t * esp_partition_find_first(esp_partition_type_t type,
+                                                            esp_partition_subtype_t subtype,
+                                                            const char * label)
+{
+    const esp_partition_t * found = nullptr;
+
+    for (size_t i = 0u; (i < (sizeof(partitions) / sizeof(partitions[0]))) && (found == nullptr); i++)
+    {
+        const esp_partition_t * info = &partitions[i].info;
+
+        if (   (info->type == type)
+            && ((subtype == ESP_PARTITION_SUBTYPE_ANY) || (info->subtype == subtype))
+            && ((label == nullptr) || (strcmp(info->label, label) == 0)))
+        {
+            found = info;
+        }
+    }
+
+    return found;
+}
+
+extern "C" esp_err_t esp_partition_read(const esp_partition_t * partition, size_t src_offset,
+                                        void * dst, size_t size)
+{
+    esp_err_t err = ESP_OK;
+    HostPartition_t * host = findPartition(partition);
+    std::lock_guard<std::mutex> guard(flashLock);
+
+    if ((host == nullptr) || (dst == nullptr))
+    {
+        err = ESP_ERR_INVALID_ARG;
+    }
+    else if ((src_offset > partition->size) || (size > (partition->size - src_offset)))
+    {
+        err = ESP_ERR_INVALID_SIZE;
+    }
+    else
+    {
+        mountPartition(host);
+        memcpy(dst, &host->data[src_offset], size);
+        host->stats.reads++;
+    }
+
+    return err;
+}
+
+/*!
+ * \brief programming only clears bits, like the nor flash behind the
+ * partition. Writes that try to set a bit are counted, not refused
+ */
+extern "C" esp_err_t esp_partition_write(const esp_partition_t * partition, size_t dst_offset,
+                                         const void * src, size_t size)
+{
+    esp_err_t err = ESP_OK;
+    HostPartition_t * host = findPartition(partition);
+    std::lock_guard<std::mutex> guard(flashLock);
+
+    if ((host == nullptr) || (src == nullptr))
+    {
+        err = ESP_ERR_INVALID_ARG;
+    }
+    else if ((dst_offset > partition->size) || (size > (partition->size - dst_offset)))
+    {
+        err = ESP_ERR_INVALID_SIZE;
+    }
+    else
+    {
+        const uint8_t * bytes = (const uint8_t *)src;
+        bool setsBit = false;
+
+        mountPartition(host);
+        for (size_t i = 0u; i < size; i++)
+        {
+            uint8_t old = host->data[dst_offset + i];
+
+            setsBit |= ((old & bytes[i]) != bytes[i]);
+            host->data[dst_offset + i] = old & bytes[i];
+        }
+
+        host->stats.writes++;
+        host->stats.bytesWritten += (uint32_t)size;
+        if (setsBit)
+        {
+            host->stats.programErrors++;
+        }
+    }
+
+    return err;
+}
+
+extern "C" esp_err_t esp_partition_erase_range(const esp_partition_t * partition, size_t start_addr,
+                                               size_t size)
+{
+    esp_err_t err = ESP_OK;
+    HostPartition_t * host = findPartition(partition);
+    std::lock_guard<std::mutex> guard(flashLock);
+
+    if (host == nullptr)
+    {
+        err = ESP_ERR_INVALID_ARG;
+    }
+    else if (   ((start_addr % HOST_FLASH_SECTOR_SIZE) != 0u)
+             || ((size % HOST_FLASH_SECTOR_SIZE) != 0u)
+             || (start_addr > partition->size)
+             || (size > (partition->size - start_addr)))
+    {
+        err = ESP_ERR_INVALID_SIZE;
+    }
+    else
+    {
+        mountPartition(host);
+        memset(&host->data[start_addr], 0xFF, size);
+        for (size_t sector = start_addr / HOST_FLASH_SECTOR_SIZE;
+             sector < ((start_addr + size) / HOST_FLASH_SECTOR_SIZE);
+             sector++)
+        {
+            host->sectorErases[sector]++;
+            host->stats.erases++;
+            if (host->sectorErases[sector] > host->stats.maxSectorErases)
+            {
+                host->stats.maxSectorErases = host->sectorErases[sector];
+            }
+        }
+    }
+
+    return err;
+}
+
+extern "C" void host_flashReset(void)
+{
+    std::lock_guard<std::mutex> guard(flashLock);
+
+    for (size_t i = 0u; i < (sizeof(partitions) / sizeof(partitions[0])); i++)
+    {
+        HostPartition_t * host = &partitions[i];
+
+        mountPartition(host);
+        memset(host->data, 0xFF, host->info.size);
+        memset(host->sectorErases, 0, (host->info.size / HOST_FLASH_SECTOR_SIZE) * sizeof(uint32_t));
+        memset(&host->stats, 0, sizeof(host->stats));
+    }
+}
+
+extern "C" esp_err_t host_flashGetStats(const char * label, host_flash_stats_t * stats)
+{
+    esp_err_t err = ESP_ERR_NOT_FOUND;
+    std::lock_guard<std::mutex> guard(flashLock);
+
+    for (size_t i = 0u; i < (sizeof(partitions) / sizeof(partitions[0])); i++)
+    {
+        if (strcmp(partitions[i].info.label, label) == 0)
+        {
+            *stats = partitions[i].stats;
+            err = ESP_OK;
+        }
+    }
+
+    return err;
+}
+
+extern "C" esp_err_t nvs_flash_init(void)
+{
+    std::lock_guard<std::mutex> guard(nvsLock);
+
+    nvsInitialized = true;
+
+    return ESP_OK;
+}
+
+extern "C" esp_err_t nvs_flash_erase(void)
+{
+    std::lock_guard<std::mutex> guard(nvsLock);
+
+    memset(nvsNamespaces, 0, sizeof(nvsNamespaces));
+    memset(nvsEntries, 0, sizeof(nvsEntries));
+
+    return ESP_OK;
+}
+
+extern "C" esp_err_t nvs_open(const char * name, nvs_open_mode open_mode, nvs_handle * out_handle)
+{
+    esp_err_t err = ESP_ERR_NVS_NOT_FOUND;
+    std::lock_guard<std::mutex> guard(nvsLock);
+
+    if (nvsInitialized == false)
+    {
+        err = ESP_ERR_NVS_NOT_INITIALIZED;
+    }
+    else
+    {
+        for (uint32_t i = 0u; (i < NVS_MAX_NAMESPACES) && (err != ESP_OK); i++)
+        {
+            if (strncmp(nvsNamespaces[i], name, NVS_NAME_LENGTH) == 0)
+            {
+                *out_handle = i + 1u;
+                err = ESP_OK;
+            }
+        }
+
+        /*! - read only opens of a namespace never written fail, like the
+              sdk, a read write open creates it   */
+        for (uint32_t i = 0u; (i < NVS_MAX_NAMESPACES) && (err != ESP_OK) && (open_mode == NVS_READWRITE); i++)
+        {
+            if (nvsNamespaces[i][0] == '\0')
+            {
+                strncpy(nvsNamespaces[i], name, NVS_NAME_LENGTH - 1u);
+                *out_handle = i + 1u;
+                err = ESP_OK;
+            }
+        }
+    }
+
+    return err;
+}
+
+extern "C" esp_err_t nvs_get_blob(nvs_handle handle, const char * key, void * out_value, size_t * length)
+{
+    esp_err_t err = ESP_OK;
+    std::lock_guard<std::mutex> guard(nvsLock);
+    NvsEntry_t * entry = findEntry(handle, key);
+
+    if (entry == nullptr)
+    {
+        err = ESP_ERR_NVS_NOT_FOUND;
+    }
+    else if (out_value == nullptr)
+    {
+        *length = entry->length;
+    }
+    else if (*length < entry->length)
+    {
+        err = ESP_ERR_NVS_INVALID_LENGTH;
+    }
+    else
+    {
+        memcpy(out_value, entry->data, entry->length);
+        *length = entry->length;
+    }
+
+    return err;
+}
+
+extern "C" esp_err_t nvs_set_blob(nvs_handle handle, const char * key, const void * value, size_t length)
+{
+    esp_err_t err = ESP_OK;
+    std::lock_guard<std::mutex> guard(nvsLock);
+    NvsEntry_t * entry = findEntry(handle, key);
+
+    for (uint32_t i = 0u; (i < NVS_MAX_ENTRIES) && (entry == nullptr); i++)
+    {
+        if (nvsEntries[i].used == false)
+        {
+            entry = &nvsEntries[i];
+            entry->used = true;
+            entry->handle = handle;
+            strncpy(entry->key, key, NVS_NAME_LENGTH - 1u);
+        }
+    }
+
+    if (entry == nullptr)
+    {
+        err = ESP_ERR_NVS_NO_FREE_PAGES;
+    }
+    else if (length > NVS_MAX_BLOB_SIZE)
+    {
+        err = ESP_ERR_NVS_INVALID_LENGTH;
+    }
+    else
+    {
+        memcpy(entry->data, value, length);
+        entry->length = length;
+    }
+
+    return err;
+}
+
+extern "C" esp_err_t nvs_commit(nvs_handle handle)
+{
+    (void)handle;
+
+    return ESP_OK;
+}
+
+extern "C" void nvs_close(nvs_handle handle)
+{
+    (void)handle;
+}
+
+extern "C" esp_err_t esp_wifi_set_ps(wifi_ps_type_t type)
+{
+    wifiPowerSave = type;
+
+    return ESP_OK;
+}
+
+extern "C" esp_err_t esp_wifi_get_ps(wifi_ps_type_t * type)
+{
+    *type = wifiPowerSave;
+
+    return ESP_OK;
+}
+
+extern "C" esp_err_t esp_wifi_get_config(esp_interface_t interface, wifi_config_t * conf)
+{
+    esp_err_t err = ESP_ERR_INVALID_ARG;
+
+    if (interface == ESP_IF_WIFI_STA)
+    {
+        *conf = wifiStaConfig;
+        err = ESP_OK;
+    }
+
+    return err;
+}
+
+extern "C" esp_err_t esp_wifi_set_config(esp_interface_t interface, wifi_config_t * conf)
+{
+    esp_err_t err = ESP_ERR_INVALID_ARG;
+
+    if (interface == ESP_IF_WIFI_STA)
+    {
+        wifiStaConfig = *conf;
+        err = ESP_OK;
+    }
+
+    return err;
+}
@@ -0,0 +1,568 @@
+/**
+ *******************************************************************************
+ * @file    freertos_port.cpp
+ * @author  hq
+ * @date    2026-10-19 09:12:40
+ * @brief   Host port of the FreeRTOS kernel calls. Every task runs on its
+ *  own thread, priorities are recorded but the host scheduler decides who
+ *  runs. The critical section is one recursive mutex, which is what the
+ *  single core target gets by masking interrupts.
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * INCLUDES
+ *******************************************************************************/
+#include "host_port.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <new>
+#include <thread>
+
+extern "C"
+{
+    #include "freertos/FreeRTOS.h"
+    #include "freertos/task.h"
+    #include "freertos/queue.h"
+    #include "esp_timer.h"
+}
+
+/*******************************************************************************
+ * EXTERN VARIABLES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * PRIVATE MACROS AND DEFINES
+ *******************************************************************************/
+#define HOST_TASK_NAME_LENGTH       (16u)
+#define HOST_MAX_TASKS              (32u)
+
+/*******************************************************************************
+ * PRIVATE TYPEDEFS
+ *******************************************************************************/
+struct HostTask
+{
+    char name[HOST_TASK_NAME_LENGTH];
+    TaskFunction_t code;
+    void * parameters;
+    UBaseType_t priority;
+    uint32_t stackDepth;
+    uint32_t notifyCount;
+    bool suspended;
+    bool deleted;
+    std::mutex lock;
+    std::condition_variable wake;
+};
+
+struct HostQueue
+{
+    uint8_t * storage;
+    UBaseType_t length;
+    UBaseType_t itemSize;
+    UBaseType_t head;
+    UBaseType_t count;
+    std::mutex lock;
+    std::condition_variable notEmpty;
+    std::condition_variable notFull;
+};
+
+/*  thrown by vTaskDelete(NULL), unwinds the task thread to its entry */
+struct HostTaskExit
+{
+};
+
+/*******************************************************************************
+ * STATIC VARIABLES
+ *******************************************************************************/
+
+/*  statically initialized, usable by the block allocator before main */
+static pthread_mutex_t criticalLock = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
+
+static std::mutex registryLock;
+static HostTask * tasks[HOST_MAX_TASKS];
+static thread_local HostTask * currentTask = nullptr;
+static thread_local bool inIsr = false;
+
+static std::mutex clockLock;
+static bool manualClock = false;
+static int64_t manualUs = 0;
+static int64_t realOffsetUs = 0;
+static const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+/*******************************************************************************
+ * GLOBAL VARIABLES
+ *******************************************************************************/
+
+/*******************************************************************************
+ * STATIC FUNCTION PROTOTYPES
+ *******************************************************************************/
+static int64_t wallUs(void);
+static HostTask * createTask(TaskFunction_t code, const char * name, uint32_t stackDepth,
+                             void * parameters, UBaseType_t priority);
+static void runTask(HostTask * task);
+static HostTask * resolve(TaskHandle_t task);
+template <typename Predicate>
+static bool waitFor(std::condition_variable & cv, std::unique_lock<std::mutex> & lock,
+                    TickType_t ticks, Predicate ready);
+
+/*******************************************************************************
+ * STATIC FUNCTIONS
+ *******************************************************************************/
+static int64_t wallUs(void)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now() - startTime).count();
+}
+
+static HostTask * createTask(TaskFunction_t code, const char * name, uint32_t stackDepth,
+                             void * parameters, UBaseType_t priority)
+{
+    /*! - port objects stay off operator new, which the block allocator
+          replaces when it is linked in   */
+    HostTask * task = new (malloc(sizeof(HostTask))) HostTask();
+    bool registered = false;
+
+    strncpy(task->name, (name != nullptr) ? name : "", HOST_TASK_NAME_LENGTH - 1u);
+    task->code = code;
+    task->parameters = parameters;
+    task->priority = priority;
+    task->stackDepth = stackDepth;
+    task->notifyCount = 0u;
+    task->suspended = false;
+    task->deleted = false;
+
+    {
+        std::lock_guard<std::mutex> guard(registryLock);
+
+        for (uint32_t i = 0u; (i < HOST_MAX_TASKS) && (registered == false); i++)
+        {
+            if (tasks[i] == nullptr)
+            {
+                tasks[i] = task;
+                registered = true;
+            }
+        }
+    }
+
+    if (registered == false)
+    {
+        task->~HostTask();
+        free(task);
+        task = nullptr;
+    }
+    else if (code != nullptr)
+    {
+        std::thread(runTask, task).detach();
+    }
+
+    return task;
+}
+
+static void runTask(HostTask * task)
+{
+    currentTask = task;
+
+    try
+    {
+        task->code(task->parameters);
+    }
+    catch (const HostTaskExit &)
+    {
+    }
+
+    std::lock_guard<std::mutex> guard(task->lock);
+    task->deleted = true;
+}
+
+/*!
+ * \brief a NULL handle names the calling task, the main thread gets a task
+ * of its own the first time it asks
+ */
+static HostTask * resolve(TaskHandle_t task)
+{
+    if ((task == nullptr) && (currentTask == nullptr))
+    {
+        currentTask = createTask(nullptr, "main", configMINIMAL_STACK_SIZE, nullptr, 1u);
+    }
+
+    return (task != nullptr) ? task : currentTask;
+}
+
+template <typename Predicate>
+static bool waitFor(std::condition_variable & cv, std::unique_lock<std::mutex> & lock,
+                    TickType_t ticks, Predicate ready)
+{
+    bool result = false;
+
+    if (ticks == portMAX_DELAY)
+    {
+        cv.wait(lock, ready);
+        result = true;
+    }
+    else
+    {
+        result = cv.wait_for(lock, std::chrono::milliseconds(ticks * portTICK_PERIOD_MS), ready);
+    }
+
+    return result;
+}
+
+/*******************************************************************************
+ * GLOBAL FUNCTIONS
+ *******************************************************************************/
+extern "C" void vPortEnterCritical(void)
+{
+    pthread_mutex_lock(&criticalLock);
+}
+
+extern "C" void vPortExitCritical(void)
+{
+    pthread_mutex_unlock(&criticalLock);
+}
+
+extern "C" BaseType_t xPortInIsrContext(void)
+{
+    return inIsr ? pdTRUE : pdFALSE;
+}
+
+/*!
+ * \brief an isr cannot run inside a critical section and no task runs
+ * while it does, both follow from holding the critical lock
+ */
+extern "C" void host_runIsr(void (*fn)(void *), void * arg)
+{
+    vPortEnterCritical();
+    inIsr = true;
+    fn(arg);
+    inIsr = false;
+    vPortExitCritical();
+}
+
+extern "C" void host_setManualClock(int64_t startUs)
+{
+    std::lock_guard<std::mutex> guard(clockLock);
+
+    manualClock = true;
+    manualUs = startUs;
+}
+
+extern "C" void host_advanceTimeUs(int64_t us)
+{
+    std::lock_guard<std::mutex> guard(clockLock);
+
+    manualUs += us;
+}
+
+extern "C" void host_useRealClock(void)
+{
+    std::lock_guard<std::mutex> guard(clockLock);
+
+    if (manualClock)
+    {
+        realOffsetUs = manualUs - wallUs();
+        manualClock = false;
+    }
+}
+
+extern "C" int64_t esp_timer_get_time(void)
+{
+    std::lock_guard<std::mutex> guard(clockLock);
+
+    return manualClock ? manualUs : (wallUs() + realOffsetUs);
+}
+
+extern "C" TickType_t xTaskGetTickCount(void)
+{
+    return (TickType_t)(esp_timer_get_time() / (1000 * (int64_t)portTICK_PERIOD_MS));
+}
+
+extern "C" void vTaskDelay(TickType_t xTicksToDelay)
+{
+    bool manual;
+
+    {
+        std::lock_guard<std::mutex> guard(clockLock);
+        manual = manualClock;
+    }
+
+    if (manual)
+    {
+        host_advanceTimeUs((int64_t)xTicksToDelay * portTICK_PERIOD_MS * 1000);
+    }
+    else if (xTicksToDelay > 0u)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(xTicksToDelay * portTICK_PERIOD_MS));
+    }
+    else
+    {
+        std::this_thread::yield();
+    }
+}
+
+extern "C" void vTaskDelayUntil(TickType_t * pxPreviousWakeTime, TickType_t xTimeIncrement)
+{
+    TickType_t wakeTime = *pxPreviousWakeTime + xTimeIncrement;
+    TickType_t remaining = wakeTime - xTaskGetTickCount();
+
+    /*! - a wake time already passed returns at once, like the kernel   */
+    if ((remaining != 0u) && (remaining <= xTimeIncrement))
+    {
+        vTaskDelay(remaining);
+    }
+    *pxPreviousWakeTime = wakeTime;
+}
+
+extern "C" BaseType_t xTaskCreate(TaskFunction_t pxTaskCode, const char * pcName, uint32_t usStackDepth,
+                                  void * pvParameters, UBaseType_t uxPriority, TaskHandle_t * pxCreatedTask)
+{
+    HostTask * task = createTask(pxTaskCode, pcName, usStackDepth, pvParameters, uxPriority);
+
+    if (pxCreatedTask != nullptr)
+    {
+        *pxCreatedTask = task;
+    }
+
+    return (task != nullptr) ? pdPASS : pdFAIL;
+}
+
+extern "C" TaskHandle_t xTaskCreateStatic(TaskFunction_t pxTaskCode, const char * pcName, uint32_t ulStackDepth,
+                                          void * pvParameters, UBaseType_t uxPriority,
+                                          StackType_t * puxStackBuffer, StaticTask_t * pxTaskBuffer)
+{
+    TaskHandle_t task = nullptr;
+
+    if ((puxStackBuffer != nullptr) && (pxTaskBuffer != nullptr))
+    {
+        task = createTask(pxTaskCode, pcName, ulStackDepth, pvParameters, uxPriority);
+    }
+
+    return task;
+}
+
+extern "C" void vTaskDelete(TaskHandle_t xTaskToDelete)
+{
+    HostTask * task = resolve(xTaskToDelete);
+
+    if (task == currentTask)
+    {
+        throw HostTaskExit();
+    }
+
+    /*! - another thread cannot be stopped from outside, it is only marked */
+    std::lock_guard<std::mutex> guard(task->lock);
+    task->deleted = true;
+}
+
+extern "C" void vTaskSuspend(TaskHandle_t xTaskToSuspend)
+{
+    HostTask * task = resolve(xTaskToSuspend);
+    std::unique_lock<std::mutex> guard(task->lock);
+
+    task->suspended = true;
+    if (task == currentTask)
+    {
+        task->wake.wait(guard, [task] { return task->suspended == false; });
+    }
+}
+
+extern "C" void vTaskResume(TaskHandle_t xTaskToResume)
+{
+    HostTask * task = resolve(xTaskToResume);
+    std::lock_guard<std::mutex> guard(task->lock);
+
+    task->suspended = false;
+    task->wake.notify_all();
+}
+
+extern "C" void vTaskPrioritySet(TaskHandle_t xTask, UBaseType_t uxNewPriority)
+{
+    resolve(xTask)->priority = uxNewPriority;
+}
+
+extern "C" eTaskState eTaskGetState(TaskHandle_t xTask)
+{
+    HostTask * task = resolve(xTask);
+    eTaskState state = eBlocked;
+    std::lock_guard<std::mutex> guard(task->lock);
+
+    if (task->deleted)
+    {
+        state = eDeleted;
+    }
+    else if (task->suspended)
+    {
+        state = eSuspended;
+    }
+    else if (task == currentTask)
+    {
+        state = eRunning;
+    }
+
+    return state;
+}
+
+extern "C" char * pcTaskGetName(TaskHandle_t xTaskToQuery)
+{
+    return resolve(xTaskToQuery)->name;
+}
+
+extern "C" TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    return resolve(nullptr);
+}
+
+extern "C" UBaseType_t uxTaskGetNumberOfTasks(void)
+{
+    UBaseType_t count = 0u;
+    std::lock_guard<std::mutex> guard(registryLock);
+
+    for (uint32_t i = 0u; i < HOST_MAX_TASKS; i++)
+    {
+        if ((tasks[i] != nullptr) && (tasks[i]->deleted == false))
+        {
+            count++;
+        }
+    }
+
+    return count;
+}
+
+/*!
+ * \brief the host cannot measure the target stack, the whole depth is
+ * reported free
+ */
+extern "C" UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t xTask)
+{
+    return resolve(xTask)->stackDepth;
+}
+
+extern "C" BaseType_t xTaskNotifyGive(TaskHandle_t xTaskToNotify)
+{
+    HostTask * task = resolve(xTaskToNotify);
+    std::lock_guard<std::mutex> guard(task->lock);
+
+    task->notifyCount++;
+    task->wake.notify_all();
+
+    return pdPASS;
+}
+
+extern "C" void vTaskNotifyGiveFromISR(TaskHandle_t xTaskToNotify, BaseType_t * pxHigherPriorityTaskWoken)
+{
+    xTaskNotifyGive(xTaskToNotify);
+    if (pxHigherPriorityTaskWoken != nullptr)
+    {
+        *pxHigherPriorityTaskWoken = pdTRUE;
+    }
+}
+
+extern "C" uint32_t ulTaskNotifyTake(BaseType_t xClearCountOnExit, TickType_t xTicksToWait)
+{
+    HostTask * task = resolve(nullptr);
+    uint32_t count = 0u;
+    std::unique_lock<std::mutex> guard(task->lock);
+
+    if (waitFor(task->wake, guard, xTicksToWait, [task] { return task->notifyCount > 0u; }))
+    {
+        count = task->notifyCount;
+        task->notifyCount = (xClearCountOnExit != pdFALSE) ? 0u : (count - 1u);
+    }
+
+    return count;
+}
+
+extern "C" QueueHandle_t xQueueCreate(UBaseType_t uxQueueLength, UBaseType_t uxItemSize)
+{
+    HostQueue * queue = nullptr;
+
+    if ((uxQueueLength > 0u) && (uxItemSize > 0u))
+    {
+        queue = new (malloc(sizeof(HostQueue))) HostQueue();
+        queue->storage = (uint8_t *)calloc(uxQueueLength, uxItemSize);
+        queue->length = uxQueueLength;
+        queue->itemSize = uxItemSize;
+        queue->head = 0u;
+        queue->count = 0u;
+    }
+
+    return queue;
+}
+
+extern "C" void vQueueDelete(QueueHandle_t xQueue)
+{
+    if (xQueue != nullptr)
+    {
+        free(xQueue->storage);
+        xQueue->~HostQueue();
+        free(xQueue);
+    }
+}
+
+extern "C" BaseType_t xQueueSendToBack(QueueHandle_t xQueue, const void * pvItemToQueue, TickType_t xTicksToWait)
+{
+    BaseType_t result = errQUEUE_FULL;
+    std::unique_lock<std::mutex> guard(xQueue->lock);
+
+    if (waitFor(xQueue->notFull, guard, xTicksToWait, [xQueue] { return xQueue->count < xQueue->length; }))
+    {
+        UBaseType_t tail = (xQueue->head + xQueue->count) % xQueue->length;
+
+        memcpy(&xQueue->storage[tail * xQueue->itemSize], pvItemToQueue, xQueue->itemSize);
+        xQueue->count++;
+        xQueue->notEmpty.notify_one();
+        result = pdPASS;
+    }
+
+    return result;
+}
+
+extern "C" BaseType_t xQueueSendToBackFromISR(QueueHandle_t xQueue, const void * pvItemToQueue,
+                                              BaseType_t * pxHigherPriorityTaskWoken)
+{
+    BaseType_t result = xQueueSendToBack(xQueue, pvItemToQueue, 0u);
+
+    if ((result == pdPASS) && (pxHigherPriorityTaskWoken != nullptr))
+    {
+        *pxHigherPriorityTaskWoken = pdTRUE;
+    }
+
+    return result;
+}
+
+extern "C" BaseType_t xQueueReceive(QueueHandle_t xQueue, void * pvBuffer, TickType_t xTicksToWait)
+{
+    BaseType_t result = pdFALSE;
+    std::unique_lock<std::mutex> guard(xQueue->lock);
+
+    if (waitFor(xQueue->notEmpty, guard, xTicksToWait, [xQueue] { return xQueue->count > 0u; }))
+    {
+        memcpy(pvBuffer, &xQueue->storage[xQueue->head * xQueue->itemSize], xQueue->itemSize);
+        xQueue->head = (xQueue->head + 1u) % xQueue->length;
+        xQueue->count--;
+        xQueue->notFull.notify_one();
+        result = pdTRUE;
+    }
+
+    return result;
+}
+
+extern "C" UBaseType_t uxQueueMessagesWaiting(QueueHandle_t xQueue)
+{
+    std::lock_guard<std::mutex> guard(xQueue->lock);
+
+    return xQueue->count;
+}
+
+extern "C" UBaseType_t uxQueueSpacesAvailable(QueueHandle_t xQueue)
+{
+    std::lock_guard<std::mutex> guard(xQueue->lock);
+
+    return xQueue->length - xQueue->count;
+}
@@ -0,0 +1,32 @@
+/**
+ ********************************************************************************
+ * @file    hw_timer.h
+ * @author  hq
+ * @date    2026-10-19 09:12:40
+ * @brief   Host port of the FRC1 timer driver, the alarm fires only through host_hwTimerFire()
+ ********************************************************************************
+ */
+
+#ifndef HOST_DRIVER_HW_TIMER_H
+#define HOST_DRIVER_HW_TIMER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+typedef void (*hw_timer_callback_t)(void * arg);
+
+esp_err_t hw_timer_init(hw_timer_callback_t callback, void * arg);
+esp_err_t hw_timer_deinit(void);
+esp_err_t hw_timer_alarm_us(uint32_t value, bool reload);
+esp_err_t hw_timer_enable(bool en);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //HOST_DRIVER_HW_TIMER_H
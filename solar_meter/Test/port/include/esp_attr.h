@@ -0,0 +1,17 @@
+/**
+ ********************************************************************************
+ * @file    esp_attr.h
+ * @author  hq
+ * @date    2026-10-19 09:12:40
+ * @brief   Host port of the SDK section attributes, all plain ram here
+ ********************************************************************************
+ */
+
+#ifndef HOST_ESP_ATTR_H
+#define HOST_ESP_ATTR_H
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define RTC_DATA_ATTR
+
+#endif //HOST_ESP_ATTR_H
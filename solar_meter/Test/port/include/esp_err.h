@@ -0,0 +1,48 @@
+/**
+ ********************************************************************************
+ * @file    esp_err.h
+ * @author  hq
+ * @date    2026-10-19 09:12:40
+ * @brief   Host port of the SDK error codes
+ ********************************************************************************
+ */
+
+#ifndef HOST_ESP_ERR_H
+#define HOST_ESP_ERR_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+typedef int32_t esp_err_t;
+
+#define ESP_OK                          (0)
+#define ESP_FAIL                        (-1)
+#define ESP_ERR_NO_MEM                  (0x101)
+#define ESP_ERR_INVALID_ARG             (0x102)
+#define ESP_ERR_INVALID_STATE           (0x103)
+#define ESP_ERR_INVALID_SIZE            (0x104)
+#define ESP_ERR_NOT_FOUND               (0x105)
+#define ESP_ERR_TIMEOUT                 (0x107)
+
+#define ESP_ERROR_CHECK(x)                                                      \
+    do                                                                          \
+    {                                                                           \
+        esp_err_t rc_ = (x);                                                    \
+        if (rc_ != ESP_OK)                                                      \
+        {                                                                       \
+            fprintf(stderr, "ESP_ERROR_CHECK failed: 0x%x at %s:%d\n",          \
+                    (unsigned)rc_, __FILE__, __LINE__);                         \
+            abort();                                                            \
+        }                                                                       \
+    } while (0)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //HOST_ESP_ERR_H
@@ -0,0 +1,48 @@
+/**
+ ********************************************************************************
+ * @file    esp_log.h
+ * @author  hq
+ * @date    2026-10-19 09:12:40
+ * @brief   Host port of the SDK log macros, printed to stdout
+ ********************************************************************************
+ */
+
+#ifndef HOST_ESP_LOG_H
+#define HOST_ESP_LOG_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+typedef enum
+{
+    ESP_LOG_NONE,
+    ESP_LOG_ERROR,
+    ESP_LOG_WARN,
+    ESP_LOG_INFO,
+    ESP_LOG_DEBUG,
+    ESP_LOG_VERBOSE
+} esp_log_level_t;
+
+/** @brief  Sets the level of every tag, only the "*" wildcard is kept
+ */
+void esp_log_level_set(const char * tag, esp_log_level_t level);
+uint32_t esp_log_timestamp(void);
+void esp_log_write(esp_log_level_t level, const char * tag, const char * format, ...)
+    __attribute__((format(printf, 3, 4)));
+
+#define ESP_LOG_FORMAT(letter, format)  #letter " (%u) %s: " format "\n"
+
+#define ESP_LOGE(tag, format, ...)  esp_log_write(ESP_LOG_ERROR,   tag, ESP_LOG_FORMAT(E, format), (unsigned)esp_log_timestamp(), tag, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...)  esp_log_write(ESP_LOG_WARN,    tag, ESP_LOG_FORMAT(W, format), (unsigned)esp_log_timestamp(), tag, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...)  esp_log_write(ESP_LOG_INFO,    tag, ESP_LOG_FORMAT(I, format), (unsigned)esp_log_timestamp(), tag, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...)  esp_log_write(ESP_LOG_DEBUG,   tag, ESP_LOG_FORMAT(D, format), (unsigned)esp_log_timestamp(), tag, ##__VA_ARGS__)
+#define ESP_LOGV(tag, format, ...)  esp_log_write(ESP_LOG_VERBOSE, tag, ESP_LOG_FORMAT(V, format), (unsigned)esp_log_timestamp(), tag, ##__VA_ARGS__)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //HOST_ESP_LOG_H
@@ -0,0 +1,56 @@
+/**
+ ********************************************************************************
+ * @file    esp_partition.h
+ * @author  hq
+ * @date    2026-10-19 09:12:40
+ * @brief   Host port of the SDK partition api, ram backed with nor flash semantics
+ ********************************************************************************
+ */
+
+#ifndef HOST_ESP_PARTITION_H
+#define HOST_ESP_PARTITION_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+typedef enum
+{
+    ESP_PARTITION_TYPE_APP = 0x00,
+    ESP_PARTITION_TYPE_DATA = 0x01
+} esp_partition_type_t;
+
+typedef int esp_partition_subtype_t;
+
+#define ESP_PARTITION_SUBTYPE_ANY       (0xff)
+
+typedef struct
+{
+    esp_partition_type_t type;
+    esp_partition_subtype_t subtype;
+    uint32_t address;
+    uint32_t size;
+    char label[17];
+    bool encrypted;
+} esp_partition_t;
+
+const esp_partition_t * esp_partition_find_first(esp_partition_type_t type,
+                                                 esp_partition_subtype_t subtype,
+                                                 const char * label);
+esp_err_t esp_partition_read(const esp_partition_t * partition, size_t src_offset,
+                             void * dst, size_t size);
+esp_err_t esp_partition_write(const esp_partition_t * partition, size_t dst_offset,
+                              const void * src, size_t size);
+esp_err_t esp_partition_erase_range(const esp_partition_t * partition, size_t start_addr,
+                                    size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //HOST_ESP_PARTITION_H
@@ -0,0 +1,28 @@
+/**
+ ********************************************************************************
+ * @file    esp_system.h
+ * @author  hq
+ * @date    2026-10-19 09:12:40
+ * @brief   Host port of the SDK heap queries
+ ********************************************************************************
+ */
+
+#ifndef HOST_ESP_SYSTEM_H
+#define HOST_ESP_SYSTEM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/** @brief  Host heap model, HOST_HEAP_SIZE less the bytes malloc holds
+ */
+uint32_t esp_get_free_heap_size(void);
+uint32_t esp_get_minimum_free_heap_size(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //HOST_ESP_SYSTEM_H
@@ -0,0 +1,27 @@
+/**
+ ********************************************************************************
+ * @file    esp_timer.h
+ * @author  hq
+ * @date    2026-10-19 09:12:40
+ * @brief   Host port of the SDK microsecond timer, see host_port.h for the manual clock
+ ********************************************************************************
+ */
+
+#ifndef HOST_ESP_TIMER_H
+#define HOST_ESP_TIMER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/** @brief  Microseconds since the port started, or the manual clock
+ */
+int64_t esp_timer_get_time(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //HOST_ESP_TIMER_H
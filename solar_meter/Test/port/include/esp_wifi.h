@@ -0,0 +1,54 @@
+/**
+ ********************************************************************************
+ * @file    esp_wifi.h
+ * @author  hq
+ * @date    2026-10-19 09:12:40
+ * @brief   Host port of the SDK wifi calls the transmit scheduler makes, the host keeps the last values set
+ ********************************************************************************
+ */
+
+#ifndef HOST_ESP_WIFI_H
+#define HOST_ESP_WIFI_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "esp_err.h"
+
+typedef enum
+{
+    WIFI_PS_NONE,
+    WIFI_PS_MIN_MODEM,
+    WIFI_PS_MAX_MODEM
+} wifi_ps_type_t;
+
+typedef enum
+{
+    ESP_IF_WIFI_STA = 0,
+    ESP_IF_WIFI_AP
+} esp_interface_t;
+
+typedef struct
+{
+    uint8_t ssid[32];
+    uint8_t password[64];
+    uint16_t listen_interval;
+} wifi_sta_config_t;
+
+typedef union
+{
+    wifi_sta_config_t sta;
+} wifi_config_t;
+
+esp_err_t esp_wifi_set_ps(wifi_ps_type_t type);
+esp_err_t esp_wifi_get_ps(wifi_ps_type_t * type);
+esp_err_t esp_wifi_get_config(esp_interface_t interface, wifi_config_t * conf);
+esp_err_t esp_wifi_set_config(esp_interface_t interface, wifi_config_t * conf);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //HOST_ESP_WIFI_H
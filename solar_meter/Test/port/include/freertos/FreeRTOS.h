@@ -0,0 +1,87 @@
+/**
+ ********************************************************************************
+ * @file    FreeRTOS.h
+ * @author  hq
+ * @date    2026-10-19 09:12:40
+ * @brief   Host port of the FreeRTOS types and configuration the firmware
+ *  uses. Tasks run on threads, see Test/port/freertos_port.cpp.
+ ********************************************************************************
+ */
+
+#ifndef HOST_FREERTOS_H
+#define HOST_FREERTOS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/************************************
+ * INCLUDES
+ ************************************/
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+/************************************
+ * MACROS AND DEFINES
+ ************************************/
+#define configTICK_RATE_HZ              (1000u)     /* CONFIG_FREERTOS_HZ */
+#define configMAX_PRIORITIES            (15)
+#define configMINIMAL_STACK_SIZE        (768)
+#define configSUPPORT_STATIC_ALLOCATION (1)
+
+#define pdFALSE                         ((BaseType_t)0)
+#define pdTRUE                          ((BaseType_t)1)
+#define pdPASS                          (pdTRUE)
+#define pdFAIL                          (pdFALSE)
+#define errQUEUE_FULL                   ((BaseType_t)0)
+
+#define portMAX_DELAY                   ((TickType_t)0xFFFFFFFFu)
+#define portTICK_PERIOD_MS              ((TickType_t)(1000u / configTICK_RATE_HZ))
+#define portTICK_RATE_MS                (portTICK_PERIOD_MS)
+#define pdMS_TO_TICKS(xTimeInMs)        ((TickType_t)(((TickType_t)(xTimeInMs) * configTICK_RATE_HZ) / 1000u))
+
+#define portENTER_CRITICAL()            vPortEnterCritical()
+#define portEXIT_CRITICAL()             vPortExitCritical()
+#define portYIELD_FROM_ISR()
+
+/************************************
+ * TYPEDEFS
+ ************************************/
+typedef int32_t BaseType_t;
+typedef uint32_t UBaseType_t;
+typedef uint32_t TickType_t;
+typedef uint8_t StackType_t;                    /* stack depths are in bytes */
+typedef void (*TaskFunction_t)(void *);
+
+typedef struct HostTask * TaskHandle_t;
+typedef struct HostQueue * QueueHandle_t;
+
+/*  static task control block, the host keeps its own task state */
+typedef struct
+{
+    uint8_t reserved[96];
+} StaticTask_t;
+
+/************************************
+ * GLOBAL FUNCTION PROTOTYPES
+ ************************************/
+
+/** @brief  Enters the single, recursive critical section shared by every
+ *  task and the simulated isrs
+ */
+void vPortEnterCritical(void);
+
+/** @brief  Leaves the critical section entered by vPortEnterCritical()
+ */
+void vPortExitCritical(void);
+
+/** @brief  Returns pdTRUE while the calling thread runs a simulated isr
+ */
+BaseType_t xPortInIsrContext(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //HOST_FREERTOS_H
@@ -0,0 +1,41 @@
+/**
+ ********************************************************************************
+ * @file    queue.h
+ * @author  hq
+ * @date    2026-10-19 09:12:40
+ * @brief   Host port of the FreeRTOS queue api, items are copied by value
+ ********************************************************************************
+ */
+
+#ifndef HOST_QUEUE_H
+#define HOST_QUEUE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/************************************
+ * INCLUDES
+ ************************************/
+#include "freertos/FreeRTOS.h"
+
+/************************************
+ * GLOBAL FUNCTION PROTOTYPES
+ ************************************/
+QueueHandle_t xQueueCreate(UBaseType_t uxQueueLength, UBaseType_t uxItemSize);
+void vQueueDelete(QueueHandle_t xQueue);
+BaseType_t xQueueSendToBack(QueueHandle_t xQueue, const void * pvItemToQueue, TickType_t xTicksToWait);
+BaseType_t xQueueSendToBackFromISR(QueueHandle_t xQueue, const void * pvItemToQueue,
+                                   BaseType_t * pxHigherPriorityTaskWoken);
+BaseType_t xQueueReceive(QueueHandle_t xQueue, void * pvBuffer, TickType_t xTicksToWait);
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t xQueue);
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t xQueue);
+
+#define xQueueSend(xQueue, pvItemToQueue, xTicksToWait) \
+    xQueueSendToBack((xQueue), (pvItemToQueue), (xTicksToWait))
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //HOST_QUEUE_H
@@ -0,0 +1,16 @@
+/**
+ ********************************************************************************
+ * @file    semphr.h
+ * @author  hq
+ * @date    2026-10-19 09:12:40
+ * @brief   Host port placeholder, the firmware includes the header but
+ *  synchronizes through notifications and queues only
+ ********************************************************************************
+ */
+
+#ifndef HOST_SEMPHR_H
+#define HOST_SEMPHR_H
+
+#include "freertos/queue.h"
+
+#endif //HOST_SEMPHR_H
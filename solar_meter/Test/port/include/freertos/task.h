@@ -0,0 +1,71 @@
+/**
+ ********************************************************************************
+ * @file    task.h
+ * @author  hq
+ * @date    2026-10-19 09:12:40
+ * @brief   Host port of the FreeRTOS task api
+ ********************************************************************************
+ */
+
+#ifndef HOST_TASK_H
+#define HOST_TASK_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/************************************
+ * INCLUDES
+ ************************************/
+#include "freertos/FreeRTOS.h"
+
+/************************************
+ * MACROS AND DEFINES
+ ************************************/
+#define taskENTER_CRITICAL()            portENTER_CRITICAL()
+#define taskEXIT_CRITICAL()             portEXIT_CRITICAL()
+#define tskIDLE_PRIORITY                ((UBaseType_t)0)
+
+/************************************
+ * TYPEDEFS
+ ************************************/
+typedef enum
+{
+    eRunning = 0,
+    eReady,
+    eBlocked,
+    eSuspended,
+    eDeleted
+} eTaskState;
+
+/************************************
+ * GLOBAL FUNCTION PROTOTYPES
+ ************************************/
+BaseType_t xTaskCreate(TaskFunction_t pxTaskCode, const char * pcName, uint32_t usStackDepth,
+                       void * pvParameters, UBaseType_t uxPriority, TaskHandle_t * pxCreatedTask);
+TaskHandle_t xTaskCreateStatic(TaskFunction_t pxTaskCode, const char * pcName, uint32_t ulStackDepth,
+                               void * pvParameters, UBaseType_t uxPriority,
+                               StackType_t * puxStackBuffer, StaticTask_t * pxTaskBuffer);
+void vTaskDelete(TaskHandle_t xTaskToDelete);
+void vTaskSuspend(TaskHandle_t xTaskToSuspend);
+void vTaskResume(TaskHandle_t xTaskToResume);
+void vTaskPrioritySet(TaskHandle_t xTask, UBaseType_t uxNewPriority);
+eTaskState eTaskGetState(TaskHandle_t xTask);
+char * pcTaskGetName(TaskHandle_t xTaskToQuery);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+UBaseType_t uxTaskGetNumberOfTasks(void);
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t xTask);
+
+void vTaskDelay(TickType_t xTicksToDelay);
+void vTaskDelayUntil(TickType_t * pxPreviousWakeTime, TickType_t xTimeIncrement);
+TickType_t xTaskGetTickCount(void);
+
+BaseType_t xTaskNotifyGive(TaskHandle_t xTaskToNotify);
+void vTaskNotifyGiveFromISR(TaskHandle_t xTaskToNotify, BaseType_t * pxHigherPriorityTaskWoken);
+uint32_t ulTaskNotifyTake(BaseType_t xClearCountOnExit, TickType_t xTicksToWait);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //HOST_TASK_H
@@ -0,0 +1,92 @@
+/**
+ ********************************************************************************
+ * @file    host_port.h
+ * @author  hq
+ * @date    2026-10-19 09:12:40
+ * @brief   Controls the host tests use to drive the ported kernel, clock,
+ *  drivers and flash. Firmware sources never include this header.
+ ********************************************************************************
+ */
+
+#ifndef HOST_PORT_H
+#define HOST_PORT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/************************************
+ * INCLUDES
+ ************************************/
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+/************************************
+ * MACROS AND DEFINES
+ ************************************/
+#define HOST_HEAP_SIZE                  (80u * 1024u)   /* free heap after boot */
+#define HOST_FLASH_SECTOR_SIZE          (4096u)
+
+/************************************
+ * TYPEDEFS
+ ************************************/
+
+/*  device model behind the i2c driver, called with the bytes of one command */
+typedef esp_err_t (*host_i2c_write_t)(uint8_t address, const uint8_t * data, size_t length, void * arg);
+typedef esp_err_t (*host_i2c_read_t)(uint8_t address, uint8_t * data, size_t length, void * arg);
+
+typedef struct
+{
+    uint32_t reads;
+    uint32_t writes;                    /**< esp_partition_write calls              */
+    uint32_t bytesWritten;
+    uint32_t erases;                    /**< sectors erased                         */
+    uint32_t maxSectorErases;           /**< most erases any one sector took        */
+    uint32_t programErrors;             /**< writes that tried to set a zero bit    */
+} host_flash_stats_t;
+
+/************************************
+ * GLOBAL FUNCTION PROTOTYPES
+ ************************************/
+
+/** @brief  Stops the clock at startUs, from then on time only moves with
+ *  host_advanceTimeUs() and vTaskDelay(). For single threaded tests
+ */
+void host_setManualClock(int64_t startUs);
+
+/** @brief  Moves the manual clock forward
+ */
+void host_advanceTimeUs(int64_t us);
+
+/** @brief  Returns to the wall clock, time keeps counting from its value
+ */
+void host_useRealClock(void);
+
+/** @brief  Runs fn as an isr, xPortInIsrContext() is true while it runs
+ */
+void host_runIsr(void (*fn)(void *), void * arg);
+
+/** @brief  Fires the FRC1 alarm armed through hw_timer_alarm_us()
+ */
+void host_hwTimerFire(void);
+
+/** @brief  Sets the i2c device model, NULL callbacks read zeros and
+ *  accept every write
+ */
+void host_i2cSetDevice(host_i2c_write_t write, host_i2c_read_t read, void * arg);
+
+/** @brief  Erases every partition and clears the flash statistics
+ */
+void host_flashReset(void);
+
+/** @brief  Flash statistics of the partition with the given label
+ */
+esp_err_t host_flashGetStats(const char * label, host_flash_stats_t * stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //HOST_PORT_H
@@ -0,0 +1,37 @@
+/**
+ ********************************************************************************
+ * @file    sockets.h
+ * @author  hq
+ * @date    2026-10-19 09:12:40
+ * @brief   Host port of the lwip socket api, mapped onto the posix sockets of the host
+ ********************************************************************************
+ */
+
+#ifndef HOST_LWIP_SOCKETS_H
+#define HOST_LWIP_SOCKETS_H
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#define lwip_socket                     socket
+#define lwip_bind                       bind
+#define lwip_listen                     listen
+#define lwip_accept                     accept
+#define lwip_connect                    connect
+#define lwip_close                      close
+#define lwip_recv                       recv
+#define lwip_select                     select
+#define lwip_fcntl                      fcntl
+#define lwip_setsockopt                 setsockopt
+#define lwip_getsockopt                 getsockopt
+/*  a peer that went away must fail the send, not raise SIGPIPE */
+#define lwip_send(s, data, size, flags) send((s), (data), (size), (flags) | MSG_NOSIGNAL)
+
+#endif //HOST_LWIP_SOCKETS_H
@@ -0,0 +1,26 @@
+/**
+ ********************************************************************************
+ * @file    nvs_flash.h
+ * @author  hq
+ * @date    2026-10-19 09:12:40
+ * @brief   Host port of the SDK nvs partition api
+ ********************************************************************************
+ */
+
+#ifndef HOST_NVS_FLASH_H
+#define HOST_NVS_FLASH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "nvs.h"
+
+esp_err_t nvs_flash_init(void);
+esp_err_t nvs_flash_erase(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //HOST_NVS_FLASH_H
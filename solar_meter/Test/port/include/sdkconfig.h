@@ -0,0 +1,17 @@
+/**
+ ********************************************************************************
+ * @file    sdkconfig.h
+ * @author  hq
+ * @date    2026-10-19 09:12:40
+ * @brief   Host copy of the sdkconfig values the firmware reads
+ ********************************************************************************
+ */
+
+#ifndef HOST_SDKCONFIG_H
+#define HOST_SDKCONFIG_H
+
+#define CONFIG_ESP8266_DEFAULT_CPU_FREQ_MHZ 160
+#define CONFIG_FREERTOS_HZ 1000
+#define CONFIG_LOG_DEFAULT_LEVEL 3
+
+#endif //HOST_SDKCONFIG_H
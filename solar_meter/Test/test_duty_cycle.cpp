@@ -0,0 +1,436 @@
+/**
+ *******************************************************************************
+ * @file    test_duty_cycle.cpp
+ * @author  hq
+ * @date    2026-10-19 09:12:40
+ * @brief   Runs the deep sleep wake cycle of runDutyCycle() in main.cpp on
+ *  the host. A fake rtc memory survives the simulated sleeps, or loses its
+ *  content on a power loss, the clock restarts at zero on every boot.
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * INCLUDES
+ *******************************************************************************/
+#include "host_test.h"
+#include "duty_cycle.hpp"
+#include "persistent_config.hpp"
+#include "message_serializer.hpp"
+
+#include <string.h>
+
+extern "C"
+{
+    #include "host_port.h"
+    #include "esp_log.h"
+    #include "nvs_flash.h"
+}
+
+/*******************************************************************************
+ * PRIVATE MACROS AND DEFINES
+ *******************************************************************************/
+#define TEST_SLEEP_MS               (10000u)
+#define TEST_BURST_SAMPLES          (4u)
+#define TEST_TRANSMIT_EVERY         (3u)
+#define TEST_BOOT_US                (40000)     /* boot to the first sample   */
+#define TEST_REPORT_OFFSET          (TLV_HEADER_SIZE + 3u)
+
+/*******************************************************************************
+ * PRIVATE TYPEDEFS
+ *******************************************************************************/
+
+/*  rtc slow memory, kept across deep sleep and lost on a power loss */
+class FakeRtcMemory : public RtcMemory
+{
+public:
+    FakeRtcMemory() { powerLoss(); }
+
+    uint32_t getSize(void) const override { return RTC_MEMORY_SIZE; }
+
+    Status_t read(uint32_t offset, void * data, uint32_t length) override
+    {
+        Status_t status = checkRange(offset, length);
+
+        if (status == STATUS_OKAY)
+        {
+            memcpy(data, &bytes[offset], length);
+        }
+        return status;
+    }
+
+    Status_t write(uint32_t offset, const void * data, uint32_t length) override
+    {
+        Status_t status = checkRange(offset, length);
+
+        if (status == STATUS_OKAY)
+        {
+            memcpy(&bytes[offset], data, length);
+        }
+        return status;
+    }
+
+    /*  the content after power up is whatever the cells settled to */
+    void powerLoss(void)
+    {
+        for (uint32_t i = 0u; i < RTC_MEMORY_SIZE; i++)
+        {
+            bytes[i] = (uint8_t)((i * 151u) + 17u);
+        }
+    }
+
+    void corrupt(uint32_t offset) { bytes[offset] ^= 0x5Au; }
+
+private:
+    uint8_t bytes[RTC_MEMORY_SIZE];
+
+    static Status_t checkRange(uint32_t offset, uint32_t length)
+    {
+        bool valid =    (((offset | length) & (RTC_MEMORY_ALIGNMENT - 1u)) == 0u)
+                     && (offset <= RTC_MEMORY_SIZE)
+                     && (length <= (RTC_MEMORY_SIZE - offset));
+
+        return valid ? STATUS_OKAY : STATUS_OUT_OF_BOUNDS;
+    }
+};
+
+/*  constant bus values, the first read of a wake ends the boot latency */
+class FakeBurstSampler : public BurstSampler
+{
+public:
+    float busVoltage = 5.0f;
+    float busCurrent = 0.4f;
+    bool failing = false;
+    uint32_t reads = 0u;
+
+    Status_t start(void) override
+    {
+        host_advanceTimeUs(TEST_BOOT_US);
+        return STATUS_OKAY;
+    }
+
+    Status_t read(float * voltage, float * current) override
+    {
+        Status_t status = failing ? STATUS_HAL_ERROR : STATUS_OKAY;
+
+        host_advanceTimeUs((int64_t)ADS1115_BURST_CONVERSION_WAIT_MS * 2000);
+        if (status == STATUS_OKAY)
+        {
+            *voltage = busVoltage;
+            *current = busCurrent;
+            reads++;
+        }
+        return status;
+    }
+};
+
+/*  records the last payload published */
+class FakeTransport : public NetworkingTransport
+{
+public:
+    Status_t result = STATUS_OKAY;
+    uint32_t publishes = 0u;
+    uint8_t payload[DUTY_CYCLE_PAYLOAD_SIZE];
+    uint16_t length = 0u;
+
+    Status_t publish(const uint8_t * data, uint16_t size) override
+    {
+        publishes++;
+        if (size <= sizeof(payload))
+        {
+            memcpy(payload, data, size);
+            length = size;
+        }
+        return result;
+    }
+};
+
+/*  what one wake of runDutyCycle() reports */
+typedef struct
+{
+    Status_t wakeStatus;
+    bool transmitDue;
+    Status_t transmitStatus;
+    bool nextWakeTransmits;
+    DutyCycleStats_t stats;
+    DutyCycleRollup_t rollup;
+} WakeResult_t;
+
+/*******************************************************************************
+ * STATIC VARIABLES
+ *******************************************************************************/
+static const DutyCycleConfig_t testConfig =
+{
+    .sleepMs = TEST_SLEEP_MS,
+    .burstSamples = TEST_BURST_SAMPLES,
+    .transmitEvery = TEST_TRANSMIT_EVERY,
+};
+
+/*******************************************************************************
+ * GLOBAL VARIABLES
+ *******************************************************************************/
+HOST_TEST_MAIN_VARIABLES;
+
+/*******************************************************************************
+ * STATIC FUNCTIONS
+ *******************************************************************************/
+
+/*!
+ * \brief one boot: the same order of calls as runDutyCycle(), with the
+ * deep sleep at the end replaced by returning
+ */
+static WakeResult_t boot(FakeRtcMemory & rtc, FakeBurstSampler & sampler, NetworkingTransport * transport)
+{
+    WakeResult_t result;
+    DutyCycle dutyCycle(rtc, sampler);
+
+    memset(&result, 0, sizeof(result));
+    host_setManualClock(0);
+
+    result.wakeStatus = dutyCycle.init(&testConfig);
+    if (result.wakeStatus == STATUS_OKAY)
+    {
+        result.wakeStatus = dutyCycle.wake(&result.transmitDue);
+    }
+
+    /*! - the rollup is read before a transmit clears it  */
+    dutyCycle.getRollup(&result.rollup);
+    result.transmitStatus = STATUS_UNKNOWN;
+    if (result.transmitDue)
+    {
+        result.transmitStatus = dutyCycle.transmit(transport);
+    }
+
+    result.nextWakeTransmits = dutyCycle.nextWakeTransmits();
+    HOST_CHECK_EQUAL(STATUS_OKAY, dutyCycle.persist());
+    HOST_CHECK_EQUAL((uint64_t)TEST_SLEEP_MS * 1000u, dutyCycle.getSleepUs());
+    dutyCycle.getStats(&result.stats);
+
+    return result;
+}
+
+static float getReportFloat(const uint8_t * payload, uint32_t offset)
+{
+    float value;
+
+    memcpy(&value, &payload[TEST_REPORT_OFFSET + offset], sizeof(value));
+    return value;
+}
+
+/*******************************************************************************
+ * TESTS
+ *******************************************************************************/
+static void coldStartCountsFirstWake(void)
+{
+    FakeRtcMemory rtc;
+    FakeBurstSampler sampler;
+    FakeTransport transport;
+    WakeResult_t result = boot(rtc, sampler, &transport);
+
+    HOST_CHECK_EQUAL(STATUS_OKAY, result.wakeStatus);
+    HOST_CHECK_EQUAL(1u, result.stats.wakes);
+    HOST_CHECK_EQUAL(1u, result.rollup.wakes);
+    HOST_CHECK_EQUAL(TEST_BURST_SAMPLES, result.rollup.samples);
+    HOST_CHECK_EQUAL(TEST_BURST_SAMPLES, sampler.reads);
+    HOST_CHECK_EQUAL(false, result.transmitDue);
+    HOST_CHECK_EQUAL(0u, transport.publishes);
+    HOST_CHECK_EQUAL(TEST_BOOT_US + (ADS1115_BURST_CONVERSION_WAIT_MS * 2000), result.stats.lastBootToSampleUs);
+    HOST_CHECK_NEAR(2.0f, result.rollup.meanPower, 1e-5);
+}
+
+static void stateSurvivesSleepAndTransmitsEveryN(void)
+{
+    FakeRtcMemory rtc;
+    FakeBurstSampler sampler;
+    FakeTransport transport;
+
+    for (uint32_t wake = 1u; wake <= (3u * TEST_TRANSMIT_EVERY); wake++)
+    {
+        WakeResult_t result = boot(rtc, sampler, &transport);
+        bool due = ((wake % TEST_TRANSMIT_EVERY) == 0u);
+
+        HOST_CHECK_EQUAL(wake, result.stats.wakes);
+        HOST_CHECK_EQUAL(due, result.transmitDue);
+        HOST_CHECK_EQUAL(((wake + 1u) % TEST_TRANSMIT_EVERY) == 0u, result.nextWakeTransmits);
+        HOST_CHECK_EQUAL(due ? TEST_TRANSMIT_EVERY : (wake % TEST_TRANSMIT_EVERY), result.rollup.wakes);
+        if (due)
+        {
+            HOST_CHECK_EQUAL(STATUS_OKAY, result.transmitStatus);
+        }
+    }
+
+    WakeResult_t last = boot(rtc, sampler, &transport);
+
+    HOST_CHECK_EQUAL(3u, transport.publishes);
+    HOST_CHECK_EQUAL(3u, last.stats.transmits);
+    HOST_CHECK_EQUAL(0u, last.stats.transmitFailures);
+    /*! - the rollup restarted after the third transmit   */
+    HOST_CHECK_EQUAL(1u, last.rollup.wakes);
+}
+
+static void reportCarriesRollupAndClock(void)
+{
+    FakeRtcMemory rtc;
+    FakeBurstSampler sampler;
+    FakeTransport transport;
+    uint32_t awakeMs = 0u;
+
+    for (uint32_t wake = 1u; wake <= TEST_TRANSMIT_EVERY; wake++)
+    {
+        (void)boot(rtc, sampler, &transport);
+    }
+    awakeMs = (uint32_t)(TEST_BOOT_US + (TEST_BURST_SAMPLES * ADS1115_BURST_CONVERSION_WAIT_MS * 2000)) / 1000u;
+
+    HOST_CHECK_EQUAL(TEST_REPORT_OFFSET + DUTY_CYCLE_REPORT_SIZE, transport.length);
+    HOST_CHECK_EQUAL(MESSAGE_ID_DUTY_CYCLE, transport.payload[TLV_HEADER_SIZE]);
+    HOST_CHECK_EQUAL(DUTY_CYCLE_REPORT_VERSION, transport.payload[TEST_REPORT_OFFSET]);
+    HOST_CHECK_EQUAL(TEST_TRANSMIT_EVERY, transport.payload[TEST_REPORT_OFFSET + 1u]);
+
+    /*! - the base timestamp is the clock kept across sleeps, two sleeps
+          and two awake times after the cold start   */
+    uint32_t clockMs =    (uint32_t)transport.payload[2]
+                       | ((uint32_t)transport.payload[3] << 8)
+                       | ((uint32_t)transport.payload[4] << 16)
+                       | ((uint32_t)transport.payload[5] << 24);
+    HOST_CHECK_EQUAL((TEST_TRANSMIT_EVERY - 1u) * (TEST_SLEEP_MS + awakeMs), clockMs);
+
+    HOST_CHECK_NEAR(5.0f, getReportFloat(transport.payload, 4u), 1e-5);
+    HOST_CHECK_NEAR(0.4f, getReportFloat(transport.payload, 8u), 1e-5);
+    HOST_CHECK_NEAR(2.0f, getReportFloat(transport.payload, 12u), 1e-5);
+
+    /*! - 2 W over the time between the first and the last burst   */
+    HOST_CHECK_NEAR(2.0f * (float)clockMs / 3600000.0f, getReportFloat(transport.payload, 24u), 1e-5);
+}
+
+static void failedTransmitKeepsRollup(void)
+{
+    FakeRtcMemory rtc;
+    FakeBurstSampler sampler;
+    FakeTransport transport;
+    WakeResult_t result;
+
+    transport.result = STATUS_OS_ERROR;
+    for (uint32_t wake = 1u; wake <= TEST_TRANSMIT_EVERY; wake++)
+    {
+        result = boot(rtc, sampler, &transport);
+    }
+    HOST_CHECK_EQUAL(STATUS_OS_ERROR, result.transmitStatus);
+    HOST_CHECK_EQUAL(1u, result.stats.transmitFailures);
+
+    /*! - due again on the next wake, with one more wake in the rollup */
+    transport.result = STATUS_OKAY;
+    result = boot(rtc, sampler, &transport);
+    HOST_CHECK_EQUAL(true, result.transmitDue);
+    HOST_CHECK_EQUAL(TEST_TRANSMIT_EVERY + 1u, result.rollup.wakes);
+    HOST_CHECK_EQUAL(STATUS_OKAY, result.transmitStatus);
+    HOST_CHECK_EQUAL(1u, result.stats.transmits);
+    HOST_CHECK_EQUAL(TEST_TRANSMIT_EVERY + 1u, transport.payload[TEST_REPORT_OFFSET + 1u]);
+}
+
+static void missingTransportIsNotCounted(void)
+{
+    FakeRtcMemory rtc;
+    FakeBurstSampler sampler;
+    WakeResult_t result;
+
+    for (uint32_t wake = 1u; wake <= TEST_TRANSMIT_EVERY; wake++)
+    {
+        result = boot(rtc, sampler, nullptr);
+    }
+    HOST_CHECK_EQUAL(STATUS_NULL_POINTER, result.transmitStatus);
+    HOST_CHECK_EQUAL(0u, result.stats.transmits);
+    HOST_CHECK_EQUAL(0u, result.stats.transmitFailures);
+    HOST_CHECK_EQUAL(TEST_TRANSMIT_EVERY, result.rollup.wakes);
+}
+
+static void corruptedStateStartsCold(void)
+{
+    FakeRtcMemory rtc;
+    FakeBurstSampler sampler;
+    FakeTransport transport;
+    WakeResult_t result;
+
+    (void)boot(rtc, sampler, &transport);
+    result = boot(rtc, sampler, &transport);
+    HOST_CHECK_EQUAL(2u, result.stats.wakes);
+
+    /*! - one flipped byte inside the crc range  */
+    rtc.corrupt(DUTY_CYCLE_RTC_OFFSET + 16u);
+    result = boot(rtc, sampler, &transport);
+    HOST_CHECK_EQUAL(1u, result.stats.wakes);
+    HOST_CHECK_EQUAL(1u, result.rollup.wakes);
+
+    rtc.powerLoss();
+    result = boot(rtc, sampler, &transport);
+    HOST_CHECK_EQUAL(1u, result.stats.wakes);
+    HOST_CHECK_NEAR(0.0f, result.rollup.energyWh, 1e-9);
+}
+
+static void burstWithoutSamplesFails(void)
+{
+    FakeRtcMemory rtc;
+    FakeBurstSampler sampler;
+    FakeTransport transport;
+    WakeResult_t result;
+
+    (void)boot(rtc, sampler, &transport);
+    sampler.failing = true;
+    result = boot(rtc, sampler, &transport);
+    HOST_CHECK_EQUAL(STATUS_HAL_ERROR, result.wakeStatus);
+    HOST_CHECK_EQUAL(2u, result.stats.wakes);
+    HOST_CHECK_EQUAL(1u, result.stats.sampleFailures);
+    HOST_CHECK_EQUAL(1u, result.rollup.wakes);
+}
+
+/*!
+ * \brief the configuration is read from nvs once after a power loss and
+ * from its rtc copy on every wake, next to the duty cycle state
+ */
+static void configCacheSharesRtcMemory(void)
+{
+    FakeRtcMemory rtc;
+    FakeBurstSampler sampler;
+    FakeTransport transport;
+    NvsConfigStore store(PERSISTENT_CONFIG_NAMESPACE, PERSISTENT_CONFIG_KEY);
+    PersistentConfig config;
+    WakeResult_t result;
+
+    HOST_CHECK_EQUAL(ESP_OK, nvs_flash_erase());
+    HOST_CHECK_EQUAL(ESP_OK, nvs_flash_init());
+
+    HOST_CHECK(config.loadCached(rtc) != STATUS_OKAY);
+    HOST_CHECK_EQUAL(STATUS_UNKNOWN, config.load(store));
+    HOST_CHECK_EQUAL(STATUS_OKAY, config.cache(rtc));
+
+    for (uint32_t wake = 1u; wake <= 4u; wake++)
+    {
+        PersistentConfig woken;
+
+        HOST_CHECK_EQUAL(STATUS_OKAY, woken.loadCached(rtc));
+        HOST_CHECK(memcmp(&woken.get(), &config.get(), sizeof(device_config_t)) == 0);
+        result = boot(rtc, sampler, &transport);
+        HOST_CHECK_EQUAL(wake, result.stats.wakes);
+    }
+
+    rtc.powerLoss();
+    HOST_CHECK(config.loadCached(rtc) != STATUS_OKAY);
+    HOST_CHECK_EQUAL(STATUS_OKAY, config.load(store));
+}
+
+/*******************************************************************************
+ * GLOBAL FUNCTIONS
+ *******************************************************************************/
+int main(void)
+{
+    esp_log_level_set("*", ESP_LOG_WARN);
+
+    HOST_RUN(coldStartCountsFirstWake);
+    HOST_RUN(stateSurvivesSleepAndTransmitsEveryN);
+    HOST_RUN(reportCarriesRollupAndClock);
+    HOST_RUN(failedTransmitKeepsRollup);
+    HOST_RUN(missingTransportIsNotCounted);
+    HOST_RUN(corruptedStateStartsCold);
+    HOST_RUN(burstWithoutSamplesFails);
+    HOST_RUN(configCacheSharesRtcMemory);
+
+    return hostTestFailures;
+}
@@ -0,0 +1,241 @@
+/**
+ *******************************************************************************
+ * @file    test_metrics_server.cpp
+ * @author  hq
+ * @date    2026-10-19 18:21:09
+ * @brief   Scrapes the MetricsServer task over loopback TCP, as a scraper on
+ *  the network would. Checks the chunked text and binary responses, the
+ *  source added to the server, and the refused requests.
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * INCLUDES
+ *******************************************************************************/
+#include "host_test.h"
+#include "metrics_server.hpp"
+#include "socket_stream.hpp"
+
+#include <string.h>
+
+extern "C"
+{
+    #include "freertos/FreeRTOS.h"
+    #include "freertos/task.h"
+    #include "esp_log.h"
+}
+
+/*******************************************************************************
+ * PRIVATE MACROS AND DEFINES
+ *******************************************************************************/
+#define TEST_HOST                   "127.0.0.1"
+#define TEST_PORT                   (19100u)
+#define TEST_PORT_ATTEMPTS          (16u)
+#define TEST_RESPONSE_SIZE          (16384u)
+#define TEST_RECEIVE_TIMEOUT_MS     (3000u)
+
+/*******************************************************************************
+ * PRIVATE TYPEDEFS
+ *******************************************************************************/
+
+/*  one gauge with a fixed value, to find in the scrape */
+class TestSource : public MetricsSource
+{
+public:
+    volatile uint32_t scrapes = 0u;
+
+    void writeMetrics(MetricsWriter & writer) override
+    {
+        scrapes++;
+        writer.family("test_source_value", METRICS_TYPE_GAUGE, "Fixed value of the test source");
+        writer.writeUint(42u);
+    }
+};
+
+/*******************************************************************************
+ * STATIC VARIABLES
+ *******************************************************************************/
+
+/*  the task keeps serving to the end of the process, one server for all */
+static MetricsServer metricsServer;
+static TestSource testSource;
+static uint16_t serverPort = 0u;
+
+static char response[TEST_RESPONSE_SIZE];
+static char body[TEST_RESPONSE_SIZE];
+
+/*******************************************************************************
+ * GLOBAL VARIABLES
+ *******************************************************************************/
+HOST_TEST_MAIN_VARIABLES;
+
+/*******************************************************************************
+ * STATIC FUNCTIONS
+ *******************************************************************************/
+
+/*!
+ * \brief sends the request and reads until the server closes, returns the
+ * response length
+ */
+static uint32_t request(const char * text)
+{
+    SocketStream client;
+    uint32_t length = 0u;
+    Status_t status = client.openStream(TEST_HOST, serverPort);
+
+    HOST_CHECK_EQUAL(STATUS_OKAY, status);
+    if (status == STATUS_OKAY)
+    {
+        status = client.sendBytes((const uint8_t *)text, (uint16_t)strlen(text));
+    }
+
+    while ((status == STATUS_OKAY) && (length < (TEST_RESPONSE_SIZE - 1u)))
+    {
+        uint16_t received = 0u;
+
+        status = client.receiveBytes((uint8_t *)&response[length], (uint16_t)(TEST_RESPONSE_SIZE - 1u - length),
+                                     &received, TEST_RECEIVE_TIMEOUT_MS);
+        if ((status == STATUS_OKAY) && (received == 0u))
+        {
+            status = STATUS_NOTIFY_TIMEOUT;
+        }
+        length += received;
+    }
+
+    /*! - the server closes once the response is out */
+    HOST_CHECK_EQUAL(STATUS_HAL_ERROR, status);
+    response[length] = '\0';
+
+    return length;
+}
+
+/*!
+ * \brief joins the chunks of the body, returns its length or -1 if the
+ * chunk framing is broken
+ */
+static int32_t dechunk(const char * data, uint32_t length)
+{
+    const char * end = data + length;
+    const char * cursor = strstr(data, "\r\n\r\n");
+    int32_t bodyLength = 0;
+    bool last = false;
+
+    cursor = (cursor != nullptr) ? (cursor + 4) : end;
+
+    while ((cursor < end) && (last == false) && (bodyLength >= 0))
+    {
+        char * sizeEnd = nullptr;
+        unsigned long chunkSize = strtoul(cursor, &sizeEnd, 16);
+
+        if ((sizeEnd == cursor) || ((sizeEnd + 2 + chunkSize + 2) > end) || (memcmp(sizeEnd, "\r\n", 2) != 0))
+        {
+            bodyLength = -1;
+        }
+        else
+        {
+            memcpy(&body[bodyLength], sizeEnd + 2, chunkSize);
+            bodyLength += (int32_t)chunkSize;
+            cursor = sizeEnd + 2 + chunkSize + 2;
+            last = (chunkSize == 0u);
+        }
+    }
+
+    if (last == false)
+    {
+        bodyLength = -1;
+    }
+    else
+    {
+        body[bodyLength] = '\0';
+    }
+
+    return bodyLength;
+}
+
+static void textScrapeHasAllFamilies(void)
+{
+    uint32_t length = request("GET /metrics HTTP/1.1\r\nHost: meter\r\nAccept: */*\r\n\r\n");
+    int32_t bodyLength = 0;
+
+    HOST_CHECK(strncmp(response, "HTTP/1.1 200 OK\r\n", 17) == 0);
+    HOST_CHECK(strstr(response, "Transfer-Encoding: chunked\r\n") != nullptr);
+    HOST_CHECK(strstr(response, "Content-Type: text/plain; version=0.0.4\r\n") != nullptr);
+
+    bodyLength = dechunk(response, length);
+    HOST_CHECK(bodyLength > 0);
+    if (bodyLength > 0)
+    {
+        HOST_CHECK(strstr(body, "# TYPE solar_heap_free_bytes gauge\n") != nullptr);
+        HOST_CHECK(strstr(body, "# TYPE solar_metrics_scrapes_total counter\n") != nullptr);
+        HOST_CHECK(strstr(body, "\ntest_source_value 42\n") != nullptr);
+    }
+}
+
+static void binaryScrapeIsChunked(void)
+{
+    uint32_t length = request("GET /metrics.bin HTTP/1.1\r\n\r\n");
+
+    HOST_CHECK(strncmp(response, "HTTP/1.1 200 OK\r\n", 17) == 0);
+    HOST_CHECK(strstr(response, "Content-Type: application/octet-stream\r\n") != nullptr);
+    HOST_CHECK(dechunk(response, length) > 0);
+}
+
+static void unknownPathIsNotFound(void)
+{
+    MetricsServerStats_t before;
+    MetricsServerStats_t stats;
+
+    HOST_CHECK_EQUAL(STATUS_OKAY, metricsServer.getStats(&before));
+    (void)request("GET /metricsx HTTP/1.1\r\n\r\n");
+    HOST_CHECK(strncmp(response, "HTTP/1.1 404 Not Found\r\n", 24) == 0);
+
+    (void)request("POST /metrics HTTP/1.1\r\n\r\n");
+    HOST_CHECK(strncmp(response, "HTTP/1.1 404 Not Found\r\n", 24) == 0);
+
+    HOST_CHECK_EQUAL(STATUS_OKAY, metricsServer.getStats(&stats));
+    HOST_CHECK_EQUAL(before.badRequests + 2u, stats.badRequests);
+    HOST_CHECK_EQUAL(before.scrapes, stats.scrapes);
+}
+
+static void scrapesAreCounted(void)
+{
+    MetricsServerStats_t stats;
+
+    /*! - the two scrapes and the source ran once for each */
+    HOST_CHECK_EQUAL(STATUS_OKAY, metricsServer.getStats(&stats));
+    HOST_CHECK_EQUAL(2u, stats.scrapes);
+    HOST_CHECK_EQUAL(0u, stats.failures);
+    HOST_CHECK(stats.lastScrapeBytes > 0u);
+    HOST_CHECK_EQUAL(2u, testSource.scrapes);
+}
+
+/*******************************************************************************
+ * GLOBAL FUNCTIONS
+ *******************************************************************************/
+int main(void)
+{
+    Status_t status = STATUS_HAL_ERROR;
+
+    /*! - the refused requests are expected, the bind retries too */
+    esp_log_level_set("*", ESP_LOG_NONE);
+
+    HOST_CHECK_EQUAL(STATUS_OKAY, metricsServer.addSource(&testSource));
+
+    /*! - parallel runs may hold the first ports */
+    for (uint16_t i = 0u; (i < TEST_PORT_ATTEMPTS) && (status != STATUS_OKAY); i++)
+    {
+        serverPort = (uint16_t)(TEST_PORT + i);
+        status = metricsServer.init(serverPort);
+    }
+    HOST_CHECK_EQUAL(STATUS_OKAY, status);
+
+    if (status == STATUS_OKAY)
+    {
+        HOST_RUN(textScrapeHasAllFamilies);
+        HOST_RUN(binaryScrapeIsChunked);
+        HOST_RUN(unknownPathIsNotFound);
+        HOST_RUN(scrapesAreCounted);
+    }
+
+    return hostTestFailures;
+}
@@ -0,0 +1,204 @@
+/**
+ *******************************************************************************
+ * @file    test_networking.cpp
+ * @author  hq
+ * @date    2026-10-19 15:02:44
+ * @brief   Runs the NetworkingModule task on the host against a fake
+ *  transport and the store log on the ported telemetry partition, and
+ *  checks how each batch is counted and where it goes. Every message
+ *  closes a batch of its own.
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * INCLUDES
+ *******************************************************************************/
+#include "host_test.h"
+#include "networking.hpp"
+#include "message_pool.hpp"
+#include "flash_device.hpp"
+#include "flash_ring_log.hpp"
+
+#include <string.h>
+
+extern "C"
+{
+    #include "host_port.h"
+    #include "esp_log.h"
+}
+
+/*******************************************************************************
+ * PRIVATE MACROS AND DEFINES
+ *******************************************************************************/
+#define TEST_WAIT_MS                (2000u)
+#define TEST_PARTITION_LABEL        "telemetry"
+#define TEST_PARTITION_SUBTYPE      (0x40)
+
+/*******************************************************************************
+ * PRIVATE TYPEDEFS
+ *******************************************************************************/
+
+/*  takes or refuses every payload, as the test sets it */
+class FakeTransport : public NetworkingTransport
+{
+public:
+    volatile Status_t result = STATUS_OKAY;
+    volatile uint32_t publishes = 0u;
+
+    Status_t publish(const uint8_t * data, uint16_t size) override
+    {
+        (void)data;
+        (void)size;
+        publishes++;
+        return result;
+    }
+};
+
+/*******************************************************************************
+ * STATIC VARIABLES
+ *******************************************************************************/
+
+/*  the task keeps running to the end of the process, one module for all */
+static NetworkingModule networkingModule;
+static FakeTransport transport;
+static PartitionFlash telemetryFlash(TEST_PARTITION_LABEL, (esp_partition_subtype_t)TEST_PARTITION_SUBTYPE);
+static FlashRingLog storeLog(telemetryFlash);
+
+static const NetworkingBatchConfig_t testBatchConfig =
+{
+    NETWORKING_MAX_PAYLOAD_SIZE,
+    1u,
+    NETWORKING_DEFAULT_BATCH_LATENCY_MS,
+};
+
+/*******************************************************************************
+ * GLOBAL VARIABLES
+ *******************************************************************************/
+HOST_TEST_MAIN_VARIABLES;
+
+/*******************************************************************************
+ * STATIC FUNCTIONS
+ *******************************************************************************/
+static Status_t queueFloat(float value)
+{
+    Status_t status = STATUS_POOL_EXHAUSTED;
+    NetworkingMessage_t message;
+    MessageBuffer_t * buffer = messagePool.allocate(sizeof(float));
+
+    if (buffer != nullptr)
+    {
+        memcpy(buffer->data, &value, sizeof(float));
+        buffer->length = sizeof(float);
+        message.id = MESSAGE_ID_BUS_VOLTAGE;
+        message.timestamp = xTaskGetTickCount();
+        message.buffer = buffer;
+        status = networkingModule.queueNetworkingMessage(&message);
+    }
+
+    return status;
+}
+
+/*!
+ * \brief waits until the task closed as many batches as expected, sent or
+ * not, and returns the statistics then
+ */
+static NetworkingStats_t waitForBatches(uint32_t batches)
+{
+    NetworkingStats_t stats;
+    uint32_t waitedMs = 0u;
+
+    (void)networkingModule.getStats(&stats);
+    while (    ((stats.batchesPublished + stats.publishFailures) < batches)
+            && (waitedMs++ < TEST_WAIT_MS))
+    {
+        vTaskDelay(1u);
+        (void)networkingModule.getStats(&stats);
+    }
+
+    return stats;
+}
+
+/*!
+ * \brief before netStartupTask sets the transport the link counts as down,
+ * the batches go to the store log and are replayed once it is set
+ */
+static void missingTransportStoresBatch(void)
+{
+    NetworkingStats_t stats;
+    uint32_t waitedMs = 0u;
+
+    HOST_CHECK_EQUAL(STATUS_OKAY, queueFloat(1.0f));
+    HOST_CHECK_EQUAL(STATUS_OKAY, queueFloat(2.0f));
+    stats = waitForBatches(2u);
+    HOST_CHECK_EQUAL(0u, stats.batchesPublished);
+    HOST_CHECK_EQUAL(2u, stats.publishFailures);
+    HOST_CHECK_EQUAL(2u, stats.batchesStored);
+    HOST_CHECK_EQUAL(0u, stats.storeFailures);
+    HOST_CHECK_EQUAL(2u, storeLog.getPendingCount());
+
+    /*! - the first publish that goes through brings the backlog after it */
+    transport.result = STATUS_OKAY;
+    networkingModule.setTransport(&transport);
+    HOST_CHECK_EQUAL(STATUS_OKAY, queueFloat(3.0f));
+    while ((stats.batchesReplayed < 2u) && (waitedMs++ < TEST_WAIT_MS))
+    {
+        vTaskDelay(1u);
+        (void)networkingModule.getStats(&stats);
+    }
+    HOST_CHECK_EQUAL(1u, stats.batchesPublished);
+    HOST_CHECK_EQUAL(2u, stats.batchesReplayed);
+    HOST_CHECK_EQUAL(3u, transport.publishes);
+    HOST_CHECK_EQUAL(0u, storeLog.getPendingCount());
+}
+
+/*!
+ * \brief a refused payload is a failure, not a published batch
+ */
+static void refusedPayloadIsNotPublished(void)
+{
+    NetworkingStats_t before;
+    NetworkingStats_t stats;
+
+    (void)networkingModule.getStats(&before);
+    uint32_t closed = before.batchesPublished + before.publishFailures;
+
+    transport.result = STATUS_OKAY;
+    HOST_CHECK_EQUAL(STATUS_OKAY, queueFloat(1.0f));
+    stats = waitForBatches(closed + 1u);
+    HOST_CHECK_EQUAL(before.batchesPublished + 1u, stats.batchesPublished);
+    HOST_CHECK_EQUAL(before.publishFailures, stats.publishFailures);
+
+    transport.result = STATUS_HAL_ERROR;
+    HOST_CHECK_EQUAL(STATUS_OKAY, queueFloat(2.0f));
+    HOST_CHECK_EQUAL(STATUS_OKAY, queueFloat(3.0f));
+    stats = waitForBatches(closed + 3u);
+    HOST_CHECK_EQUAL(before.batchesPublished + 1u, stats.batchesPublished);
+    HOST_CHECK_EQUAL(before.publishFailures + 2u, stats.publishFailures);
+
+    /*! - the averages cover every batch closed */
+    HOST_CHECK_EQUAL(1u, stats.averageBatchMessages);
+    HOST_CHECK(stats.averageBatchBytes > 0u);
+}
+
+/*******************************************************************************
+ * GLOBAL FUNCTIONS
+ *******************************************************************************/
+int main(void)
+{
+    /*! - refused payloads are logged by the module */
+    esp_log_level_set("*", ESP_LOG_NONE);
+
+    /*! - the transport is set by the first test, as netStartupTask does
+          once the station is up */
+    host_flashReset();
+    HOST_CHECK_EQUAL(STATUS_OKAY, telemetryFlash.init());
+    HOST_CHECK_EQUAL(STATUS_OKAY, storeLog.mount());
+    networkingModule.setStoreLog(&storeLog);
+    HOST_CHECK_EQUAL(STATUS_OKAY, networkingModule.setBatchConfig(&testBatchConfig));
+    HOST_CHECK_EQUAL(STATUS_OKAY, networkingModule.init());
+
+    HOST_RUN(missingTransportStoresBatch);
+    HOST_RUN(refusedPayloadIsNotPublished);
+
+    return hostTestFailures;
+}
@@ -0,0 +1,377 @@
+/**
+ *******************************************************************************
+ * @file    test_power_monitor.cpp
+ * @author  hq
+ * @date    2026-10-19 14:20:31
+ * @brief   Runs the PowerMonitor sample path on the host: the sample clock
+ *  fires, the i2c task runs the slot commands against an ADS1115 model and
+ *  the monitor reads the conversions on its period. Checks what the raw
+ *  samples feed besides the bus means.
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * INCLUDES
+ *******************************************************************************/
+#include "host_test.h"
+#include "power_monitor.hpp"
+
+#include <math.h>
+#include <string.h>
+
+extern "C"
+{
+    #include "host_port.h"
+    #include "esp_log.h"
+    #include "i2c_task.h"
+    #include "sample_clock.h"
+}
+
+/*******************************************************************************
+ * PRIVATE MACROS AND DEFINES
+ *******************************************************************************/
+#define TEST_PERIOD_MS              (100u)
+#define TEST_SLOW_PERIOD_MS         (4000u)     /* below 1 Hz per channel     */
+#define TEST_VOLTS_PER_COUNT        (0.000125f)
+#define TEST_AMPS_PER_COUNT         (0.000125f)
+#define TEST_VOLTAGE_COUNTS         (12000)
+#define TEST_CURRENT_COUNTS         (3200)
+#define TEST_RIPPLE_HZ              (3.0)
+#define TEST_RIPPLE_COUNTS          (400.0)
+#define TEST_SAG_COUNTS             (6000)
+#define TEST_SAG_AT                 (40u)       /* voltage conversion index */
+#define TEST_CAPTURE_SAMPLES        (16u)       /* before and after         */
+#define TEST_QUIET_PERIOD_MS        (800u)      /* 400 ms per channel       */
+#define TEST_ACTIVE_PERIOD_MS       (100u)      /* 50 ms per channel        */
+#define TEST_I2C_POLLS              (1000u)
+#define TEST_PI                     (3.14159265358979)
+
+/*******************************************************************************
+ * PRIVATE TYPEDEFS
+ *******************************************************************************/
+
+/*  the time event is handed to dispatch() directly, no dispatcher task */
+class TestPowerMonitor : public PowerMonitor
+{
+public:
+    using PowerMonitor::PowerMonitor;
+
+    void timeout(void)
+    {
+        Event_t event = { EVENT_SIGNAL_TIMEOUT, 0u, 0u };
+
+        dispatch(event);
+    }
+};
+
+/*  single shot conversions: a config write starts one on its mux, the
+    conversion register returns it */
+class Ads1115Model
+{
+public:
+    ads1115Mux_t voltageMux = ADS1115_MUX_AIN0_GND;
+    double rippleHz = 0.0;
+    double rippleCounts = 0.0;
+    uint32_t sagAt = UINT32_MAX;
+    uint32_t voltageConversions = 0u;
+    uint8_t dataRate = 0u;              /* of the last conversion started   */
+
+    static esp_err_t write(uint8_t address, const uint8_t * data, size_t length, void * arg)
+    {
+        Ads1115Model * model = (Ads1115Model *)arg;
+
+        (void)address;
+        if (length == 1u)
+        {
+            model->pointer = data[0];
+        }
+        else if ((length == ADS1115_CONFIG_REGISTER_SIZE) && (model->pointer == ADS1115_CONFIG_REGISTER))
+        {
+            ads1115ConfigRegister_t configRegister;
+
+            memcpy(configRegister.bytes, data, length);
+            model->dataRate = configRegister.dataRate;
+            model->convert((ads1115Mux_t)configRegister.mux);
+        }
+        return ESP_OK;
+    }
+
+    static esp_err_t read(uint8_t address, uint8_t * data, size_t length, void * arg)
+    {
+        Ads1115Model * model = (Ads1115Model *)arg;
+
+        (void)address;
+        if (length == ADS1115_CONVERSION_REGISTER_SIZE)
+        {
+            data[0] = (uint8_t)((uint16_t)model->result >> 8);
+            data[1] = (uint8_t)model->result;
+        }
+        return ESP_OK;
+    }
+
+private:
+    uint8_t pointer = ADS1115_CONVERSION_REGISTER;
+    int16_t result = 0;
+
+    void convert(ads1115Mux_t mux)
+    {
+        if (mux == voltageMux)
+        {
+            double rateHz = 1000.0 / TEST_PERIOD_MS * POWER_MONITOR_TICKS_PER_PERIOD / POWER_MONITOR_CHANNELS;
+            double phase = 2.0 * TEST_PI * rippleHz * (double)voltageConversions / rateHz;
+
+            result = (int16_t)lround(TEST_VOLTAGE_COUNTS + (rippleCounts * sin(phase)));
+            if (voltageConversions >= sagAt)
+            {
+                result -= TEST_SAG_COUNTS;
+            }
+            voltageConversions++;
+        }
+        else
+        {
+            result = TEST_CURRENT_COUNTS;
+        }
+    }
+};
+
+/*******************************************************************************
+ * STATIC VARIABLES
+ *******************************************************************************/
+static const PowerMonitorAcquisition_t testAcquisition =
+{
+    ADS1115_MUX_AIN0_GND,
+    ADS1115_MUX_AIN1_AIN3,
+    0b001u,
+    ADS1115_DATA_RATE_860_SPS,
+};
+
+/*******************************************************************************
+ * GLOBAL VARIABLES
+ *******************************************************************************/
+HOST_TEST_MAIN_VARIABLES;
+
+/*******************************************************************************
+ * STATIC FUNCTIONS
+ *******************************************************************************/
+
+/*!
+ * \brief fires the ticks of one period, each waits for the i2c task to run
+ * its command, then hands the monitor its time event
+ */
+static void runPeriods(TestPowerMonitor & monitor, uint32_t periods)
+{
+    i2c_stats_t stats;
+
+    for (uint32_t period = 0u; period < periods; period++)
+    {
+        for (uint32_t tick = 0u; tick < POWER_MONITOR_TICKS_PER_PERIOD; tick++)
+        {
+            uint32_t polls = 0u;
+
+            (void)i2c_getStats(&stats);
+            uint32_t expected = stats.transactions + 1u;
+
+            host_hwTimerFire();
+            while ((stats.transactions < expected) && (polls++ < TEST_I2C_POLLS))
+            {
+                vTaskDelay(0u);
+                (void)i2c_getStats(&stats);
+            }
+        }
+
+        /*! - the notification follows the statistics update */
+        vTaskDelay(1u);
+        monitor.timeout();
+    }
+}
+
+/*!
+ * \brief the tone on the voltage input is found at the per channel rate,
+ * the current conversions stay out of the block
+ */
+static void rippleAnalyzerSeesVoltageOnly(void)
+{
+    Ads1115Model model;
+    BusVoltage busVoltage(TEST_VOLTS_PER_COUNT);
+    BusCurrent busCurrent(TEST_AMPS_PER_COUNT);
+    EnergyIntegrator energyIntegrator;
+    NetworkingModule networkingModule;
+    PowerTelemetry powerTelemetry(networkingModule);
+    PowerSampleTopic topic(energyIntegrator, powerTelemetry);
+    TestPowerMonitor monitor(topic, busVoltage, busCurrent, testAcquisition, TEST_PERIOD_MS);
+    RippleAnalyzer analyzer;
+    RippleResult_t ripple;
+    double rateHz = 1000.0 / TEST_PERIOD_MS * POWER_MONITOR_TICKS_PER_PERIOD / POWER_MONITOR_CHANNELS;
+
+    model.rippleHz = TEST_RIPPLE_HZ;
+    model.rippleCounts = TEST_RIPPLE_COUNTS;
+    host_i2cSetDevice(Ads1115Model::write, Ads1115Model::read, &model);
+    monitor.setRippleAnalyzer(&analyzer);
+
+    /*! - the first period starts the clock   */
+    runPeriods(monitor, 1u);
+    HOST_CHECK_EQUAL(STATUS_UNKNOWN, monitor.getRipple(&ripple));
+
+    runPeriods(monitor, (RIPPLE_BLOCK_SIZE / 2u) + 4u);
+    HOST_CHECK_EQUAL(STATUS_OKAY, monitor.getRipple(&ripple));
+
+    /*! - a quarter bin, plus the 0.1 Hz step of the result    */
+    HOST_CHECK_NEAR(TEST_RIPPLE_HZ, ripple.dominantFrequencyDeciHz / 10.0, (0.25 * rateHz / RIPPLE_BLOCK_SIZE) + 0.1);
+    HOST_CHECK_NEAR(TEST_RIPPLE_COUNTS, (double)ripple.rippleAmplitude, 0.2 * TEST_RIPPLE_COUNTS);
+    HOST_CHECK_NEAR(TEST_VOLTAGE_COUNTS, ripple.blockMean, 0.05 * TEST_RIPPLE_COUNTS);
+
+    HOST_CHECK_EQUAL(STATUS_OKAY, sample_clock_stop());
+}
+
+/*!
+ * \brief a sag on the voltage input freezes the capture, the monitor
+ * publishes the block once the post trigger samples are in and re-arms it
+ */
+static void transientCapturePublishesSag(void)
+{
+    Ads1115Model model;
+    BusVoltage busVoltage(TEST_VOLTS_PER_COUNT);
+    BusCurrent busCurrent(TEST_AMPS_PER_COUNT);
+    EnergyIntegrator energyIntegrator;
+    NetworkingModule networkingModule;
+    PowerTelemetry powerTelemetry(networkingModule);
+    PowerSampleTopic topic(energyIntegrator, powerTelemetry);
+    TestPowerMonitor monitor(topic, busVoltage, busCurrent, testAcquisition, TEST_PERIOD_MS);
+    NetworkingModule captureNetworking;
+    TransientCapture capture(captureNetworking);
+    NetworkingStats_t stats;
+    const CaptureConfig_t config =
+    {
+        CAPTURE_TRIGGER_SLOPE_FALLING,
+        TEST_SAG_COUNTS / 2,
+        TEST_CAPTURE_SAMPLES,
+        TEST_CAPTURE_SAMPLES,
+    };
+
+    /*! - only the capture queues, the telemetry of the monitor is refused */
+    HOST_CHECK_EQUAL(STATUS_OKAY, captureNetworking.initQueue(4u));
+    HOST_CHECK_EQUAL(STATUS_OKAY, capture.configure(&config));
+    model.sagAt = TEST_SAG_AT;
+    host_i2cSetDevice(Ads1115Model::write, Ads1115Model::read, &model);
+    monitor.setTransientCapture(&capture);
+
+    /*! - two voltage conversions per period  */
+    runPeriods(monitor, (TEST_SAG_AT / 2u) - 2u);
+    HOST_CHECK_EQUAL(CAPTURE_STATE_ARMED, capture.getState());
+
+    runPeriods(monitor, (TEST_CAPTURE_SAMPLES / 2u) + 4u);
+    HOST_CHECK_EQUAL(CAPTURE_STATE_ARMED, capture.getState());
+    HOST_CHECK_EQUAL(STATUS_OKAY, captureNetworking.getStats(&stats));
+    HOST_CHECK_EQUAL(1u, stats.messagesQueued);
+
+    HOST_CHECK_EQUAL(STATUS_OKAY, sample_clock_stop());
+}
+
+/*!
+ * \brief a step on the voltage input raises the data rate and shortens the
+ * period at once, a quiet bus steps them back down level by level
+ */
+static void adaptiveSamplerSetsRateAndPeriod(void)
+{
+    Ads1115Model model;
+    BusVoltage busVoltage(TEST_VOLTS_PER_COUNT);
+    BusCurrent busCurrent(TEST_AMPS_PER_COUNT);
+    EnergyIntegrator energyIntegrator;
+    NetworkingModule networkingModule;
+    PowerTelemetry powerTelemetry(networkingModule);
+    PowerSampleTopic topic(energyIntegrator, powerTelemetry);
+    TestPowerMonitor monitor(topic, busVoltage, busCurrent, testAcquisition, TEST_PERIOD_MS);
+    AdaptiveSampler sampler;
+    AdaptiveSamplerStats_t stats;
+    uint32_t periods = 0u;
+    const AdaptiveSamplerConfig_t config =
+    {
+        ADS1115_DATA_RATE_128_SPS,
+        ADS1115_DATA_RATE_860_SPS,
+        TEST_QUIET_PERIOD_MS / 2u,
+        TEST_ACTIVE_PERIOD_MS / 2u,
+        TEST_SAG_COUNTS / 2u,
+        50u,
+        UINT32_MAX,
+        1600u,
+        4u,
+    };
+
+    host_i2cSetDevice(Ads1115Model::write, Ads1115Model::read, &model);
+    HOST_CHECK_EQUAL(STATUS_OKAY, sampler.init(&config));
+
+    /*! - the quiet level is taken before the clock starts   */
+    monitor.setAdaptiveSampler(&sampler);
+    HOST_CHECK_EQUAL(TEST_QUIET_PERIOD_MS, monitor.getPeriodMs());
+
+    runPeriods(monitor, 8u);
+    HOST_CHECK_EQUAL(TEST_QUIET_PERIOD_MS, monitor.getPeriodMs());
+    HOST_CHECK_EQUAL(ADS1115_DATA_RATE_128_SPS, model.dataRate);
+
+    /*! - the step may be read in the next period, the clock is stopped
+          at the end of that one and restarts a period later  */
+    model.sagAt = model.voltageConversions + 1u;
+    runPeriods(monitor, 4u);
+    HOST_CHECK_EQUAL(TEST_ACTIVE_PERIOD_MS, monitor.getPeriodMs());
+    HOST_CHECK_EQUAL(ADS1115_DATA_RATE_860_SPS, model.dataRate);
+
+    /*! - the variance of the step decays, then one level per quiet hold */
+    while ((monitor.getPeriodMs() != TEST_QUIET_PERIOD_MS) && (periods++ < 200u))
+    {
+        runPeriods(monitor, 1u);
+    }
+    runPeriods(monitor, 2u);
+    HOST_CHECK_EQUAL(TEST_QUIET_PERIOD_MS, monitor.getPeriodMs());
+    HOST_CHECK_EQUAL(ADS1115_DATA_RATE_128_SPS, model.dataRate);
+
+    HOST_CHECK_EQUAL(STATUS_OKAY, sampler.getStats(&stats));
+    HOST_CHECK_EQUAL(4u, stats.levelChanges);
+
+    HOST_CHECK_EQUAL(STATUS_OKAY, sample_clock_stop());
+}
+
+/*!
+ * \brief a period with less than one conversion per second and channel
+ * samples without the analyzer
+ */
+static void slowPeriodSamplesWithoutRipple(void)
+{
+    Ads1115Model model;
+    BusVoltage busVoltage(TEST_VOLTS_PER_COUNT);
+    BusCurrent busCurrent(TEST_AMPS_PER_COUNT);
+    EnergyIntegrator energyIntegrator;
+    NetworkingModule networkingModule;
+    PowerTelemetry powerTelemetry(networkingModule);
+    PowerSampleTopic topic(energyIntegrator, powerTelemetry);
+    TestPowerMonitor monitor(topic, busVoltage, busCurrent, testAcquisition, TEST_SLOW_PERIOD_MS);
+    RippleAnalyzer analyzer;
+    RippleResult_t ripple;
+    PowerMonitorMeasurements_t measurements;
+
+    host_i2cSetDevice(Ads1115Model::write, Ads1115Model::read, &model);
+    monitor.setRippleAnalyzer(&analyzer);
+
+    runPeriods(monitor, RIPPLE_BLOCK_SIZE + 2u);
+    HOST_CHECK_EQUAL(STATUS_UNKNOWN, monitor.getRipple(&ripple));
+    HOST_CHECK_EQUAL(STATUS_OKAY, monitor.getMeasurements(&measurements));
+    HOST_CHECK_NEAR(TEST_VOLTAGE_COUNTS * TEST_VOLTS_PER_COUNT, measurements.busVoltage, 0.001);
+
+    HOST_CHECK_EQUAL(STATUS_OKAY, sample_clock_stop());
+}
+
+/*******************************************************************************
+ * GLOBAL FUNCTIONS
+ *******************************************************************************/
+int main(void)
+{
+    /*! - nothing drains the telemetry queue, the monitor logs every publish */
+    esp_log_level_set("*", ESP_LOG_NONE);
+    init_i2cHandler();
+
+    HOST_RUN(rippleAnalyzerSeesVoltageOnly);
+    HOST_RUN(transientCapturePublishesSag);
+    HOST_RUN(adaptiveSamplerSetsRateAndPeriod);
+    HOST_RUN(slowPeriodSamplesWithoutRipple);
+
+    return hostTestFailures;
+}